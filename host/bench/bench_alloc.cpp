@@ -0,0 +1,387 @@
+/*
+ * bench_alloc.cpp
+ *
+ * Heap Allocations per Scan Cycle
+ * Runs the sketch's own scan -> event -> subscriber path (tagDetected,
+ * logTagEvent, the display and web subscribers, publishing to a
+ * loopback broker) over the simulator's built-in scenario on the virtual
+ * clock, and counts malloc calls per scan cycle and per tag event.
+ *
+ * The first pass warms up (broker connection, first draws) and records
+ * the raw scan results with the trace recorder. The second pass is the
+ * measurement. The recorded results are then fed through the String
+ * path the reader had before TagUID - processNFCReader()'s UID
+ * formatting and debounce, tagDetected(), displayTag() and publishTag(),
+ * lifted from the 1.0.15 sources - publishing on the same connection.
+ *
+ * The host String has no small-string buffer. The ESP32 core's keeps
+ * up to 11 characters inline, so the legacy figures are an upper bound
+ * for the short temporaries; the 16-digit UIDs and topics allocate on
+ * both.
+ */
+
+#include <Arduino.h>
+#include "../../src/MQTTTagReaderDisplay_ESP32.ino"
+#include "nfc_simulator.h"
+#include "mqtt_test_broker.h"
+#include <ArduinoJson.h>
+#include <stdlib.h>
+#include <vector>
+
+static MqttTestBroker broker;
+static uint32_t benchEvents = 0;
+
+// The bus has room for the sketch's four subscribers only, so events
+// are counted on the way into the log subscriber
+static void countAndLogEvent(const TagEventInfo& event) {
+  benchEvents++;
+  logTagEvent(event);
+}
+
+struct StageCounts {
+  uint64_t scan;       // processNFCReader()
+  uint64_t events;     // dispatchNFCEvents() - all subscribers, publish included
+  uint64_t loop;       // the rest of loop(): web, MQTT loop/queue/batch, display
+  uint32_t cycles;
+  uint32_t tagEvents;
+  uint32_t polls;      // Inventory rounds the simulator answered
+};
+
+// setup() without the 1-9 s of splash screens and without startNFCTask() -
+// the bench calls processNFCReader() itself
+static void benchSetup() {
+  loadConfig();
+  SPI.begin(18, 19, 23, 5);
+  initDisplay();
+  initMqttHandler(&mqttClient, &espClient, &config);
+  setMqttConfig(config.mqtt_broker, config.mqtt_port, config.mqtt_subscribe_topic);
+  setWebServerConfig(&config);
+  setWebServerMqttClient(&mqttClient);
+  setConfigSaveCallback(saveConfig);
+  initWebServer(&webServer);
+  initNFCTrace();
+  initMqttQueue();
+  setNFCProtocols(config.protocols);
+  if (!initNFCReader()) {
+    fprintf(stderr, "initNFCReader failed\n");
+    hostExit(1);
+  }
+  subscribeTagEvents("mqtt", tagDetected, 8);
+  subscribeTagEvents("display", displayTagEvent, 0);
+  subscribeTagEvents("web", webTagEvent, 0);
+  subscribeTagEvents("log", countAndLogEvent, 4);
+  setNFCScanIntervals(config.scan_min_interval, config.scan_max_interval);
+  DebouncePolicy policy = {
+    config.debounce_mode, config.debounce_enter, config.debounce_window,
+    config.debounce_leave, config.debounce_timeout
+  };
+  setNFCDebounce(policy);
+  setNFCIdleMode(config.lpcd_quiet);
+  setDisplayPage(config.display_page);
+  updateDisplay();
+}
+
+// One pass of the scenario: what the scan task does, then loop()
+static StageCounts runPass() {
+  PN5180Simulator* sim = getNFCSimulator(0);
+  uint32_t runs = sim->getStats().runs;
+  uint32_t eventsBefore = benchEvents;
+  uint32_t pollsBefore = sim->getStats().polls;
+  StageCounts c = {};
+
+  while (sim->getStats().runs == runs) {
+    uint64_t a = hostHeapStats().allocations;
+    processNFCReader();
+    uint64_t b = hostHeapStats().allocations;
+    dispatchNFCEvents();
+    uint64_t d = hostHeapStats().allocations;
+    loop();
+    uint64_t e = hostHeapStats().allocations;
+    c.scan += b - a;
+    c.events += d - b;
+    c.loop += e - d;
+    c.cycles++;
+    delay(1);
+  }
+  c.tagEvents = benchEvents - eventsBefore;
+  c.polls = sim->getStats().polls - pollsBefore;
+  return c;
+}
+
+// ---- The pre-TagUID path (1.0.15), fed from recorded scan results ----
+
+#define LEGACY_REQUIRED_CONSECUTIVE_READS 2
+#define LEGACY_TAG_TIMEOUT 1000
+#define LEGACY_CONTINUING_INTERVAL 3000
+#define LEGACY_EC_NO_CARD 0x01
+
+static String legacyLastUID = "";
+static bool legacyTagPresent = false;
+static unsigned long legacyLastTagTime = 0;
+static String legacyPendingUID = "";
+static int legacyConsecutiveReads = 0;
+static String legacyLastPublishedUID = "";
+static String legacyLastPublishedEvent = "";
+static unsigned long legacyLastContinuingTime = 0;
+static String legacyCurrentUID = "";
+static unsigned long legacyNow = 0;
+static uint32_t legacyEvents = 0;
+static uint32_t legacyPublished = 0;
+
+static void legacyPublishTag(const char* uid, const char* event) {
+  if (!mqttClient.connected()) return;
+
+  String topic = String(config.mqtt_base_topic) + "/" + event;
+
+  StaticJsonDocument<200> doc;
+  doc["u"] = uid;
+  doc["s"] = config.sensor_id;
+
+  if (strcmp(event, "Read") == 0) {
+    doc["R"] = "R";
+  } else if (strcmp(event, "Continuing") == 0) {
+    doc["R"] = "C";
+  } else if (strcmp(event, "Unread") == 0) {
+    doc["R"] = "U";
+  }
+
+  String payload;
+  serializeJson(doc, payload);
+
+  if (mqttClient.publish(topic.c_str(), payload.c_str())) {
+    legacyPublished++;
+    Serial.print(F("MQTT: "));
+    Serial.print(topic);
+    Serial.print(F(" -> "));
+    Serial.println(payload);
+  }
+}
+
+// displayTag() without the redraw it triggered
+static void legacyDisplayTag(const char* uid, bool present) {
+  legacyCurrentUID = String(uid);
+}
+
+static void legacyTagDetected(const char* uid, bool present) {
+  legacyEvents++;
+  legacyDisplayTag(uid, present);
+
+  if (present) {
+    if (String(uid) != legacyLastPublishedUID) {
+      legacyPublishTag(uid, "Read");
+      legacyLastPublishedUID = String(uid);
+      legacyLastPublishedEvent = "Read";
+      legacyLastContinuingTime = legacyNow;
+    } else {
+      unsigned long now = legacyNow;
+      if (now - legacyLastContinuingTime >= LEGACY_CONTINUING_INTERVAL) {
+        if (legacyLastPublishedEvent != "Continuing") {
+          legacyPublishTag(uid, "Continuing");
+          legacyLastPublishedEvent = "Continuing";
+          legacyLastContinuingTime = now;
+        }
+      }
+    }
+  } else {
+    legacyPublishTag(uid, "Unread");
+    legacyLastPublishedUID = "";
+    legacyLastPublishedEvent = "Unread";
+  }
+}
+
+// processNFCReader() after getInventory(), minus the status counters
+static void legacyScan(unsigned long now, uint8_t rc, const uint8_t* uid) {
+  legacyNow = now;
+
+  if (rc == 0) {
+    bool validUID = false;
+    bool allZeros = true;
+    bool allFF = true;
+    for (int i = 0; i < 8; i++) {
+      if (uid[i] != 0x00) allZeros = false;
+      if (uid[i] != 0xFF) allFF = false;
+      if (uid[i] != 0x00 && uid[i] != 0xFF) validUID = true;
+    }
+
+    if (allZeros || allFF || !validUID) {
+      legacyConsecutiveReads = 0;
+      legacyPendingUID = "";
+      if (legacyTagPresent && (now - legacyLastTagTime > LEGACY_TAG_TIMEOUT)) {
+        legacyTagPresent = false;
+        legacyTagDetected(legacyLastUID.c_str(), false);
+        legacyLastUID = "";
+      }
+      return;
+    }
+
+    String uidStr = "";
+    for (int i = 7; i >= 0; i--) {
+      if (uid[i] < 0x10) uidStr += "0";
+      uidStr += String(uid[i], HEX);
+    }
+    uidStr.toUpperCase();
+
+    if (uidStr == legacyPendingUID) {
+      legacyConsecutiveReads++;
+    } else {
+      legacyPendingUID = uidStr;
+      legacyConsecutiveReads = 1;
+    }
+
+    if (legacyConsecutiveReads < LEGACY_REQUIRED_CONSECUTIVE_READS) {
+      Serial.print(F("Pending read ("));
+      Serial.print(legacyConsecutiveReads);
+      Serial.print(F("/"));
+      Serial.print(LEGACY_REQUIRED_CONSECUTIVE_READS);
+      Serial.print(F("): "));
+      Serial.println(uidStr);
+      return;
+    }
+
+    if (uidStr != legacyLastUID) {
+      Serial.print(F("Tag detected: "));
+      Serial.println(uidStr);
+      legacyLastUID = uidStr;
+      legacyTagPresent = true;
+      legacyLastTagTime = now;
+      legacyTagDetected(uidStr.c_str(), true);
+    } else if (!legacyTagPresent) {
+      Serial.print(F("Tag returned: "));
+      Serial.println(uidStr);
+      legacyTagPresent = true;
+      legacyLastTagTime = now;
+      legacyTagDetected(uidStr.c_str(), true);
+    } else {
+      legacyLastTagTime = now;
+      legacyTagDetected(uidStr.c_str(), true);
+    }
+  } else if (rc != LEGACY_EC_NO_CARD) {
+    legacyConsecutiveReads = 0;
+    legacyPendingUID = "";
+  }
+
+  if (legacyTagPresent && (now - legacyLastTagTime > LEGACY_TAG_TIMEOUT)) {
+    Serial.print(F("Tag removed: "));
+    Serial.println(legacyLastUID);
+    legacyTagPresent = false;
+    legacyTagDetected(legacyLastUID.c_str(), false);
+    legacyLastUID = "";
+  }
+}
+
+struct RecordedScan {
+  uint32_t time;
+  uint8_t rc;
+  uint8_t uid[8];
+};
+
+// Read back the trace file(s) the first pass wrote, oldest first
+static void loadTrace(const char* root, std::vector<RecordedScan>& scans) {
+  const char* files[] = { NFC_TRACE_OLD_FILE, NFC_TRACE_FILE };
+  for (const char* name : files) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s%s", root, name);
+    FILE* f = fopen(path, "rb");
+    if (!f) continue;
+    uint32_t magic = 0;
+    if (fread(&magic, 4, 1, f) != 1 || magic != NFC_TRACE_MAGIC) {
+      fclose(f);
+      continue;
+    }
+    uint8_t head[6];
+    while (fread(head, 1, 6, f) == 6) {
+      uint8_t cards = head[5] & 0x1F;
+      uint8_t uids[MAX_TAGS * 8] = { 0 };
+      if (cards > MAX_TAGS || fread(uids, 8, cards, f) != cards) break;
+      if (head[5] & 0x80) continue;  // ISO14443A - the old reader never saw these
+      RecordedScan s;
+      memcpy(&s.time, head, 4);
+      // One getInventory() result: the first card, or no card
+      s.rc = head[4] == NFC_TRACE_NO_CARD ? LEGACY_EC_NO_CARD : head[4];
+      if (s.rc == 0 && cards == 0) s.rc = LEGACY_EC_NO_CARD;
+      memcpy(s.uid, uids, 8);
+      scans.push_back(s);
+    }
+    fclose(f);
+  }
+}
+
+static void printRow(const char* stage, uint64_t count, uint32_t cycles, uint32_t events) {
+  printf("  %-34s %8llu %10.3f %10.2f\n", stage, (unsigned long long)count,
+         cycles ? (double)count / cycles : 0.0, events ? (double)count / events : 0.0);
+}
+
+int main() {
+  hostSerialEcho(false);
+  hostUseVirtualClock(true);
+
+  char root[] = "/tmp/bench_alloc_XXXXXX";
+  if (!mkdtemp(root)) return 1;
+  hostSetFilesystemRoot(root);
+
+  if (!broker.start()) {
+    fprintf(stderr, "broker failed to start\n");
+    return 1;
+  }
+  Preferences prefs;
+  prefs.begin("rfid-reader", false);
+  prefs.putString("mqtt_broker", "127.0.0.1");
+  prefs.putUInt("mqtt_port", broker.port());
+  prefs.end();
+
+  benchSetup();
+
+  // Pass 1: warm-up, with the trace recorder capturing every scan result
+  startNFCTrace();
+  StageCounts warm = runPass();
+  stopNFCTrace();
+  flushNFCTrace();
+  if (!mqttClient.connected()) {
+    fprintf(stderr, "not connected to the loopback broker\n");
+    return 1;
+  }
+  uint32_t publishedBefore = getMqttPublishCount();
+
+  // Pass 2: measured
+  HostHeapStats before = hostHeapStats();
+  StageCounts c = runPass();
+  HostHeapStats after = hostHeapStats();
+  uint32_t published = getMqttPublishCount() - publishedBefore;
+
+  printf("Current path (TagUID, static buffers) - one pass of the built-in scenario\n");
+  printf("  warm-up pass: %u cycles, %llu allocations\n", warm.cycles,
+         (unsigned long long)(warm.scan + warm.events + warm.loop));
+  printf("  measured pass: %u scan cycles, %u inventory rounds, %u tag events, %u MQTT messages\n",
+         c.cycles, c.polls, c.tagEvents, published);
+  printf("  %-34s %8s %10s %10s\n", "stage", "allocs", "per cycle", "per event");
+  printRow("processNFCReader()", c.scan, c.cycles, c.tagEvents);
+  printRow("dispatchNFCEvents() + subscribers", c.events, c.cycles, c.tagEvents);
+  printRow("rest of loop()", c.loop, c.cycles, c.tagEvents);
+  printRow("total", after.allocations - before.allocations, c.cycles, c.tagEvents);
+  printf("  bytes requested: %llu\n", (unsigned long long)(after.bytes - before.bytes));
+
+  // Legacy path over the pass-1 scan results
+  std::vector<RecordedScan> scans;
+  loadTrace(root, scans);
+  if (scans.empty()) {
+    fprintf(stderr, "no scan results recorded\n");
+    return 1;
+  }
+  uint32_t legacyEventsBefore = legacyEvents;
+  uint32_t legacyPublishedBefore = legacyPublished;
+  before = hostHeapStats();
+  for (const RecordedScan& s : scans) legacyScan(s.time, s.rc, s.uid);
+  after = hostHeapStats();
+  uint32_t events = legacyEvents - legacyEventsBefore;
+
+  printf("\nString path (1.0.15) - the same pass, replayed from the trace\n");
+  printf("  %u scan results, %u tag callbacks, %u MQTT messages\n",
+         (uint32_t)scans.size(), events, legacyPublished - legacyPublishedBefore);
+  printf("  %-34s %8s %10s %10s\n", "stage", "allocs", "per scan", "per callback");
+  printRow("scan + callback + publish", after.allocations - before.allocations,
+           scans.size(), events);
+  printf("  bytes requested: %llu\n", (unsigned long long)(after.bytes - before.bytes));
+
+  broker.stop();
+  hostExit(0);
+}
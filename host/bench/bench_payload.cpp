@@ -0,0 +1,225 @@
+/*
+ * bench_payload.cpp
+ *
+ * JSON vs Binary Payloads
+ * Publishes the same tag events in both Payload Formats to the loopback
+ * broker and feeds the broker's copies back through mqttCallback() as
+ * another sensor's messages, printing payload bytes, encode time and
+ * decode time per event.
+ *
+ * For the timings PubSubClient writes to a DiscardClient, so a loopback
+ * socket shared with the broker thread doesn't swamp them. Encode is
+ * publishTag() from the event to that write (its Serial log line
+ * included); the same bytes handed straight to mqttClient.publish() are
+ * timed alongside, and the difference is building the payload plus the
+ * history and log bookkeeping both formats share. Decode is the whole of
+ * mqttCallback() for a message that gets parsed, the history and fleet
+ * statistics updates included. Each time is the best of TIMING_REPEATS
+ * runs, in host nanoseconds: the ratio between the formats is the figure
+ * to take to the ESP32, not the absolute values.
+ */
+
+#include <Arduino.h>
+#include "../../src/MQTTTagReaderDisplay_ESP32.ino"
+#include "discard_client.h"
+#include "mqtt_test_broker.h"
+#include <chrono>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#define ROUNDS        2000  // Events per measurement
+#define BATCH_EVENTS  16
+#define OTHER_SENSOR  7     // The reader's ID while decoding its own messages
+#define TIMING_REPEATS 7
+
+static MqttTestBroker broker;
+static DiscardClient discardClient;
+
+struct EventKind {
+  const char* name;
+  const char* event;
+  unsigned long dwell;
+};
+
+static const EventKind kinds[] = {
+  { "Read",              "Read",       0 },
+  { "Continuing",        "Continuing", 0 },
+  { "Unread with dwell", "Unread",     5230 },
+};
+
+struct FormatResult {
+  uint32_t bytes;               // Payload bytes per message
+  double encodeNs;              // publishTag() per event
+  double rawNs;                 // mqttClient.publish() of the same bytes
+  double decodeNs;              // mqttCallback() per message
+};
+
+static uint64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool connectBroker() {
+  for (int i = 0; i < 2000 && !mqttClient.connected(); i++) {
+    processMqttConnection();
+    usleep(500);
+  }
+  return mqttClient.connected();
+}
+
+static TagUID benchUid(uint32_t i) {
+  TagUID uid;
+  uid.value = 0xE004010918480000ULL + i;
+  return uid;
+}
+
+// mqttCallback() over the given messages, as another sensor's; ns per message
+static double timeDecode(const std::vector<MqttTestMessage>& messages) {
+  uint8_t ownId = config.sensor_id;
+  config.sensor_id = OTHER_SENSOR;
+  refreshMqttConfig();
+  MqttReceiveStats before = getMqttReceiveStats();
+
+  uint64_t best = UINT64_MAX;
+  for (int r = 0; r < TIMING_REPEATS; r++) {
+    uint64_t start = nowNs();
+    for (const MqttTestMessage& m : messages) {
+      mqttCallback((char*)m.topic, (byte*)m.payload, m.length);
+    }
+    best = min(best, nowNs() - start);
+  }
+
+  MqttReceiveStats after = getMqttReceiveStats();
+  config.sensor_id = ownId;
+  refreshMqttConfig();
+  uint32_t expected = messages.size() * TIMING_REPEATS;
+  if (after.parsed - before.parsed != expected) {
+    fprintf(stderr, "only %u of %u messages parsed\n", after.parsed - before.parsed, expected);
+    exit(1);
+  }
+  return (double)best / messages.size();
+}
+
+// publishTag() for count events; ns per event
+static double timePublish(const EventKind& kind, uint32_t count) {
+  uint64_t best = UINT64_MAX;
+  for (int r = 0; r < TIMING_REPEATS; r++) {
+    uint64_t start = nowNs();
+    for (uint32_t i = 0; i < count; i++) {
+      publishTag(benchUid(i), kind.event, 0, PROTOCOL_ISO15693, kind.dwell, millis());
+    }
+    best = min(best, nowNs() - start);
+  }
+  return (double)best / count;
+}
+
+// One event kind in one format, batchEvents per message (1 = no batching)
+static FormatResult measure(uint8_t format, const EventKind& kind, uint8_t batchEvents) {
+  FormatResult result;
+  config.mqtt_format = format;
+  config.mqtt_batch_ms = (batchEvents > 1) ? 60000 : 0;
+  config.mqtt_batch_max = batchEvents;
+  uint32_t messageCount = ROUNDS / batchEvents;
+  uint32_t events = messageCount * batchEvents;
+
+  // Sizes, and the messages to decode, from the broker
+  MqttPublishStats stats = getMqttPublishStats();
+  uint32_t published = broker.publishes() + messageCount;
+  size_t first = broker.messageCount();
+  for (uint32_t i = 0; i < events; i++) {
+    publishTag(benchUid(i), kind.event, 0, PROTOCOL_ISO15693, kind.dwell, millis());
+  }
+  mqttClient.loop();
+  if (!broker.waitForPublishes(published, 10000)) {
+    fprintf(stderr, "broker missed publishes\n");
+    exit(1);
+  }
+  MqttPublishStats after = getMqttPublishStats();
+  result.bytes = (after.bytes - stats.bytes) / (after.messages - stats.messages);
+  std::vector<MqttTestMessage> messages(messageCount);
+  for (uint32_t i = 0; i < messageCount; i++) {
+    broker.message(first + i, &messages[i]);
+  }
+  broker.clearMessages();
+
+  // Times, with the writes discarded
+  mqttClient.setClient(discardClient);
+  result.encodeNs = timePublish(kind, events);
+
+  // The same payload and topic without building it
+  const MqttTestMessage& sample = messages[0];
+  uint64_t best = UINT64_MAX;
+  for (int r = 0; r < TIMING_REPEATS; r++) {
+    uint64_t start = nowNs();
+    for (uint32_t i = 0; i < messageCount; i++) {
+      mqttClient.publish(sample.topic, sample.payload, sample.length, false);
+    }
+    best = min(best, nowNs() - start);
+  }
+  result.rawNs = (double)best / events;
+  mqttClient.setClient(espClient);
+
+  result.decodeNs = timeDecode(messages) / batchEvents;
+  config.mqtt_batch_ms = 0;
+  return result;
+}
+
+static void printRow(const char* name, const FormatResult& json, const FormatResult& binary) {
+  printf("  %-22s %6u %6u   %7.0f %7.0f   %7.0f %7.0f   %7.0f %7.0f\n", name,
+         json.bytes, binary.bytes,
+         json.encodeNs, binary.encodeNs,
+         json.encodeNs - json.rawNs, binary.encodeNs - binary.rawNs,
+         json.decodeNs, binary.decodeNs);
+}
+
+int main() {
+  hostSerialEcho(false);
+  hostUseVirtualClock(true);
+
+  char root[] = "/tmp/bench_payload_XXXXXX";
+  if (!mkdtemp(root)) return 1;
+  hostSetFilesystemRoot(root);
+  if (!broker.start()) {
+    fprintf(stderr, "broker failed to start\n");
+    return 1;
+  }
+
+  Preferences prefs;
+  prefs.begin("rfid-reader", false);
+  prefs.putString("mqtt_broker", "127.0.0.1");
+  prefs.putUInt("mqtt_port", broker.port());
+  prefs.end();
+
+  loadConfig();
+  config.mqtt_batch_ms = 0;
+  initNFCTrace();
+  initMqttHandler(&mqttClient, &espClient, &config);
+  initMqttQueue();
+  if (!connectBroker()) {
+    fprintf(stderr, "not connected to the loopback broker\n");
+    return 1;
+  }
+
+  // Warm-up: first publishes, history and fleet tables filled once
+  measure(MQTT_FORMAT_JSON, kinds[0], 1);
+  measure(MQTT_FORMAT_BINARY, kinds[0], 1);
+
+  printf("JSON vs binary payloads, %u events per figure, best of %d (ns per event)\n", ROUNDS,
+         TIMING_REPEATS);
+  printf("  %-22s %13s   %15s   %15s   %15s\n", "", "bytes", "publishTag()", "less publish()", "mqttCallback()");
+  printf("  %-22s %6s %6s   %7s %7s   %7s %7s   %7s %7s\n", "message",
+         "JSON", "binary", "JSON", "binary", "JSON", "binary", "JSON", "binary");
+  for (const EventKind& kind : kinds) {
+    FormatResult json = measure(MQTT_FORMAT_JSON, kind, 1);
+    FormatResult binary = measure(MQTT_FORMAT_BINARY, kind, 1);
+    printRow(kind.name, json, binary);
+  }
+  FormatResult json = measure(MQTT_FORMAT_JSON, kinds[0], BATCH_EVENTS);
+  FormatResult binary = measure(MQTT_FORMAT_BINARY, kinds[0], BATCH_EVENTS);
+  printRow("Batch of 16 Reads", json, binary);
+  printf("  (batch bytes are per message, times per event in it)\n");
+
+  broker.stop();
+  return 0;
+}
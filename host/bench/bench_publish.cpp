@@ -0,0 +1,294 @@
+/*
+ * bench_publish.cpp
+ *
+ * MQTT Publish Path, Before and After Precomputed Topics
+ * Times and counts heap allocations per event for each step of sending
+ * one tag event, the way 1.0.15 did it (String topic, JSON serialized
+ * into a String, a String client ID per connect attempt) against the
+ * current code (topics and client ID built once by refreshMqttConfig(),
+ * payloads serialized into static buffers).
+ *
+ * The whole-path rows are the 1.0.15 publishTag(), lifted as in
+ * bench_alloc, and today's publishTag() - which also formats the UID,
+ * adds the event to the history and keeps the publish statistics, so it
+ * does more work than the old one for the same message. The sketch
+ * connects to the loopback broker, then PubSubClient writes to a
+ * DiscardClient for the measurements so no socket is in the figures.
+ *
+ * Times are the best of TIMING_REPEATS runs, in host nanoseconds and, on
+ * x86, TSC ticks. The host String has no small-string buffer (the ESP32
+ * core's keeps up to 11 characters inline); the topics and payloads here
+ * are longer than that, so they allocate on both.
+ */
+
+#include <Arduino.h>
+#include "../../src/MQTTTagReaderDisplay_ESP32.ino"
+#include "discard_client.h"
+#include "mqtt_test_broker.h"
+#include <ArduinoJson.h>
+#include <chrono>
+#include <stdlib.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#define ROUNDS         3000  // Events per timing run
+#define TIMING_REPEATS 7
+
+static MqttTestBroker broker;
+static DiscardClient discardClient;
+static const char* const events[3] = { "Read", "Continuing", "Unread" };
+static char uidHex[ROUNDS][TAG_UID_HEX_LEN];
+static volatile uintptr_t sink;    // Keeps results the compiler could drop
+
+struct StepResult {
+  double ns;
+  double ticks;
+  double allocations;
+  double bytes;
+};
+
+static uint64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t ticksNow() {
+#if HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static TagUID benchUid(uint32_t i) {
+  TagUID uid;
+  uid.value = 0xE004010918480000ULL + i;
+  return uid;
+}
+
+// 1.0.15 ---------------------------------------------------------------
+
+static String legacyTopic(const char* event) {
+  return String(config.mqtt_base_topic) + "/" + event;
+}
+
+static void legacyFillDoc(JsonDocument& doc, const char* uid, const char* event) {
+  doc["u"] = uid;
+  doc["s"] = config.sensor_id;
+  if (strcmp(event, "Read") == 0) {
+    doc["R"] = "R";
+  } else if (strcmp(event, "Continuing") == 0) {
+    doc["R"] = "C";
+  } else if (strcmp(event, "Unread") == 0) {
+    doc["R"] = "U";
+  }
+}
+
+static void legacyPublishTag(const char* uid, const char* event) {
+  if (!mqttClient.connected()) return;
+
+  String topic = String(config.mqtt_base_topic) + "/" + event;
+
+  StaticJsonDocument<200> doc;
+  legacyFillDoc(doc, uid, event);
+
+  String payload;
+  serializeJson(doc, payload);
+
+  if (mqttClient.publish(topic.c_str(), payload.c_str())) {
+    Serial.print(F("MQTT: "));
+    Serial.print(topic);
+    Serial.print(F(" -> "));
+    Serial.println(payload);
+  }
+}
+
+// The steps -------------------------------------------------------------
+
+enum Step {
+  TOPIC_STRING,        // String(base) + "/" + event
+  TOPIC_SNPRINTF,      // snprintf into a stack buffer (1.0.21 - 1.0.34)
+  TOPIC_PRECOMPUTED,   // a table lookup
+  PAYLOAD_STRING,      // serializeJson(doc, String)
+  PAYLOAD_BUFFER,      // serializeJson(doc, buf, size)
+  CLIENT_ID_STRING,    // "ESP32-RFID-" + String(sensor_id), per connect attempt
+  CLIENT_ID_PRECOMPUTED,
+  PUBLISH_LEGACY,      // 1.0.15 publishTag()
+  PUBLISH_CURRENT,     // publishTag()
+  STEP_COUNT
+};
+
+static const char* const stepNames[STEP_COUNT] = {
+  "topic: String concat (1.0.15)",
+  "topic: snprintf (1.0.21)",
+  "topic: precomputed",
+  "payload: serializeJson to String",
+  "payload: serializeJson to buffer",
+  "client ID: String (1.0.15)",
+  "client ID: precomputed",
+  "publishTag() 1.0.15",
+  "publishTag() now",
+};
+
+static char payloadBuffer[128];
+
+// Built once, as refreshMqttConfig() builds the handler's own
+static char topics[3][MQTT_TOPIC_LEN];
+static char clientId[24];
+
+static void buildTopics() {
+  for (int i = 0; i < 3; i++) {
+    snprintf(topics[i], MQTT_TOPIC_LEN, "%s/%s", config.mqtt_base_topic, events[i]);
+  }
+  snprintf(clientId, sizeof(clientId), "ESP32-RFID-%u", config.sensor_id);
+}
+
+static void runStep(Step step, uint32_t i) {
+  const char* event = events[i % 3];
+  switch (step) {
+    case TOPIC_STRING: {
+      String topic = legacyTopic(event);
+      sink = topic.length();
+      break;
+    }
+    case TOPIC_SNPRINTF: {
+      char topic[sizeof(config.mqtt_base_topic) + 16];
+      snprintf(topic, sizeof(topic), "%s/%s", config.mqtt_base_topic, event);
+      sink = (uintptr_t)topic[0];
+      break;
+    }
+    case TOPIC_PRECOMPUTED:
+      sink = (uintptr_t)topics[i % 3];
+      break;
+    case PAYLOAD_STRING: {
+      StaticJsonDocument<200> doc;
+      legacyFillDoc(doc, uidHex[i], event);
+      String payload;
+      serializeJson(doc, payload);
+      sink = payload.length();
+      break;
+    }
+    case PAYLOAD_BUFFER: {
+      StaticJsonDocument<200> doc;
+      legacyFillDoc(doc, uidHex[i], event);
+      sink = serializeJson(doc, payloadBuffer, sizeof(payloadBuffer));
+      break;
+    }
+    case CLIENT_ID_STRING: {
+      String clientId = "ESP32-RFID-";
+      clientId += String(config.sensor_id);
+      sink = clientId.length();
+      break;
+    }
+    case CLIENT_ID_PRECOMPUTED:
+      sink = (uintptr_t)clientId;
+      break;
+    case PUBLISH_LEGACY:
+      legacyPublishTag(uidHex[i], event);
+      break;
+    case PUBLISH_CURRENT:
+      publishTag(benchUid(i), event, 0, PROTOCOL_ISO15693, 0, millis());
+      break;
+    default:
+      break;
+  }
+}
+
+static StepResult measure(Step step) {
+  StepResult result;
+  HostHeapStats before = hostHeapStats();
+  for (uint32_t i = 0; i < ROUNDS; i++) runStep(step, i);
+  HostHeapStats after = hostHeapStats();
+  result.allocations = (double)(after.allocations - before.allocations) / ROUNDS;
+  result.bytes = (double)(after.bytes - before.bytes) / ROUNDS;
+
+  uint64_t bestNs = UINT64_MAX;
+  uint64_t bestTicks = UINT64_MAX;
+  for (int r = 0; r < TIMING_REPEATS; r++) {
+    uint64_t startNs = nowNs();
+    uint64_t startTicks = ticksNow();
+    for (uint32_t i = 0; i < ROUNDS; i++) runStep(step, i);
+    bestTicks = min(bestTicks, ticksNow() - startTicks);
+    bestNs = min(bestNs, nowNs() - startNs);
+  }
+  result.ns = (double)bestNs / ROUNDS;
+  result.ticks = (double)bestTicks / ROUNDS;
+  return result;
+}
+
+static bool connectBroker() {
+  for (int i = 0; i < 2000 && !mqttClient.connected(); i++) {
+    processMqttConnection();
+    usleep(500);
+  }
+  return mqttClient.connected();
+}
+
+int main() {
+  hostSerialEcho(false);
+  hostUseVirtualClock(true);
+
+  char root[] = "/tmp/bench_publish_XXXXXX";
+  if (!mkdtemp(root)) return 1;
+  hostSetFilesystemRoot(root);
+  if (!broker.start()) {
+    fprintf(stderr, "broker failed to start\n");
+    return 1;
+  }
+
+  Preferences prefs;
+  prefs.begin("rfid-reader", false);
+  prefs.putString("mqtt_broker", "127.0.0.1");
+  prefs.putUInt("mqtt_port", broker.port());
+  prefs.end();
+
+  loadConfig();
+  config.mqtt_batch_ms = 0;
+  initNFCTrace();
+  initMqttHandler(&mqttClient, &espClient, &config);
+  initMqttQueue();
+  if (!connectBroker()) {
+    fprintf(stderr, "not connected to the loopback broker\n");
+    return 1;
+  }
+  for (uint32_t i = 0; i < ROUNDS; i++) benchUid(i).toHex(uidHex[i]);
+  buildTopics();
+
+  // Both versions put the same message on the same topic
+  legacyPublishTag(uidHex[0], "Read");
+  publishTag(benchUid(0), "Read", 0, PROTOCOL_ISO15693, 0, millis());
+  if (!broker.waitForPublishes(2, 2000)) {
+    fprintf(stderr, "broker missed publishes\n");
+    return 1;
+  }
+  MqttTestMessage legacy, current;
+  broker.message(0, &legacy);
+  broker.message(1, &current);
+  if (strcmp(legacy.topic, current.topic) != 0 || legacy.length != current.length ||
+      memcmp(legacy.payload, current.payload, legacy.length) != 0) {
+    fprintf(stderr, "1.0.15 and current messages differ\n");
+    return 1;
+  }
+
+  mqttClient.setClient(discardClient);
+  for (int s = 0; s < STEP_COUNT; s++) measure((Step)s);  // Warm-up
+
+  printf("MQTT publish path, %u events per run, best of %d, per event\n", ROUNDS, TIMING_REPEATS);
+  printf("  %-34s %8s %8s %8s %8s\n", "step", "ns", HAVE_TSC ? "ticks" : "", "allocs", "bytes");
+  for (int s = 0; s < STEP_COUNT; s++) {
+    StepResult r = measure((Step)s);
+    printf("  %-34s %8.1f", stepNames[s], r.ns);
+    if (HAVE_TSC) printf(" %8.0f", r.ticks); else printf(" %8s", "");
+    printf(" %8.2f %8.1f\n", r.allocations, r.bytes);
+  }
+  printf("  (client ID rows are per connect attempt)\n");
+
+  mqttClient.setClient(espClient);
+  broker.stop();
+  return 0;
+}
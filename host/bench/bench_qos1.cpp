@@ -0,0 +1,96 @@
+/*
+ * bench_qos1.cpp
+ *
+ * QoS 1 Throughput per In-Flight Window
+ * Keeps the window full of 64-byte QoS 1 messages against the loopback
+ * broker, which sends each PUBACK ACK_DELAY_MS after the PUBLISH arrives,
+ * and counts acknowledged messages per second for windows 1, 8 and 32.
+ * The loop is the reader's: mqttInflightPublish() until the window is
+ * full, then mqttClient.loop() (one incoming packet per call) and
+ * processMqttInflight(). Everything runs in real time.
+ */
+
+#include <Arduino.h>
+#include "../../src/MQTTTagReaderDisplay_ESP32.ino"
+#include "mqtt_test_broker.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+#define ACK_DELAY_MS   20
+#define PAYLOAD_BYTES  64
+#define RUN_MS         3000
+
+static MqttTestBroker broker;
+static const uint8_t windows[] = { 1, 8, 32 };
+
+static bool connectBroker() {
+  for (int i = 0; i < 2000 && !mqttClient.connected(); i++) {
+    processMqttConnection();
+    mqttClient.loop();
+    usleep(500);
+  }
+  return mqttClient.connected();
+}
+
+int main() {
+  hostSerialEcho(false);
+
+  char root[] = "/tmp/bench_qos1_XXXXXX";
+  if (!mkdtemp(root)) return 1;
+  hostSetFilesystemRoot(root);
+  if (!broker.start()) {
+    fprintf(stderr, "broker failed to start\n");
+    return 1;
+  }
+  broker.setAckDelay(ACK_DELAY_MS);
+
+  Preferences prefs;
+  prefs.begin("rfid-reader", false);
+  prefs.putString("mqtt_broker", "127.0.0.1");
+  prefs.putUInt("mqtt_port", broker.port());
+  prefs.end();
+
+  loadConfig();
+  config.mqtt_qos = 1;
+  initMqttHandler(&mqttClient, &espClient, &config);
+  if (!connectBroker()) {
+    fprintf(stderr, "not connected to the loopback broker\n");
+    return 1;
+  }
+
+  uint8_t payload[PAYLOAD_BYTES];
+  for (int i = 0; i < PAYLOAD_BYTES; i++) payload[i] = i;
+
+  printf("QoS 1, %d-byte messages, PUBACK %d ms after each PUBLISH, %d ms per window\n",
+         PAYLOAD_BYTES, ACK_DELAY_MS, RUN_MS);
+  printf("  %6s %12s %12s\n", "window", "messages/s", "retransmits");
+  for (uint8_t window : windows) {
+    setMqttInflightWindow(window);
+    MqttInflightStats before = getMqttInflightStats();
+    unsigned long start = millis();
+    while (millis() - start < RUN_MS) {
+      while (mqttInflightPublish("rfid/Read", payload, sizeof(payload))) {
+      }
+      mqttClient.loop();
+      processMqttInflight();
+      usleep(100);
+    }
+    unsigned long elapsed = millis() - start;
+    MqttInflightStats after = getMqttInflightStats();
+
+    // Let the last PUBACKs in before the next window starts
+    unsigned long settle = millis();
+    while (getMqttInflightStats().inflight > 0 && millis() - settle < 1000) {
+      mqttClient.loop();
+      usleep(100);
+    }
+
+    printf("  %6u %12.0f %12u\n", window, (after.acked - before.acked) * 1000.0 / elapsed,
+           after.retransmits - before.retransmits);
+  }
+  MqttInflightStats stats = getMqttInflightStats();
+  printf("  PUBACK after %u ms on average, %u ms at most\n", stats.ackAvg, stats.ackMax);
+
+  broker.stop();
+  return 0;
+}
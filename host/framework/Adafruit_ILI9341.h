@@ -0,0 +1,52 @@
+/*
+ * Adafruit_ILI9341.h
+ *
+ * Host Stand-in for Adafruit_ILI9341 - a 240x320 Adafruit_GFX with the
+ * driver's colour constants; begin() talks to no panel.
+ */
+
+#ifndef HOST_ADAFRUIT_ILI9341_H
+#define HOST_ADAFRUIT_ILI9341_H
+
+#include "Adafruit_GFX.h"
+#include "SPI.h"
+
+#define ILI9341_TFTWIDTH  240
+#define ILI9341_TFTHEIGHT 320
+
+#define ILI9341_BLACK       0x0000
+#define ILI9341_NAVY        0x000F
+#define ILI9341_DARKGREEN   0x03E0
+#define ILI9341_DARKCYAN    0x03EF
+#define ILI9341_MAROON      0x7800
+#define ILI9341_PURPLE      0x780F
+#define ILI9341_OLIVE       0x7BE0
+#define ILI9341_LIGHTGREY   0xC618
+#define ILI9341_DARKGREY    0x7BEF
+#define ILI9341_BLUE        0x001F
+#define ILI9341_GREEN       0x07E0
+#define ILI9341_CYAN        0x07FF
+#define ILI9341_RED         0xF800
+#define ILI9341_MAGENTA     0xF81F
+#define ILI9341_YELLOW      0xFFE0
+#define ILI9341_WHITE       0xFFFF
+#define ILI9341_ORANGE      0xFD20
+#define ILI9341_GREENYELLOW 0xAFE5
+#define ILI9341_PINK        0xFC18
+
+class Adafruit_ILI9341 : public Adafruit_GFX {
+public:
+  Adafruit_ILI9341(int8_t cs, int8_t dc, int8_t rst = -1)
+    : Adafruit_GFX(ILI9341_TFTWIDTH, ILI9341_TFTHEIGHT) {
+    (void)cs;
+    (void)dc;
+    (void)rst;
+  }
+
+  void begin(uint32_t freq = 0) { (void)freq; }
+  void setRotation(uint8_t m) override { Adafruit_GFX::setRotation(m); }
+  void invertDisplay(bool i) { (void)i; }
+  void scrollTo(uint16_t y) { (void)y; }
+};
+
+#endif // HOST_ADAFRUIT_ILI9341_H
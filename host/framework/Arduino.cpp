@@ -0,0 +1,227 @@
+/*
+ * Arduino.cpp
+ *
+ * Host Stand-in for the ESP32 Arduino Core - clock, Serial, GPIO, ESP
+ */
+
+#include "Arduino.h"
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <atomic>
+
+// Clock - see host_runtime.h
+static const uint64_t CLOCK_START_US = 1000000;
+static const auto clockEpoch = std::chrono::steady_clock::now();
+static std::atomic<bool> virtualClock(false);
+static std::atomic<uint64_t> virtualMicros(CLOCK_START_US);
+static std::atomic<int64_t> realOffset(CLOCK_START_US);
+
+static uint64_t realMicros() {
+  auto elapsed = std::chrono::steady_clock::now() - clockEpoch;
+  return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() + realOffset.load();
+}
+
+static uint64_t nowMicros() {
+  return virtualClock.load(std::memory_order_relaxed) ? virtualMicros.load() : realMicros();
+}
+
+void hostUseVirtualClock(bool enabled) {
+  if (enabled == virtualClock.load()) return;
+  if (enabled) {
+    virtualMicros.store(realMicros());
+  } else {
+    auto elapsed = std::chrono::steady_clock::now() - clockEpoch;
+    realOffset.store((int64_t)virtualMicros.load() -
+                     std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+  }
+  virtualClock.store(enabled);
+}
+
+bool hostVirtualClock() {
+  return virtualClock.load();
+}
+
+void hostAdvanceMicros(uint64_t us) {
+  if (virtualClock.load()) virtualMicros.fetch_add(us);
+}
+
+unsigned long millis() {
+  return nowMicros() / 1000;
+}
+
+unsigned long micros() {
+  return nowMicros();
+}
+
+void delay(uint32_t ms) {
+  if (virtualClock.load()) virtualMicros.fetch_add((uint64_t)ms * 1000);
+  else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Busy-waits like the core's ets_delay_us()
+void delayMicroseconds(uint32_t us) {
+  if (virtualClock.load()) {
+    virtualMicros.fetch_add(us);
+    return;
+  }
+  uint64_t end = realMicros() + us;
+  while (realMicros() < end) {
+  }
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+// GPIO - nothing is wired up on the host; inputs read LOW
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  (void)pin;
+  (void)val;
+}
+
+int digitalRead(uint8_t pin) {
+  (void)pin;
+  return LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+  (void)pin;
+  (void)handler;
+  (void)mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+  (void)pin;
+}
+
+// random() - fixed seed, so runs repeat
+static std::mutex randomMutex;
+static std::mt19937 randomEngine(1);
+
+void randomSeed(unsigned long seed) {
+  std::lock_guard<std::mutex> lock(randomMutex);
+  if (seed) randomEngine.seed(seed);
+}
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  std::lock_guard<std::mutex> lock(randomMutex);
+  return randomEngine() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = 0;
+  }
+  return len;
+}
+
+// Stream
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+  size_t count = 0;
+  unsigned long start = millis();
+  while (count < length) {
+    int c = read();
+    if (c < 0) {
+      if (millis() - start >= _timeout) break;
+      yield();
+      continue;
+    }
+    buffer[count++] = (uint8_t)c;
+  }
+  return count;
+}
+
+// Serial - echoed to stdout, last HOST_SERIAL_CAPTURE bytes kept
+HardwareSerial Serial;
+
+static std::mutex serialMutex;
+static bool serialEcho = true;
+static char serialRing[HOST_SERIAL_CAPTURE];
+static size_t serialHead = 0;   // Next write position
+static size_t serialCount = 0;
+
+void hostSerialEcho(bool enabled) {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  serialEcho = enabled;
+}
+
+size_t hostSerialCaptured(char* buffer, size_t size) {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  if (size == 0) return 0;
+  size_t n = serialCount < size - 1 ? serialCount : size - 1;
+  size_t start = (serialHead + HOST_SERIAL_CAPTURE - n) % HOST_SERIAL_CAPTURE;
+  for (size_t i = 0; i < n; i++) buffer[i] = serialRing[(start + i) % HOST_SERIAL_CAPTURE];
+  buffer[n] = 0;
+  return n;
+}
+
+void hostSerialClear() {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  serialHead = 0;
+  serialCount = 0;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  std::lock_guard<std::mutex> lock(serialMutex);
+  for (size_t i = 0; i < size; i++) {
+    serialRing[serialHead] = buffer[i];
+    serialHead = (serialHead + 1) % HOST_SERIAL_CAPTURE;
+  }
+  serialCount = serialCount + size < HOST_SERIAL_CAPTURE ? serialCount + size : HOST_SERIAL_CAPTURE;
+  if (serialEcho) fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+// ESP - heap figures are a nominal ESP32 heap less what the host has live
+#define HOST_NOMINAL_HEAP     (300 * 1024)
+#define HOST_NOMINAL_MAXALLOC (108 * 1024)
+
+EspClass ESP;
+
+uint32_t EspClass::getFreeHeap() {
+  uint64_t live = hostHeapStats().liveBytes;
+  return live < HOST_NOMINAL_HEAP ? HOST_NOMINAL_HEAP - live : 0;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return getFreeHeap();
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  uint32_t free = getFreeHeap();
+  return free < HOST_NOMINAL_MAXALLOC ? free : HOST_NOMINAL_MAXALLOC;
+}
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)(micros() * 240);
+}
+
+void EspClass::restart() {
+  Serial.println(F("[host] ESP.restart() - exiting"));
+  fflush(stdout);
+  hostExit(0);
+}
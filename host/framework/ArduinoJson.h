@@ -0,0 +1,1197 @@
+/*
+ * ArduinoJson.h
+ *
+ * Host Stand-in for ArduinoJson 6 (the subset the sketch uses)
+ * StaticJsonDocument keeps everything in its own fixed pool, charged the
+ * way ArduinoJson charges it on the ESP32 - 16 bytes per value slot plus
+ * each copied string - so overflowed() and NoMemory trip at the same
+ * document sizes as on the device. As with ArduinoJson, a const char*
+ * is stored by pointer and char*, char arrays and String are copied.
+ * Output is the library's compact form.
+ *
+ * Supported: operator[] with chained creation (doc["e"][0]["u"] = true),
+ * to<JsonObject>(), createNestedArray/Object, JsonArray add/remove/size
+ * and iteration, as<T>() and implicit conversions, serializeJson() to a
+ * buffer, String or Print, measureJson(), and deserializeJson() with
+ * DeserializationOption::Filter.
+ */
+
+#ifndef HOST_ARDUINOJSON_H
+#define HOST_ARDUINOJSON_H
+
+#include "Arduino.h"
+#include <type_traits>
+
+#define ARDUINOJSON_VERSION_MAJOR 6
+#define ARDUINOJSON_DEFAULT_NESTING_LIMIT 10
+
+namespace HostJson {
+
+#define HOST_JSON_SLOT_SIZE 16  // sizeof(VariantSlot) on the ESP32
+#define HOST_JSON_MAX_PATH  4   // Pending levels a proxy can hold (doc["a"][0]["b"])
+
+enum NodeType : uint8_t {
+  NODE_NULL,
+  NODE_BOOL,
+  NODE_INT,
+  NODE_UINT,
+  NODE_FLOAT,
+  NODE_STRING,    // Linked - points at the caller's string
+  NODE_OWNED,     // Copied into the pool
+  NODE_OBJECT,
+  NODE_ARRAY
+};
+
+struct Node {
+  const char* key;  // Member name, nullptr in arrays
+  Node* next;
+  NodeType type;
+  union {
+    bool b;
+    int64_t i;
+    uint64_t u;
+    double f;
+    const char* s;
+    struct {
+      Node* head;
+      Node* tail;
+    } c;
+  } v;
+};
+
+inline void setNull(Node* n) {
+  n->type = NODE_NULL;
+  n->v.c.head = nullptr;
+  n->v.c.tail = nullptr;
+}
+
+inline Node* findMember(const Node* object, const char* key) {
+  if (!object || object->type != NODE_OBJECT || !key) return nullptr;
+  for (Node* n = object->v.c.head; n; n = n->next) {
+    if (n->key && strcmp(n->key, key) == 0) return n;
+  }
+  return nullptr;
+}
+
+inline Node* elementAt(const Node* array, size_t index) {
+  if (!array || array->type != NODE_ARRAY) return nullptr;
+  Node* n = array->v.c.head;
+  while (n && index--) n = n->next;
+  return n;
+}
+
+inline size_t childCount(const Node* container) {
+  if (!container || (container->type != NODE_OBJECT && container->type != NODE_ARRAY)) return 0;
+  size_t count = 0;
+  for (Node* n = container->v.c.head; n; n = n->next) count++;
+  return count;
+}
+
+class Writer;
+
+}  // namespace HostJson
+
+class JsonVariant;
+class JsonObject;
+class JsonArray;
+
+class JsonDocument {
+public:
+  JsonDocument(const JsonDocument&) = delete;
+  JsonDocument& operator=(const JsonDocument&) = delete;
+
+  void clear() {
+    HostJson::setNull(&root);
+    root.key = nullptr;
+    root.next = nullptr;
+    nodesUsed = 0;
+    stringsUsed = 0;
+    used = 0;
+    overflow = false;
+  }
+
+  size_t capacity() const { return poolCapacity; }
+  size_t memoryUsage() const { return used; }
+  bool overflowed() const { return overflow; }
+  bool isNull() const { return root.type == HostJson::NODE_NULL; }
+  size_t size() const { return HostJson::childCount(&root); }
+
+  template<typename T> T to();
+  template<typename T> T as() const;
+
+  JsonVariant operator[](const char* key);
+  JsonVariant operator[](const String& key);
+  JsonVariant operator[](int index);
+
+  JsonArray createNestedArray(const char* key);
+  JsonObject createNestedObject(const char* key);
+  JsonArray createNestedArray();
+  JsonObject createNestedObject();
+
+  template<typename T> bool add(const T& value);
+
+  // Pool - used by the value types
+  HostJson::Node* allocNode() {
+    if (nodesUsed >= nodeCapacity || used + HOST_JSON_SLOT_SIZE > poolCapacity) {
+      overflow = true;
+      return nullptr;
+    }
+    HostJson::Node* n = &nodes[nodesUsed++];
+    n->key = nullptr;
+    n->next = nullptr;
+    HostJson::setNull(n);
+    used += HOST_JSON_SLOT_SIZE;
+    return n;
+  }
+
+  char* allocString(const char* s, size_t length) {
+    if (used + length + 1 > poolCapacity || stringsUsed + length + 1 > poolCapacity) {
+      overflow = true;
+      return nullptr;
+    }
+    char* copy = &strings[stringsUsed];
+    memcpy(copy, s, length);
+    copy[length] = 0;
+    stringsUsed += length + 1;
+    used += length + 1;
+    return copy;
+  }
+
+  HostJson::Node* rootNode() { return &root; }
+  const HostJson::Node* rootNode() const { return &root; }
+
+protected:
+  JsonDocument(HostJson::Node* nodeStore, size_t nodeCount, char* stringStore, size_t capacity)
+    : nodes(nodeStore), nodeCapacity(nodeCount), strings(stringStore), poolCapacity(capacity) {
+    clear();
+  }
+
+private:
+  HostJson::Node root;
+  HostJson::Node* nodes;
+  size_t nodeCapacity;
+  size_t nodesUsed;
+  char* strings;
+  size_t stringsUsed;
+  size_t poolCapacity;
+  size_t used;
+  bool overflow;
+};
+
+template<size_t desiredCapacity>
+class StaticJsonDocument : public JsonDocument {
+public:
+  StaticJsonDocument()
+    : JsonDocument(nodeStore, desiredCapacity / HOST_JSON_SLOT_SIZE, stringStore, desiredCapacity) {}
+
+private:
+  HostJson::Node nodeStore[desiredCapacity / HOST_JSON_SLOT_SIZE + 1];
+  char stringStore[desiredCapacity];
+};
+
+// Reference to a value, or to where one would go: the levels that do not
+// exist yet are kept as a path and created on assignment
+class JsonVariant {
+public:
+  JsonVariant() : doc(nullptr), anchor(nullptr), depth(0) {}
+  JsonVariant(JsonDocument* document, HostJson::Node* node) : doc(document), anchor(node), depth(0) {}
+
+  JsonVariant operator[](const char* key) const {
+    JsonVariant child(*this);
+    HostJson::Node* node = depth == 0 ? anchor : nullptr;
+    if (node && node->type == HostJson::NODE_OBJECT) {
+      HostJson::Node* member = HostJson::findMember(node, key);
+      if (member) return JsonVariant(doc, member);
+    }
+    child.push(key, -1);
+    return child;
+  }
+  JsonVariant operator[](const String& key) const { return (*this)[key.c_str()]; }
+  JsonVariant operator[](int index) const {
+    JsonVariant child(*this);
+    HostJson::Node* node = depth == 0 ? anchor : nullptr;
+    if (node && node->type == HostJson::NODE_ARRAY) {
+      HostJson::Node* element = HostJson::elementAt(node, index);
+      if (element) return JsonVariant(doc, element);
+    }
+    child.push(nullptr, index);
+    return child;
+  }
+
+  template<typename T> JsonVariant& operator=(const T& value) {
+    set(value);
+    return *this;
+  }
+  JsonVariant& operator=(const JsonVariant& other) = default;
+
+  template<typename T> bool set(const T& value) const {
+    HostJson::Node* n = materialize();
+    return n && assign(n, value);
+  }
+
+  template<typename T> T as() const;
+  template<typename T> operator T() const { return as<T>(); }
+
+  bool isNull() const {
+    const HostJson::Node* n = resolve();
+    return !n || n->type == HostJson::NODE_NULL;
+  }
+  size_t size() const { return HostJson::childCount(resolve()); }
+
+  JsonArray createNestedArray(const char* key) const;
+  JsonObject createNestedObject(const char* key) const;
+
+  // Internals shared with the other value types
+  HostJson::Node* resolve() const {
+    HostJson::Node* n = anchor;
+    for (uint8_t i = 0; i < depth && n; i++) {
+      n = path[i].key ? HostJson::findMember(n, path[i].key) : HostJson::elementAt(n, path[i].index);
+    }
+    return n;
+  }
+
+  HostJson::Node* materialize() const {
+    HostJson::Node* n = anchor;
+    if (!doc) return nullptr;
+    for (uint8_t i = 0; i < depth && n; i++) {
+      if (path[i].key) {
+        if (n->type == HostJson::NODE_NULL) n->type = HostJson::NODE_OBJECT;
+        if (n->type != HostJson::NODE_OBJECT) return nullptr;
+        HostJson::Node* member = HostJson::findMember(n, path[i].key);
+        if (!member) {
+          member = append(n);
+          if (member) member->key = path[i].key;
+        }
+        n = member;
+      } else {
+        if (n->type == HostJson::NODE_NULL) n->type = HostJson::NODE_ARRAY;
+        if (n->type != HostJson::NODE_ARRAY) return nullptr;
+        size_t count = HostJson::childCount(n);
+        HostJson::Node* element = HostJson::elementAt(n, path[i].index);
+        while (!element && count <= (size_t)path[i].index) {
+          element = append(n);
+          if (!element) return nullptr;
+          count++;
+          if (count <= (size_t)path[i].index) element = nullptr;
+        }
+        n = element;
+      }
+    }
+    return n;
+  }
+
+  HostJson::Node* append(HostJson::Node* container) const {
+    HostJson::Node* n = doc->allocNode();
+    if (!n) return nullptr;
+    if (container->v.c.tail) container->v.c.tail->next = n;
+    else container->v.c.head = n;
+    container->v.c.tail = n;
+    return n;
+  }
+
+  template<typename T> bool assign(HostJson::Node* n, const T& value) const;
+
+  JsonDocument* document() const { return doc; }
+
+private:
+  struct Step {
+    const char* key;  // nullptr = array index
+    int index;
+  };
+
+  JsonDocument* doc;
+  HostJson::Node* anchor;
+  uint8_t depth;
+  Step path[HOST_JSON_MAX_PATH];
+
+  void push(const char* key, int index) {
+    if (depth >= HOST_JSON_MAX_PATH) {
+      anchor = nullptr;  // Deeper than a proxy can hold - reads null, writes fail
+      depth = 0;
+      return;
+    }
+    path[depth].key = key;
+    path[depth].index = index;
+    depth++;
+  }
+};
+
+class JsonObject {
+public:
+  JsonObject() : doc(nullptr), node(nullptr) {}
+  JsonObject(JsonDocument* document, HostJson::Node* n) : doc(document), node(n) {}
+
+  JsonVariant operator[](const char* key) const {
+    if (!node) return JsonVariant();
+    return JsonVariant(doc, node)[key];
+  }
+  JsonVariant operator[](const String& key) const { return (*this)[key.c_str()]; }
+
+  JsonArray createNestedArray(const char* key) const;
+  JsonObject createNestedObject(const char* key) const;
+
+  bool isNull() const { return node == nullptr; }
+  size_t size() const { return HostJson::childCount(node); }
+  bool containsKey(const char* key) const { return HostJson::findMember(node, key) != nullptr; }
+  void remove(const char* key) const {
+    if (!node) return;
+    HostJson::Node* prev = nullptr;
+    for (HostJson::Node* n = node->v.c.head; n; prev = n, n = n->next) {
+      if (n->key && strcmp(n->key, key) == 0) {
+        if (prev) prev->next = n->next;
+        else node->v.c.head = n->next;
+        if (node->v.c.tail == n) node->v.c.tail = prev;
+        return;
+      }
+    }
+  }
+
+  HostJson::Node* raw() const { return node; }
+  JsonDocument* document() const { return doc; }
+
+private:
+  JsonDocument* doc;
+  HostJson::Node* node;
+};
+
+class JsonArrayIterator {
+public:
+  JsonArrayIterator(JsonDocument* document, HostJson::Node* n) : doc(document), node(n) {}
+  JsonVariant operator*() const { return JsonVariant(doc, node); }
+  JsonArrayIterator& operator++() {
+    node = node->next;
+    return *this;
+  }
+  bool operator!=(const JsonArrayIterator& other) const { return node != other.node; }
+  bool operator==(const JsonArrayIterator& other) const { return node == other.node; }
+
+private:
+  JsonDocument* doc;
+  HostJson::Node* node;
+};
+
+class JsonArray {
+public:
+  JsonArray() : doc(nullptr), node(nullptr) {}
+  JsonArray(JsonDocument* document, HostJson::Node* n) : doc(document), node(n) {}
+
+  template<typename T> bool add(const T& value) const {
+    HostJson::Node* element = addElement();
+    return element && JsonVariant(doc, node).assign(element, value);
+  }
+
+  JsonArray createNestedArray() const {
+    HostJson::Node* element = addElement();
+    if (!element) return JsonArray();
+    element->type = HostJson::NODE_ARRAY;
+    return JsonArray(doc, element);
+  }
+
+  JsonObject createNestedObject() const {
+    HostJson::Node* element = addElement();
+    if (!element) return JsonObject();
+    element->type = HostJson::NODE_OBJECT;
+    return JsonObject(doc, element);
+  }
+
+  JsonVariant operator[](int index) const {
+    if (!node) return JsonVariant();
+    return JsonVariant(doc, node)[index];
+  }
+
+  // Like ArduinoJson, the removed slot is not given back to the pool
+  void remove(size_t index) const {
+    if (!node) return;
+    HostJson::Node* prev = nullptr;
+    HostJson::Node* n = node->v.c.head;
+    while (n && index--) {
+      prev = n;
+      n = n->next;
+    }
+    if (!n) return;
+    if (prev) prev->next = n->next;
+    else node->v.c.head = n->next;
+    if (node->v.c.tail == n) node->v.c.tail = prev;
+  }
+
+  bool isNull() const { return node == nullptr; }
+  size_t size() const { return HostJson::childCount(node); }
+
+  JsonArrayIterator begin() const { return JsonArrayIterator(doc, node ? node->v.c.head : nullptr); }
+  JsonArrayIterator end() const { return JsonArrayIterator(doc, nullptr); }
+
+  HostJson::Node* raw() const { return node; }
+  JsonDocument* document() const { return doc; }
+
+private:
+  JsonDocument* doc;
+  HostJson::Node* node;
+
+  HostJson::Node* addElement() const {
+    if (!node) return nullptr;
+    return JsonVariant(doc, node).append(node);
+  }
+};
+
+// Value assignment - the same storage rules as ArduinoJson
+template<typename T>
+bool JsonVariant::assign(HostJson::Node* n, const T& value) const {
+  using namespace HostJson;
+  typedef typename std::decay<T>::type V;
+  n->v.c.head = nullptr;
+  n->v.c.tail = nullptr;
+  if constexpr (std::is_same<V, bool>::value) {
+    n->type = NODE_BOOL;
+    n->v.b = value;
+  } else if constexpr (std::is_integral<V>::value && std::is_signed<V>::value) {
+    n->type = NODE_INT;
+    n->v.i = value;
+  } else if constexpr (std::is_integral<V>::value) {
+    n->type = NODE_UINT;
+    n->v.u = value;
+  } else if constexpr (std::is_floating_point<V>::value) {
+    n->type = NODE_FLOAT;
+    n->v.f = value;
+  } else if constexpr (std::is_same<T, const char*>::value) {
+    if (!value) {
+      n->type = NODE_NULL;
+    } else {
+      n->type = NODE_STRING;  // Stored by pointer
+      n->v.s = value;
+    }
+  } else if constexpr (std::is_same<V, char*>::value || std::is_same<V, const char*>::value) {
+    // char* and char arrays are copied
+    const char* s = value;
+    if (!s) {
+      n->type = NODE_NULL;
+      return true;
+    }
+    char* copy = doc->allocString(s, strlen(s));
+    if (!copy) {
+      n->type = NODE_NULL;
+      return false;
+    }
+    n->type = NODE_OWNED;
+    n->v.s = copy;
+  } else if constexpr (std::is_same<V, String>::value) {
+    char* copy = doc->allocString(value.c_str(), value.length());
+    if (!copy) {
+      n->type = NODE_NULL;
+      return false;
+    }
+    n->type = NODE_OWNED;
+    n->v.s = copy;
+  } else if constexpr (std::is_same<V, const __FlashStringHelper*>::value) {
+    const char* s = reinterpret_cast<const char*>(value);
+    char* copy = doc->allocString(s, strlen(s));
+    if (!copy) {
+      n->type = NODE_NULL;
+      return false;
+    }
+    n->type = NODE_OWNED;
+    n->v.s = copy;
+  } else if constexpr (std::is_same<V, std::nullptr_t>::value) {
+    n->type = NODE_NULL;
+  } else {
+    static_assert(std::is_same<V, bool>::value, "type not supported by the ArduinoJson stand-in");
+  }
+  return true;
+}
+
+template<typename T>
+T JsonVariant::as() const {
+  using namespace HostJson;
+  typedef typename std::decay<T>::type V;
+  const Node* n = resolve();
+  if constexpr (std::is_same<V, JsonObject>::value) {
+    return JsonObject(doc, n && n->type == NODE_OBJECT ? const_cast<Node*>(n) : nullptr);
+  } else if constexpr (std::is_same<V, JsonArray>::value) {
+    return JsonArray(doc, n && n->type == NODE_ARRAY ? const_cast<Node*>(n) : nullptr);
+  } else if constexpr (std::is_same<V, JsonVariant>::value) {
+    return *this;
+  } else if constexpr (std::is_same<V, const char*>::value) {
+    return n && (n->type == NODE_STRING || n->type == NODE_OWNED) ? n->v.s : nullptr;
+  } else if constexpr (std::is_same<V, String>::value) {
+    return n && (n->type == NODE_STRING || n->type == NODE_OWNED) ? String(n->v.s) : String();
+  } else if constexpr (std::is_same<V, bool>::value) {
+    if (!n) return false;
+    switch (n->type) {
+      case NODE_BOOL: return n->v.b;
+      case NODE_INT: return n->v.i != 0;
+      case NODE_UINT: return n->v.u != 0;
+      case NODE_FLOAT: return n->v.f != 0;
+      default: return false;
+    }
+  } else if constexpr (std::is_arithmetic<V>::value) {
+    if (!n) return V(0);
+    switch (n->type) {
+      case NODE_BOOL: return V(n->v.b);
+      case NODE_INT: return V(n->v.i);
+      case NODE_UINT: return V(n->v.u);
+      case NODE_FLOAT: return V(n->v.f);
+      default: return V(0);
+    }
+  } else {
+    static_assert(std::is_same<V, bool>::value, "type not supported by the ArduinoJson stand-in");
+  }
+}
+
+inline JsonArray JsonVariant::createNestedArray(const char* key) const {
+  HostJson::Node* n = (*this)[key].materialize();
+  if (!n) return JsonArray();
+  if (n->type == HostJson::NODE_NULL) n->type = HostJson::NODE_ARRAY;
+  return JsonArray(doc, n->type == HostJson::NODE_ARRAY ? n : nullptr);
+}
+
+inline JsonObject JsonVariant::createNestedObject(const char* key) const {
+  HostJson::Node* n = (*this)[key].materialize();
+  if (!n) return JsonObject();
+  if (n->type == HostJson::NODE_NULL) n->type = HostJson::NODE_OBJECT;
+  return JsonObject(doc, n->type == HostJson::NODE_OBJECT ? n : nullptr);
+}
+
+inline JsonArray JsonObject::createNestedArray(const char* key) const {
+  if (!node) return JsonArray();
+  return JsonVariant(doc, node).createNestedArray(key);
+}
+
+inline JsonObject JsonObject::createNestedObject(const char* key) const {
+  if (!node) return JsonObject();
+  return JsonVariant(doc, node).createNestedObject(key);
+}
+
+template<typename T>
+T JsonDocument::to() {
+  clear();
+  if constexpr (std::is_same<T, JsonObject>::value) {
+    root.type = HostJson::NODE_OBJECT;
+    return JsonObject(this, &root);
+  } else if constexpr (std::is_same<T, JsonArray>::value) {
+    root.type = HostJson::NODE_ARRAY;
+    return JsonArray(this, &root);
+  } else {
+    return JsonVariant(this, &root);
+  }
+}
+
+template<typename T>
+T JsonDocument::as() const {
+  return JsonVariant(const_cast<JsonDocument*>(this), const_cast<HostJson::Node*>(&root)).as<T>();
+}
+
+inline JsonVariant JsonDocument::operator[](const char* key) {
+  return JsonVariant(this, &root)[key];
+}
+
+inline JsonVariant JsonDocument::operator[](const String& key) {
+  return JsonVariant(this, &root)[key.c_str()];
+}
+
+inline JsonVariant JsonDocument::operator[](int index) {
+  return JsonVariant(this, &root)[index];
+}
+
+inline JsonArray JsonDocument::createNestedArray(const char* key) {
+  return JsonVariant(this, &root).createNestedArray(key);
+}
+
+inline JsonObject JsonDocument::createNestedObject(const char* key) {
+  return JsonVariant(this, &root).createNestedObject(key);
+}
+
+inline JsonArray JsonDocument::createNestedArray() {
+  if (root.type == HostJson::NODE_NULL) root.type = HostJson::NODE_ARRAY;
+  return JsonArray(this, root.type == HostJson::NODE_ARRAY ? &root : nullptr).createNestedArray();
+}
+
+inline JsonObject JsonDocument::createNestedObject() {
+  if (root.type == HostJson::NODE_NULL) root.type = HostJson::NODE_ARRAY;
+  return JsonArray(this, root.type == HostJson::NODE_ARRAY ? &root : nullptr).createNestedObject();
+}
+
+template<typename T>
+bool JsonDocument::add(const T& value) {
+  if (root.type == HostJson::NODE_NULL) root.type = HostJson::NODE_ARRAY;
+  return JsonArray(this, root.type == HostJson::NODE_ARRAY ? &root : nullptr).add(value);
+}
+
+// Serialization
+namespace HostJson {
+
+class Writer {
+public:
+  virtual ~Writer() {}
+  virtual void write(const char* s, size_t length) = 0;
+  void write(const char* s) { write(s, strlen(s)); }
+  size_t count = 0;
+};
+
+class CountingWriter : public Writer {
+public:
+  void write(const char* s, size_t length) override {
+    (void)s;
+    count += length;
+  }
+};
+
+class BufferWriter : public Writer {
+public:
+  BufferWriter(char* buffer, size_t size) : out(buffer), capacity(size) {}
+  void write(const char* s, size_t length) override {
+    // Room is kept for the terminator; the rest is cut off
+    size_t room = capacity > count + 1 ? capacity - count - 1 : 0;
+    size_t n = length < room ? length : room;
+    memcpy(out + count, s, n);
+    count += n;
+  }
+
+private:
+  char* out;
+  size_t capacity;
+};
+
+class StringWriter : public Writer {
+public:
+  explicit StringWriter(String& output) : out(output) {}
+  void write(const char* s, size_t length) override {
+    out.concat(s, length);
+    count += length;
+  }
+
+private:
+  String& out;
+};
+
+class PrintWriter : public Writer {
+public:
+  explicit PrintWriter(Print& output) : out(output) {}
+  void write(const char* s, size_t length) override {
+    count += out.write((const uint8_t*)s, length);
+  }
+
+private:
+  Print& out;
+};
+
+inline void writeString(Writer& w, const char* s) {
+  w.write("\"", 1);
+  const char* run = s;
+  for (; *s; s++) {
+    unsigned char c = *s;
+    const char* escape = nullptr;
+    switch (c) {
+      case '"': escape = "\\\""; break;
+      case '\\': escape = "\\\\"; break;
+      case '\b': escape = "\\b"; break;
+      case '\f': escape = "\\f"; break;
+      case '\n': escape = "\\n"; break;
+      case '\r': escape = "\\r"; break;
+      case '\t': escape = "\\t"; break;
+      default: break;
+    }
+    char unicode[7];
+    if (!escape && c < 0x20) {
+      snprintf(unicode, sizeof(unicode), "\\u%04x", c);
+      escape = unicode;
+    }
+    if (escape) {
+      w.write(run, s - run);
+      w.write(escape);
+      run = s + 1;
+    }
+  }
+  w.write(run, s - run);
+  w.write("\"", 1);
+}
+
+inline void writeFloat(Writer& w, double value) {
+  char buf[32];
+  if (isnan(value) || isinf(value)) {
+    w.write("null", 4);
+    return;
+  }
+  int len = snprintf(buf, sizeof(buf), "%.9g", value);
+  w.write(buf, len);
+}
+
+inline void writeNode(Writer& w, const Node* n) {
+  char buf[24];
+  int len;
+  if (!n) {
+    w.write("null", 4);
+    return;
+  }
+  switch (n->type) {
+    case NODE_NULL:
+      w.write("null", 4);
+      break;
+    case NODE_BOOL:
+      if (n->v.b) w.write("true", 4);
+      else w.write("false", 5);
+      break;
+    case NODE_INT:
+      len = snprintf(buf, sizeof(buf), "%lld", (long long)n->v.i);
+      w.write(buf, len);
+      break;
+    case NODE_UINT:
+      len = snprintf(buf, sizeof(buf), "%llu", (unsigned long long)n->v.u);
+      w.write(buf, len);
+      break;
+    case NODE_FLOAT:
+      writeFloat(w, n->v.f);
+      break;
+    case NODE_STRING:
+    case NODE_OWNED:
+      writeString(w, n->v.s);
+      break;
+    case NODE_OBJECT:
+      w.write("{", 1);
+      for (const Node* m = n->v.c.head; m; m = m->next) {
+        writeString(w, m->key ? m->key : "");
+        w.write(":", 1);
+        writeNode(w, m);
+        if (m->next) w.write(",", 1);
+      }
+      w.write("}", 1);
+      break;
+    case NODE_ARRAY:
+      w.write("[", 1);
+      for (const Node* m = n->v.c.head; m; m = m->next) {
+        writeNode(w, m);
+        if (m->next) w.write(",", 1);
+      }
+      w.write("]", 1);
+      break;
+  }
+}
+
+inline const Node* sourceNode(const JsonDocument& doc) { return doc.rootNode(); }
+inline const Node* sourceNode(const JsonObject& obj) { return obj.raw(); }
+inline const Node* sourceNode(const JsonArray& arr) { return arr.raw(); }
+inline const Node* sourceNode(const JsonVariant& var) { return var.resolve(); }
+
+}  // namespace HostJson
+
+template<typename TSource>
+size_t serializeJson(const TSource& source, char* buffer, size_t bufferSize) {
+  HostJson::BufferWriter writer(buffer, bufferSize);
+  HostJson::writeNode(writer, HostJson::sourceNode(source));
+  if (bufferSize > 0) buffer[writer.count] = 0;
+  return writer.count;
+}
+
+template<typename TSource>
+size_t serializeJson(const TSource& source, String& output) {
+  HostJson::StringWriter writer(output);
+  HostJson::writeNode(writer, HostJson::sourceNode(source));
+  return writer.count;
+}
+
+template<typename TSource>
+size_t serializeJson(const TSource& source, Print& output) {
+  HostJson::PrintWriter writer(output);
+  HostJson::writeNode(writer, HostJson::sourceNode(source));
+  return writer.count;
+}
+
+template<typename TSource>
+size_t measureJson(const TSource& source) {
+  HostJson::CountingWriter writer;
+  HostJson::writeNode(writer, HostJson::sourceNode(source));
+  return writer.count;
+}
+
+// Deserialization
+class DeserializationError {
+public:
+  enum Code {
+    Ok,
+    EmptyInput,
+    IncompleteInput,
+    InvalidInput,
+    NoMemory,
+    TooDeep
+  };
+
+  DeserializationError() : _code(Ok) {}
+  DeserializationError(Code c) : _code(c) {}
+
+  explicit operator bool() const { return _code != Ok; }
+  bool operator==(Code c) const { return _code == c; }
+  bool operator!=(Code c) const { return _code != c; }
+  Code code() const { return _code; }
+
+  const char* c_str() const {
+    static const char* const messages[] = { "Ok", "EmptyInput", "IncompleteInput",
+                                            "InvalidInput", "NoMemory", "TooDeep" };
+    return messages[_code];
+  }
+
+private:
+  Code _code;
+};
+
+namespace DeserializationOption {
+
+class Filter {
+public:
+  explicit Filter(const JsonDocument& doc) : node(doc.rootNode()), allowAll(false) {}
+  Filter() : node(nullptr), allowAll(true) {}
+
+  const HostJson::Node* node;
+  bool allowAll;
+};
+
+class NestingLimit {
+public:
+  NestingLimit() : value(ARDUINOJSON_DEFAULT_NESTING_LIMIT) {}
+  explicit NestingLimit(uint8_t n) : value(n) {}
+
+  uint8_t value;
+};
+
+}  // namespace DeserializationOption
+
+namespace HostJson {
+
+// A filter value: true keeps a whole value, an object keeps the listed
+// members ("*" for any), an array filters each element with its first entry
+struct FilterRef {
+  const Node* node;
+  bool all;
+
+  bool allowValue() const { return all || (node && node->type == NODE_BOOL && node->v.b); }
+  bool allowObject() const { return allowValue() || (node && node->type == NODE_OBJECT); }
+  bool allowArray() const { return allowValue() || (node && node->type == NODE_ARRAY); }
+  bool allow() const {
+    if (all) return true;
+    if (!node) return false;
+    return node->type == NODE_OBJECT || node->type == NODE_ARRAY ||
+           (node->type == NODE_BOOL && node->v.b);
+  }
+  FilterRef member(const char* key) const {
+    if (allowValue()) return { node, true };
+    const Node* m = findMember(node, key);
+    if (!m) m = findMember(node, "*");
+    return { m, false };
+  }
+  FilterRef element() const {
+    if (allowValue()) return { node, true };
+    return { elementAt(node, 0), false };
+  }
+};
+
+class Parser {
+public:
+  Parser(JsonDocument& document, const char* input, size_t length)
+    : doc(document), p(input), end(input + length) {}
+
+  DeserializationError parse(FilterRef filter, uint8_t nestingLimit) {
+    doc.clear();
+    skipSpace();
+    if (p >= end) return DeserializationError::EmptyInput;
+    return parseValue(doc.rootNode(), filter, nestingLimit);
+  }
+
+private:
+  JsonDocument& doc;
+  const char* p;
+  const char* end;
+
+  void skipSpace() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+  }
+
+  Node* append(Node* container) {
+    Node* n = doc.allocNode();
+    if (!n) return nullptr;
+    if (container->v.c.tail) container->v.c.tail->next = n;
+    else container->v.c.head = n;
+    container->v.c.tail = n;
+    return n;
+  }
+
+  // Node == nullptr: parse and drop (filtered out)
+  DeserializationError parseValue(Node* node, FilterRef filter, uint8_t nesting) {
+    skipSpace();
+    if (p >= end) return DeserializationError::IncompleteInput;
+    switch (*p) {
+      case '{':
+        return parseObject(filter.allowObject() ? node : nullptr, filter, nesting);
+      case '[':
+        return parseArray(filter.allowArray() ? node : nullptr, filter, nesting);
+      case '"':
+        return parseString(filter.allowValue() ? node : nullptr);
+      default:
+        return parseLiteral(filter.allowValue() ? node : nullptr);
+    }
+  }
+
+  DeserializationError parseObject(Node* node, FilterRef filter, uint8_t nesting) {
+    if (nesting == 0) return DeserializationError::TooDeep;
+    p++;  // '{'
+    if (node) node->type = NODE_OBJECT;
+    skipSpace();
+    if (p >= end) return DeserializationError::IncompleteInput;
+    if (*p == '}') {
+      p++;
+      return DeserializationError::Ok;
+    }
+    for (;;) {
+      skipSpace();
+      if (p >= end) return DeserializationError::IncompleteInput;
+      if (*p != '"') return DeserializationError::InvalidInput;
+      const char* keyStart;
+      size_t keyLength;
+      char keyBuffer[64];
+      DeserializationError err = readString(keyBuffer, sizeof(keyBuffer), &keyStart, &keyLength);
+      if (err) return err;
+      skipSpace();
+      if (p >= end) return DeserializationError::IncompleteInput;
+      if (*p != ':') return DeserializationError::InvalidInput;
+      p++;
+
+      FilterRef memberFilter = filter.member(keyStart);
+      Node* member = nullptr;
+      if (node && memberFilter.allow()) {
+        member = findMember(node, keyStart);
+        if (!member) {
+          char* key = doc.allocString(keyStart, keyLength);
+          if (!key) return DeserializationError::NoMemory;
+          member = append(node);
+          if (!member) return DeserializationError::NoMemory;
+          member->key = key;
+        }
+      }
+      err = parseValue(member, memberFilter, nesting - 1);
+      if (err) return err;
+
+      skipSpace();
+      if (p >= end) return DeserializationError::IncompleteInput;
+      if (*p == ',') {
+        p++;
+        continue;
+      }
+      if (*p == '}') {
+        p++;
+        return DeserializationError::Ok;
+      }
+      return DeserializationError::InvalidInput;
+    }
+  }
+
+  DeserializationError parseArray(Node* node, FilterRef filter, uint8_t nesting) {
+    if (nesting == 0) return DeserializationError::TooDeep;
+    p++;  // '['
+    if (node) node->type = NODE_ARRAY;
+    skipSpace();
+    if (p >= end) return DeserializationError::IncompleteInput;
+    if (*p == ']') {
+      p++;
+      return DeserializationError::Ok;
+    }
+    FilterRef elementFilter = filter.element();
+    for (;;) {
+      Node* element = nullptr;
+      if (node && elementFilter.allow()) {
+        element = append(node);
+        if (!element) return DeserializationError::NoMemory;
+      }
+      DeserializationError err = parseValue(element, elementFilter, nesting - 1);
+      if (err) return err;
+      skipSpace();
+      if (p >= end) return DeserializationError::IncompleteInput;
+      if (*p == ',') {
+        p++;
+        continue;
+      }
+      if (*p == ']') {
+        p++;
+        return DeserializationError::Ok;
+      }
+      return DeserializationError::InvalidInput;
+    }
+  }
+
+  DeserializationError parseString(Node* node) {
+    const char* start;
+    size_t length;
+    char small[64];
+    if (!node) return readString(small, 0, &start, &length);
+    // Unescaped length is at most the raw length
+    const char* close = p + 1;
+    while (close < end && *close != '"') close += (*close == '\\') ? 2 : 1;
+    if (close >= end) return DeserializationError::IncompleteInput;
+    size_t raw = close - p - 1;
+    char* scratch = (char*)malloc(raw + 1);
+    if (!scratch) return DeserializationError::NoMemory;
+    DeserializationError err = readString(scratch, raw + 1, &start, &length);
+    if (!err) {
+      char* copy = doc.allocString(start, length);
+      if (!copy) {
+        err = DeserializationError::NoMemory;
+      } else {
+        node->type = NODE_OWNED;
+        node->v.s = copy;
+      }
+    }
+    free(scratch);
+    return err;
+  }
+
+  // Reads a quoted string into out (when size > 0); start/length describe
+  // the unescaped text
+  DeserializationError readString(char* out, size_t size, const char** start, size_t* length) {
+    p++;  // Opening quote
+    size_t n = 0;
+    bool keep = size > 0;
+    while (p < end && *p != '"') {
+      char c = *p++;
+      if (c == '\\') {
+        if (p >= end) return DeserializationError::IncompleteInput;
+        char e = *p++;
+        switch (e) {
+          case '"': c = '"'; break;
+          case '\\': c = '\\'; break;
+          case '/': c = '/'; break;
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case 'n': c = '\n'; break;
+          case 'r': c = '\r'; break;
+          case 't': c = '\t'; break;
+          case 'u': {
+            if (end - p < 4) return DeserializationError::IncompleteInput;
+            unsigned code = 0;
+            for (int i = 0; i < 4; i++) {
+              char h = *p++;
+              code <<= 4;
+              if (h >= '0' && h <= '9') code |= h - '0';
+              else if (h >= 'a' && h <= 'f') code |= h - 'a' + 10;
+              else if (h >= 'A' && h <= 'F') code |= h - 'A' + 10;
+              else return DeserializationError::InvalidInput;
+            }
+            char utf8[3];
+            size_t bytes = 0;
+            if (code < 0x80) {
+              utf8[bytes++] = (char)code;
+            } else if (code < 0x800) {
+              utf8[bytes++] = (char)(0xC0 | (code >> 6));
+              utf8[bytes++] = (char)(0x80 | (code & 0x3F));
+            } else {
+              utf8[bytes++] = (char)(0xE0 | (code >> 12));
+              utf8[bytes++] = (char)(0x80 | ((code >> 6) & 0x3F));
+              utf8[bytes++] = (char)(0x80 | (code & 0x3F));
+            }
+            for (size_t i = 0; i < bytes; i++) {
+              if (keep && n + 1 < size) out[n] = utf8[i];
+              n++;
+            }
+            continue;
+          }
+          default:
+            return DeserializationError::InvalidInput;
+        }
+      }
+      if (keep && n + 1 < size) out[n] = c;
+      n++;
+    }
+    if (p >= end) return DeserializationError::IncompleteInput;
+    p++;  // Closing quote
+    if (keep) {
+      if (n + 1 > size) return DeserializationError::NoMemory;  // Key longer than the scratch buffer
+      out[n] = 0;
+    }
+    *start = out;
+    *length = n;
+    return DeserializationError::Ok;
+  }
+
+  DeserializationError parseLiteral(Node* node) {
+    const char* start = p;
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\t' &&
+           *p != '\r' && *p != '\n') {
+      p++;
+    }
+    size_t length = p - start;
+    if (length == 0) return DeserializationError::InvalidInput;
+    if (length == 4 && memcmp(start, "true", 4) == 0) {
+      if (node) {
+        node->type = NODE_BOOL;
+        node->v.b = true;
+      }
+      return DeserializationError::Ok;
+    }
+    if (length == 5 && memcmp(start, "false", 5) == 0) {
+      if (node) {
+        node->type = NODE_BOOL;
+        node->v.b = false;
+      }
+      return DeserializationError::Ok;
+    }
+    if (length == 4 && memcmp(start, "null", 4) == 0) {
+      if (node) node->type = NODE_NULL;
+      return DeserializationError::Ok;
+    }
+    if (p >= end && (start[0] == 't' || start[0] == 'f' || start[0] == 'n')) {
+      return DeserializationError::IncompleteInput;
+    }
+
+    char number[40];
+    if (length >= sizeof(number)) return DeserializationError::InvalidInput;
+    memcpy(number, start, length);
+    number[length] = 0;
+    bool isFloat = strpbrk(number, ".eE") != nullptr;
+    char* parsedEnd;
+    if (isFloat) {
+      double value = strtod(number, &parsedEnd);
+      if (*parsedEnd) return DeserializationError::InvalidInput;
+      if (node) {
+        node->type = NODE_FLOAT;
+        node->v.f = value;
+      }
+    } else if (number[0] == '-') {
+      long long value = strtoll(number, &parsedEnd, 10);
+      if (*parsedEnd || parsedEnd == number + 1) return DeserializationError::InvalidInput;
+      if (node) {
+        node->type = NODE_INT;
+        node->v.i = value;
+      }
+    } else {
+      unsigned long long value = strtoull(number, &parsedEnd, 10);
+      if (*parsedEnd || parsedEnd == number) return DeserializationError::InvalidInput;
+      if (node) {
+        node->type = NODE_UINT;
+        node->v.u = value;
+      }
+    }
+    return DeserializationError::Ok;
+  }
+};
+
+}  // namespace HostJson
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t inputSize,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter(),
+                                            DeserializationOption::NestingLimit nestingLimit = DeserializationOption::NestingLimit()) {
+  if (!input) return DeserializationError::EmptyInput;
+  HostJson::Parser parser(doc, input, inputSize);
+  return parser.parse({ filter.node, filter.allowAll }, nestingLimit.value);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const uint8_t* input, size_t inputSize,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter(),
+                                            DeserializationOption::NestingLimit nestingLimit = DeserializationOption::NestingLimit()) {
+  return deserializeJson(doc, (const char*)input, inputSize, filter, nestingLimit);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter()) {
+  return deserializeJson(doc, input, input ? strlen(input) : 0, filter);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& input,
+                                            DeserializationOption::Filter filter = DeserializationOption::Filter()) {
+  return deserializeJson(doc, input.c_str(), input.length(), filter);
+}
+
+#endif // HOST_ARDUINOJSON_H
@@ -0,0 +1,196 @@
+/*
+ * FS.cpp
+ *
+ * Host Stand-in for fs::File, fs::FS and LittleFS - see FS.h, LittleFS.h
+ */
+
+#include "LittleFS.h"
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <mutex>
+
+#define HOST_LITTLEFS_TOTAL (1536 * 1024)
+
+static std::mutex rootMutex;
+static std::string filesystemRoot = "littlefs";
+
+void hostSetFilesystemRoot(const char* path) {
+  std::lock_guard<std::mutex> lock(rootMutex);
+  filesystemRoot = path;
+  while (filesystemRoot.size() > 1 && filesystemRoot.back() == '/') filesystemRoot.pop_back();
+}
+
+static std::string currentRoot() {
+  std::lock_guard<std::mutex> lock(rootMutex);
+  return filesystemRoot;
+}
+
+namespace fs {
+
+File::File(FILE* f, const char* path) : handle(f, fclose), filePath(path) {
+}
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!handle) return 0;
+  return fwrite(buf, 1, size, handle.get());
+}
+
+int File::available() {
+  if (!handle) return 0;
+  return (int)(size() - position());
+}
+
+int File::read() {
+  if (!handle) return -1;
+  int c = fgetc(handle.get());
+  return c == EOF ? -1 : c;
+}
+
+int File::peek() {
+  if (!handle) return -1;
+  int c = fgetc(handle.get());
+  if (c == EOF) return -1;
+  ungetc(c, handle.get());
+  return c;
+}
+
+void File::flush() {
+  if (handle) fflush(handle.get());
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  if (!handle) return 0;
+  return fread(buf, 1, size, handle.get());
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!handle) return false;
+  int whence = mode == SeekCur ? SEEK_CUR : mode == SeekEnd ? SEEK_END : SEEK_SET;
+  return fseek(handle.get(), pos, whence) == 0;
+}
+
+size_t File::position() const {
+  if (!handle) return 0;
+  long pos = ftell(handle.get());
+  return pos < 0 ? 0 : pos;
+}
+
+size_t File::size() const {
+  if (!handle) return 0;
+  fflush(handle.get());
+  struct stat st;
+  if (fstat(fileno(handle.get()), &st) != 0) return 0;
+  return st.st_size;
+}
+
+void File::close() {
+  handle.reset();
+}
+
+const char* File::name() const {
+  if (!handle) return nullptr;
+  size_t slash = filePath.rfind('/');
+  return filePath.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+}
+
+std::string FS::hostPath(const char* path) const {
+  std::string p = currentRoot();
+  if (path[0] != '/') p += '/';
+  return p + path;
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+  (void)create;
+  if (!mounted || !path) return File();
+  const char* hostMode = "rb";
+  if (mode[0] == 'w') hostMode = mode[1] == '+' ? "w+b" : "wb";
+  else if (mode[0] == 'a') hostMode = mode[1] == '+' ? "a+b" : "ab";
+  else if (mode[1] == '+') hostMode = "r+b";
+
+  std::string full = hostPath(path);
+  struct stat st;
+  if (stat(full.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) return File();
+  FILE* f = fopen(full.c_str(), hostMode);
+  if (!f) return File();
+  return File(f, path);
+}
+
+bool FS::exists(const char* path) {
+  if (!mounted || !path) return false;
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  if (!mounted || !path) return false;
+  return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+  if (!mounted || !pathFrom || !pathTo) return false;
+  return ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  if (!mounted || !path) return false;
+  return ::mkdir(hostPath(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool FS::rmdir(const char* path) {
+  if (!mounted || !path) return false;
+  return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles, const char* partitionLabel) {
+  (void)formatOnFail;
+  (void)basePath;
+  (void)maxOpenFiles;
+  (void)partitionLabel;
+  std::string root = currentRoot();
+  struct stat st;
+  if (stat(root.c_str(), &st) != 0 && ::mkdir(root.c_str(), 0755) != 0) return false;
+  mounted = true;
+  return true;
+}
+
+bool LittleFSFS::format() {
+  std::string root = currentRoot();
+  DIR* dir = opendir(root.c_str());
+  if (!dir) return false;
+  while (struct dirent* entry = readdir(dir)) {
+    if (entry->d_type == DT_REG) ::unlink((root + "/" + entry->d_name).c_str());
+  }
+  closedir(dir);
+  return true;
+}
+
+size_t LittleFSFS::totalBytes() {
+  return HOST_LITTLEFS_TOTAL;
+}
+
+size_t LittleFSFS::usedBytes() {
+  std::string root = currentRoot();
+  DIR* dir = opendir(root.c_str());
+  if (!dir) return 0;
+  size_t used = 0;
+  while (struct dirent* entry = readdir(dir)) {
+    struct stat st;
+    if (entry->d_type == DT_REG && stat((root + "/" + entry->d_name).c_str(), &st) == 0) used += st.st_size;
+  }
+  closedir(dir);
+  return used;
+}
+
+void LittleFSFS::end() {
+  mounted = false;
+}
+
+}  // namespace fs
+
+fs::LittleFSFS LittleFS;
@@ -0,0 +1,32 @@
+/*
+ * HardwareSerial.h
+ *
+ * Host Stand-in for the ESP32 UART0 Serial Port
+ * Output goes to stdout (see hostSerialEcho()); there is no input.
+ */
+
+#ifndef HOST_HARDWARESERIAL_H
+#define HOST_HARDWARESERIAL_H
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  void flush() override;
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_HARDWARESERIAL_H
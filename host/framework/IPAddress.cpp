@@ -0,0 +1,73 @@
+/*
+ * IPAddress.cpp
+ *
+ * Host Stand-in for the Arduino IPAddress Class
+ */
+
+#include "IPAddress.h"
+#include <stdio.h>
+#include <string.h>
+
+IPAddress::IPAddress() {
+  memset(bytes, 0, sizeof(bytes));
+}
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) {
+  bytes[0] = first;
+  bytes[1] = second;
+  bytes[2] = third;
+  bytes[3] = fourth;
+}
+
+IPAddress::IPAddress(uint32_t address) {
+  memcpy(bytes, &address, sizeof(bytes));
+}
+
+bool IPAddress::fromString(const char* address) {
+  uint16_t acc = 0;
+  uint8_t dots = 0;
+  bool digit = false;
+  uint8_t parsed[4];
+  if (!address) return false;
+  for (const char* p = address; *p; p++) {
+    char c = *p;
+    if (c >= '0' && c <= '9') {
+      acc = acc * 10 + (c - '0');
+      if (acc > 255) return false;
+      digit = true;
+    } else if (c == '.') {
+      if (dots == 3 || !digit) return false;
+      parsed[dots++] = acc;
+      acc = 0;
+      digit = false;
+    } else {
+      return false;
+    }
+  }
+  if (dots != 3 || !digit) return false;
+  parsed[3] = acc;
+  memcpy(bytes, parsed, sizeof(bytes));
+  return true;
+}
+
+IPAddress::operator uint32_t() const {
+  uint32_t address;
+  memcpy(&address, bytes, sizeof(address));
+  return address;
+}
+
+size_t IPAddress::printTo(Print& p) const {
+  size_t n = 0;
+  for (int i = 0; i < 3; i++) {
+    n += p.print(bytes[i], DEC);
+    n += p.print('.');
+  }
+  n += p.print(bytes[3], DEC);
+  return n;
+}
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+  return String(buf);
+}
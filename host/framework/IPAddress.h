@@ -0,0 +1,41 @@
+/*
+ * IPAddress.h
+ *
+ * Host Stand-in for the Arduino IPAddress Class (IPv4 only)
+ */
+
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <stdint.h>
+#include "Print.h"
+#include "WString.h"
+
+class IPAddress : public Printable {
+public:
+  IPAddress();
+  IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth);
+  IPAddress(uint32_t address);  // Network byte order, as lwIP stores it
+
+  bool fromString(const char* address);
+  bool fromString(const String& address) { return fromString(address.c_str()); }
+
+  // Network byte order - the value for sockaddr_in.sin_addr.s_addr
+  operator uint32_t() const;
+  bool operator==(const IPAddress& addr) const { return (uint32_t)*this == (uint32_t)addr; }
+  bool operator!=(const IPAddress& addr) const { return !(*this == addr); }
+
+  uint8_t operator[](int index) const { return bytes[index]; }
+  uint8_t& operator[](int index) { return bytes[index]; }
+
+  size_t printTo(Print& p) const override;
+  String toString() const;
+
+private:
+  uint8_t bytes[4];
+
+  uint8_t* raw_address() { return bytes; }
+  friend class Client;
+};
+
+#endif // HOST_IPADDRESS_H
@@ -0,0 +1,33 @@
+/*
+ * LittleFS.h
+ *
+ * Host Stand-in for the ESP32 LittleFS library
+ * The filesystem is a host directory, set with hostSetFilesystemRoot()
+ * (default ./littlefs). begin() creates it; totalBytes() reports the
+ * 1.5 MB partition of the default ESP32 layout.
+ */
+
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+  LittleFSFS() : FS("/littlefs") {}
+
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+             const char* partitionLabel = "spiffs");
+  bool format();
+  size_t totalBytes();
+  size_t usedBytes();
+  void end();
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
@@ -0,0 +1,233 @@
+/*
+ * PN5180.cpp
+ *
+ * Host Stand-in for the PN5180 library - a reader with no chip behind it
+ * (see PN5180.h)
+ */
+
+#include "PN5180.h"
+#include "PN5180ISO15693.h"
+#include "PN5180ISO14443.h"
+
+PN5180::PN5180(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi)
+  : PN5180_NSS(SSpin), PN5180_BUSY(BUSYpin), PN5180_RST(RSTpin) {
+  (void)spi;
+  memset(readBuffer, 0, sizeof(readBuffer));
+}
+
+void PN5180::begin() {
+}
+
+void PN5180::end() {
+}
+
+void PN5180::reset() {
+  delay(10);
+}
+
+bool PN5180::writeRegister(uint8_t reg, uint32_t value) {
+  (void)reg;
+  (void)value;
+  return false;
+}
+
+bool PN5180::writeRegisterWithOrMask(uint8_t addr, uint32_t mask) {
+  (void)addr;
+  (void)mask;
+  return false;
+}
+
+bool PN5180::writeRegisterWithAndMask(uint8_t addr, uint32_t mask) {
+  (void)addr;
+  (void)mask;
+  return false;
+}
+
+bool PN5180::readRegister(uint8_t reg, uint32_t* value) {
+  (void)reg;
+  *value = 0xFFFFFFFF;
+  return false;
+}
+
+bool PN5180::writeEEprom(uint8_t addr, uint8_t* buffer, uint8_t len) {
+  (void)addr;
+  (void)buffer;
+  (void)len;
+  return false;
+}
+
+// MISO floats high with nothing on the bus
+bool PN5180::readEEprom(uint8_t addr, uint8_t* buffer, int len) {
+  (void)addr;
+  memset(buffer, 0xFF, len);
+  return true;
+}
+
+bool PN5180::sendData(const uint8_t* data, int len, uint8_t validBits) {
+  (void)data;
+  (void)len;
+  (void)validBits;
+  return false;
+}
+
+uint8_t* PN5180::readData(int len) {
+  if (len <= 0 || len > (int)sizeof(readBuffer)) return nullptr;
+  memset(readBuffer, 0xFF, len);
+  return readBuffer;
+}
+
+bool PN5180::readData(int len, uint8_t* buffer) {
+  (void)len;
+  (void)buffer;
+  return false;
+}
+
+bool PN5180::prepareLPCD() {
+  return false;
+}
+
+bool PN5180::switchToLPCD(uint16_t wakeupCounterInMs) {
+  (void)wakeupCounterInMs;
+  return false;
+}
+
+bool PN5180::loadRFConfig(uint8_t txConf, uint8_t rxConf) {
+  (void)txConf;
+  (void)rxConf;
+  return false;
+}
+
+bool PN5180::setRF_on() {
+  return false;
+}
+
+bool PN5180::setRF_off() {
+  return false;
+}
+
+PN5180TransceiveStat PN5180::getTransceiveState() {
+  return PN5180_TS_Idle;
+}
+
+uint32_t PN5180::getIRQStatus() {
+  return 0;
+}
+
+bool PN5180::clearIRQStatus(uint32_t irqMask) {
+  (void)irqMask;
+  return false;
+}
+
+// ISO 15693
+PN5180ISO15693::PN5180ISO15693(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi)
+  : PN5180(SSpin, BUSYpin, RSTpin, spi) {
+}
+
+ISO15693ErrorCode PN5180ISO15693::getInventory(uint8_t* uid) {
+  (void)uid;
+  return EC_NO_CARD;
+}
+
+ISO15693ErrorCode PN5180ISO15693::getInventoryMultiple(uint8_t* uid, uint8_t maxTags, uint8_t* numCard) {
+  (void)uid;
+  (void)maxTags;
+  *numCard = 0;
+  return EC_NO_CARD;
+}
+
+ISO15693ErrorCode PN5180ISO15693::readSingleBlock(uint8_t* uid, uint8_t blockNo, uint8_t* blockData, uint8_t blockSize) {
+  (void)uid;
+  (void)blockNo;
+  (void)blockData;
+  (void)blockSize;
+  return EC_NO_CARD;
+}
+
+ISO15693ErrorCode PN5180ISO15693::writeSingleBlock(uint8_t* uid, uint8_t blockNo, uint8_t* blockData, uint8_t blockSize) {
+  (void)uid;
+  (void)blockNo;
+  (void)blockData;
+  (void)blockSize;
+  return EC_NO_CARD;
+}
+
+ISO15693ErrorCode PN5180ISO15693::readMultipleBlock(uint8_t* uid, uint8_t blockNo, uint8_t numBlock,
+                                                    uint8_t* blockData, uint8_t blockSize) {
+  (void)uid;
+  (void)blockNo;
+  (void)numBlock;
+  (void)blockData;
+  (void)blockSize;
+  return EC_NO_CARD;
+}
+
+ISO15693ErrorCode PN5180ISO15693::getSystemInfo(uint8_t* uid, uint8_t* blockSize, uint8_t* numBlocks) {
+  (void)uid;
+  (void)blockSize;
+  (void)numBlocks;
+  return EC_NO_CARD;
+}
+
+bool PN5180ISO15693::setupRF() {
+  return false;
+}
+
+const __FlashStringHelper* PN5180ISO15693::strerror(ISO15693ErrorCode code) {
+  switch (code) {
+    case EC_NO_CARD: return F("No card detected!");
+    case ISO15693_EC_OK: return F("OK!");
+    case ISO15693_EC_NOT_SUPPORTED: return F("Command is not supported!");
+    case ISO15693_EC_NOT_RECOGNIZED: return F("Command is not recognized!");
+    case ISO15693_EC_OPTION_NOT_SUPPORTED: return F("Option is not supported!");
+    case ISO15693_EC_BLOCK_NOT_AVAILABLE: return F("Block is not available!");
+    case ISO15693_EC_BLOCK_ALREADY_LOCKED: return F("Block is already locked!");
+    case ISO15693_EC_BLOCK_IS_LOCKED: return F("Block is locked!");
+    case ISO15693_EC_BLOCK_NOT_PROGRAMMED: return F("Block was not successfully programmed!");
+    case ISO15693_EC_BLOCK_NOT_LOCKED: return F("Block was not successfully locked!");
+    default: return F("Unknown error!");
+  }
+}
+
+// ISO 14443
+PN5180ISO14443::PN5180ISO14443(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi)
+  : PN5180(SSpin, BUSYpin, RSTpin, spi) {
+}
+
+bool PN5180ISO14443::setupRF() {
+  return false;
+}
+
+uint16_t PN5180ISO14443::rxBytesReceived() {
+  return 0;
+}
+
+uint8_t PN5180ISO14443::activateTypeA(uint8_t* buffer, uint8_t kind) {
+  (void)kind;
+  memset(buffer, 0, 10);
+  return 0;
+}
+
+bool PN5180ISO14443::mifareBlockRead(uint8_t blockno, uint8_t* buffer) {
+  (void)blockno;
+  (void)buffer;
+  return false;
+}
+
+uint8_t PN5180ISO14443::mifareBlockWrite16(uint8_t blockno, uint8_t* buffer) {
+  (void)blockno;
+  (void)buffer;
+  return 0;
+}
+
+bool PN5180ISO14443::mifareHalt() {
+  return false;
+}
+
+int8_t PN5180ISO14443::readCardSerial(uint8_t* buffer) {
+  (void)buffer;
+  return 0;
+}
+
+bool PN5180ISO14443::isCardPresent() {
+  return false;
+}
@@ -0,0 +1,27 @@
+/*
+ * PN5180ISO14443.h
+ *
+ * Host Stand-in for the PN5180 library's ISO 14443 layer - no card ever
+ * answers activation.
+ */
+
+#ifndef HOST_PN5180ISO14443_H
+#define HOST_PN5180ISO14443_H
+
+#include "PN5180.h"
+
+class PN5180ISO14443 : public PN5180 {
+public:
+  PN5180ISO14443(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi = SPI);
+
+  bool setupRF();
+  uint16_t rxBytesReceived();
+  uint8_t activateTypeA(uint8_t* buffer, uint8_t kind);
+  bool mifareBlockRead(uint8_t blockno, uint8_t* buffer);
+  uint8_t mifareBlockWrite16(uint8_t blockno, uint8_t* buffer);
+  bool mifareHalt();
+  int8_t readCardSerial(uint8_t* buffer);
+  bool isCardPresent();
+};
+
+#endif // HOST_PN5180ISO14443_H
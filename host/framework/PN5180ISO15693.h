@@ -0,0 +1,43 @@
+/*
+ * PN5180ISO15693.h
+ *
+ * Host Stand-in for the PN5180 library's ISO 15693 layer - every command
+ * ends in EC_NO_CARD, as with no tag (or no chip) in range.
+ */
+
+#ifndef HOST_PN5180ISO15693_H
+#define HOST_PN5180ISO15693_H
+
+#include "PN5180.h"
+
+enum ISO15693ErrorCode {
+  EC_NO_CARD = -1,
+  ISO15693_EC_OK = 0,
+  ISO15693_EC_NOT_SUPPORTED = 0x01,
+  ISO15693_EC_NOT_RECOGNIZED = 0x02,
+  ISO15693_EC_OPTION_NOT_SUPPORTED = 0x03,
+  ISO15693_EC_UNKNOWN_ERROR = 0x0f,
+  ISO15693_EC_BLOCK_NOT_AVAILABLE = 0x10,
+  ISO15693_EC_BLOCK_ALREADY_LOCKED = 0x11,
+  ISO15693_EC_BLOCK_IS_LOCKED = 0x12,
+  ISO15693_EC_BLOCK_NOT_PROGRAMMED = 0x13,
+  ISO15693_EC_BLOCK_NOT_LOCKED = 0x14,
+  ISO15693_EC_CUSTOM_CMD_ERROR = 0xA0
+};
+
+class PN5180ISO15693 : public PN5180 {
+public:
+  PN5180ISO15693(uint8_t SSpin, uint8_t BUSYpin, uint8_t RSTpin, SPIClass& spi = SPI);
+
+  ISO15693ErrorCode getInventory(uint8_t* uid);
+  ISO15693ErrorCode getInventoryMultiple(uint8_t* uid, uint8_t maxTags, uint8_t* numCard);
+  ISO15693ErrorCode readSingleBlock(uint8_t* uid, uint8_t blockNo, uint8_t* blockData, uint8_t blockSize);
+  ISO15693ErrorCode writeSingleBlock(uint8_t* uid, uint8_t blockNo, uint8_t* blockData, uint8_t blockSize);
+  ISO15693ErrorCode readMultipleBlock(uint8_t* uid, uint8_t blockNo, uint8_t numBlock, uint8_t* blockData, uint8_t blockSize);
+  ISO15693ErrorCode getSystemInfo(uint8_t* uid, uint8_t* blockSize, uint8_t* numBlocks);
+
+  bool setupRF();
+  const __FlashStringHelper* strerror(ISO15693ErrorCode code);
+};
+
+#endif // HOST_PN5180ISO15693_H
@@ -0,0 +1,95 @@
+/*
+ * Preferences.cpp
+ *
+ * Host Stand-in for the ESP32 Preferences (NVS) library - see Preferences.h
+ */
+
+#include "Preferences.h"
+#include <map>
+#include <mutex>
+
+// NVS keys are limited to 15 characters, namespaces likewise
+#define NVS_KEY_MAX 15
+
+static std::mutex storeMutex;
+static std::map<std::string, std::map<std::string, std::string>> store;
+
+bool Preferences::begin(const char* name, bool readOnlyMode, const char* partition) {
+  (void)partition;
+  if (opened || !name || strlen(name) > NVS_KEY_MAX) return false;
+  space = name;
+  readOnly = readOnlyMode;
+  opened = true;
+  return true;
+}
+
+void Preferences::end() {
+  opened = false;
+}
+
+bool Preferences::clear() {
+  if (!opened || readOnly) return false;
+  std::lock_guard<std::mutex> lock(storeMutex);
+  store[space].clear();
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!opened || readOnly || !key) return false;
+  std::lock_guard<std::mutex> lock(storeMutex);
+  return store[space].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  std::string value;
+  return findValue(key, &value);
+}
+
+size_t Preferences::putValue(const char* key, const void* value, size_t length) {
+  if (!opened || readOnly || !key || strlen(key) > NVS_KEY_MAX) return 0;
+  std::lock_guard<std::mutex> lock(storeMutex);
+  store[space][key] = std::string((const char*)value, length);
+  return length;
+}
+
+bool Preferences::findValue(const char* key, std::string* value) {
+  if (!opened || !key) return false;
+  std::lock_guard<std::mutex> lock(storeMutex);
+  auto ns = store.find(space);
+  if (ns == store.end()) return false;
+  auto it = ns->second.find(key);
+  if (it == ns->second.end()) return false;
+  *value = it->second;
+  return true;
+}
+
+// Strings are stored with their terminator, as NVS does
+size_t Preferences::putString(const char* key, const char* value) {
+  if (!value) return 0;
+  return putValue(key, value, strlen(value) + 1) ? strlen(value) : 0;
+}
+
+String Preferences::getString(const char* key, const String defaultValue) {
+  std::string value;
+  if (!findValue(key, &value) || value.empty()) return defaultValue;
+  return String(value.c_str());
+}
+
+size_t Preferences::getString(const char* key, char* buffer, size_t maxLen) {
+  std::string value;
+  if (!findValue(key, &value) || value.size() > maxLen) return 0;
+  memcpy(buffer, value.data(), value.size());
+  return value.size();
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  std::string value;
+  return findValue(key, &value) ? value.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLen) {
+  std::string value;
+  if (!findValue(key, &value) || value.size() > maxLen) return 0;
+  memcpy(buffer, value.data(), value.size());
+  return value.size();
+}
@@ -0,0 +1,67 @@
+/*
+ * Preferences.h
+ *
+ * Host Stand-in for the ESP32 Preferences (NVS) library
+ * Namespaces live in memory for the life of the process, so a test can
+ * save settings and read them back after a simulated reboot.
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include "Arduino.h"
+#include <string>
+
+class Preferences {
+public:
+  Preferences() : opened(false), readOnly(false) {}
+
+  bool begin(const char* name, bool readOnly = false, const char* partition = nullptr);
+  void end();
+
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putChar(const char* key, int8_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putUChar(const char* key, uint8_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putShort(const char* key, int16_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putUShort(const char* key, uint16_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putInt(const char* key, int32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putUInt(const char* key, uint32_t value) { return putValue(key, &value, sizeof(value)); }
+  size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+  size_t putString(const char* key, const char* value);
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+  size_t putBytes(const char* key, const void* value, size_t length) { return putValue(key, value, length); }
+
+  int8_t getChar(const char* key, int8_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+  int16_t getShort(const char* key, int16_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+  int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+  bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+  String getString(const char* key, const String defaultValue = String());
+  size_t getString(const char* key, char* value, size_t maxLen);
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buffer, size_t maxLen);
+
+private:
+  std::string space;
+  bool opened;
+  bool readOnly;
+
+  size_t putValue(const char* key, const void* value, size_t length);
+  bool findValue(const char* key, std::string* value);
+
+  template<typename T>
+  T getValue(const char* key, T defaultValue) {
+    std::string value;
+    if (!findValue(key, &value) || value.size() != sizeof(T)) return defaultValue;
+    T result;
+    memcpy(&result, value.data(), sizeof(T));
+    return result;
+  }
+};
+
+#endif // HOST_PREFERENCES_H
@@ -0,0 +1,494 @@
+/*
+ * PubSubClient.cpp
+ *
+ * Host Stand-in for PubSubClient (knolleary, 2.8)
+ * Follows the library's packet handling step for step, including the
+ * CONNACK wait that spins on millis() - under the virtual clock nothing
+ * moves time forward there, so use the real clock with a live broker.
+ */
+
+#include "PubSubClient.h"
+
+#define CHECK_STRING_LENGTH(l, s) \
+  if (l + 2 + strnlen(s, this->bufferSize) > this->bufferSize) { \
+    _client->stop(); \
+    return false; \
+  }
+
+PubSubClient::PubSubClient()
+  : _client(nullptr), buffer(nullptr), bufferSize(0), keepAlive(MQTT_KEEPALIVE),
+    socketTimeout(MQTT_SOCKET_TIMEOUT), nextMsgId(0), lastOutActivity(0), lastInActivity(0),
+    pingOutstanding(false), callback(nullptr), domain(nullptr), port(0),
+    _state(MQTT_DISCONNECTED) {
+  setBufferSize(MQTT_MAX_PACKET_SIZE);
+}
+
+PubSubClient::PubSubClient(Client& client) : PubSubClient() {
+  setClient(client);
+}
+
+PubSubClient::~PubSubClient() {
+  free(buffer);
+}
+
+bool PubSubClient::connect(const char* id) {
+  return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+  return connect(id, user, pass, nullptr, 0, false, nullptr, true);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass,
+                           const char* willTopic, uint8_t willQos, bool willRetain,
+                           const char* willMessage, bool cleanSession) {
+  if (connected()) return true;
+
+  int result = 0;
+  if (_client->connected()) {
+    result = 1;
+  } else if (domain != nullptr) {
+    result = _client->connect(domain, port);
+  } else {
+    result = _client->connect(ip, port);
+  }
+
+  if (result != 1) {
+    _state = MQTT_CONNECT_FAILED;
+    return false;
+  }
+
+  nextMsgId = 1;
+  // Leave room in the buffer for header and variable length field
+  uint16_t length = MQTT_MAX_HEADER_SIZE;
+  const uint8_t d[7] = { 0x00, 0x04, 'M', 'Q', 'T', 'T', MQTT_VERSION };
+  for (unsigned int j = 0; j < sizeof(d); j++) buffer[length++] = d[j];
+
+  uint8_t v;
+  if (willTopic) {
+    v = 0x04 | (willQos << 3) | (willRetain << 5);
+  } else {
+    v = 0x00;
+  }
+  if (cleanSession) v = v | 0x02;
+  if (user != nullptr) {
+    v = v | 0x80;
+    if (pass != nullptr) v = v | (0x80 >> 1);
+  }
+  buffer[length++] = v;
+  buffer[length++] = ((keepAlive) >> 8);
+  buffer[length++] = ((keepAlive) & 0xFF);
+
+  CHECK_STRING_LENGTH(length, id)
+  length = writeString(id, buffer, length);
+  if (willTopic) {
+    CHECK_STRING_LENGTH(length, willTopic)
+    length = writeString(willTopic, buffer, length);
+    CHECK_STRING_LENGTH(length, willMessage)
+    length = writeString(willMessage, buffer, length);
+  }
+  if (user != nullptr) {
+    CHECK_STRING_LENGTH(length, user)
+    length = writeString(user, buffer, length);
+    if (pass != nullptr) {
+      CHECK_STRING_LENGTH(length, pass)
+      length = writeString(pass, buffer, length);
+    }
+  }
+
+  write(MQTTCONNECT, buffer, length - MQTT_MAX_HEADER_SIZE);
+
+  lastInActivity = lastOutActivity = millis();
+
+  while (!_client->available()) {
+    unsigned long t = millis();
+    if (t - lastInActivity >= ((int32_t)socketTimeout * 1000UL)) {
+      _state = MQTT_CONNECTION_TIMEOUT;
+      _client->stop();
+      return false;
+    }
+  }
+  uint8_t llen;
+  uint32_t len = readPacket(&llen);
+
+  if (len == 4) {
+    if (buffer[3] == 0) {
+      lastInActivity = millis();
+      pingOutstanding = false;
+      _state = MQTT_CONNECTED;
+      return true;
+    } else {
+      _state = buffer[3];
+    }
+  }
+  _client->stop();
+  return false;
+}
+
+// Reads a byte, waiting up to the socket timeout for it
+bool PubSubClient::readByte(uint8_t* result) {
+  unsigned long previousMillis = millis();
+  while (!_client->available()) {
+    yield();
+    unsigned long currentMillis = millis();
+    if (currentMillis - previousMillis >= ((int32_t)socketTimeout * 1000)) return false;
+  }
+  *result = _client->read();
+  return true;
+}
+
+bool PubSubClient::readByte(uint8_t* result, uint16_t* index) {
+  uint16_t current_index = *index;
+  uint8_t* write_address = &(result[current_index]);
+  if (readByte(write_address)) {
+    *index = current_index + 1;
+    return true;
+  }
+  return false;
+}
+
+uint32_t PubSubClient::readPacket(uint8_t* lengthLength) {
+  uint16_t len = 0;
+  if (!readByte(buffer, &len)) return 0;
+  bool isPublish = (buffer[0] & 0xF0) == MQTTPUBLISH;
+  uint32_t multiplier = 1;
+  uint32_t length = 0;
+  uint8_t digit = 0;
+  uint16_t skip = 0;
+  uint32_t start = 0;
+
+  do {
+    if (len == 5) {
+      // Invalid remaining length encoding - kill the connection
+      _state = MQTT_DISCONNECTED;
+      _client->stop();
+      return 0;
+    }
+    if (!readByte(&digit)) return 0;
+    buffer[len++] = digit;
+    length += (digit & 127) * multiplier;
+    multiplier <<= 7;
+  } while ((digit & 128) != 0);
+  *lengthLength = len - 1;
+
+  if (isPublish) {
+    // Read in topic length to calculate bytes to skip over for Stream writing
+    if (!readByte(buffer, &len)) return 0;
+    if (!readByte(buffer, &len)) return 0;
+    skip = (buffer[*lengthLength + 1] << 8) + buffer[*lengthLength + 2];
+    start = 2;
+    if (buffer[0] & MQTTQOS1) {
+      // Skip message id
+      skip += 2;
+    }
+  }
+  uint32_t idx = len;
+
+  for (uint32_t i = start; i < length; i++) {
+    if (!readByte(&digit)) return 0;
+    if (len < bufferSize) {
+      buffer[len] = digit;
+      len++;
+    }
+    idx++;
+  }
+  (void)skip;
+
+  if (idx > bufferSize) len = 0;  // This will cause the packet to be ignored
+  return len;
+}
+
+bool PubSubClient::loop() {
+  if (!connected()) return false;
+
+  unsigned long t = millis();
+  if ((t - lastInActivity > keepAlive * 1000UL) || (t - lastOutActivity > keepAlive * 1000UL)) {
+    if (pingOutstanding) {
+      _state = MQTT_CONNECTION_TIMEOUT;
+      _client->stop();
+      return false;
+    } else {
+      buffer[0] = MQTTPINGREQ;
+      buffer[1] = 0;
+      _client->write(buffer, 2);
+      lastOutActivity = t;
+      lastInActivity = t;
+      pingOutstanding = true;
+    }
+  }
+  if (_client->available()) {
+    uint8_t llen;
+    uint16_t len = readPacket(&llen);
+    uint16_t msgId = 0;
+    uint8_t* payload;
+    if (len > 0) {
+      lastInActivity = t;
+      uint8_t type = buffer[0] & 0xF0;
+      if (type == MQTTPUBLISH) {
+        if (callback) {
+          uint16_t tl = (buffer[llen + 1] << 8) + buffer[llen + 2];  // Topic length
+          memmove(buffer + llen + 2, buffer + llen + 3, tl);  // Move topic inside buffer 1 byte to front
+          buffer[llen + 2 + tl] = 0;  // End the topic as a 'C' string with \x00
+          char* topic = (char*)buffer + llen + 2;
+          if ((buffer[0] & 0x06) == MQTTQOS1) {
+            msgId = (buffer[llen + 3 + tl] << 8) + buffer[llen + 3 + tl + 1];
+            payload = buffer + llen + 3 + tl + 2;
+            callback(topic, payload, len - llen - 3 - tl - 2);
+
+            buffer[0] = MQTTPUBACK;
+            buffer[1] = 2;
+            buffer[2] = (msgId >> 8);
+            buffer[3] = (msgId & 0xFF);
+            _client->write(buffer, 4);
+            lastOutActivity = t;
+          } else {
+            payload = buffer + llen + 3 + tl;
+            callback(topic, payload, len - llen - 3 - tl);
+          }
+        }
+      } else if (type == MQTTPINGREQ) {
+        buffer[0] = MQTTPINGRESP;
+        buffer[1] = 0;
+        _client->write(buffer, 2);
+      } else if (type == MQTTPINGRESP) {
+        pingOutstanding = false;
+      }
+    } else if (!connected()) {
+      // readPacket has closed the connection
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+  return publish(topic, (const uint8_t*)payload, payload ? strnlen(payload, bufferSize) : 0, false);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+  return publish(topic, (const uint8_t*)payload, payload ? strnlen(payload, bufferSize) : 0, retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength) {
+  return publish(topic, payload, plength, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, bool retained) {
+  if (!connected()) return false;
+  if (bufferSize < MQTT_MAX_HEADER_SIZE + 2 + strnlen(topic, bufferSize) + plength) {
+    // Too long
+    return false;
+  }
+  // Leave room in the buffer for header and variable length field
+  uint16_t length = MQTT_MAX_HEADER_SIZE;
+  length = writeString(topic, buffer, length);
+
+  // Add payload
+  for (uint16_t i = 0; i < plength; i++) buffer[length++] = payload[i];
+
+  // Write the header
+  uint8_t header = MQTTPUBLISH;
+  if (retained) header |= 1;
+  return write(header, buffer, length - MQTT_MAX_HEADER_SIZE);
+}
+
+bool PubSubClient::beginPublish(const char* topic, unsigned int plength, bool retained) {
+  if (!connected()) return false;
+  // Send the header and variable length field
+  uint16_t length = MQTT_MAX_HEADER_SIZE;
+  length = writeString(topic, buffer, length);
+  uint8_t header = MQTTPUBLISH;
+  if (retained) header |= 1;
+  size_t hlen = buildHeader(header, buffer, plength + length - MQTT_MAX_HEADER_SIZE);
+  uint16_t rc = _client->write(buffer + (MQTT_MAX_HEADER_SIZE - hlen), length - (MQTT_MAX_HEADER_SIZE - hlen));
+  lastOutActivity = millis();
+  return (rc == (length - (MQTT_MAX_HEADER_SIZE - hlen)));
+}
+
+int PubSubClient::endPublish() {
+  return 1;
+}
+
+size_t PubSubClient::write(uint8_t data) {
+  lastOutActivity = millis();
+  return _client->write(data);
+}
+
+size_t PubSubClient::write(const uint8_t* buf, size_t size) {
+  lastOutActivity = millis();
+  return _client->write(buf, size);
+}
+
+size_t PubSubClient::buildHeader(uint8_t header, uint8_t* buf, uint16_t length) {
+  uint8_t lenBuf[4];
+  uint8_t llen = 0;
+  uint8_t digit;
+  uint8_t pos = 0;
+  uint16_t len = length;
+  do {
+    digit = len & 127;  // digit = len % 128
+    len >>= 7;          // len = len / 128
+    if (len > 0) digit |= 0x80;
+    lenBuf[pos++] = digit;
+    llen++;
+  } while (len > 0);
+
+  buf[4 - llen] = header;
+  for (int i = 0; i < llen; i++) buf[MQTT_MAX_HEADER_SIZE - llen + i] = lenBuf[i];
+  return llen + 1;  // Full header size is variable length bit plus the 1-byte fixed header
+}
+
+bool PubSubClient::write(uint8_t header, uint8_t* buf, uint16_t length) {
+  uint16_t rc;
+  uint8_t hlen = buildHeader(header, buf, length);
+  rc = _client->write(buf + (MQTT_MAX_HEADER_SIZE - hlen), length + hlen);
+  lastOutActivity = millis();
+  return (rc == hlen + length);
+}
+
+bool PubSubClient::subscribe(const char* topic) {
+  return subscribe(topic, 0);
+}
+
+bool PubSubClient::subscribe(const char* topic, uint8_t qos) {
+  size_t topicLength = strnlen(topic, bufferSize);
+  if (topic == nullptr) return false;
+  if (qos > 1) return false;
+  if (bufferSize < 9 + topicLength) {
+    // Too long
+    return false;
+  }
+  if (connected()) {
+    // Leave room in the buffer for header and variable length field
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    nextMsgId++;
+    if (nextMsgId == 0) nextMsgId = 1;
+    buffer[length++] = (nextMsgId >> 8);
+    buffer[length++] = (nextMsgId & 0xFF);
+    length = writeString(topic, buffer, length);
+    buffer[length++] = qos;
+    return write(MQTTSUBSCRIBE | MQTTQOS1, buffer, length - MQTT_MAX_HEADER_SIZE);
+  }
+  return false;
+}
+
+bool PubSubClient::unsubscribe(const char* topic) {
+  size_t topicLength = strnlen(topic, bufferSize);
+  if (topic == nullptr) return false;
+  if (bufferSize < 9 + topicLength) {
+    // Too long
+    return false;
+  }
+  if (connected()) {
+    uint16_t length = MQTT_MAX_HEADER_SIZE;
+    nextMsgId++;
+    if (nextMsgId == 0) nextMsgId = 1;
+    buffer[length++] = (nextMsgId >> 8);
+    buffer[length++] = (nextMsgId & 0xFF);
+    length = writeString(topic, buffer, length);
+    return write(MQTTUNSUBSCRIBE | MQTTQOS1, buffer, length - MQTT_MAX_HEADER_SIZE);
+  }
+  return false;
+}
+
+void PubSubClient::disconnect() {
+  buffer[0] = MQTTDISCONNECT;
+  buffer[1] = 0;
+  _client->write(buffer, 2);
+  _state = MQTT_DISCONNECTED;
+  _client->flush();
+  _client->stop();
+  lastInActivity = lastOutActivity = millis();
+}
+
+uint16_t PubSubClient::writeString(const char* string, uint8_t* buf, uint16_t pos) {
+  const char* idp = string;
+  uint16_t i = 0;
+  pos += 2;
+  while (*idp) {
+    buf[pos++] = *idp++;
+    i++;
+  }
+  buf[pos - i - 2] = (i >> 8);
+  buf[pos - i - 1] = (i & 0xFF);
+  return pos;
+}
+
+bool PubSubClient::connected() {
+  bool rc;
+  if (_client == nullptr) {
+    rc = false;
+  } else {
+    rc = (int)_client->connected();
+    if (!rc) {
+      if (_state == MQTT_CONNECTED) {
+        _state = MQTT_CONNECTION_LOST;
+        _client->flush();
+        _client->stop();
+      }
+    } else {
+      return _state == MQTT_CONNECTED;
+    }
+  }
+  return rc;
+}
+
+PubSubClient& PubSubClient::setServer(IPAddress ipAddress, uint16_t serverPort) {
+  ip = ipAddress;
+  port = serverPort;
+  domain = nullptr;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setServer(const char* serverDomain, uint16_t serverPort) {
+  domain = serverDomain;
+  port = serverPort;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+  this->callback = callback;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setClient(Client& client) {
+  _client = &client;
+  return *this;
+}
+
+int PubSubClient::state() {
+  return _state;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+  if (size == 0) {
+    // Cannot set it back to 0
+    return false;
+  }
+  if (bufferSize == 0) {
+    buffer = (uint8_t*)malloc(size);
+  } else {
+    uint8_t* newBuffer = (uint8_t*)realloc(buffer, size);
+    if (newBuffer != nullptr) {
+      buffer = newBuffer;
+    } else {
+      return false;
+    }
+  }
+  bufferSize = size;
+  return (buffer != nullptr);
+}
+
+uint16_t PubSubClient::getBufferSize() {
+  return bufferSize;
+}
+
+PubSubClient& PubSubClient::setKeepAlive(uint16_t keepAliveSeconds) {
+  keepAlive = keepAliveSeconds;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setSocketTimeout(uint16_t timeout) {
+  socketTimeout = timeout;
+  return *this;
+}
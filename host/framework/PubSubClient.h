@@ -0,0 +1,133 @@
+/*
+ * PubSubClient.h
+ *
+ * Host Stand-in for PubSubClient (knolleary, 2.8)
+ * A working MQTT 3.1.1 client with the library's interface and
+ * behaviour: QoS 0 publishing, CONNECT/CONNACK with the socket timeout
+ * busy-wait, keepalive PINGREQs from loop(), incoming PUBLISH delivered
+ * to the callback from the shared buffer (QoS 1 ones acknowledged), and
+ * SUBSCRIBE.
+ */
+
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "Client.h"
+#include <functional>
+
+#define MQTT_VERSION_3_1_1 4
+#define MQTT_VERSION MQTT_VERSION_3_1_1
+
+#ifndef MQTT_MAX_PACKET_SIZE
+#define MQTT_MAX_PACKET_SIZE 256
+#endif
+
+#ifndef MQTT_KEEPALIVE
+#define MQTT_KEEPALIVE 15
+#endif
+
+#ifndef MQTT_SOCKET_TIMEOUT
+#define MQTT_SOCKET_TIMEOUT 15
+#endif
+
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+#define MQTT_CONNECT_BAD_PROTOCOL    1
+#define MQTT_CONNECT_BAD_CLIENT_ID   2
+#define MQTT_CONNECT_UNAVAILABLE     3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED    5
+
+#define MQTTCONNECT     1 << 4
+#define MQTTCONNACK     2 << 4
+#define MQTTPUBLISH     3 << 4
+#define MQTTPUBACK      4 << 4
+#define MQTTPUBREC      5 << 4
+#define MQTTPUBREL      6 << 4
+#define MQTTPUBCOMP     7 << 4
+#define MQTTSUBSCRIBE   8 << 4
+#define MQTTSUBACK      9 << 4
+#define MQTTUNSUBSCRIBE 10 << 4
+#define MQTTUNSUBACK    11 << 4
+#define MQTTPINGREQ     12 << 4
+#define MQTTPINGRESP    13 << 4
+#define MQTTDISCONNECT  14 << 4
+#define MQTTReserved    15 << 4
+
+#define MQTTQOS0        (0 << 1)
+#define MQTTQOS1        (1 << 1)
+#define MQTTQOS2        (2 << 1)
+
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient : public Print {
+public:
+  PubSubClient();
+  PubSubClient(Client& client);
+  ~PubSubClient();
+
+  PubSubClient& setServer(IPAddress ip, uint16_t port);
+  PubSubClient& setServer(const char* domain, uint16_t port);
+  PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+  PubSubClient& setClient(Client& client);
+  PubSubClient& setKeepAlive(uint16_t keepAlive);
+  PubSubClient& setSocketTimeout(uint16_t timeout);
+
+  bool setBufferSize(uint16_t size);
+  uint16_t getBufferSize();
+
+  bool connect(const char* id);
+  bool connect(const char* id, const char* user, const char* pass);
+  bool connect(const char* id, const char* user, const char* pass, const char* willTopic,
+               uint8_t willQos, bool willRetain, const char* willMessage, bool cleanSession = true);
+  void disconnect();
+
+  bool publish(const char* topic, const char* payload);
+  bool publish(const char* topic, const char* payload, bool retained);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int plength);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int plength, bool retained);
+
+  bool beginPublish(const char* topic, unsigned int plength, bool retained);
+  int endPublish();
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+
+  bool subscribe(const char* topic);
+  bool subscribe(const char* topic, uint8_t qos);
+  bool unsubscribe(const char* topic);
+  bool loop();
+  bool connected();
+  int state();
+
+private:
+  Client* _client;
+  uint8_t* buffer;
+  uint16_t bufferSize;
+  uint16_t keepAlive;
+  uint16_t socketTimeout;
+  uint16_t nextMsgId;
+  unsigned long lastOutActivity;
+  unsigned long lastInActivity;
+  bool pingOutstanding;
+  MQTT_CALLBACK_SIGNATURE;
+  IPAddress ip;
+  const char* domain;
+  uint16_t port;
+  int _state;
+
+  uint32_t readPacket(uint8_t* lengthLength);
+  bool readByte(uint8_t* result);
+  bool readByte(uint8_t* result, uint16_t* index);
+  bool write(uint8_t header, uint8_t* buf, uint16_t length);
+  uint16_t writeString(const char* string, uint8_t* buf, uint16_t pos);
+  size_t buildHeader(uint8_t header, uint8_t* buf, uint16_t length);
+};
+
+#endif // HOST_PUBSUBCLIENT_H
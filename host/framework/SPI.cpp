@@ -0,0 +1,9 @@
+/*
+ * SPI.cpp
+ *
+ * Host Stand-in for the ESP32 SPI library - see SPI.h
+ */
+
+#include "SPI.h"
+
+SPIClass SPI;
@@ -0,0 +1,55 @@
+/*
+ * SPI.h
+ *
+ * Host Stand-in for the ESP32 SPI library - nothing is on the bus, so
+ * transfers read back 0xFF as from an unpopulated MISO line.
+ */
+
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x01
+#define SPI_MODE2 0x02
+#define SPI_MODE3 0x03
+
+#define SPI_MSBFIRST 1
+#define SPI_LSBFIRST 0
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = SPI_MSBFIRST, uint8_t dataMode = SPI_MODE0)
+    : _clock(clock), _bitOrder(bitOrder), _dataMode(dataMode) {}
+
+  uint32_t _clock;
+  uint8_t _bitOrder;
+  uint8_t _dataMode;
+};
+
+class SPIClass {
+public:
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+    (void)sck;
+    (void)miso;
+    (void)mosi;
+    (void)ss;
+  }
+  void end() {}
+  void beginTransaction(SPISettings settings) { (void)settings; }
+  void endTransaction() {}
+  uint8_t transfer(uint8_t data) {
+    (void)data;
+    return 0xFF;
+  }
+  void transfer(void* data, uint32_t size) { memset(data, 0xFF, size); }
+  void transferBytes(const uint8_t* data, uint8_t* out, uint32_t size) {
+    (void)data;
+    if (out) memset(out, 0xFF, size);
+  }
+};
+
+extern SPIClass SPI;
+
+#endif // HOST_SPI_H
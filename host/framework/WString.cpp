@@ -0,0 +1,346 @@
+/*
+ * WString.cpp
+ *
+ * Host Stand-in for the Arduino String Class
+ */
+
+#include "WString.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+String::String(const char* cstr) {
+  init();
+  if (cstr) copy(cstr, strlen(cstr));
+}
+
+String::String(const char* cstr, unsigned int length) {
+  init();
+  if (cstr) copy(cstr, length);
+}
+
+String::String(const String& str) {
+  init();
+  *this = str;
+}
+
+String::String(String&& rval) {
+  init();
+  move(rval);
+}
+
+String::String(const __FlashStringHelper* str) {
+  init();
+  if (str) copy(reinterpret_cast<const char*>(str), strlen(reinterpret_cast<const char*>(str)));
+}
+
+String::String(char c) {
+  init();
+  char buf[2] = { c, 0 };
+  *this = buf;
+}
+
+// Integer constructors - same digits as the core's ltoa/ultoa
+static void formatUnsigned(char* buf, unsigned long long value, unsigned char base) {
+  char tmp[66];
+  int i = 0;
+  if (base < 2) base = 10;
+  do {
+    unsigned digit = value % base;
+    tmp[i++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while (value);
+  int j = 0;
+  while (i) buf[j++] = tmp[--i];
+  buf[j] = 0;
+}
+
+static void formatSigned(char* buf, long long value, unsigned char base) {
+  if (value < 0 && base == 10) {
+    *buf++ = '-';
+    formatUnsigned(buf, 0ULL - (unsigned long long)value, base);
+  } else {
+    formatUnsigned(buf, (unsigned long long)value, base);
+  }
+}
+
+String::String(unsigned char value, unsigned char base) {
+  init();
+  char buf[66];
+  formatUnsigned(buf, value, base);
+  *this = buf;
+}
+
+String::String(int value, unsigned char base) {
+  init();
+  char buf[67];
+  if (base == 10) formatSigned(buf, value, base);
+  else formatUnsigned(buf, (unsigned int)value, base);
+  *this = buf;
+}
+
+String::String(unsigned int value, unsigned char base) {
+  init();
+  char buf[66];
+  formatUnsigned(buf, value, base);
+  *this = buf;
+}
+
+String::String(long value, unsigned char base) {
+  init();
+  char buf[67];
+  formatSigned(buf, value, base);
+  *this = buf;
+}
+
+String::String(unsigned long value, unsigned char base) {
+  init();
+  char buf[66];
+  formatUnsigned(buf, value, base);
+  *this = buf;
+}
+
+String::String(long long value, unsigned char base) {
+  init();
+  char buf[67];
+  formatSigned(buf, value, base);
+  *this = buf;
+}
+
+String::String(unsigned long long value, unsigned char base) {
+  init();
+  char buf[66];
+  formatUnsigned(buf, value, base);
+  *this = buf;
+}
+
+String::String(float value, unsigned int decimalPlaces) {
+  init();
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, (double)value);
+  *this = buf;
+}
+
+String::String(double value, unsigned int decimalPlaces) {
+  init();
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+  *this = buf;
+}
+
+String::~String() {
+  free(buffer);
+}
+
+void String::init() {
+  buffer = nullptr;
+  capacity = 0;
+  len = 0;
+}
+
+void String::invalidate() {
+  free(buffer);
+  init();
+}
+
+bool String::reserve(unsigned int size) {
+  if (buffer && capacity >= size) return true;
+  if (changeBuffer(size)) {
+    if (len == 0) buffer[0] = 0;
+    return true;
+  }
+  return false;
+}
+
+bool String::changeBuffer(unsigned int maxStrLen) {
+  char* newBuffer = (char*)realloc(buffer, maxStrLen + 1);
+  if (!newBuffer) return false;
+  buffer = newBuffer;
+  capacity = maxStrLen;
+  return true;
+}
+
+String& String::copy(const char* cstr, unsigned int length) {
+  if (!reserve(length)) {
+    invalidate();
+    return *this;
+  }
+  len = length;
+  memmove(buffer, cstr, length);
+  buffer[len] = 0;
+  return *this;
+}
+
+void String::move(String& rhs) {
+  free(buffer);
+  buffer = rhs.buffer;
+  capacity = rhs.capacity;
+  len = rhs.len;
+  rhs.init();
+}
+
+String& String::operator=(const String& rhs) {
+  if (this == &rhs) return *this;
+  if (rhs.buffer) copy(rhs.buffer, rhs.len);
+  else invalidate();
+  return *this;
+}
+
+String& String::operator=(String&& rval) {
+  if (this != &rval) move(rval);
+  return *this;
+}
+
+String& String::operator=(const char* cstr) {
+  if (cstr) copy(cstr, strlen(cstr));
+  else invalidate();
+  return *this;
+}
+
+String& String::operator=(const __FlashStringHelper* str) {
+  return *this = reinterpret_cast<const char*>(str);
+}
+
+bool String::concat(const char* cstr, unsigned int length) {
+  unsigned int newlen = len + length;
+  if (!cstr) return false;
+  if (length == 0) return true;
+  if (!reserve(newlen)) return false;
+  memmove(buffer + len, cstr, length);
+  len = newlen;
+  buffer[len] = 0;
+  return true;
+}
+
+bool String::concat(const String& s) {
+  return concat(s.c_str(), s.len);
+}
+
+bool String::concat(const char* cstr) {
+  return cstr ? concat(cstr, strlen(cstr)) : false;
+}
+
+bool String::concat(const __FlashStringHelper* str) {
+  return concat(reinterpret_cast<const char*>(str));
+}
+
+bool String::concat(char c) {
+  return concat(&c, 1);
+}
+
+bool String::concat(unsigned char num) { return concat(String(num)); }
+bool String::concat(int num) { return concat(String(num)); }
+bool String::concat(unsigned int num) { return concat(String(num)); }
+bool String::concat(long num) { return concat(String(num)); }
+bool String::concat(unsigned long num) { return concat(String(num)); }
+bool String::concat(long long num) { return concat(String(num)); }
+bool String::concat(unsigned long long num) { return concat(String(num)); }
+bool String::concat(float num) { return concat(String(num)); }
+bool String::concat(double num) { return concat(String(num)); }
+
+String operator+(const String& lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+bool String::equals(const String& s) const {
+  return len == s.len && strcmp(c_str(), s.c_str()) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+  return strcmp(c_str(), cstr ? cstr : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+  return len == s.len && strcasecmp(c_str(), s.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+  return prefix.len <= len && strncmp(c_str(), prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  return suffix.len <= len && strcmp(c_str() + len - suffix.len, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  return index < len ? buffer[index] : 0;
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= len || !buffer) {
+    dummy = 0;
+    return dummy;
+  }
+  return buffer[index];
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  if (fromIndex >= len) return -1;
+  const char* p = strchr(buffer + fromIndex, ch);
+  return p ? (int)(p - buffer) : -1;
+}
+
+int String::indexOf(const char* str, unsigned int fromIndex) const {
+  if (fromIndex >= len) return -1;
+  const char* p = strstr(buffer + fromIndex, str);
+  return p ? (int)(p - buffer) : -1;
+}
+
+String String::substring(unsigned int left, unsigned int right) const {
+  if (left > right) {
+    unsigned int temp = right;
+    right = left;
+    left = temp;
+  }
+  if (left >= len) return String();
+  if (right > len) right = len;
+  return String(buffer + left, right - left);
+}
+
+void String::toLowerCase() {
+  for (unsigned int i = 0; i < len; i++) buffer[i] = tolower((unsigned char)buffer[i]);
+}
+
+void String::toUpperCase() {
+  for (unsigned int i = 0; i < len; i++) buffer[i] = toupper((unsigned char)buffer[i]);
+}
+
+void String::trim() {
+  if (!buffer || len == 0) return;
+  char* begin = buffer;
+  while (isspace((unsigned char)*begin)) begin++;
+  char* end = buffer + len - 1;
+  while (end >= begin && isspace((unsigned char)*end)) end--;
+  len = end + 1 - begin;
+  if (begin > buffer) memmove(buffer, begin, len);
+  buffer[len] = 0;
+}
+
+long String::toInt() const {
+  return buffer ? atol(buffer) : 0;
+}
+
+float String::toFloat() const {
+  return (float)toDouble();
+}
+
+double String::toDouble() const {
+  return buffer ? atof(buffer) : 0;
+}
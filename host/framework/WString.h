@@ -0,0 +1,110 @@
+/*
+ * WString.h
+ *
+ * Host Stand-in for the Arduino String Class
+ * Same interface and growth behaviour as the core's WString (a malloc'd
+ * buffer grown with realloc), so code that builds Strings allocates on
+ * the host much as it does on the ESP32.
+ */
+
+#ifndef HOST_WSTRING_H
+#define HOST_WSTRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class __FlashStringHelper;
+#define PSTR(s) (s)
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(PSTR(string_literal)))
+
+class String {
+public:
+  String(const char* cstr = "");
+  String(const char* cstr, unsigned int length);
+  String(const String& str);
+  String(String&& rval);
+  String(const __FlashStringHelper* str);
+  explicit String(char c);
+  explicit String(unsigned char value, unsigned char base = 10);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value, unsigned char base = 10);
+  explicit String(unsigned long long value, unsigned char base = 10);
+  explicit String(float value, unsigned int decimalPlaces = 2);
+  explicit String(double value, unsigned int decimalPlaces = 2);
+  ~String();
+
+  bool reserve(unsigned int size);
+  unsigned int length() const { return len; }
+  bool isEmpty() const { return len == 0; }
+  const char* c_str() const { return buffer ? buffer : ""; }
+
+  String& operator=(const String& rhs);
+  String& operator=(String&& rval);
+  String& operator=(const char* cstr);
+  String& operator=(const __FlashStringHelper* str);
+
+  bool concat(const String& str);
+  bool concat(const char* cstr);
+  bool concat(const char* cstr, unsigned int length);
+  bool concat(const __FlashStringHelper* str);
+  bool concat(char c);
+  bool concat(unsigned char num);
+  bool concat(int num);
+  bool concat(unsigned int num);
+  bool concat(long num);
+  bool concat(unsigned long num);
+  bool concat(long long num);
+  bool concat(unsigned long long num);
+  bool concat(float num);
+  bool concat(double num);
+
+  template<typename T> String& operator+=(const T& rhs) {
+    concat(rhs);
+    return *this;
+  }
+
+  bool equals(const String& s) const;
+  bool equals(const char* cstr) const;
+  bool equalsIgnoreCase(const String& s) const;
+  bool operator==(const String& rhs) const { return equals(rhs); }
+  bool operator==(const char* cstr) const { return equals(cstr); }
+  bool operator!=(const String& rhs) const { return !equals(rhs); }
+  bool operator!=(const char* cstr) const { return !equals(cstr); }
+  bool startsWith(const String& prefix) const;
+  bool endsWith(const String& suffix) const;
+
+  char charAt(unsigned int index) const;
+  char operator[](unsigned int index) const { return charAt(index); }
+  char& operator[](unsigned int index);
+  int indexOf(char ch, unsigned int fromIndex = 0) const;
+  int indexOf(const char* str, unsigned int fromIndex = 0) const;
+  String substring(unsigned int beginIndex) const { return substring(beginIndex, len); }
+  String substring(unsigned int beginIndex, unsigned int endIndex) const;
+
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+  long toInt() const;
+  float toFloat() const;
+  double toDouble() const;
+
+private:
+  char* buffer;
+  unsigned int capacity;
+  unsigned int len;
+
+  void init();
+  void invalidate();
+  bool changeBuffer(unsigned int maxStrLen);
+  String& copy(const char* cstr, unsigned int length);
+  void move(String& rhs);
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+
+#endif // HOST_WSTRING_H
@@ -0,0 +1,180 @@
+/*
+ * WebServer.cpp
+ *
+ * Host Stand-in for the ESP32 WebServer - see WebServer.h
+ */
+
+#include "WebServer.h"
+
+WebServer::WebServer(int port)
+  : requestMethod(HTTP_ANY), responseCode(0), contentLength(CONTENT_LENGTH_NOT_SET) {
+  (void)port;
+}
+
+void WebServer::begin() {
+}
+
+void WebServer::begin(uint16_t port) {
+  (void)port;
+}
+
+void WebServer::handleClient() {
+}
+
+void WebServer::close() {
+}
+
+void WebServer::stop() {
+}
+
+void WebServer::on(const String& uri, THandlerFunction handler) {
+  on(uri, HTTP_ANY, handler);
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+  routes.push_back({ std::string(uri.c_str()), method, handler });
+}
+
+void WebServer::onNotFound(THandlerFunction handler) {
+  notFound = handler;
+}
+
+String WebServer::arg(const String& name) {
+  for (const Arg& a : requestArgs) {
+    if (a.name == name) return a.value;
+  }
+  return String();
+}
+
+String WebServer::arg(int i) {
+  return i >= 0 && i < (int)requestArgs.size() ? requestArgs[i].value : String();
+}
+
+String WebServer::argName(int i) {
+  return i >= 0 && i < (int)requestArgs.size() ? requestArgs[i].name : String();
+}
+
+int WebServer::args() {
+  return requestArgs.size();
+}
+
+bool WebServer::hasArg(const String& name) {
+  for (const Arg& a : requestArgs) {
+    if (a.name == name) return true;
+  }
+  return false;
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+  responseCode = code;
+  responseType = contentType ? contentType : "text/html";
+  responseHeaders.insert(responseHeaders.end(), pendingHeaders.begin(), pendingHeaders.end());
+  pendingHeaders.clear();
+  responseBody += content;
+}
+
+void WebServer::send(int code, const char* contentType, const char* content) {
+  send(code, contentType, String(content));
+}
+
+void WebServer::send(int code, const String& contentType, const String& content) {
+  send(code, contentType.c_str(), content);
+}
+
+void WebServer::send_P(int code, const char* contentType, const char* content) {
+  send(code, contentType, String(content));
+}
+
+void WebServer::send_P(int code, const char* contentType, const char* content, size_t length) {
+  String body;
+  body.concat(content, length);
+  send(code, contentType, body);
+}
+
+void WebServer::setContentLength(size_t length) {
+  contentLength = length;
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+  if (first) pendingHeaders.insert(pendingHeaders.begin(), { name, value });
+  else pendingHeaders.push_back({ name, value });
+}
+
+// An empty chunk only ends a chunked response
+void WebServer::sendContent(const String& content) {
+  responseBody += content;
+}
+
+void WebServer::sendContent(const char* content, size_t length) {
+  responseBody.concat(content, length);
+}
+
+void WebServer::sendContent_P(const char* content) {
+  responseBody += content;
+}
+
+String WebServer::hostHeader(const char* name) const {
+  for (const Arg& h : responseHeaders) {
+    if (h.name.equalsIgnoreCase(name)) return h.value;
+  }
+  return String();
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static String urlDecode(const char* s, size_t length) {
+  String out;
+  for (size_t i = 0; i < length; i++) {
+    if (s[i] == '+') {
+      out += ' ';
+    } else if (s[i] == '%' && i + 2 < length && hexValue(s[i + 1]) >= 0 && hexValue(s[i + 2]) >= 0) {
+      out += (char)(hexValue(s[i + 1]) * 16 + hexValue(s[i + 2]));
+      i += 2;
+    } else {
+      out += s[i];
+    }
+  }
+  return out;
+}
+
+int WebServer::hostRequest(HTTPMethod method, const char* uri, const char* query) {
+  requestUri = uri;
+  requestMethod = method;
+  requestArgs.clear();
+  responseCode = 0;
+  responseType = "";
+  responseBody = "";
+  responseHeaders.clear();
+  pendingHeaders.clear();
+  contentLength = CONTENT_LENGTH_NOT_SET;
+
+  const char* p = query ? query : "";
+  while (*p) {
+    const char* end = strchr(p, '&');
+    if (!end) end = p + strlen(p);
+    const char* eq = (const char*)memchr(p, '=', end - p);
+    if (end > p) {
+      if (eq) requestArgs.push_back({ urlDecode(p, eq - p), urlDecode(eq + 1, end - eq - 1) });
+      else requestArgs.push_back({ urlDecode(p, end - p), String() });
+    }
+    p = *end ? end + 1 : end;
+  }
+
+  for (const Route& route : routes) {
+    if (route.uri == requestUri && (route.method == HTTP_ANY || route.method == method)) {
+      route.handler();
+      return responseCode;
+    }
+  }
+  if (notFound) {
+    notFound();
+    return responseCode;
+  }
+  send(404, "text/plain", String("Not found: ") + uri);
+  return responseCode;
+}
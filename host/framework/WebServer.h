@@ -0,0 +1,106 @@
+/*
+ * WebServer.h
+ *
+ * Host Stand-in for the ESP32 WebServer
+ * There is no HTTP listener; handlers are registered as on the device and
+ * a test calls hostRequest() to run one. Everything the handler sends -
+ * status, content type, headers, body and chunked content - is captured
+ * for the test to read back.
+ */
+
+#ifndef HOST_WEBSERVER_H
+#define HOST_WEBSERVER_H
+
+#include "Arduino.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  WebServer(int port = 80);
+
+  void begin();
+  void begin(uint16_t port);
+  void handleClient();
+  void close();
+  void stop();
+
+  void on(const String& uri, THandlerFunction handler);
+  void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+  void onNotFound(THandlerFunction handler);
+
+  String uri() { return String(requestUri.c_str()); }
+  HTTPMethod method() { return requestMethod; }
+  String arg(const String& name);
+  String arg(int i);
+  String argName(int i);
+  int args();
+  bool hasArg(const String& name);
+
+  void send(int code, const char* contentType = nullptr, const String& content = String(""));
+  void send(int code, const char* contentType, const char* content);
+  void send(int code, const String& contentType, const String& content);
+  void send_P(int code, const char* contentType, const char* content);
+  void send_P(int code, const char* contentType, const char* content, size_t contentLength);
+  void setContentLength(size_t contentLength);
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void sendContent(const String& content);
+  void sendContent(const char* content, size_t contentLength);
+  void sendContent_P(const char* content);
+
+  template<typename T>
+  size_t streamFile(T& file, const String& contentType, int code = 200) {
+    uint8_t buffer[512];
+    size_t total = 0;
+    setContentLength(file.size());
+    send(code, contentType.c_str(), "");
+    size_t n;
+    while ((n = file.read(buffer, sizeof(buffer))) > 0) {
+      sendContent((const char*)buffer, n);
+      total += n;
+    }
+    return total;
+  }
+
+  // Host only - runs the handler for a request; args is a query string
+  // ("ssid=lab&port=1883"). Returns the status code (404 if nothing
+  // matched, 0 if the handler sent nothing)
+  int hostRequest(HTTPMethod method, const char* uri, const char* args = "");
+  int hostStatus() const { return responseCode; }
+  const String& hostContentType() const { return responseType; }
+  const String& hostBody() const { return responseBody; }
+  String hostHeader(const char* name) const;
+
+private:
+  struct Route {
+    std::string uri;
+    HTTPMethod method;
+    THandlerFunction handler;
+  };
+  struct Arg {
+    String name;
+    String value;
+  };
+
+  std::vector<Route> routes;
+  THandlerFunction notFound;
+  std::string requestUri;
+  HTTPMethod requestMethod;
+  std::vector<Arg> requestArgs;
+  int responseCode;
+  String responseType;
+  String responseBody;
+  std::vector<Arg> responseHeaders;
+  std::vector<Arg> pendingHeaders;
+  size_t contentLength;
+};
+
+#endif // HOST_WEBSERVER_H
@@ -0,0 +1,70 @@
+/*
+ * WiFi.cpp
+ *
+ * Host Stand-in for the ESP32 WiFi Library
+ */
+
+#include "WiFi.h"
+#include <netdb.h>
+#include <arpa/inet.h>
+
+WiFiClass WiFi;
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  (void)mode;
+  return true;
+}
+
+bool WiFiClass::setHostname(const char* hostname) {
+  (void)hostname;
+  return true;
+}
+
+wl_status_t WiFiClass::begin(const char* ssidName, const char* passphrase) {
+  (void)passphrase;
+  if (ssidName && *ssidName) strlcpy(ssid, ssidName, sizeof(ssid));
+  return WL_CONNECTED;
+}
+
+wl_status_t WiFiClass::status() {
+  return WL_CONNECTED;
+}
+
+bool WiFiClass::softAP(const char* ssidName, const char* passphrase) {
+  (void)ssidName;
+  (void)passphrase;
+  return true;
+}
+
+bool WiFiClass::disconnect(bool wifioff) {
+  (void)wifioff;
+  return true;
+}
+
+IPAddress WiFiClass::localIP() {
+  return IPAddress(127, 0, 0, 1);
+}
+
+IPAddress WiFiClass::softAPIP() {
+  return IPAddress(192, 168, 4, 1);
+}
+
+String WiFiClass::SSID() {
+  return String(ssid);
+}
+
+int8_t WiFiClass::RSSI() {
+  return -50;
+}
+
+int WiFiClass::hostByName(const char* hostname, IPAddress& result) {
+  struct addrinfo hints;
+  struct addrinfo* res = nullptr;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(hostname, nullptr, &hints, &res) != 0 || res == nullptr) return 0;
+  result = IPAddress((uint32_t)((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr);
+  freeaddrinfo(res);
+  return 1;
+}
@@ -0,0 +1,54 @@
+/*
+ * WiFi.h
+ *
+ * Host Stand-in for the ESP32 WiFi Library
+ * The host is always on its network: status() is WL_CONNECTED from the
+ * start and localIP() is the loopback address. hostByName() uses the
+ * host's resolver.
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+} wifi_mode_t;
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t mode);
+  bool setHostname(const char* hostname);
+  wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+  wl_status_t status();
+  bool softAP(const char* ssid, const char* passphrase = nullptr);
+  bool disconnect(bool wifioff = false);
+  IPAddress localIP();
+  IPAddress softAPIP();
+  String SSID();
+  int8_t RSSI();
+  int hostByName(const char* hostname, IPAddress& result);
+
+private:
+  char ssid[33] = "host";
+};
+
+extern WiFiClass WiFi;
+
+#endif // HOST_WIFI_H
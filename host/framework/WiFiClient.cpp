@@ -0,0 +1,172 @@
+/*
+ * WiFiClient.cpp
+ *
+ * Host Stand-in for the ESP32 WiFiClient
+ */
+
+#include "WiFiClient.h"
+#include "WiFi.h"
+#include <lwip/sockets.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+
+#define WIFI_CLIENT_DEF_CONN_TIMEOUT_MS 3000
+
+class WiFiClientSocketHandle {
+public:
+  explicit WiFiClientSocketHandle(int fd) : sockfd(fd) {}
+  ~WiFiClientSocketHandle() { close(sockfd); }
+  int fd() const { return sockfd; }
+
+private:
+  int sockfd;
+};
+
+WiFiClient::WiFiClient() : _connected(false) {
+}
+
+WiFiClient::WiFiClient(int fd) : _connected(true) {
+  clientSocketHandle.reset(new WiFiClientSocketHandle(fd));
+}
+
+WiFiClient::~WiFiClient() {
+}
+
+void WiFiClient::stop() {
+  clientSocketHandle = nullptr;
+  _connected = false;
+}
+
+int WiFiClient::fd() const {
+  return clientSocketHandle ? clientSocketHandle->fd() : -1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip, port, WIFI_CLIENT_DEF_CONN_TIMEOUT_MS);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeout) {
+  stop();
+  int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  if (sockfd < 0) return 0;
+  fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL, 0) | O_NONBLOCK);
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = (uint32_t)ip;
+  addr.sin_port = htons(port);
+
+  int res = ::connect(sockfd, (struct sockaddr*)&addr, sizeof(addr));
+  if (res < 0 && errno != EINPROGRESS) {
+    close(sockfd);
+    return 0;
+  }
+  struct pollfd pfd = { sockfd, POLLOUT, 0 };
+  if (res < 0 && poll(&pfd, 1, timeout < 0 ? WIFI_CLIENT_DEF_CONN_TIMEOUT_MS : timeout) <= 0) {
+    close(sockfd);
+    return 0;
+  }
+  int error = 0;
+  socklen_t len = sizeof(error);
+  if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0) {
+    close(sockfd);
+    return 0;
+  }
+  fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL, 0) & ~O_NONBLOCK);
+  clientSocketHandle.reset(new WiFiClientSocketHandle(sockfd));
+  _connected = true;
+  return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  return connect(host, port, WIFI_CLIENT_DEF_CONN_TIMEOUT_MS);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeout) {
+  IPAddress srv;
+  if (!WiFi.hostByName(host, srv)) return 0;
+  return connect(srv, port, timeout);
+}
+
+int WiFiClient::setNoDelay(bool nodelay) {
+  int flag = nodelay;
+  return setsockopt(fd(), IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+size_t WiFiClient::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  if (!_connected || fd() < 0) return 0;
+  size_t total = 0;
+  while (total < size) {
+    ssize_t res = send(fd(), buf + total, size - total, MSG_NOSIGNAL);
+    if (res > 0) {
+      total += res;
+    } else if (res < 0 && errno == EINTR) {
+      continue;
+    } else {
+      _connected = false;  // Send timeout (SO_SNDTIMEO) or error
+      break;
+    }
+  }
+  return total;
+}
+
+int WiFiClient::available() {
+  if (!_connected || fd() < 0) return 0;
+  int count = 0;
+  if (ioctl(fd(), FIONREAD, &count) < 0) {
+    _connected = false;
+    return 0;
+  }
+  return count;
+}
+
+int WiFiClient::read() {
+  uint8_t data = 0;
+  return read(&data, 1) == 1 ? data : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+  if (!_connected || fd() < 0) return -1;
+  ssize_t res = recv(fd(), buf, size, MSG_DONTWAIT);
+  if (res > 0) return res;
+  if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+  _connected = false;  // Peer closed or error
+  return -1;
+}
+
+int WiFiClient::peek() {
+  if (!_connected || fd() < 0) return -1;
+  uint8_t data = 0;
+  return recv(fd(), &data, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? data : -1;
+}
+
+void WiFiClient::flush() {
+  uint8_t discard[256];
+  while (available() > 0 && read(discard, sizeof(discard)) > 0) {
+  }
+}
+
+uint8_t WiFiClient::connected() {
+  if (_connected && fd() >= 0) {
+    uint8_t dummy;
+    ssize_t res = recv(fd(), &dummy, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (res == 0) {
+      _connected = false;  // Orderly shutdown and nothing left to read
+    } else if (res < 0) {
+      switch (errno) {
+        case EWOULDBLOCK:
+        case EINTR:
+          break;
+        default:
+          _connected = false;
+          break;
+      }
+    }
+  }
+  return _connected;
+}
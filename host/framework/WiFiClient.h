@@ -0,0 +1,50 @@
+/*
+ * WiFiClient.h
+ *
+ * Host Stand-in for the ESP32 WiFiClient
+ * A TCP client on a host socket. Like the core's, copies share the
+ * socket (closed when the last copy lets go), reads never block and
+ * flush() discards unread input.
+ */
+
+#ifndef HOST_WIFICLIENT_H
+#define HOST_WIFICLIENT_H
+
+#include "Arduino.h"
+#include "Client.h"
+#include <memory>
+
+class WiFiClientSocketHandle;
+
+class WiFiClient : public Client {
+public:
+  WiFiClient();
+  WiFiClient(int fd);
+  ~WiFiClient();
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(IPAddress ip, uint16_t port, int32_t timeout);
+  int connect(const char* host, uint16_t port) override;
+  int connect(const char* host, uint16_t port, int32_t timeout);
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override;
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+
+  int fd() const;
+  int setNoDelay(bool nodelay);
+  void setTimeout(uint32_t seconds) { _timeout = seconds * 1000; }
+
+private:
+  std::shared_ptr<WiFiClientSocketHandle> clientSocketHandle;
+  bool _connected;
+};
+
+#endif // HOST_WIFICLIENT_H
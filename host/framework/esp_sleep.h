@@ -0,0 +1,20 @@
+/*
+ * esp_sleep.h
+ *
+ * Host Stand-in for ESP-IDF Light Sleep
+ * esp_light_sleep_start() just waits out the timer wakeup.
+ */
+
+#ifndef HOST_ESP_SLEEP_H
+#define HOST_ESP_SLEEP_H
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+esp_err_t esp_sleep_enable_gpio_wakeup();
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+esp_err_t esp_light_sleep_start();
+
+#endif // HOST_ESP_SLEEP_H
@@ -0,0 +1,131 @@
+/*
+ * freertos.cpp
+ *
+ * Host Stand-in for the ESP-IDF FreeRTOS Port and Light Sleep
+ */
+
+#include "Arduino.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+struct HostTask {
+  TaskFunction_t code;
+  void* parameters;
+  uint32_t stackDepth;
+  char name[16];
+};
+
+struct HostSemaphore {
+  std::timed_mutex mutex;
+};
+
+static thread_local HostTask* currentTask = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                                   void* parameters, UBaseType_t priority,
+                                   TaskHandle_t* createdTask, BaseType_t coreId) {
+  (void)priority;
+  (void)coreId;
+  HostTask* task = new HostTask;
+  task->code = code;
+  task->parameters = parameters;
+  task->stackDepth = stackDepth;
+  strlcpy(task->name, name ? name : "", sizeof(task->name));
+  if (createdTask) *createdTask = task;
+  // Tasks never return; the process ends with them still running
+  std::thread([task]() {
+    currentTask = task;
+    task->code(task->parameters);
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth,
+                       void* parameters, UBaseType_t priority, TaskHandle_t* createdTask) {
+  return xTaskCreatePinnedToCore(code, name, stackDepth, parameters, priority, createdTask,
+                                 tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // Only a task deleting itself is supported: park its thread for good
+  if (task == nullptr || task == currentTask) {
+    for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+  }
+}
+
+void vTaskDelay(TickType_t ticks) {
+  if (ticks == 0) {
+    std::this_thread::yield();
+    return;
+  }
+  delay(ticks * portTICK_PERIOD_MS);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)(millis() / portTICK_PERIOD_MS);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  // Host threads have megabytes of stack; report the untouched size
+  HostTask* t = task ? task : currentTask;
+  return t ? t->stackDepth : 0;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return currentTask;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new HostSemaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  if (semaphore == nullptr) return pdFALSE;
+  if (ticksToWait == portMAX_DELAY) {
+    semaphore->mutex.lock();
+    return pdTRUE;
+  }
+  return semaphore->mutex.try_lock_for(std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS))
+         ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  if (semaphore == nullptr) return pdFALSE;
+  semaphore->mutex.unlock();
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+// Light sleep - no GPIO can wake the host, so sleep runs to the timer
+static uint64_t sleepTimerUs = 0;
+
+esp_err_t gpio_wakeup_enable(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+  (void)gpio_num;
+  (void)intr_type;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t gpio_num) {
+  (void)gpio_num;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+  sleepTimerUs = time_in_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+  delay(sleepTimerUs / 1000);
+  return ESP_OK;
+}
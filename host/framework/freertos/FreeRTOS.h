@@ -0,0 +1,43 @@
+/*
+ * freertos/FreeRTOS.h
+ *
+ * Host Stand-in for the ESP-IDF FreeRTOS Port
+ * Tasks run on std::thread and a tick is one millisecond, as with the
+ * Arduino core's configTICK_RATE_HZ of 1000. portMUX critical sections
+ * are recursive mutexes - they exclude the other task the way the ESP32
+ * spinlock excludes the other core.
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <mutex>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  0
+#define pdPASS  1
+
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY       ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define tskNO_AFFINITY      0x7FFFFFFF
+
+struct portMUX_TYPE {
+  std::recursive_mutex lock;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->lock.lock()
+#define portEXIT_CRITICAL(mux)  (mux)->lock.unlock()
+#define portENTER_CRITICAL_ISR(mux) portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)  portEXIT_CRITICAL(mux)
+
+#endif // HOST_FREERTOS_H
@@ -0,0 +1,87 @@
+/*
+ * host_heap.cpp
+ *
+ * Heap Counters (see host_runtime.h)
+ * Defines the malloc family in front of glibc's allocator. The
+ * executable's definitions win over libc's for every caller, including
+ * libstdc++'s operator new.
+ */
+
+#include "host_runtime.h"
+#include <atomic>
+#include <stdlib.h>
+#include <unistd.h>
+#include <malloc.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void __libc_free(void* ptr);
+}
+
+static std::atomic<uint64_t> allocations(0);
+static std::atomic<uint64_t> frees(0);
+static std::atomic<uint64_t> bytes(0);
+static std::atomic<uint64_t> liveBytes(0);
+
+static void countAllocation(void* ptr, size_t size) {
+  if (!ptr) return;
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(size, std::memory_order_relaxed);
+  liveBytes.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed);
+}
+
+static void countFree(void* ptr) {
+  if (!ptr) return;
+  frees.fetch_add(1, std::memory_order_relaxed);
+  liveBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+}
+
+extern "C" {
+
+void* malloc(size_t size) {
+  void* ptr = __libc_malloc(size);
+  countAllocation(ptr, size);
+  return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+  void* ptr = __libc_calloc(count, size);
+  countAllocation(ptr, count * size);
+  return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+  size_t old = ptr ? malloc_usable_size(ptr) : 0;
+  void* result = __libc_realloc(ptr, size);
+  if (!result) return result;
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  bytes.fetch_add(size, std::memory_order_relaxed);
+  liveBytes.fetch_add(malloc_usable_size(result), std::memory_order_relaxed);
+  liveBytes.fetch_sub(old, std::memory_order_relaxed);
+  if (ptr) frees.fetch_add(1, std::memory_order_relaxed);
+  return result;
+}
+
+void free(void* ptr) {
+  countFree(ptr);
+  __libc_free(ptr);
+}
+
+}
+
+HostHeapStats hostHeapStats() {
+  HostHeapStats stats;
+  stats.allocations = allocations.load(std::memory_order_relaxed);
+  stats.frees = frees.load(std::memory_order_relaxed);
+  stats.bytes = bytes.load(std::memory_order_relaxed);
+  stats.liveBytes = liveBytes.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void hostExit(int code) {
+  fflush(stdout);
+  fflush(stderr);
+  _exit(code);
+}
@@ -0,0 +1,53 @@
+/*
+ * host_runtime.h
+ *
+ * Host Runtime Controls
+ * Not part of the Arduino API - tests and benchmarks use these to drive
+ * the stand-ins.
+ *
+ * Clock: millis()/micros() start at one second, as if setup() ran a
+ * second after boot. By default they follow the host's monotonic clock.
+ * With the virtual clock they only move when something waits - delay(),
+ * delayMicroseconds(), vTaskDelay() - or when a test calls
+ * hostAdvanceMicros(), so a simulator run is repeatable and takes no
+ * real time. The virtual clock is meant for single-threaded runs that
+ * call processNFCReader() themselves; tasks running on threads should
+ * keep the real clock.
+ */
+
+#ifndef HOST_RUNTIME_H
+#define HOST_RUNTIME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+void hostUseVirtualClock(bool enabled);
+bool hostVirtualClock();
+void hostAdvanceMicros(uint64_t us);  // Virtual clock only
+
+// Serial output goes to stdout unless echo is off; the last
+// HOST_SERIAL_CAPTURE bytes are kept either way for tests to inspect
+#define HOST_SERIAL_CAPTURE 16384
+void hostSerialEcho(bool enabled);
+size_t hostSerialCaptured(char* buffer, size_t size);  // NUL-terminated copy
+void hostSerialClear();
+
+// Root directory LittleFS files live under (created by LittleFS.begin())
+void hostSetFilesystemRoot(const char* path);
+
+// Heap counters - malloc/calloc/realloc/free (and so new/delete and
+// String) are counted, so a test can see whether a code path allocates.
+// glibc only: the counters sit in front of glibc's own allocator.
+struct HostHeapStats {
+  uint64_t allocations;  // malloc, calloc and realloc calls that got memory
+  uint64_t frees;
+  uint64_t bytes;        // Total requested
+  uint64_t liveBytes;    // Currently allocated (usable size)
+};
+HostHeapStats hostHeapStats();
+
+// Flushes stdout and ends the process without running static
+// destructors, which a scan task still running on its thread would race
+[[noreturn]] void hostExit(int code);
+
+#endif // HOST_RUNTIME_H
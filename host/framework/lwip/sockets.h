@@ -0,0 +1,21 @@
+/*
+ * lwip/sockets.h
+ *
+ * Host Stand-in for lwIP's BSD Socket API - the POSIX calls it mirrors
+ */
+
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#endif // HOST_LWIP_SOCKETS_H
@@ -0,0 +1,43 @@
+/*
+ * reader_host.cpp
+ *
+ * Host Runner for the Sketch
+ * Builds MQTTTagReaderDisplay_ESP32.ino as it is and drives it the way
+ * the ESP32 core does: setup() once, then loop() for ever (or for
+ * --seconds N). The NFC scan task runs on its own thread against the
+ * simulator; the web server answers no HTTP, MQTT goes to the broker in
+ * the saved configuration.
+ *
+ *   reader_host [--seconds N] [--fs DIR]
+ *
+ * --fs sets the directory LittleFS files (queue, scan trace) live in.
+ */
+
+#include <Arduino.h>
+#include "../src/MQTTTagReaderDisplay_ESP32.ino"
+
+int main(int argc, char** argv) {
+  unsigned long seconds = 0;  // 0 = until killed
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      seconds = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--fs") == 0 && i + 1 < argc) {
+      hostSetFilesystemRoot(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: %s [--seconds N] [--fs DIR]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  setup();
+
+  // The core calls loop() back to back; the 1 ms pause only stops the
+  // host runner spinning a CPU
+  unsigned long start = millis();
+  while (seconds == 0 || millis() - start < seconds * 1000UL) {
+    loop();
+    delay(1);
+  }
+
+  hostExit(0);
+}
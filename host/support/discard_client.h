@@ -0,0 +1,32 @@
+/*
+ * discard_client.h
+ *
+ * Client That Discards Writes
+ * Swapped into a PubSubClient that is already connected (setClient), it
+ * takes every write and never has anything to read, so a benchmark can
+ * time or count the publish path without a loopback socket, and the
+ * broker thread on the other end of it, in the figures.
+ */
+
+#ifndef DISCARD_CLIENT_H
+#define DISCARD_CLIENT_H
+
+#include <Client.h>
+
+class DiscardClient : public Client {
+public:
+  int connect(IPAddress ip, uint16_t port) override { return 1; }
+  int connect(const char* host, uint16_t port) override { return 1; }
+  size_t write(uint8_t) override { return 1; }
+  size_t write(const uint8_t* buf, size_t size) override { return size; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int read(uint8_t* buf, size_t size) override { return -1; }
+  int peek() override { return -1; }
+  void flush() override {}
+  void stop() override {}
+  uint8_t connected() override { return 1; }
+  operator bool() override { return true; }
+};
+
+#endif
@@ -0,0 +1,338 @@
+/*
+ * mqtt_test_broker.cpp
+ *
+ * Loopback MQTT Broker Implementation
+ * One client at a time - a new connection replaces the old one, as a
+ * broker does for a reconnecting client ID.
+ */
+
+#include "mqtt_test_broker.h"
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define RX_BUFFER_SIZE 16384
+
+static uint64_t realMicrosNow() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+MqttTestBroker::MqttTestBroker()
+  : mode(BROKER_NORMAL), listenFd(-1), listenPort(0), clientFd(-1), running(false),
+    ackDelay(0), acks(true), connectCount(0), publishCount(0), dupCount(0),
+    records(nullptr), recordCount(0), rxBuffer(nullptr), rxLength(0),
+    pendingHead(0), pendingCount(0) {
+  for (int i = 0; i < 4; i++) fillers[i] = -1;
+}
+
+MqttTestBroker::~MqttTestBroker() {
+  stop();
+  delete[] records;
+  delete[] rxBuffer;
+}
+
+bool MqttTestBroker::start(MqttTestBrokerMode brokerMode) {
+  stop();
+  mode = brokerMode;
+  if (!records) records = new MqttTestMessage[MQTT_TEST_RECORDS];
+  if (!rxBuffer) rxBuffer = new uint8_t[RX_BUFFER_SIZE];
+  recordCount = 0;
+  rxLength = 0;
+  pendingHead = 0;
+  pendingCount = 0;
+  connectCount = 0;
+  publishCount = 0;
+  dupCount = 0;
+
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd < 0) return false;
+  int one = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t len = sizeof(addr);
+  if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+      getsockname(listenFd, (struct sockaddr*)&addr, &len) < 0) {
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+  listenPort = ntohs(addr.sin_port);
+
+  if (mode == BROKER_REFUSE) {
+    // Port was free a moment ago and nothing listens on it now
+    close(listenFd);
+    listenFd = -1;
+    return true;
+  }
+
+  if (listen(listenFd, mode == BROKER_BLACKHOLE ? 0 : 4) < 0) {
+    close(listenFd);
+    listenFd = -1;
+    return false;
+  }
+
+  if (mode == BROKER_BLACKHOLE) {
+    // Nothing is ever accepted; once these fill the queue the kernel
+    // drops further SYNs, so a connect just hangs
+    for (int i = 0; i < 4; i++) {
+      fillers[i] = socket(AF_INET, SOCK_STREAM, 0);
+      fcntl(fillers[i], F_SETFL, fcntl(fillers[i], F_GETFL, 0) | O_NONBLOCK);
+      connect(fillers[i], (struct sockaddr*)&addr, sizeof(addr));
+    }
+    usleep(50000);  // Let the handshakes that can complete do so
+    return true;
+  }
+
+  running = true;
+  thread = std::thread(&MqttTestBroker::run, this);
+  return true;
+}
+
+void MqttTestBroker::stop() {
+  running = false;
+  if (thread.joinable()) thread.join();
+  closeClient();
+  for (int i = 0; i < 4; i++) {
+    if (fillers[i] >= 0) close(fillers[i]);
+    fillers[i] = -1;
+  }
+  if (listenFd >= 0) close(listenFd);
+  listenFd = -1;
+}
+
+void MqttTestBroker::closeClient() {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  int fd = clientFd.exchange(-1);
+  if (fd >= 0) close(fd);
+  rxLength = 0;
+  pendingCount = 0;
+}
+
+void MqttTestBroker::dropClient() {
+  int fd = clientFd.load();
+  if (fd >= 0) shutdown(fd, SHUT_RDWR);  // The broker thread sees EOF and closes it
+}
+
+bool MqttTestBroker::sendPacket(const uint8_t* data, size_t length) {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  int fd = clientFd.load();
+  if (fd < 0) return false;
+  while (length > 0) {
+    ssize_t n = send(fd, data, length, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    data += n;
+    length -= n;
+  }
+  return true;
+}
+
+bool MqttTestBroker::publish(const char* topic, const uint8_t* payload, size_t length) {
+  uint8_t packet[5 + 2 + MQTT_TEST_TOPIC_MAX + MQTT_TEST_PAYLOAD_MAX];
+  size_t topicLength = strlen(topic);
+  if (topicLength >= MQTT_TEST_TOPIC_MAX || length > MQTT_TEST_PAYLOAD_MAX) return false;
+
+  size_t remaining = 2 + topicLength + length;
+  size_t pos = 0;
+  packet[pos++] = 0x30;
+  do {
+    uint8_t digit = remaining & 0x7F;
+    remaining >>= 7;
+    packet[pos++] = digit | (remaining ? 0x80 : 0);
+  } while (remaining);
+  packet[pos++] = topicLength >> 8;
+  packet[pos++] = topicLength & 0xFF;
+  memcpy(packet + pos, topic, topicLength);
+  pos += topicLength;
+  memcpy(packet + pos, payload, length);
+  return sendPacket(packet, pos + length);
+}
+
+size_t MqttTestBroker::messageCount() {
+  std::lock_guard<std::mutex> lock(recordMutex);
+  return recordCount;
+}
+
+bool MqttTestBroker::message(size_t index, MqttTestMessage* out) {
+  std::lock_guard<std::mutex> lock(recordMutex);
+  if (index >= recordCount) return false;
+  *out = records[index];
+  return true;
+}
+
+void MqttTestBroker::clearMessages() {
+  std::lock_guard<std::mutex> lock(recordMutex);
+  recordCount = 0;
+}
+
+bool MqttTestBroker::waitForPublishes(uint32_t count, uint32_t timeoutMs) {
+  uint64_t end = realMicrosNow() + (uint64_t)timeoutMs * 1000;
+  while (publishCount.load() < count) {
+    if (realMicrosNow() >= end) return false;
+    usleep(200);
+  }
+  return true;
+}
+
+void MqttTestBroker::run() {
+  while (running) {
+    struct pollfd fds[2];
+    int count = 0;
+    fds[count++] = { listenFd, POLLIN, 0 };
+    int fd = clientFd.load();
+    if (fd >= 0) fds[count++] = { fd, POLLIN, 0 };
+
+    // Wake up for the next PUBACK that comes due
+    int timeout = 1;
+    if (pendingCount == 0) timeout = 5;
+    poll(fds, count, timeout);
+
+    if (fds[0].revents & POLLIN) {
+      int accepted = accept(listenFd, nullptr, nullptr);
+      if (accepted >= 0) {
+        int one = 1;
+        setsockopt(accepted, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        closeClient();
+        clientFd = accepted;
+      }
+    }
+    if (count > 1 && (fds[1].revents & (POLLIN | POLLHUP | POLLERR))) receive();
+    sendAcks();
+  }
+}
+
+void MqttTestBroker::receive() {
+  int fd = clientFd.load();
+  if (fd < 0) return;
+  ssize_t n = recv(fd, rxBuffer + rxLength, RX_BUFFER_SIZE - rxLength, MSG_DONTWAIT);
+  if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+    closeClient();
+    return;
+  }
+  if (n < 0) return;
+  rxLength += n;
+
+  size_t used = 0;
+  while (used < rxLength) {
+    size_t packet = handlePacket(rxBuffer + used, rxLength - used);
+    if (packet == 0) break;
+    used += packet;
+  }
+  if (clientFd.load() < 0) return;  // DISCONNECT
+  memmove(rxBuffer, rxBuffer + used, rxLength - used);
+  rxLength -= used;
+  if (rxLength == RX_BUFFER_SIZE) closeClient();  // Nothing the reader sends is this big
+}
+
+// One complete packet at data, or 0 if more bytes are needed
+size_t MqttTestBroker::handlePacket(const uint8_t* data, size_t length) {
+  if (length < 2) return 0;
+  size_t remaining = 0;
+  size_t pos = 1;
+  int shift = 0;
+  while (true) {
+    if (pos >= length) return 0;
+    uint8_t digit = data[pos++];
+    remaining |= (size_t)(digit & 0x7F) << shift;
+    shift += 7;
+    if (!(digit & 0x80)) break;
+    if (shift > 21) {
+      closeClient();
+      return 0;
+    }
+  }
+  if (length - pos < remaining) return 0;
+
+  uint8_t header = data[0];
+  const uint8_t* body = data + pos;
+  switch (header & 0xF0) {
+    case 0x10: {  // CONNECT
+      connectCount++;
+      if (mode == BROKER_SILENT) break;
+      static const uint8_t connack[] = { 0x20, 0x02, 0x00, 0x00 };
+      sendPacket(connack, sizeof(connack));
+      break;
+    }
+    case 0x30:    // PUBLISH
+      handlePublish(header, body, remaining);
+      break;
+    case 0x80: {  // SUBSCRIBE
+      if (remaining < 2) break;
+      uint8_t suback[] = { 0x90, 0x03, body[0], body[1], 0x00 };
+      sendPacket(suback, sizeof(suback));
+      break;
+    }
+    case 0xC0: {  // PINGREQ
+      static const uint8_t pingresp[] = { 0xD0, 0x00 };
+      sendPacket(pingresp, sizeof(pingresp));
+      break;
+    }
+    case 0xE0:    // DISCONNECT
+      closeClient();
+      return 0;
+  }
+  return pos + remaining;
+}
+
+void MqttTestBroker::handlePublish(uint8_t header, const uint8_t* body, size_t length) {
+  if (length < 2) return;
+  uint8_t qos = (header >> 1) & 0x03;
+  bool dup = header & 0x08;
+  size_t topicLength = ((size_t)body[0] << 8) | body[1];
+  size_t pos = 2 + topicLength;
+  uint16_t packetId = 0;
+  if (qos > 0) {
+    if (pos + 2 > length) return;
+    packetId = ((uint16_t)body[pos] << 8) | body[pos + 1];
+    pos += 2;
+  }
+  if (pos > length) return;
+
+  {
+    std::lock_guard<std::mutex> lock(recordMutex);
+    if (recordCount < MQTT_TEST_RECORDS) {
+      MqttTestMessage& m = records[recordCount++];
+      size_t copy = topicLength < MQTT_TEST_TOPIC_MAX - 1 ? topicLength : MQTT_TEST_TOPIC_MAX - 1;
+      memcpy(m.topic, body + 2, copy);
+      m.topic[copy] = 0;
+      m.length = length - pos;
+      memcpy(m.payload, body + pos, m.length < MQTT_TEST_PAYLOAD_MAX ? m.length : MQTT_TEST_PAYLOAD_MAX);
+      m.qos = qos;
+      m.dup = dup;
+      m.packetId = packetId;
+      m.time = millis();
+    }
+  }
+  if (dup) dupCount++;
+  publishCount++;
+
+  if (qos == 1 && acks && pendingCount < MQTT_TEST_PENDING_ACKS) {
+    PendingAck& ack = pendingAcks[(pendingHead + pendingCount) % MQTT_TEST_PENDING_ACKS];
+    ack.packetId = packetId;
+    ack.due = realMicrosNow() + (uint64_t)ackDelay.load() * 1000;
+    pendingCount++;
+  }
+}
+
+// PUBACKs go out in order once due, as a broker acknowledges QoS 1
+void MqttTestBroker::sendAcks() {
+  uint64_t now = realMicrosNow();
+  while (pendingCount > 0 && pendingAcks[pendingHead].due <= now) {
+    uint16_t id = pendingAcks[pendingHead].packetId;
+    uint8_t puback[] = { 0x40, 0x02, (uint8_t)(id >> 8), (uint8_t)(id & 0xFF) };
+    pendingHead = (pendingHead + 1) % MQTT_TEST_PENDING_ACKS;
+    pendingCount--;
+    sendPacket(puback, sizeof(puback));
+  }
+}
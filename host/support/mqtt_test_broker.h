@@ -0,0 +1,118 @@
+/*
+ * mqtt_test_broker.h
+ *
+ * Loopback MQTT Broker for Host Tests and Benchmarks
+ * Listens on 127.0.0.1 (an ephemeral port) from its own thread and
+ * speaks as much MQTT 3.1.1 as the reader uses: CONNACK, SUBACK,
+ * PINGRESP, and PUBACK for QoS 1 after a set delay (or never). Every
+ * PUBLISH is counted and the first MQTT_TEST_RECORDS are kept.
+ *
+ * Storage is allocated by start(), so a running broker adds nothing to
+ * the heap counters (host_runtime.h) a benchmark is reading.
+ *
+ * The other modes stand in for brokers that are not there:
+ *   BROKER_REFUSE     nothing listens on the port (connect refused)
+ *   BROKER_BLACKHOLE  the accept queue is full, SYNs go unanswered
+ *   BROKER_SILENT     TCP is accepted but CONNECT never gets a CONNACK
+ */
+
+#ifndef MQTT_TEST_BROKER_H
+#define MQTT_TEST_BROKER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#define MQTT_TEST_RECORDS      4096  // PUBLISH packets kept for inspection
+#define MQTT_TEST_TOPIC_MAX    128
+#define MQTT_TEST_PAYLOAD_MAX  2304
+#define MQTT_TEST_PENDING_ACKS 256   // PUBACKs waiting for their delay
+
+enum MqttTestBrokerMode {
+  BROKER_NORMAL,
+  BROKER_REFUSE,
+  BROKER_BLACKHOLE,
+  BROKER_SILENT
+};
+
+struct MqttTestMessage {
+  char topic[MQTT_TEST_TOPIC_MAX];
+  uint8_t payload[MQTT_TEST_PAYLOAD_MAX];
+  uint16_t length;               // Payload bytes (truncated copies keep the real length)
+  uint8_t qos;
+  bool dup;
+  uint16_t packetId;             // QoS 1 only
+  unsigned long time;            // millis() when it arrived
+};
+
+class MqttTestBroker {
+public:
+  MqttTestBroker();
+  ~MqttTestBroker();
+
+  bool start(MqttTestBrokerMode mode = BROKER_NORMAL);
+  void stop();
+  uint16_t port() const { return listenPort; }
+
+  void setAckDelay(uint32_t ms) { ackDelay = ms; }     // Real time before each PUBACK
+  void setAcks(bool enabled) { acks = enabled; }       // false = QoS 1 goes unacknowledged
+
+  // Close the reader's connection, as a broker restart would
+  void dropClient();
+
+  // Send a QoS 0 PUBLISH to the connected client
+  bool publish(const char* topic, const uint8_t* payload, size_t length);
+
+  uint32_t connects() const { return connectCount; }   // CONNECT packets seen
+  uint32_t publishes() const { return publishCount; }  // PUBLISH packets seen
+  uint32_t duplicates() const { return dupCount; }     // ... with the DUP flag
+  bool clientConnected() const { return clientFd.load() >= 0; }
+
+  size_t messageCount();
+  bool message(size_t index, MqttTestMessage* out);
+  void clearMessages();
+
+  // Wait (real time) until at least count PUBLISH packets have arrived
+  bool waitForPublishes(uint32_t count, uint32_t timeoutMs);
+
+private:
+  struct PendingAck {
+    uint16_t packetId;
+    uint64_t due;                // Real-time µs
+  };
+
+  MqttTestBrokerMode mode;
+  int listenFd;
+  uint16_t listenPort;
+  int fillers[4];                // Connections that fill the accept queue (blackhole)
+  std::atomic<int> clientFd;
+  std::atomic<bool> running;
+  std::atomic<uint32_t> ackDelay;
+  std::atomic<bool> acks;
+  std::atomic<uint32_t> connectCount;
+  std::atomic<uint32_t> publishCount;
+  std::atomic<uint32_t> dupCount;
+  std::thread thread;
+  std::mutex writeMutex;
+  std::mutex recordMutex;
+
+  MqttTestMessage* records;
+  size_t recordCount;
+
+  uint8_t* rxBuffer;
+  size_t rxLength;
+  PendingAck pendingAcks[MQTT_TEST_PENDING_ACKS];
+  size_t pendingHead;
+  size_t pendingCount;
+
+  void run();
+  void closeClient();
+  void receive();
+  size_t handlePacket(const uint8_t* data, size_t length);
+  void handlePublish(uint8_t header, const uint8_t* body, size_t length);
+  void sendAcks();
+  bool sendPacket(const uint8_t* data, size_t length);
+};
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * host_test.h
+ *
+ * Minimal Test Helpers for the Host Build
+ * CHECK() records a failure and carries on; finish() prints the result
+ * and exits through hostExit(), which a scan task still running on its
+ * thread needs.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <Arduino.h>
+#include <stdio.h>
+
+static int testFailures = 0;
+static int testChecks = 0;
+
+#define CHECK(cond)                                                      \
+  do {                                                                   \
+    testChecks++;                                                        \
+    if (!(cond)) {                                                       \
+      testFailures++;                                                    \
+      fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);    \
+    }                                                                    \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                       \
+  do {                                                                   \
+    testChecks++;                                                        \
+    long long _a = (long long)(actual);                                  \
+    long long _e = (long long)(expected);                                \
+    if (_a != _e) {                                                      \
+      testFailures++;                                                    \
+      fprintf(stderr, "FAIL %s:%d: %s == %lld, expected %lld\n",         \
+              __FILE__, __LINE__, #actual, _a, _e);                      \
+    }                                                                    \
+  } while (0)
+
+#define CHECK_STR(actual, expected)                                      \
+  do {                                                                   \
+    testChecks++;                                                        \
+    const char* _a = (actual);                                           \
+    const char* _e = (expected);                                         \
+    if (!_a || strcmp(_a, _e) != 0) {                                    \
+      testFailures++;                                                    \
+      fprintf(stderr, "FAIL %s:%d: %s == \"%s\", expected \"%s\"\n",     \
+              __FILE__, __LINE__, #actual, _a ? _a : "(null)", _e);      \
+    }                                                                    \
+  } while (0)
+
+[[noreturn]] static inline void finish(const char* name) {
+  printf("%s: %d checks, %d failed\n", name, testChecks, testFailures);
+  hostExit(testFailures == 0 ? 0 : 1);
+}
+
+#endif // HOST_TEST_H
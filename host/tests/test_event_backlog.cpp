@@ -0,0 +1,132 @@
+/*
+ * test_event_backlog.cpp
+ *
+ * Enter and Leave Survive a Subscriber That Falls Behind
+ * Tags come and go every second on the virtual clock while loop() only
+ * gets to dispatchNFCEvents() every STALL_MS (a slow reconnect or a large
+ * page), and then hands the "mqtt" subscriber its budget of 8 as the
+ * sketch does - fewer than arrive in that time. Its ring fills; present
+ * events may be lost, but every enter must still reach it followed by
+ * its leave - a lost leave is an Unread never published and a presence
+ * entry never freed. Enters and leaves held back for room must reach the
+ * subscriber that drains everything alike, in the same order and with
+ * the same times.
+ */
+
+#include "host_test.h"
+#include "nfc_reader.h"
+#include "nfc_simulator.h"
+#include <map>
+#include <vector>
+
+#define STALL_MS      3000   // loop() time between dispatches while behind
+#define RUN_MS        60000
+#define MQTT_BUDGET   8
+
+// Two pairs of tags taking turns, each pair in for 400 ms
+static const SimStep backlogScenario[] = {
+  // type      duration  uid                    uid2                   read%  err  busy  cardA
+  { SIM_TAG,   400,      0xE004010918485391ULL, 0xE0040150A1B2C3D4ULL, 100,   0,   0,    0 },
+  { SIM_EMPTY, 500,      0,                     0,                     0,     0,   0,    0 },
+  { SIM_TAG,   400,      0xE004015011223344ULL, 0xE004015055667788ULL, 100,   0,   0,    0 },
+  { SIM_EMPTY, 500,      0,                     0,                     0,     0,   0,    0 },
+};
+
+struct Received {
+  TagUID uid;
+  TagEvent event;
+  unsigned long time;
+};
+
+static std::vector<Received> allTransitions;
+static std::vector<Received> mqttTransitions;
+static uint32_t mqttPresents = 0;
+
+static void onAll(const TagEventInfo& event) {
+  if (event.event != TAG_PRESENT) allTransitions.push_back({ event.uid, event.event, event.time });
+}
+
+static void onMqtt(const TagEventInfo& event) {
+  if (event.event == TAG_PRESENT) mqttPresents++;
+  else mqttTransitions.push_back({ event.uid, event.event, event.time });
+}
+
+// Every UID alternates enter, leave, ... and ends with a leave
+static bool paired(const std::vector<Received>& events) {
+  std::map<uint64_t, bool> present;
+  for (const Received& e : events) {
+    bool& in = present[e.uid.value];
+    if (in == (e.event == TAG_ENTER)) return false;
+    in = !in;
+  }
+  for (const auto& p : present) {
+    if (p.second) return false;
+  }
+  return true;
+}
+
+int main() {
+  hostSerialEcho(false);
+  hostUseVirtualClock(true);
+
+  CHECK(initNFCReader());
+  getNFCSimulator(0)->setScenario(backlogScenario, sizeof(backlogScenario) / sizeof(backlogScenario[0]));
+  int all = subscribeTagEvents("all", onAll, 0);
+  int mqtt = subscribeTagEvents("mqtt", onMqtt, MQTT_BUDGET);
+  CHECK(all >= 0 && mqtt >= 0);
+
+  // Behind: scans keep going, dispatch only every STALL_MS
+  unsigned long start = millis();
+  unsigned long lastDispatch = start;
+  while (millis() - start < RUN_MS) {
+    processNFCReader();
+    delay(1);
+    if (millis() - lastDispatch >= STALL_MS) {
+      dispatchNFCEvents();
+      lastDispatch = millis();
+    }
+  }
+
+  SimStats sim = getNFCSimulator(0)->getStats();
+
+  // Caught up: the field empties and everything held back goes out
+  const SimStep emptyField[] = { { SIM_EMPTY, 3600000, 0, 0, 0, 0, 0, 0 } };
+  getNFCSimulator(0)->setScenario(emptyField, 1);
+  unsigned long end = millis();
+  while (millis() - end < 5000) {
+    processNFCReader();
+    dispatchNFCEvents();
+    delay(1);
+  }
+
+  TagSubscriberStatus allStatus, mqttStatus;
+  CHECK(getTagSubscriberStatus(all, &allStatus));
+  CHECK(getTagSubscriberStatus(mqtt, &mqttStatus));
+  NFCStatus status = getNFCStatus();
+  printf("%lu ms behind: %u arrivals, %u transitions, mqtt %u presents, %u dropped, "
+         "max depth %u, %u deferred\n", (unsigned long)RUN_MS, sim.arrivals,
+         (unsigned)allTransitions.size(), mqttPresents, mqttStatus.dropped, mqttStatus.maxDepth,
+         status.eventsDeferred);
+
+  // The mqtt ring filled, lost present events and held transitions back
+  CHECK_EQ(mqttStatus.maxDepth, NFC_EVENT_RING_SIZE);
+  CHECK(mqttStatus.dropped > 0);
+  CHECK_EQ(status.eventsDropped, allStatus.dropped + mqttStatus.dropped);
+  CHECK(status.eventsDeferred > 0);
+  CHECK_EQ(status.tagsPresent, 0);
+
+  // ... but every enter got its leave, at both subscribers alike
+  CHECK(allTransitions.size() >= 20);
+  CHECK(paired(allTransitions));
+  CHECK(paired(mqttTransitions));
+  CHECK_EQ(mqttTransitions.size(), allTransitions.size());
+  bool same = mqttTransitions.size() == allTransitions.size();
+  for (size_t i = 0; same && i < allTransitions.size(); i++) {
+    same = mqttTransitions[i].uid == allTransitions[i].uid &&
+           mqttTransitions[i].event == allTransitions[i].event &&
+           mqttTransitions[i].time == allTransitions[i].time;
+  }
+  CHECK(same);
+
+  finish("test_event_backlog");
+}
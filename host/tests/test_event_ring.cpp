@@ -0,0 +1,135 @@
+/*
+ * test_event_ring.cpp
+ *
+ * Tag Event Bus Across Threads
+ * The scan task runs on its own thread (real clock) while this thread
+ * plays loop() and calls dispatchNFCEvents(). One subscriber drains
+ * everything; the other only gets one event per dispatch, so its ring
+ * fills. Checks that the slow one drops only its own present events (its
+ * enters and leaves fit in the slots kept for them), that the fast one
+ * loses nothing, and that what the slow one does get is the fast one's
+ * sequence with the dropped events missing - nothing torn, duplicated or
+ * reordered.
+ */
+
+#include "host_test.h"
+#include "nfc_reader.h"
+#include "nfc_simulator.h"
+#include <vector>
+
+#define DISPATCH_PERIOD_MS 100
+
+// Tags in and out quickly, then an empty field so the event stream ends
+static const SimStep ringScenario[] = {
+  // type      duration  uid                    uid2                   read%  err  busy  cardA
+  { SIM_TAG,   1500,     0xE004010918485391ULL, 0,                     100,   0,   0,    0 },
+  { SIM_EMPTY, 500,      0,                     0,                     0,     0,   0,    0 },
+  { SIM_TAG,   1500,     0xE004010918485391ULL, 0xE0040150A1B2C3D4ULL, 100,   0,   0,    0 },
+  { SIM_EMPTY, 500,      0,                     0,                     0,     0,   0,    0 },
+  { SIM_TAG,   1500,     0xE0040150A1B2C3D4ULL, 0,                     100,   0,   0,    0 },
+  { SIM_EMPTY, 600000,   0,                     0,                     0,     0,   0,    0 },
+};
+
+struct Received {
+  TagUID uid;
+  TagEvent event;
+  unsigned long time;
+};
+
+static std::vector<Received> fastEvents;
+static std::vector<Received> slowEvents;
+static unsigned long maxQueueDelay = 0;
+
+static void onFast(const TagEventInfo& event) {
+  fastEvents.push_back({ event.uid, event.event, event.time });
+  unsigned long delay = millis() - event.time;
+  if (delay > maxQueueDelay) maxQueueDelay = delay;
+}
+
+static void onSlow(const TagEventInfo& event) {
+  slowEvents.push_back({ event.uid, event.event, event.time });
+}
+
+static bool sameEvent(const Received& a, const Received& b) {
+  return a.uid == b.uid && a.event == b.event && a.time == b.time;
+}
+
+int main() {
+  hostSerialEcho(false);
+
+  CHECK(initNFCReader());
+  getNFCSimulator(0)->setScenario(ringScenario, sizeof(ringScenario) / sizeof(ringScenario[0]));
+  int fast = subscribeTagEvents("fast", onFast, 0);
+  int slow = subscribeTagEvents("slow", onSlow, 1);
+  CHECK(fast >= 0 && slow >= 0);
+  CHECK(startNFCTask());
+
+  // loop(): dispatch every DISPATCH_PERIOD_MS until the script's tags are
+  // all gone and have been for a while
+  unsigned long start = millis();
+  unsigned long emptySince = 0;
+  while (millis() - start < 20000UL) {
+    dispatchNFCEvents();
+    delay(DISPATCH_PERIOD_MS);
+    bool scriptDone = millis() - start > 5500;
+    if (scriptDone && getNFCStatus().tagsPresent == 0) {
+      if (emptySince == 0) emptySince = millis();
+      if (millis() - emptySince > 500) break;
+    } else {
+      emptySince = 0;
+    }
+  }
+
+  // Drain what the slow subscriber still has queued
+  TagSubscriberStatus slowStatus;
+  for (int i = 0; i < NFC_EVENT_RING_SIZE + 1; i++) dispatchNFCEvents();
+
+  TagSubscriberStatus fastStatus;
+  CHECK(getTagSubscriberStatus(fast, &fastStatus));
+  CHECK(getTagSubscriberStatus(slow, &slowStatus));
+  uint32_t enters = 0, leaves = 0;
+  for (const Received& e : fastEvents) {
+    if (e.event == TAG_ENTER) enters++;
+    if (e.event == TAG_LEAVE) leaves++;
+  }
+
+  printf("%lu ms, fast: %u delivered (%u enter, %u leave), %u dropped, max depth %u, max queue delay %lu ms\n",
+         millis() - start, fastStatus.delivered, enters, leaves, fastStatus.dropped,
+         fastStatus.maxDepth, maxQueueDelay);
+  printf("slow (1 per dispatch): %u delivered, %u dropped, max depth %u\n", slowStatus.delivered,
+         slowStatus.dropped, slowStatus.maxDepth);
+
+  // The fast subscriber saw every arrival and departure
+  CHECK_EQ(enters, 4);
+  CHECK_EQ(leaves, 4);
+  CHECK_EQ(fastStatus.dropped, 0);
+  CHECK_EQ(fastStatus.delivered, fastEvents.size());
+  CHECK(maxQueueDelay <= DISPATCH_PERIOD_MS + 50);
+
+  // The slow one filled its ring up to the reserve and dropped the rest,
+  // all present events, and only its own
+  uint32_t slowEnters = 0, slowLeaves = 0;
+  for (const Received& e : slowEvents) {
+    if (e.event == TAG_ENTER) slowEnters++;
+    if (e.event == TAG_LEAVE) slowLeaves++;
+  }
+  CHECK(slowStatus.maxDepth >= NFC_EVENT_RING_SIZE - NFC_EVENT_RESERVE);
+  CHECK(slowStatus.maxDepth < NFC_EVENT_RING_SIZE);
+  CHECK(slowStatus.dropped > 0);
+  CHECK_EQ(slowEnters, 4);
+  CHECK_EQ(slowLeaves, 4);
+  CHECK_EQ(getNFCStatus().eventsDeferred, 0);
+  CHECK_EQ(slowStatus.depth, 0);
+  CHECK_EQ(slowStatus.delivered, slowEvents.size());
+  CHECK_EQ(slowStatus.delivered + slowStatus.dropped, fastStatus.delivered);
+  CHECK_EQ(getNFCStatus().eventsDropped, slowStatus.dropped);
+
+  // ... and got the fast one's events in the same order, some missing
+  size_t j = 0;
+  for (size_t i = 0; i < fastEvents.size() && j < slowEvents.size(); i++) {
+    if (sameEvent(fastEvents[i], slowEvents[j])) j++;
+  }
+  CHECK_EQ(j, slowEvents.size());
+
+  finish("test_event_ring");
+}
@@ -0,0 +1,175 @@
+/*
+ * test_framework.cpp
+ *
+ * Stand-in Checks
+ * The host tests are only as good as the stand-ins under them; these pin
+ * down the device behaviour the firmware relies on.
+ */
+
+#include "host_test.h"
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <WebServer.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void testJsonStorage() {
+  // const char* is stored by pointer, char* is copied (ArduinoJson 6)
+  StaticJsonDocument<256> doc;
+  char buffer[8];
+  strcpy(buffer, "one");
+  doc["linked"] = (const char*)buffer;
+  doc["copied"] = (char*)buffer;
+  strcpy(buffer, "two");
+  CHECK_STR(doc["linked"].as<const char*>(), "two");
+  CHECK_STR(doc["copied"].as<const char*>(), "one");
+
+  // Chained creation, numbers, compact output
+  StaticJsonDocument<256> out;
+  out["e"][0]["u"] = true;
+  out["n"] = -5;
+  out["f"] = 1.5;
+  char json[64];
+  size_t n = serializeJson(out, json, sizeof(json));
+  CHECK_STR(json, "{\"e\":[{\"u\":true}],\"n\":-5,\"f\":1.5}");
+  CHECK_EQ(n, strlen(json));
+  CHECK_EQ(measureJson(out), n);
+
+  // Output is cut to the buffer, terminator kept
+  n = serializeJson(out, json, 8);
+  CHECK_EQ(n, 7);
+  CHECK_STR(json, "{\"e\":[{");
+}
+
+static void testJsonCapacity() {
+  // 16 bytes per value on the ESP32: the 7-value receive filter leaves
+  // room for one more in 128 bytes
+  StaticJsonDocument<128> filter;
+  filter["u"] = true;
+  filter["s"] = true;
+  filter["R"] = true;
+  filter["e"][0]["u"] = true;
+  filter["e"][0]["R"] = true;
+  CHECK(!filter.overflowed());
+  CHECK_EQ(filter.memoryUsage(), 7 * 16);
+  filter["x"] = true;
+  CHECK(!filter.overflowed());
+  filter["y"] = true;
+  CHECK(filter.overflowed());
+
+  // Parsed strings are copied into the document
+  StaticJsonDocument<64> doc;
+  CHECK(deserializeJson(doc, "{\"a\":\"01234567890123456789012345678901234567890123456789\"}") == DeserializationError::NoMemory);
+}
+
+static void testJsonParse() {
+  StaticJsonDocument<128> filter;
+  filter["s"] = true;
+  filter["e"][0]["u"] = true;
+
+  StaticJsonDocument<512> doc;
+  const char* input = "{\"s\":7,\"skip\":{\"deep\":[1,2,3]},\"e\":[{\"u\":\"E0:04\",\"x\":1},{\"u\":\"A\\u00e9\"}]}";
+  DeserializationError err = deserializeJson(doc, input, strlen(input), DeserializationOption::Filter(filter));
+  CHECK(!err);
+  CHECK_EQ(doc["s"].as<int>(), 7);
+  CHECK(doc["skip"].isNull());
+  JsonArray events = doc["e"];
+  CHECK_EQ(events.size(), 2);
+  int i = 0;
+  for (JsonObject e : events) {
+    const char* uid = e["u"];
+    CHECK_STR(uid, i == 0 ? "E0:04" : "A\xc3\xa9");
+    CHECK(e["x"].isNull());
+    i++;
+  }
+
+  CHECK(deserializeJson(doc, "") == DeserializationError::EmptyInput);
+  CHECK(deserializeJson(doc, "{\"a\":") == DeserializationError::IncompleteInput);
+  CHECK(deserializeJson(doc, "{\"a\" 1}") == DeserializationError::InvalidInput);
+  CHECK(deserializeJson(doc, "[[[[[[[[[[[1]]]]]]]]]]]") == DeserializationError::TooDeep);
+}
+
+static void testClock() {
+  hostUseVirtualClock(true);
+  unsigned long start = millis();
+  delay(2500);
+  CHECK_EQ(millis() - start, 2500);
+  hostAdvanceMicros(1500);
+  CHECK_EQ(millis() - start, 2501);
+  hostUseVirtualClock(false);
+  CHECK(millis() - start >= 2501);
+}
+
+static void testFilesystem() {
+  char root[] = "/tmp/host_fs_XXXXXX";
+  CHECK(mkdtemp(root) != nullptr);
+  hostSetFilesystemRoot(root);
+  CHECK(LittleFS.begin(true));
+
+  File f = LittleFS.open("/data.bin", FILE_WRITE);
+  CHECK((bool)f);
+  f.write((const uint8_t*)"abc", 3);
+  f.close();
+  f = LittleFS.open("/data.bin", FILE_APPEND);
+  f.write((const uint8_t*)"de", 2);
+  f.close();
+
+  f = LittleFS.open("/data.bin", FILE_READ);
+  CHECK_EQ(f.size(), 5);
+  f.seek(3);
+  uint8_t buf[8] = { 0 };
+  CHECK_EQ(f.read(buf, sizeof(buf)), 2);
+  CHECK_STR((const char*)buf, "de");
+  f.close();
+
+  CHECK(LittleFS.rename("/data.bin", "/old.bin"));
+  CHECK(!LittleFS.exists("/data.bin"));
+  CHECK(LittleFS.remove("/old.bin"));
+  CHECK(!LittleFS.open("/missing.bin", FILE_READ));
+  rmdir(root);
+}
+
+static void testPreferences() {
+  Preferences prefs;
+  prefs.begin("test", false);
+  prefs.putString("name", "lab");
+  prefs.putUShort("port", 1883);
+  prefs.end();
+
+  prefs.begin("test", true);
+  CHECK(prefs.getString("name", "x") == "lab");
+  CHECK_EQ(prefs.getUShort("port", 0), 1883);
+  CHECK_EQ(prefs.getUChar("port", 9), 9);  // Stored as a different type
+  CHECK_EQ(prefs.putUChar("ro", 1), 0);    // Read-only
+  prefs.end();
+}
+
+static void testWebServer() {
+  WebServer server(80);
+  server.on("/config", HTTP_POST, [&]() {
+    server.send(200, "text/plain", server.arg("ssid") + "/" + server.arg("port"));
+  });
+  CHECK_EQ(server.hostRequest(HTTP_POST, "/config", "ssid=my+lab%21&port=1883"), 200);
+  CHECK(server.hostBody() == "my lab!/1883");
+  CHECK_EQ(server.hostRequest(HTTP_GET, "/config"), 404);
+}
+
+static void testHeapCounters() {
+  HostHeapStats before = hostHeapStats();
+  String s("a string long enough to need the heap");
+  HostHeapStats after = hostHeapStats();
+  CHECK(after.allocations > before.allocations);
+}
+
+int main() {
+  testJsonStorage();
+  testJsonCapacity();
+  testJsonParse();
+  testClock();
+  testFilesystem();
+  testPreferences();
+  testWebServer();
+  testHeapCounters();
+  finish("test_framework");
+}
@@ -0,0 +1,145 @@
+/*
+ * test_mqtt_connect.cpp
+ *
+ * Broker Connection Without Stalling loop()
+ * Steps processMqttConnection() in real time, as loop() does, against
+ * brokers that are not there: nothing listening (refused), a full accept
+ * queue (SYNs unanswered, the TCP connect times out) and one that takes
+ * the connection but never sends CONNACK. Each is followed by a working
+ * broker, which the reader must reach again. The longest single step is
+ * timed here and compared with the handler's own longestStall; only the
+ * silent broker may hold loop() up, for the bounded CONNACK wait.
+ */
+
+#include <Arduino.h>
+#include "../../src/MQTTTagReaderDisplay_ESP32.ino"
+#include "host_test.h"
+#include "mqtt_test_broker.h"
+#include <chrono>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define QUICK_STEP_MS 50   // Longest a step may take with no CONNACK wait in it
+
+static MqttTestBroker broker;
+
+static uint64_t realMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+           std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Phase {
+  uint32_t attempts;             // Connection attempts it took
+  uint32_t failures;             // Consecutive failures at the end
+  uint64_t longestStep;          // Real ms, one processMqttConnection() call
+  uint64_t elapsed;              // Real ms until done
+};
+
+// Point the reader at the broker, then step the connection until it is
+// connected (connect = true) or until `attempts` attempts have failed
+static Phase run(MqttTestBrokerMode mode, bool connect, uint32_t attempts, uint32_t timeoutMs) {
+  broker.stop();
+  CHECK(broker.start(mode));
+  config.mqtt_port = broker.port();
+
+  Phase phase = { 0, 0, 0, 0 };
+  MqttConnectionStats start = getMqttConnectionStats();
+  uint64_t begin = realMs();
+  while (realMs() - begin < timeoutMs) {
+    uint64_t stepStart = realMs();
+    processMqttConnection();
+    uint64_t step = realMs() - stepStart;
+    if (step > phase.longestStep) phase.longestStep = step;
+    mqttClient.loop();  // Reads SUBACK/PINGRESP, so a closed socket shows as lost
+
+    MqttConnectionStats stats = getMqttConnectionStats();
+    if (connect ? stats.state == MQTT_CONN_CONNECTED
+                : stats.state == MQTT_CONN_WAITING && stats.attempts - start.attempts >= attempts) {
+      break;
+    }
+    usleep(1000);
+  }
+  MqttConnectionStats end = getMqttConnectionStats();
+  phase.attempts = end.attempts - start.attempts;
+  phase.failures = end.failures;
+  phase.elapsed = realMs() - begin;
+  return phase;
+}
+
+static void report(const char* name, const Phase& phase) {
+  printf("  %-30s %3u attempts %6llu ms  longest step %4llu ms\n", name, phase.attempts,
+         (unsigned long long)phase.elapsed, (unsigned long long)phase.longestStep);
+}
+
+int main() {
+  hostSerialEcho(false);
+
+  char root[] = "/tmp/test_mqtt_connect_XXXXXX";
+  CHECK(mkdtemp(root) != nullptr);
+  hostSetFilesystemRoot(root);
+
+  Preferences prefs;
+  prefs.begin("rfid-reader", false);
+  prefs.putString("mqtt_broker", "127.0.0.1");
+  prefs.end();
+  loadConfig();
+  initMqttHandler(&mqttClient, &espClient, &config);
+
+  printf("processMqttConnection() against missing brokers (real time)\n");
+
+  // Refused: fails at once, and the second try waits out the backoff
+  Phase refused = run(BROKER_REFUSE, false, 2, 5000);
+  report("refused, 2 attempts", refused);
+  CHECK_EQ(refused.attempts, 2);
+  CHECK_EQ(refused.failures, 2);
+  CHECK(refused.elapsed >= MQTT_BACKOFF_MIN / 2);
+  CHECK(refused.longestStep < QUICK_STEP_MS);
+  MqttConnectionStats stats = getMqttConnectionStats();
+  CHECK(stats.retryIn > 0 && stats.retryIn <= 2 * MQTT_BACKOFF_MIN);
+
+  Phase back = run(BROKER_NORMAL, true, 0, 5000);
+  report("broker back", back);
+  CHECK(mqttClient.connected());
+  CHECK_EQ(getMqttConnectionStats().failures, 0);
+  CHECK(back.longestStep < QUICK_STEP_MS);
+
+  // Blackhole: the TCP connect never completes and is given up on
+  Phase blackhole = run(BROKER_BLACKHOLE, false, 1, MQTT_CONNECT_TIMEOUT + 3000);
+  report("SYN unanswered, 1 attempt", blackhole);
+  CHECK_EQ(blackhole.attempts, 1);
+  CHECK_EQ(blackhole.failures, 1);
+  CHECK(blackhole.elapsed >= MQTT_CONNECT_TIMEOUT);
+  CHECK(blackhole.longestStep < QUICK_STEP_MS);
+
+  back = run(BROKER_NORMAL, true, 0, 5000);
+  report("broker back", back);
+  CHECK(mqttClient.connected());
+
+  stats = getMqttConnectionStats();
+  printf("  handler longest stall so far: %u ms\n", stats.longestStall);
+  CHECK(stats.longestStall < QUICK_STEP_MS);
+
+  // Silent: TCP is up, so PubSubClient waits for CONNACK - once, bounded
+  Phase silent = run(BROKER_SILENT, false, 1, 5000);
+  report("no CONNACK, 1 attempt", silent);
+  CHECK_EQ(silent.attempts, 1);
+  CHECK_EQ(silent.failures, 1);
+  CHECK(silent.longestStep >= MQTT_HANDSHAKE_TIMEOUT * 1000 - 100);
+  CHECK(silent.longestStep < MQTT_HANDSHAKE_TIMEOUT * 1000 + 500);
+  CHECK_EQ(broker.connects(), 1);
+
+  back = run(BROKER_NORMAL, true, 0, 5000);
+  report("broker back", back);
+  CHECK(mqttClient.connected());
+
+  stats = getMqttConnectionStats();
+  printf("  handler: %u attempts, %u connects, %u ms connecting, longest stall %u ms\n",
+         stats.attempts, stats.connects, stats.connectingTime, stats.longestStall);
+  CHECK_EQ(stats.attempts, 7);
+  CHECK_EQ(stats.connects, 3);
+  CHECK(stats.longestStall >= MQTT_HANDSHAKE_TIMEOUT * 1000 - 100);
+  CHECK(stats.longestStall < MQTT_HANDSHAKE_TIMEOUT * 1000 + 500);
+
+  broker.stop();
+  finish("test_mqtt_connect");
+}
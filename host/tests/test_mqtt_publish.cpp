@@ -0,0 +1,104 @@
+/*
+ * test_mqtt_publish.cpp
+ *
+ * MQTT Event Times
+ * Builds the sketch (its tagDetected() subscriber) and publishes to the
+ * loopback broker. The time an event carries is when the scan task
+ * raised it, however long loop() took to deliver it: the queued JSON
+ * "t" and "a" fields and the binary record's time field are checked
+ * against events delivered a few hundred ms late.
+ */
+
+#include <Arduino.h>
+#include "../../src/MQTTTagReaderDisplay_ESP32.ino"
+#include "host_test.h"
+#include "mqtt_test_broker.h"
+#include <ArduinoJson.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static MqttTestBroker broker;
+
+static TagEventInfo tagEvent(TagEvent kind, unsigned long time) {
+  TagEventInfo event;
+  event.uid.value = 0xE0040150C0FFEE01ULL;
+  event.event = kind;
+  event.reader = 0;
+  event.protocol = PROTOCOL_ISO15693;
+  event.time = time;
+  return event;
+}
+
+// Connect steps until the handshake is done (the broker runs in real time)
+static bool connectBroker() {
+  for (int i = 0; i < 2000 && !mqttClient.connected(); i++) {
+    processMqttConnection();
+    usleep(500);
+  }
+  return mqttClient.connected();
+}
+
+static uint32_t readU32(const uint8_t* in) {
+  return in[0] | (in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+int main() {
+  hostSerialEcho(false);
+  hostUseVirtualClock(true);
+
+  char root[] = "/tmp/test_mqtt_publish_XXXXXX";
+  CHECK(mkdtemp(root) != nullptr);
+  hostSetFilesystemRoot(root);
+  CHECK(broker.start());
+
+  Preferences prefs;
+  prefs.begin("rfid-reader", false);
+  prefs.putString("mqtt_broker", "127.0.0.1");
+  prefs.putUInt("mqtt_port", broker.port());
+  prefs.end();
+
+  loadConfig();
+  initNFCTrace();
+  initMqttHandler(&mqttClient, &espClient, &config);
+  CHECK(initMqttQueue());
+
+  // Queued while the broker is not connected yet, delivered 300 ms late
+  unsigned long enterTime = millis();
+  hostAdvanceMicros(300000);
+  tagDetected(tagEvent(TAG_ENTER, enterTime));
+  CHECK_EQ(getMqttQueueDepth(), 1);
+
+  CHECK(connectBroker());
+  hostAdvanceMicros(MQTT_QUEUE_DRAIN_INTERVAL * 1000);
+  unsigned long drainTime = millis();
+  processMqttQueue();
+  CHECK(broker.waitForPublishes(1, 2000));
+
+  MqttTestMessage message;
+  CHECK(broker.message(0, &message));
+  CHECK_STR(message.topic, "rfid/Read");
+  StaticJsonDocument<256> doc;
+  CHECK(deserializeJson(doc, (const char*)message.payload, message.length) == DeserializationError::Ok);
+  CHECK_EQ(doc["t"].as<unsigned long>(), enterTime);
+  CHECK_EQ(doc["a"].as<unsigned long>(), drainTime - enterTime);
+
+  // Live binary Unread, delivered 250 ms after the scan task raised it
+  config.mqtt_format = MQTT_FORMAT_BINARY;
+  hostAdvanceMicros(2000000);
+  unsigned long leaveTime = millis();
+  hostAdvanceMicros(250000);
+  tagDetected(tagEvent(TAG_LEAVE, leaveTime));
+  CHECK(broker.waitForPublishes(2, 2000));
+
+  CHECK(broker.message(1, &message));
+  CHECK_STR(message.topic, "rfid/Unread");
+  CHECK_EQ(message.length, MQTT_BINARY_RECORD);
+  CHECK_EQ(message.payload[0], MQTT_BINARY_MARKER);
+  CHECK_EQ(message.payload[1], 'U');
+  CHECK_EQ(readU32(&message.payload[12]), leaveTime);
+  CHECK_EQ(readU32(&message.payload[16]), 0);                      // Not queued: no age
+  CHECK_EQ(readU32(&message.payload[20]), leaveTime - enterTime);  // Dwell
+
+  broker.stop();
+  finish("test_mqtt_publish");
+}
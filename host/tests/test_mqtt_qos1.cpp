@@ -0,0 +1,109 @@
+/*
+ * test_mqtt_qos1.cpp
+ *
+ * QoS 1 Resend Keeps Its Topic
+ * A QoS 1 message still waiting for its PUBACK when the base topic is
+ * changed (config save -> refreshMqttConfig()) must go again on the topic
+ * it was first sent on, both after MQTT_ACK_TIMEOUT and on a reconnect.
+ * A message sent on a new connection before the first check is not one
+ * to resend. The broker here never acknowledges.
+ */
+
+#include <Arduino.h>
+#include "../../src/MQTTTagReaderDisplay_ESP32.ino"
+#include "host_test.h"
+#include "mqtt_test_broker.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+static MqttTestBroker broker;
+
+static bool connectBroker() {
+  for (int i = 0; i < 2000 && !mqttClient.connected(); i++) {
+    processMqttConnection();
+    mqttClient.loop();
+    usleep(500);
+  }
+  return mqttClient.connected();
+}
+
+int main() {
+  hostSerialEcho(false);
+  hostUseVirtualClock(true);
+
+  char root[] = "/tmp/test_mqtt_qos1_XXXXXX";
+  CHECK(mkdtemp(root) != nullptr);
+  hostSetFilesystemRoot(root);
+  CHECK(broker.start());
+  broker.setAcks(false);
+
+  Preferences prefs;
+  prefs.begin("rfid-reader", false);
+  prefs.putString("mqtt_broker", "127.0.0.1");
+  prefs.putUInt("mqtt_port", broker.port());
+  prefs.end();
+
+  loadConfig();
+  config.mqtt_qos = 1;
+  config.mqtt_batch_ms = 0;
+  initNFCTrace();
+  initMqttHandler(&mqttClient, &espClient, &config);
+  CHECK(initMqttQueue());
+  CHECK(connectBroker());
+
+  TagUID uid;
+  uid.value = 0xE0040150C0FFEE01ULL;
+  CHECK(publishTag(uid, "Read", 0, PROTOCOL_ISO15693, 0, millis()));
+  CHECK(broker.waitForPublishes(1, 2000));
+  MqttTestMessage first;
+  CHECK(broker.message(0, &first));
+  CHECK_STR(first.topic, "rfid/Read");
+  CHECK_EQ(first.qos, 1);
+  CHECK_EQ(getMqttInflightStats().inflight, 1);
+
+  // Sent on this connection, so not resent as if left over from the last one
+  processMqttInflight();
+  CHECK_EQ(getMqttInflightStats().retransmits, 0);
+
+  // Base topic changed while the PUBACK is outstanding
+  strlcpy(config.mqtt_base_topic, "moved", sizeof(config.mqtt_base_topic));
+  refreshMqttConfig();
+
+  // Resend after the ack timeout
+  hostAdvanceMicros((MQTT_ACK_TIMEOUT + 100) * 1000ULL);
+  processMqttInflight();
+  CHECK(broker.waitForPublishes(2, 2000));
+  MqttTestMessage resend;
+  CHECK(broker.message(1, &resend));
+  CHECK_STR(resend.topic, "rfid/Read");
+  CHECK(resend.dup);
+  CHECK_EQ(resend.packetId, first.packetId);
+  CHECK_EQ(resend.length, first.length);
+  CHECK(memcmp(resend.payload, first.payload, first.length) == 0);
+
+  // Resend on a reconnect
+  broker.dropClient();
+  for (int i = 0; i < 2000 && mqttClient.connected(); i++) {
+    mqttClient.loop();
+    usleep(500);
+  }
+  CHECK(!mqttClient.connected());
+  CHECK(connectBroker());
+  processMqttInflight();
+  CHECK(broker.waitForPublishes(3, 2000));
+  CHECK(broker.message(2, &resend));
+  CHECK_STR(resend.topic, "rfid/Read");
+  CHECK(resend.dup);
+  CHECK_EQ(resend.packetId, first.packetId);
+
+  // New messages use the new topic
+  CHECK(publishTag(uid, "Unread", 0, PROTOCOL_ISO15693, 1000, millis()));
+  CHECK(broker.waitForPublishes(4, 2000));
+  MqttTestMessage next;
+  CHECK(broker.message(3, &next));
+  CHECK_STR(next.topic, "moved/Unread");
+  CHECK_EQ(getMqttInflightStats().retransmits, 2);
+
+  broker.stop();
+  finish("test_mqtt_qos1");
+}
@@ -0,0 +1,122 @@
+/*
+ * test_scan_path.cpp
+ *
+ * Simulator Scan Path
+ * Runs the real scan, debounce and event code against the simulator's
+ * default scenario on the virtual clock, the way the scan task would
+ * (processNFCReader(), then a one-tick delay), and checks the events that
+ * come out against the scripted arrivals and departures.
+ *
+ * With the default policy (2 reads in a row, leave after 4 missed scans)
+ * the 70% "edge of range" step may flap - a leave and a re-enter - so
+ * only pairing and latency are checked. Hysteresis over 8 scans must turn
+ * every arrival and departure into exactly one event.
+ */
+
+#include "host_test.h"
+#include "nfc_reader.h"
+#include "nfc_simulator.h"
+
+#define TEST_PASSES 3
+
+static uint32_t enters = 0;
+static uint32_t leaves = 0;
+static uint32_t presents = 0;
+static unsigned long lastEventTime = 0;
+static bool eventsInOrder = true;
+
+static void onTagEvent(const TagEventInfo& event) {
+  if (event.event == TAG_ENTER) enters++;
+  else if (event.event == TAG_LEAVE) leaves++;
+  else presents++;
+  if (event.time < lastEventTime) eventsInOrder = false;
+  lastEventTime = event.time;
+}
+
+struct PassResult {
+  uint32_t arrivals;
+  uint32_t departures;
+  uint32_t enters;
+  uint32_t leaves;
+  uint32_t presents;
+  unsigned long maxEnterLatency;
+  unsigned long maxLeaveLatency;
+};
+
+// Run the scenario TEST_PASSES more times; counts are for those passes only
+static PassResult runPasses(const char* label) {
+  PN5180Simulator* sim = getNFCSimulator(0);
+  SimStats before = sim->getStats();
+  uint32_t entersBefore = enters, leavesBefore = leaves, presentsBefore = presents;
+
+  unsigned long start = millis();
+  uint32_t cycles = 0;
+  while (sim->getStats().runs < before.runs + TEST_PASSES && millis() - start < 600000UL) {
+    processNFCReader();
+    dispatchNFCEvents();
+    delay(1);
+    cycles++;
+  }
+
+  SimStats after = sim->getStats();
+  PassResult r;
+  r.arrivals = after.arrivals - before.arrivals;
+  r.departures = after.departures - before.departures;
+  r.enters = enters - entersBefore;
+  r.leaves = leaves - leavesBefore;
+  r.presents = presents - presentsBefore;
+  r.maxEnterLatency = after.maxEnterLatency;
+  r.maxLeaveLatency = after.maxLeaveLatency;
+
+  printf("%s: %u passes, %lu ms simulated, %u scan cycles, %u polls\n", label,
+         after.runs - before.runs, millis() - start, cycles, after.polls - before.polls);
+  printf("  arrivals %u -> enter %u, departures %u -> leave %u, present %u\n",
+         r.arrivals, r.enters, r.departures, r.leaves, r.presents);
+  printf("  enter latency last %lu max %lu ms, leave latency last %lu max %lu ms\n",
+         after.lastEnterLatency, r.maxEnterLatency, after.lastLeaveLatency, r.maxLeaveLatency);
+  return r;
+}
+
+int main() {
+  hostSerialEcho(false);
+  hostUseVirtualClock(true);
+
+  CHECK(initNFCReader());
+  CHECK(subscribeTagEvents("test", onTagEvent, 0) >= 0);
+
+  // Default policy
+  PassResult r = runPasses("consecutive 2, timeout 4");
+  CHECK(r.arrivals > 0);
+  CHECK(r.enters >= r.arrivals);
+  CHECK_EQ(r.enters, r.leaves);
+  CHECK_EQ(r.arrivals, r.departures);
+  CHECK(r.presents > 0);
+  CHECK(r.maxEnterLatency < 500);
+  CHECK(r.maxLeaveLatency < 500);
+  CHECK_EQ(getNFCStatus().tagsPresent, 0);  // Script ends with an empty field
+
+  // Hysteresis rides out the edge-of-range misses
+  DebouncePolicy policy = { DEBOUNCE_HYSTERESIS, 2, 8, 1, 8 };
+  setNFCDebounce(policy);
+  r = runPasses("hysteresis 2 of 8, leave below 1");
+  CHECK_EQ(r.enters, r.arrivals);
+  CHECK_EQ(r.leaves, r.departures);
+  CHECK(r.maxLeaveLatency < 1000);
+  CHECK_EQ(getNFCStatus().tagsPresent, 0);
+
+  NFCStatus status = getNFCStatus();
+  printf("scans %u, reads %u, suppressed enters %u, suppressed leaves %u, dropped %u\n",
+         status.totalScans, status.successfulReads, status.suppressedEnters,
+         status.suppressedLeaves, status.eventsDropped);
+  CHECK(eventsInOrder);
+  CHECK_EQ(status.eventsDropped, 0);
+
+  // New scan intervals are staged and only applied by the scan side
+  uint16_t oldInterval = getNFCStatus().scanInterval;
+  setNFCScanIntervals(120, 480);
+  CHECK_EQ(getNFCStatus().scanInterval, oldInterval);
+  processNFCReader();
+  CHECK_EQ(getNFCStatus().scanInterval, 120);
+
+  finish("test_scan_path");
+}
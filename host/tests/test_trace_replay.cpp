@@ -0,0 +1,97 @@
+/*
+ * test_trace_replay.cpp
+ *
+ * Scan Trace Replay Time Base
+ * A trace is replayed with the times it was recorded at, which need not
+ * be anywhere near the current millis() (an earlier boot, or a file
+ * copied from another reader). Detection latency must come out of the
+ * record times alone: the trace here was recorded 10 minutes before the
+ * replay, sees one tag on two scans 50 ms apart and then loses it. The
+ * events raised carry the record times too, not the time of the replay.
+ */
+
+#include "host_test.h"
+#include "nfc_reader.h"
+#include "nfc_simulator.h"
+#include "nfc_trace.h"
+#include <stdlib.h>
+
+#define SCAN_MS       50
+#define TAG_SCANS     6
+#define EMPTY_SCANS   10
+
+static const SimStep emptyField[] = {
+  { SIM_EMPTY, 3600000, 0, 0, 0, 0, 0, 0 },
+};
+
+static uint32_t enters = 0;
+static uint32_t leaves = 0;
+static unsigned long enterTime = 0;
+static unsigned long leaveTime = 0;
+
+static void onTagEvent(const TagEventInfo& event) {
+  if (event.event == TAG_ENTER) {
+    enters++;
+    enterTime = event.time;
+  } else if (event.event == TAG_LEAVE) {
+    leaves++;
+    leaveTime = event.time;
+  }
+}
+
+int main() {
+  hostSerialEcho(false);
+  hostUseVirtualClock(true);
+
+  char root[] = "/tmp/test_trace_replay_XXXXXX";
+  CHECK(mkdtemp(root) != nullptr);
+  hostSetFilesystemRoot(root);
+  CHECK(initNFCTrace());
+
+  CHECK(initNFCReader());
+  getNFCSimulator(0)->setScenario(emptyField, 1);
+  CHECK(subscribeTagEvents("test", onTagEvent, 0) >= 0);
+
+  // Recorded early in a boot: the tag on six scans, then an empty field
+  uint8_t uid[8] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x07, 0xE0 };
+  uint32_t recordStart = 2000;
+  startNFCTrace();
+  for (int i = 0; i < TAG_SCANS + EMPTY_SCANS; i++) {
+    bool tag = i < TAG_SCANS;
+    traceRecord(recordStart + i * SCAN_MS, tag ? ISO15693_EC_OK : EC_NO_CARD, uid, tag ? 1 : 0,
+                0, PROTOCOL_ISO15693);
+  }
+  stopNFCTrace();
+  CHECK_EQ(getNFCTraceStatus().recordsWritten, TAG_SCANS + EMPTY_SCANS);
+
+  // Replayed ten minutes later
+  hostAdvanceMicros(600000000ULL);
+  CHECK(startNFCReplay(true));
+  bool started = false;
+  for (int i = 0; i < 1000; i++) {
+    processNFCReader();
+    dispatchNFCEvents();
+    delay(1);
+    bool replaying = getNFCTraceStatus().replaying;
+    if (replaying) started = true;
+    else if (started) break;
+  }
+  CHECK(started);
+  CHECK(!getNFCTraceStatus().replaying);
+  CHECK_EQ(getNFCTraceStatus().replayRecords, TAG_SCANS + EMPTY_SCANS);
+
+  // Two reads in a row confirm the tag one scan after it was first seen
+  NFCStatus status = getNFCStatus();
+  printf("replay: enters %u, leaves %u, detect latency last %lu avg %lu ms\n",
+         enters, leaves, status.lastDetectLatency, status.avgDetectLatency);
+  CHECK_EQ(enters, 1);
+  CHECK_EQ(leaves, 1);
+  CHECK_EQ(status.lastDetectLatency, SCAN_MS);
+  CHECK_EQ(status.avgDetectLatency, SCAN_MS);
+  CHECK_EQ(status.tagsPresent, 0);
+  CHECK_EQ(enterTime, recordStart + SCAN_MS);
+  CHECK(leaveTime > recordStart + (TAG_SCANS - 1) * SCAN_MS);
+  CHECK(leaveTime < recordStart + (TAG_SCANS + EMPTY_SCANS) * SCAN_MS);
+
+  finish("test_trace_replay");
+}
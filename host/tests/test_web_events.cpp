@@ -0,0 +1,73 @@
+/*
+ * test_web_events.cpp
+ *
+ * /events and /status Handlers
+ * Every event in the list formats its UID into the same stack buffer,
+ * so each one has to be copied into the JSON document - linked by
+ * pointer they would all show the last UID formatted. /status builds its
+ * document in a static one, which must start empty on every request and
+ * still hold the last member.
+ */
+
+#include "host_test.h"
+#include "web_server.h"
+#include <ArduinoJson.h>
+
+static void logEvent(uint64_t uid, TagEvent kind, uint8_t reader, unsigned long time) {
+  TagEventInfo event;
+  event.uid.value = uid;
+  event.event = kind;
+  event.reader = reader;
+  event.protocol = PROTOCOL_ISO15693;
+  event.time = time;
+  webTagEvent(event);
+}
+
+int main() {
+  hostSerialEcho(false);
+  hostUseVirtualClock(true);
+
+  WebServer server(80);
+  initWebServer(&server);
+
+  unsigned long now = millis();
+  logEvent(0xE0040150AAAA0001ULL, TAG_ENTER, 0, now);
+  logEvent(0xE0040150BBBB0002ULL, TAG_ENTER, 1, now + 10);
+  logEvent(0xE0040150AAAA0001ULL, TAG_PRESENT, 0, now + 20);  // Not listed
+  logEvent(0xE0040150AAAA0001ULL, TAG_LEAVE, 0, now + 30);
+  hostAdvanceMicros(100000);
+
+  CHECK_EQ(server.hostRequest(HTTP_GET, "/events"), 200);
+  StaticJsonDocument<2048> doc;
+  CHECK(deserializeJson(doc, server.hostBody()) == DeserializationError::Ok);
+  printf("%s\n", server.hostBody().c_str());
+
+  CHECK_EQ(doc["total"].as<int>(), 3);
+  JsonArray events = doc["events"];
+  CHECK_EQ(events.size(), 3);
+  CHECK_STR(events[0]["uid"].as<const char*>(), "E0040150AAAA0001");
+  CHECK_STR(events[0]["event"].as<const char*>(), "leave");
+  CHECK_STR(events[1]["uid"].as<const char*>(), "E0040150BBBB0002");
+  CHECK_STR(events[1]["event"].as<const char*>(), "enter");
+  CHECK_EQ(events[1]["reader"].as<int>(), 1);
+  CHECK_STR(events[2]["uid"].as<const char*>(), "E0040150AAAA0001");
+  CHECK_EQ(events[2]["age_ms"].as<int>(), 100);
+
+  // /status twice: the same members both times, all of them in the document
+  static Config config;
+  setWebServerConfig(&config);
+  CHECK_EQ(server.hostRequest(HTTP_GET, "/status"), 200);
+  String first = server.hostBody();
+  CHECK_EQ(server.hostRequest(HTTP_GET, "/status"), 200);
+  static StaticJsonDocument<16384> status;
+  CHECK(deserializeJson(status, server.hostBody()) == DeserializationError::Ok);
+  JsonObject members = status.as<JsonObject>();
+  printf("/status: %u bytes, %u members\n", (unsigned)server.hostBody().length(),
+         (unsigned)members.size());
+  CHECK_EQ(server.hostBody().length(), first.length());
+  CHECK(members.containsKey("nfc_events_deferred"));
+  CHECK(members.containsKey("mqtt_queue"));
+  CHECK(members.containsKey("ip"));  // Last one added
+
+  finish("test_web_events");
+}
@@ -23,37 +23,38 @@
 #include "display.h"
 #include "web_server.h"
 #include "mqtt_handler.h"
+#include "nfc_trace.h"
+#include "mqtt_queue.h"
+#include "mqtt_inflight.h"
+#include "tag_presence.h"
 
 // Version Information
-#define VERSION "1.0.15"
+#define VERSION "1.0.39"
 #define BUILD_DATE __DATE__
 #define BUILD_TIME __TIME__
 #define HOSTNAME "ESP32-RFID-ReaderDisplay"
 
 // Timing Configuration
 // =====================
-// SCAN_INTERVAL (nfc_reader.h): 250ms = 4 scans/second
-//   - Controls how often PN5180 checks for tags
-//   - Lower = more responsive range detection
-//   - Practical minimum: ~100ms (PN5180 RF field cycling)
-//   - Consecutive reads required: 2 (noise filtering)
+// Scan interval (adaptive, min/max set on /config): 50ms - 250ms
+//   - Polls at the minimum while a tag is pending or present
+//   - Backs off to the maximum after 2s of empty field (SCAN_BACKOFF_DELAY)
+//   - Lower minimum = faster detection and removal
 //
-// TAG_TIMEOUT (nfc_reader.cpp): 1000ms
-//   - How long after last detection before tag considered "removed"
-//   - Should be 3-5x SCAN_INTERVAL for reliable detection
-//   - Current: 4x scan interval = very responsive removal detection
+// Debounce policy (set on /config, default: 2 consecutive reads)
+//   - Consecutive, N-of-M window or hysteresis (see nfc_reader.h)
+//   - Timeout: 4 missed scans before tag considered "removed"
+//   - 4x minimum interval = 200ms at 50ms, 1000ms at 250ms
 //
 // DISPLAY_UPDATE_INTERVAL: 500ms = 2 updates/second  
 //   - Controls how often display refreshes
 //   - With selective updates, can go much faster without flicker
 //   - Practical minimum: ~100ms (human perception limit)
-//   - Should be >= SCAN_INTERVAL for best responsiveness
+//   - Should be >= scan interval for best responsiveness
 //
-// MQTT_RECONNECT_INTERVAL: 5000ms
-//   - How often to retry MQTT connection if disconnected
-//   - No need to change this
+// MQTT reconnects back off from 1s to 60s (MQTT_BACKOFF_MIN/MAX in
+// mqtt_handler.h) and never block loop() for the TCP connect
 #define DISPLAY_UPDATE_INTERVAL 500
-#define MQTT_RECONNECT_INTERVAL 5000
 
 // Configuration
 Config config;
@@ -66,15 +67,10 @@ WebServer webServer(80);
 
 // State
 unsigned long lastDisplayUpdate = 0;
-unsigned long lastMqttReconnect = 0;
-uint32_t mqttPublished = 0;
-String lastPublishedUID = "";
-String lastPublishedEvent = "";  // Track last event type (Read, Continuing, Unread)
-unsigned long lastContinuingTime = 0;
-#define CONTINUING_INTERVAL 3000  // Publish continuing every 3 seconds
 
 // Forward declarations
-void tagDetected(const char* uid, bool present);
+void tagDetected(const TagEventInfo& event);
+void logTagEvent(const TagEventInfo& event);
 void setupWiFi();
 void loadConfig();
 void saveConfig();
@@ -112,7 +108,7 @@ void setup() {
   setupWiFi();
   
   // Setup MQTT
-  initMqttHandler(&mqttClient, &config);
+  initMqttHandler(&mqttClient, &espClient, &config);
   
   // Pass broker config to display
   setMqttConfig(config.mqtt_broker, config.mqtt_port, config.mqtt_subscribe_topic);
@@ -120,17 +116,34 @@ void setup() {
   // Setup Web Server
   setWebServerConfig(&config);
   setWebServerMqttClient(&mqttClient);
-  setWebServerMqttPublished(&mqttPublished);
   setConfigSaveCallback(saveConfig);
   initWebServer(&webServer);
   
+  // Scan trace storage (recording is started from the web page)
+  initNFCTrace();
+  
+  // Store-and-forward queue for events published while the broker is down
+  initMqttQueue();
+  
   // Initialize PN5180 - CRITICAL: Only once!
   Serial.println(F("\n=== Initializing PN5180 ==="));
   displayStatus("Init NFC...");
   
+  setNFCProtocols(config.protocols);  // Before init - decides the first RF setup
   if (initNFCReader()) {
     Serial.println(F("PN5180 initialized successfully"));
-    setTagCallback(tagDetected);  // Set callback for tag events
+    // Tag event subscribers (each gets its own queue, drained in loop)
+    subscribeTagEvents("mqtt", tagDetected, 8);
+    subscribeTagEvents("display", displayTagEvent, 0);
+    subscribeTagEvents("web", webTagEvent, 0);
+    subscribeTagEvents("log", logTagEvent, 4);
+    setNFCScanIntervals(config.scan_min_interval, config.scan_max_interval);
+    DebouncePolicy policy = {
+      config.debounce_mode, config.debounce_enter, config.debounce_window,
+      config.debounce_leave, config.debounce_timeout
+    };
+    setNFCDebounce(policy);
+    setNFCIdleMode(config.lpcd_quiet);
   } else {
     Serial.println(F("PN5180 initialization failed"));
     displayMessage("NFC Init Failed!");
@@ -139,32 +152,40 @@ void setup() {
   
   Serial.println(F("\n=== Setup Complete ==="));
   displayStatus("Ready!");
+  setDisplayPage(config.display_page);
   updateDisplay();
+  
+  // Start scanning on its own core (after all setup drawing on the shared SPI bus)
+  startNFCTask();
 }
 
 void loop() {
   // Handle web server
   webServer.handleClient();
   
-  // Process NFC reader (scans for tags)
-  processNFCReader();
+  // Deliver tag events from the NFC scan task
+  dispatchNFCEvents();
+  
+  // Write buffered scan trace records to flash
+  flushNFCTrace();
   
-  // Handle MQTT connection
+  // Handle MQTT connection (one non-blocking step of connect / backoff)
+  processMqttConnection();
   if (!mqttClient.connected()) {
     setMqttStatus(false);
-    unsigned long now = millis();
-    if (now - lastMqttReconnect > MQTT_RECONNECT_INTERVAL) {
-      lastMqttReconnect = now;
-      reconnectMQTT();
-    }
   } else {
     setMqttStatus(true);
     mqttClient.loop();
+    processMqttInflight();  // Resend QoS 1 messages whose PUBACK is overdue
+    processMqttQueue();  // Send events queued during an outage
   }
   
-  // Update display periodically
+  // Send a batch whose window is over (or queue it if the broker went away)
+  processMqttBatch();
+  
+  // Update display periodically (or right away when the tag list changed)
   unsigned long now = millis();
-  if (now - lastDisplayUpdate > DISPLAY_UPDATE_INTERVAL) {
+  if (now - lastDisplayUpdate > DISPLAY_UPDATE_INTERVAL || displayTagsChanged()) {
     lastDisplayUpdate = now;
     updateDisplay();
   }
@@ -172,43 +193,54 @@ void loop() {
   yield();
 }
 
-// Tag detection callback
-void tagDetected(const char* uid, bool present) {
-  // Update display
-  displayTag(uid, present);
-  
-  // Publish MQTT event
-  if (present) {
-    if (String(uid) != lastPublishedUID) {
-      // New tag - publish Read
-      publishTag(uid, "Read");
-      lastPublishedUID = String(uid);
-      lastPublishedEvent = "Read";
-      lastContinuingTime = millis();
-      mqttPublished++;
-    } else {
-      // Same tag still present - check if we should publish Continuing
-      unsigned long now = millis();
-      if (now - lastContinuingTime >= CONTINUING_INTERVAL) {
-        // Only publish Continuing if the last event was NOT already Continuing
-        if (lastPublishedEvent != "Continuing") {
-          publishTag(uid, "Continuing");
-          lastPublishedEvent = "Continuing";
-          lastContinuingTime = now;
-          mqttPublished++;
-        }
-        // If last event was already Continuing, do nothing (no spam)
-      }
+// Tag event subscriber: MQTT publishing (fired per tag)
+// Each tag on each reader has its own entry: Read on arrival, Continuing
+// every continuing_interval seconds while present, Unread with the dwell time.
+void tagDetected(const TagEventInfo& event) {
+  TagPresence* tag = findTagPresence(event.uid, event.reader);
+  
+  if (event.event == TAG_ENTER) {
+    // New tag - publish Read
+    addTagPresence(event.uid, event.reader, event.time);
+    publishTag(event.uid, "Read", event.reader, event.protocol, 0, event.time);
+  } else if (event.event == TAG_PRESENT) {
+    // Still present - heartbeat (a tag whose enter event was dropped starts here)
+    if (!tag) {
+      addTagPresence(event.uid, event.reader, event.time);
+      return;
+    }
+    
+    unsigned long interval = config.continuing_interval * 1000UL;
+    if (interval > 0 && event.time - tag->lastPublished >= interval) {
+      publishTag(event.uid, "Continuing", event.reader, event.protocol, 0, event.time);
+      tag->lastPublished = event.time;
     }
   } else {
-    // Tag removed - publish Unread
-    publishTag(uid, "Unread");
-    lastPublishedUID = "";
-    lastPublishedEvent = "Unread";
-    mqttPublished++;
+    // Tag removed - publish Unread with how long it was in the field
+    unsigned long dwell = tag ? event.time - tag->firstSeen : 0;
+    publishTag(event.uid, "Unread", event.reader, event.protocol, dwell, event.time);
+    removeTagPresence(tag);
   }
 }
 
+// Tag event subscriber: Serial log of arrivals and departures
+void logTagEvent(const TagEventInfo& event) {
+  if (event.event == TAG_PRESENT) return;
+  
+  char uidStr[TAG_UID_HEX_LEN];
+  Serial.print(event.event == TAG_ENTER ? F("Tag detected: ") : F("Tag removed: "));
+  Serial.print(event.uid.toHex(uidStr));
+  if (NFC_READER_COUNT > 1) {
+    Serial.print(F(" (reader "));
+    Serial.print(event.reader);
+    Serial.print(F(")"));
+  }
+  if (event.protocol == PROTOCOL_ISO14443A) {
+    Serial.print(F(" (ISO14443A)"));
+  }
+  Serial.println();
+}
+
 // Configuration functions
 void loadConfig() {
   preferences.begin("rfid-reader", false);
@@ -220,6 +252,24 @@ void loadConfig() {
   strlcpy(config.mqtt_base_topic, preferences.getString("mqtt_pub_topic", "rfid").c_str(), sizeof(config.mqtt_base_topic));
   strlcpy(config.mqtt_subscribe_topic, preferences.getString("mqtt_sub_topic", "rfid/#").c_str(), sizeof(config.mqtt_subscribe_topic));
   config.sensor_id = preferences.getUChar("sensor_id", 33);
+  config.scan_min_interval = preferences.getUShort("scan_min", SCAN_INTERVAL_MIN_DEFAULT);
+  config.scan_max_interval = preferences.getUShort("scan_max", SCAN_INTERVAL_MAX_DEFAULT);
+  config.debounce_mode = preferences.getUChar("db_mode", DEBOUNCE_MODE_DEFAULT);
+  config.debounce_enter = preferences.getUChar("db_enter", DEBOUNCE_ENTER_DEFAULT);
+  config.debounce_window = preferences.getUChar("db_window", DEBOUNCE_WINDOW_DEFAULT);
+  config.debounce_leave = preferences.getUChar("db_leave", DEBOUNCE_LEAVE_DEFAULT);
+  config.debounce_timeout = preferences.getUChar("db_timeout", DEBOUNCE_TIMEOUT_DEFAULT);
+  config.mqtt_tag_memory = preferences.getUChar("mqtt_tag_mem", 0);
+  config.lpcd_quiet = preferences.getUShort("lpcd_quiet", NFC_LPCD_QUIET_DEFAULT);
+  config.protocols = preferences.getUChar("protocols", NFC_PROTOCOLS_DEFAULT);
+  config.continuing_interval = preferences.getUShort("cont_int", MQTT_CONTINUING_DEFAULT);
+  config.mqtt_batch_ms = preferences.getUShort("batch_ms", 0);
+  config.mqtt_batch_max = preferences.getUChar("batch_max", MQTT_BATCH_MAX);
+  config.mqtt_format = preferences.getUChar("mqtt_fmt", MQTT_FORMAT_JSON);
+  config.mqtt_qos = preferences.getUChar("mqtt_qos", 0);
+  config.mqtt_inflight = preferences.getUChar("inflight", MQTT_INFLIGHT_DEFAULT);
+  strlcpy(config.mqtt_rx_filter, preferences.getString("rx_filter", "").c_str(), sizeof(config.mqtt_rx_filter));
+  config.display_page = preferences.getUChar("disp_page", DISPLAY_PAGE_MAIN);
   
   preferences.end();
   
@@ -229,9 +279,13 @@ void loadConfig() {
   Serial.print(F("Publish Base: ")); Serial.println(config.mqtt_base_topic);
   Serial.print(F("Subscribe: ")); Serial.println(config.mqtt_subscribe_topic);
   Serial.print(F("Sensor ID: ")); Serial.println(config.sensor_id);
+  Serial.print(F("Scan interval: ")); Serial.print(config.scan_min_interval);
+  Serial.print(F("-")); Serial.print(config.scan_max_interval); Serial.println(F("ms"));
 }
 
 void saveConfig() {
+  refreshMqttConfig();  // Base topic / sensor ID may have changed
+  
   preferences.begin("rfid-reader", false);
   
   preferences.putString("wifi_ssid", config.wifi_ssid);
@@ -241,6 +295,24 @@ void saveConfig() {
   preferences.putString("mqtt_pub_topic", config.mqtt_base_topic);
   preferences.putString("mqtt_sub_topic", config.mqtt_subscribe_topic);
   preferences.putUChar("sensor_id", config.sensor_id);
+  preferences.putUShort("scan_min", config.scan_min_interval);
+  preferences.putUShort("scan_max", config.scan_max_interval);
+  preferences.putUChar("db_mode", config.debounce_mode);
+  preferences.putUChar("db_enter", config.debounce_enter);
+  preferences.putUChar("db_window", config.debounce_window);
+  preferences.putUChar("db_leave", config.debounce_leave);
+  preferences.putUChar("db_timeout", config.debounce_timeout);
+  preferences.putUChar("mqtt_tag_mem", config.mqtt_tag_memory);
+  preferences.putUShort("lpcd_quiet", config.lpcd_quiet);
+  preferences.putUChar("protocols", config.protocols);
+  preferences.putUShort("cont_int", config.continuing_interval);
+  preferences.putUShort("batch_ms", config.mqtt_batch_ms);
+  preferences.putUChar("batch_max", config.mqtt_batch_max);
+  preferences.putUChar("mqtt_fmt", config.mqtt_format);
+  preferences.putUChar("mqtt_qos", config.mqtt_qos);
+  preferences.putUChar("inflight", config.mqtt_inflight);
+  preferences.putString("rx_filter", config.mqtt_rx_filter);
+  preferences.putUChar("disp_page", config.display_page);
   
   preferences.end();
   Serial.println(F("Configuration saved"));
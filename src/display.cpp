@@ -7,6 +7,7 @@
 #include "display.h"
 #include "ILI9341_Landscape.h"
 #include "nfc_reader.h"
+#include "fleet_stats.h"
 #include <Adafruit_GFX.h>
 #include <WiFi.h>
 
@@ -14,13 +15,15 @@
 static ILI9341_Landscape tft = ILI9341_Landscape(TFT_CS, TFT_DC, TFT_RST);
 
 // Display state
-static String currentUID = "";
-static bool currentTagPresent = false;
 static bool mqttConnected = false;
 
+// Local tags currently in the field (most recent first)
+static TagUID localTags[MAX_TAGS];
+static int localTagCount = 0;
+static uint32_t localTagSequence = 0;  // Increments whenever the tag list changes
+
 // Previous state for change detection (flicker reduction)
-static String prevUID = "";
-static bool prevTagPresent = false;
+static uint32_t prevLocalTagSequence = 0;
 static bool prevMqttConnected = false;
 static uint32_t prevTotalScans = 0;
 static uint32_t prevSuccessfulReads = 0;
@@ -34,6 +37,13 @@ static int mqttHistoryCount = 0;
 static uint32_t mqttSequence = 0;  // Sequence number - increments on every new message
 static uint32_t prevMqttSequence = 0;
 
+// Page shown (DISPLAY_PAGE_CYCLE switches between the two)
+static uint8_t pageMode = DISPLAY_PAGE_MAIN;
+static uint8_t shownPage = DISPLAY_PAGE_MAIN;
+static bool fleetDrawn = false;
+static uint32_t prevFleetSequence = 0;
+static uint32_t prevFleetSecond = 0;
+
 // MQTT broker config
 static String mqttBroker = "";
 static uint16_t mqttPort = 1883;
@@ -197,10 +207,47 @@ void displayStatus(const char* status) {
   tft.println(status);
 }
 
-void displayTag(const char* uid, bool present) {
-  currentUID = String(uid);
-  currentTagPresent = present;
-  updateDisplay();
+void displayTag(TagUID uid, bool present) {
+  // Find tag in local list
+  int index = -1;
+  for (int i = 0; i < localTagCount; i++) {
+    if (localTags[i] == uid) {
+      index = i;
+      break;
+    }
+  }
+  
+  if (present && index < 0) {
+    // New tag - shift list down and add at top (oldest drops off if full)
+    int last = (localTagCount < MAX_TAGS) ? localTagCount : MAX_TAGS - 1;
+    for (int i = last; i > 0; i--) {
+      localTags[i] = localTags[i-1];
+    }
+    localTags[0] = uid;
+    if (localTagCount < MAX_TAGS) localTagCount++;
+    localTagSequence++;
+  } else if (!present && index >= 0) {
+    // Tag removed - close the gap
+    for (int i = index; i < localTagCount - 1; i++) {
+      localTags[i] = localTags[i+1];
+    }
+    localTagCount--;
+    localTags[localTagCount].value = 0;
+    localTagSequence++;
+  }
+}
+
+void displayTagEvent(const TagEventInfo& event) {
+  if (event.event == TAG_PRESENT) return;  // Only enter/leave change the list
+  displayTag(event.uid, event.event == TAG_ENTER);
+}
+
+bool displayTagsChanged() {
+  return localTagSequence != prevLocalTagSequence;
+}
+
+void setDisplayPage(uint8_t page) {
+  pageMode = (page <= DISPLAY_PAGE_CYCLE) ? page : DISPLAY_PAGE_MAIN;
 }
 
 void setMqttStatus(bool connected) {
@@ -220,7 +267,7 @@ void addMqttMessage(const char* uid, uint8_t sensor, char direction) {
   }
   
   // Add new message at top
-  mqttHistory[0].uid = String(uid);
+  strlcpy(mqttHistory[0].uid, uid, sizeof(mqttHistory[0].uid));
   mqttHistory[0].sensor = sensor;
   mqttHistory[0].direction = direction;
   mqttHistory[0].timestamp = millis();
@@ -237,12 +284,15 @@ void addMqttMessage(const char* uid, uint8_t sensor, char direction) {
 }
 
 // Getter functions for web display
-String getCurrentUID() {
-  return currentUID;
+int getLocalTagCount() {
+  return localTagCount;
 }
 
-bool getCurrentTagPresent() {
-  return currentTagPresent;
+TagUID getLocalTagUID(int index) {
+  if (index >= 0 && index < localTagCount) {
+    return localTags[index];
+  }
+  return TagUID{ 0 };
 }
 
 int getMqttHistoryCount() {
@@ -265,19 +315,60 @@ void clearRegion(int x, int y, int width, int height) {
 void updateLocalTagArea() {
   clearRegion(0, 0, 320, 60);  // Clear upper section
   
+  char uidStr[TAG_UID_HEX_LEN];
+  
   tft.setCursor(0, 2);
   tft.setTextSize(2);
   
-  if (currentTagPresent && currentUID.length() > 0 && currentUID != "0000000000000000") {
+  if (localTagCount == 0) {
+    tft.setTextColor(COLOR_ORANGE);
+    tft.println("Scanning...");
+  } else if (localTagCount == 1) {
     tft.setTextColor(COLOR_GREEN);
     tft.println("Local Tag Read:");
     tft.setCursor(0, 22);
     tft.setTextColor(COLOR_CYAN);
     tft.setTextSize(2);
-    tft.println(currentUID.substring(0, 16));
+    tft.println(localTags[0].toHex(uidStr));
+    
+    // First bytes of the cached tag memory
+    TagMemory memory;
+    if (getTagMemory(localTags[0], &memory) && memory.length > 0) {
+      char memHex[TAG_MEM_HEX_LEN];
+      tagMemoryToHex(memory, memHex);
+      memHex[48] = '\0';  // 24 bytes fit across the screen
+      tft.setCursor(0, 44);
+      tft.setTextSize(1);
+      tft.setTextColor(COLOR_WHITE);
+      tft.print(memHex);
+    }
   } else {
-    tft.setTextColor(COLOR_ORANGE);
-    tft.println("Scanning...");
+    tft.setTextColor(COLOR_GREEN);
+    tft.print("Local Tags Read: ");
+    tft.println(localTagCount);
+    tft.setTextColor(COLOR_CYAN);
+    
+    if (localTagCount == 2) {
+      // Two tags still fit at full size
+      tft.setCursor(0, 22);
+      tft.println(localTags[0].toHex(uidStr));
+      tft.setCursor(0, 40);
+      tft.println(localTags[1].toHex(uidStr));
+    } else {
+      // Small text grid: 3 columns x 4 rows, last cell shows overflow
+      tft.setTextSize(1);
+      for (int i = 0; i < localTagCount && i < 12; i++) {
+        tft.setCursor((i % 3) * 108, 22 + (i / 3) * 9);
+        if (i == 11 && localTagCount > 12) {
+          tft.setTextColor(COLOR_YELLOW);
+          tft.print("+");
+          tft.print(localTagCount - 11);
+          tft.print(" more");
+        } else {
+          tft.print(localTags[i].toHex(uidStr));
+        }
+      }
+    }
   }
   
   // Redraw separator
@@ -311,10 +402,12 @@ void updateMqttHistoryArea() {
       tft.setTextColor(COLOR_WHITE);
     }
     
+    // "s:255 " + 16 UID characters + " R"; the uid never holds more than
+    // 16 (strlcpy in addMqttMessage), %.16s tells the compiler so
     char line[25];
-    snprintf(line, sizeof(line), "s:%d %s %c", 
+    snprintf(line, sizeof(line), "s:%u %.16s %c", 
              mqttHistory[i].sensor, 
-             mqttHistory[i].uid.c_str(), 
+             mqttHistory[i].uid, 
              mqttHistory[i].direction);
     tft.print(line);
     y += 22;
@@ -324,6 +417,49 @@ void updateMqttHistoryArea() {
   tft.drawLine(0, 180, 320, 180, COLOR_WHITE);
 }
 
+// Helper function to update the RF quality panel (right of the MQTT header)
+// AGC now and its range over the window, then one bar per AGC band showing
+// the read success rate in that band
+void updateRFArea() {
+  NFCStatus status = getNFCStatus();
+  int x = 176;
+  int y = 66;
+  
+  clearRegion(x, 65, 320 - x, 23);
+  
+  tft.setTextSize(1);
+  tft.setCursor(x, y);
+  tft.setTextColor(COLOR_WHITE);
+  tft.print("AGC ");
+  tft.setTextColor(COLOR_GREEN);
+  tft.print(status.agcValue);
+  tft.setCursor(x, y + 10);
+  tft.setTextColor(COLOR_WHITE);
+  tft.print(status.agcMin);
+  tft.print("-");
+  tft.print(status.agcMax);
+  
+  int barX = 224;
+  int barWidth = (320 - barX) / RF_HIST_BUCKETS;
+  for (int i = 0; i < RF_HIST_BUCKETS; i++) {
+    int bx = barX + i * barWidth;
+    uint16_t scans = status.rfHistScans[i];
+    if (scans == 0) {
+      tft.drawFastHLine(bx, y + 20, barWidth - 2, COLOR_WHITE);  // No samples
+      continue;
+    }
+    uint16_t reads = status.rfHistReads[i];
+    int height = (reads * 20) / scans;
+    uint16_t color = COLOR_RED;
+    if (reads * 10 >= scans * 9) {
+      color = COLOR_GREEN;
+    } else if (reads * 2 >= scans) {
+      color = COLOR_YELLOW;
+    }
+    tft.fillRect(bx, y + 20 - height, barWidth - 2, height + 1, color);
+  }
+}
+
 // Helper function to update only scan statistics numbers (no flicker)
 void updateScanStats() {
   NFCStatus status = getNFCStatus();
@@ -390,6 +526,13 @@ void updateStatusArea() {
   if (status.initialized) {
     tft.setTextColor(COLOR_GREEN);
     tft.print("OK");
+    if (NFC_READER_COUNT > 1) {
+      // Readers answering out of those fitted
+      tft.print(" ");
+      tft.print(status.readersActive);
+      tft.print("/");
+      tft.print(NFC_READER_COUNT);
+    }
   } else {
     tft.setTextColor(COLOR_RED);
     tft.print("FAIL");
@@ -407,7 +550,12 @@ void updateStatusArea() {
   tft.setCursor(228, statusY);
   tft.print(": ");
   tft.setTextColor(COLOR_GREEN);
-  tft.print("ISO15693");
+  uint8_t protocols = getNFCProtocols();
+  if (protocols == NFC_PROTOCOLS_ALL) {
+    tft.print("15693+14443A");
+  } else {
+    tft.print(nfcProtocolName((protocols & NFC_PROTOCOL_BIT(PROTOCOL_ISO14443A)) ? PROTOCOL_ISO14443A : PROTOCOL_ISO15693));
+  }
   statusY += 10;
   
   // Scan statistics
@@ -475,7 +623,112 @@ void updateStatusArea() {
   }
 }
 
-void updateDisplay() {
+// Time since an event, in the largest unit that fits ("45s", "12m", "3h")
+static void formatAge(char* out, size_t size, uint32_t ms) {
+  uint32_t s = ms / 1000;
+  if (s < 100) {
+    snprintf(out, size, "%lus", (unsigned long)s);
+  } else if (s < 6000) {
+    snprintf(out, size, "%lum", (unsigned long)(s / 60));
+  } else {
+    snprintf(out, size, "%luh", (unsigned long)(s / 3600));
+  }
+}
+
+// A counter in at most 6 characters: as is up to 999999, then in
+// thousands ("1234k") and millions ("4294M")
+static void formatCount(char* out, size_t size, uint32_t n) {
+  if (n < 1000000UL) {
+    snprintf(out, size, "%lu", (unsigned long)n);
+  } else if (n < 100000000UL) {
+    snprintf(out, size, "%luk", (unsigned long)(n / 1000));
+  } else {
+    snprintf(out, size, "%luM", (unsigned long)(n / 1000000));
+  }
+}
+
+// Fleet page: one line per sensor seen on the broker, in ID order. Redrawn
+// on new events and once a second (rates and ages move on); text is drawn
+// with a background colour over the old line, so there is no clearing
+static void updateFleetPage() {
+  uint32_t sequence = getFleetSequence();
+  uint32_t second = millis() / 1000;
+  if (fleetDrawn && sequence == prevFleetSequence && second == prevFleetSecond) return;
+  
+  if (!fleetDrawn) {
+    tft.fillScreen(COLOR_BLACK);
+    tft.setTextSize(1);
+    tft.setTextColor(COLOR_WHITE);
+    tft.setCursor(0, 22);
+    tft.print("  ID   Read   Cont   Unrd   1s   10s   60s   Seen");
+    tft.drawLine(0, 32, 320, 32, COLOR_WHITE);
+    fleetDrawn = true;
+  }
+  prevFleetSequence = sequence;
+  prevFleetSecond = second;
+  
+  char line[54];
+  tft.setTextSize(2);
+  tft.setTextColor(COLOR_YELLOW, COLOR_BLACK);
+  tft.setCursor(0, 0);
+  snprintf(line, sizeof(line), "Fleet: %u sensors  ", getFleetSensorCount());
+  tft.print(line);
+  
+  tft.setTextSize(1);
+  int rows = 0;
+  int more = 0;
+  FleetSensorStats s;
+  for (int id = 0; id < FLEET_SENSORS; id++) {
+    if (!getFleetSensor(id, &s)) continue;
+    if (rows >= DISPLAY_FLEET_ROWS) {
+      more++;
+      continue;
+    }
+    
+    // Every column clamped to its width, so a busy sensor can't push the
+    // rest of the line off the screen
+    char reads[12], continuing[12], unreads[12], seen[8];
+    formatCount(reads, sizeof(reads), s.reads);
+    formatCount(continuing, sizeof(continuing), s.continuing);
+    formatCount(unreads, sizeof(unreads), s.unreads);
+    formatAge(seen, sizeof(seen), s.lastSeenAge);
+    snprintf(line, sizeof(line), "%4u %6.6s %6.6s %6.6s %4.0f %5.1f %5.1f %6.6s",
+             s.sensor, reads, continuing, unreads, min(s.rate1, 9999.0f),
+             min(s.rate10, 999.9f), min(s.rate60, 999.9f), seen);
+    tft.setTextColor(s.lastSeenAge < FLEET_SILENT_MS ? COLOR_GREEN : COLOR_RED, COLOR_BLACK);
+    tft.setCursor(0, 36 + rows * 10);
+    tft.print(line);
+    rows++;
+  }
+  
+  // Sensors stay in the table, so rows are only ever added - nothing to clear
+  if (more > 0) {
+    snprintf(line, sizeof(line), "+%d more - see /fleet  ", more);
+    tft.setTextColor(COLOR_WHITE, COLOR_BLACK);
+    tft.setCursor(0, 36 + rows * 10);
+    tft.print(line);
+  }
+}
+
+// Page to show now
+static uint8_t currentPage() {
+  if (pageMode != DISPLAY_PAGE_CYCLE) return pageMode;
+  return ((millis() / DISPLAY_PAGE_CYCLE_MS) % 2) ? DISPLAY_PAGE_FLEET : DISPLAY_PAGE_MAIN;
+}
+
+// Redraw only the regions that changed (caller holds the SPI bus)
+static void updateDisplayRegions() {
+  uint8_t page = currentPage();
+  if (page != shownPage) {
+    shownPage = page;
+    displayInitialized = false;  // Full redraw of whichever page comes up
+    fleetDrawn = false;
+  }
+  if (page == DISPLAY_PAGE_FLEET) {
+    updateFleetPage();
+    return;
+  }
+  
   // Get NFC status
   NFCStatus status = getNFCStatus();
   
@@ -484,11 +737,11 @@ void updateDisplay() {
     tft.fillScreen(COLOR_BLACK);
     updateLocalTagArea();
     updateMqttHistoryArea();
+    updateRFArea();
     updateStatusArea();
     
     displayInitialized = true;
-    prevUID = currentUID;
-    prevTagPresent = currentTagPresent;
+    prevLocalTagSequence = localTagSequence;
     prevMqttConnected = mqttConnected;
     prevMqttSequence = mqttSequence;
     prevTotalScans = status.totalScans;
@@ -499,7 +752,7 @@ void updateDisplay() {
   }
   
   // Check what changed and update only those regions
-  bool localTagChanged = (currentUID != prevUID) || (currentTagPresent != prevTagPresent);
+  bool localTagChanged = (localTagSequence != prevLocalTagSequence);
   bool mqttHistoryChanged = (mqttSequence != prevMqttSequence);  // Use sequence instead of count
   bool statsChanged = (status.totalScans != prevTotalScans) || 
                       (status.successfulReads != prevSuccessfulReads) ||
@@ -510,8 +763,7 @@ void updateDisplay() {
   // Update only changed sections
   if (localTagChanged) {
     updateLocalTagArea();
-    prevUID = currentUID;
-    prevTagPresent = currentTagPresent;
+    prevLocalTagSequence = localTagSequence;
   }
   
   if (mqttHistoryChanged) {
@@ -519,6 +771,11 @@ void updateDisplay() {
     prevMqttSequence = mqttSequence;  // Update sequence tracking
   }
   
+  // RF panel sits inside the MQTT area, so redraw it after that is cleared
+  if (statsChanged || mqttHistoryChanged) {
+    updateRFArea();
+  }
+  
   // Granular update for scan statistics
   if (statsChanged && !mqttStatusChanged && !nfcStatusChanged) {
     // Only stats changed - update just the numbers
@@ -536,3 +793,10 @@ void updateDisplay() {
     prevNfcInitialized = status.initialized;
   }
 }
+
+void updateDisplay() {
+  // SPI bus is shared with the PN5180 scan task
+  lockNFCBus();
+  updateDisplayRegions();
+  unlockNFCBus();
+}
@@ -8,6 +8,8 @@
 #define DISPLAY_H
 
 #include <Arduino.h>
+#include "tag_uid.h"
+#include "nfc_reader.h"
 
 // Display pin definitions
 #define TFT_CS   15  // GPIO15
@@ -24,12 +26,23 @@
 #define COLOR_YELLOW  0x07FF  // Swapped
 #define COLOR_ORANGE  0x051F  // Adjusted for BGR
 
+// Pages (config display_page). The fleet page lists every sensor seen on
+// the broker (fleet_stats.h); DISPLAY_PAGE_CYCLE alternates the two.
+#define DISPLAY_PAGE_MAIN     0
+#define DISPLAY_PAGE_FLEET    1
+#define DISPLAY_PAGE_CYCLE    2
+#define DISPLAY_PAGE_CYCLE_MS 10000  // Time on each page when cycling
+#define DISPLAY_FLEET_ROWS    19     // Sensors listed on the fleet page (+1 overflow line)
+
 // Initialize display
 void initDisplay();
 
+// Choose the page(s) shown by updateDisplay
+void setDisplayPage(uint8_t page);
+
 // MQTT message structure
 struct MqttMessage {
-  String uid;
+  char uid[TAG_UID_HEX_LEN];  // As received (other publishers may not send hex)
   uint8_t sensor;
   char direction;  // R, C, or U
   unsigned long timestamp;
@@ -53,8 +66,15 @@ void updateDisplay();
 // Display simple message
 void displayMessage(const char* msg);
 
-// Display tag information
-void displayTag(const char* uid, bool present);
+// Display tag information (adds/removes the tag from the local tag list;
+// drawn by the next updateDisplay)
+void displayTag(TagUID uid, bool present);
+
+// Tag event bus subscriber for the display
+void displayTagEvent(const TagEventInfo& event);
+
+// Has the local tag list changed since it was last drawn?
+bool displayTagsChanged();
 
 // Set MQTT connection status
 void setMqttStatus(bool connected);
@@ -65,9 +85,9 @@ void setMqttConfig(const char* broker, uint16_t port, const char* topic);
 // Add MQTT message to display history
 void addMqttMessage(const char* uid, uint8_t sensor, char direction);
 
-// Get current tag info for web display
-String getCurrentUID();
-bool getCurrentTagPresent();
+// Get local tag list for web display (most recent first)
+int getLocalTagCount();
+TagUID getLocalTagUID(int index);
 int getMqttHistoryCount();
 MqttMessage getMqttHistoryItem(int index);
 
@@ -0,0 +1,120 @@
+/*
+ * fleet_stats.cpp
+ *
+ * Per-Sensor Statistics Implementation
+ *
+ * Each sensor keeps event counts for the current second and the 10 before
+ * it (one bucket each), and for the current ten-second period and the 6
+ * before it. Before a bucket is
+ * written or read, the buckets of the seconds (and ten-second periods)
+ * that have passed since the sensor was last touched are cleared - at
+ * most 11 + 7, however long it was. Only loop() records and reads the
+ * table (mqttCallback and publishing both run there), so there is no
+ * locking.
+ *
+ * Windows cover whole seconds: rate1 is the last complete second, rate10
+ * the last 10 complete seconds, rate60 the last 6 complete ten-second
+ * periods.
+ */
+
+#include "fleet_stats.h"
+
+#define SECOND_BUCKETS  11  // 10 complete seconds + the current one
+#define TEN_BUCKETS     7   // 6 complete periods + the current one
+
+struct FleetSensor {
+  bool seen;
+  uint32_t reads;
+  uint32_t continuing;
+  uint32_t unreads;
+  unsigned long lastSeen;        // millis() of the last event
+  uint32_t second;               // Seconds since boot the buckets are current for
+  uint8_t perSecond[SECOND_BUCKETS];  // Events in second s at [s % SECOND_BUCKETS] (saturating)
+  uint16_t perTen[TEN_BUCKETS];       // Events in period p = s / 10 at [p % TEN_BUCKETS]
+};
+
+static FleetSensor sensors[FLEET_SENSORS];
+static uint16_t sensorCount = 0;
+static uint32_t fleetSequence = 0;
+
+// Clear the buckets of the seconds / periods that passed since the last touch
+static void advance(FleetSensor* s, uint32_t now) {
+  if (now == s->second) return;
+  
+  uint32_t passed = now - s->second;
+  if (passed >= SECOND_BUCKETS) {
+    memset(s->perSecond, 0, sizeof(s->perSecond));
+  } else {
+    for (uint32_t t = s->second + 1; t <= now; t++) s->perSecond[t % SECOND_BUCKETS] = 0;
+  }
+  
+  uint32_t fromTen = s->second / 10;
+  uint32_t toTen = now / 10;
+  if (toTen - fromTen >= TEN_BUCKETS) {
+    memset(s->perTen, 0, sizeof(s->perTen));
+  } else {
+    for (uint32_t p = fromTen + 1; p <= toTen; p++) s->perTen[p % TEN_BUCKETS] = 0;
+  }
+  s->second = now;
+}
+
+void recordFleetEvent(uint8_t sensor, char direction) {
+  FleetSensor* s = &sensors[sensor];
+  unsigned long now = millis();
+  uint32_t second = now / 1000;
+  
+  if (!s->seen) {
+    memset(s, 0, sizeof(*s));
+    s->seen = true;
+    s->second = second;
+    sensorCount++;
+  }
+  advance(s, second);
+  
+  if (direction == 'R') s->reads++;
+  else if (direction == 'C') s->continuing++;
+  else if (direction == 'U') s->unreads++;
+  
+  uint8_t* bucket = &s->perSecond[second % SECOND_BUCKETS];
+  if (*bucket < 255) (*bucket)++;
+  uint16_t* ten = &s->perTen[(second / 10) % TEN_BUCKETS];
+  if (*ten < 0xFFFF) (*ten)++;
+  
+  s->lastSeen = now;
+  fleetSequence++;
+}
+
+bool getFleetSensor(uint8_t sensor, FleetSensorStats* stats) {
+  FleetSensor* s = &sensors[sensor];
+  if (!s->seen) return false;
+  
+  unsigned long now = millis();
+  uint32_t second = now / 1000;
+  advance(s, second);
+  
+  // Complete seconds / periods only - the current bucket is still filling
+  uint32_t last10 = 0;
+  for (int i = 0; i < SECOND_BUCKETS; i++) last10 += s->perSecond[i];
+  last10 -= s->perSecond[second % SECOND_BUCKETS];
+  uint32_t last60 = 0;
+  for (int i = 0; i < TEN_BUCKETS; i++) last60 += s->perTen[i];
+  last60 -= s->perTen[(second / 10) % TEN_BUCKETS];
+  
+  stats->sensor = sensor;
+  stats->reads = s->reads;
+  stats->continuing = s->continuing;
+  stats->unreads = s->unreads;
+  stats->rate1 = s->perSecond[(second + SECOND_BUCKETS - 1) % SECOND_BUCKETS];
+  stats->rate10 = last10 / 10.0f;
+  stats->rate60 = last60 / 60.0f;
+  stats->lastSeenAge = now - s->lastSeen;
+  return true;
+}
+
+uint16_t getFleetSensorCount() {
+  return sensorCount;
+}
+
+uint32_t getFleetSequence() {
+  return fleetSequence;
+}
@@ -0,0 +1,45 @@
+/*
+ * fleet_stats.h
+ *
+ * Per-Sensor Statistics from MQTT Traffic
+ * Every tag event seen on the broker (other sensors' as received, this
+ * reader's as sent) is counted against its sensor ID, so one reader can
+ * show which sensors on the floor are busy and which have gone quiet.
+ *
+ * Fixed table indexed by sensor ID (no search, no heap). Rates come from
+ * per-second and per-10-second buckets that are rotated lazily when a
+ * sensor is next touched, so recording an event is O(1).
+ */
+
+#ifndef FLEET_STATS_H
+#define FLEET_STATS_H
+
+#include <Arduino.h>
+
+#define FLEET_SENSORS      256   // Sensor IDs 0-255 (0 = publisher without "s")
+#define FLEET_SILENT_MS    60000 // No events for this long = silent (shown red)
+
+struct FleetSensorStats {
+  uint8_t sensor;
+  uint32_t reads;                // Events by direction
+  uint32_t continuing;
+  uint32_t unreads;
+  float rate1;                   // Events/s over the last 1, 10 and 60 s
+  float rate10;
+  float rate60;
+  uint32_t lastSeenAge;          // ms since the last event
+};
+
+// Count one event ('R', 'C' or 'U'; anything else counts towards the rates only)
+void recordFleetEvent(uint8_t sensor, char direction);
+
+// Statistics of a sensor (false = never seen)
+bool getFleetSensor(uint8_t sensor, FleetSensorStats* stats);
+
+// Sensors seen since boot
+uint16_t getFleetSensorCount();
+
+// Increments on every recorded event (display redraw check)
+uint32_t getFleetSequence();
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * le_bytes.h
+ *
+ * Little-Endian Field Helpers
+ * 32-bit fields in the fixed binary layouts: the MQTT binary payload
+ * (mqtt_handler.h) and the store-and-forward queue records (mqtt_queue.cpp).
+ */
+
+#ifndef LE_BYTES_H
+#define LE_BYTES_H
+
+#include <Arduino.h>
+
+static inline void putU32(uint8_t* out, uint32_t value) {
+  out[0] = (uint8_t)value;
+  out[1] = (uint8_t)(value >> 8);
+  out[2] = (uint8_t)(value >> 16);
+  out[3] = (uint8_t)(value >> 24);
+}
+
+static inline uint32_t getU32(const uint8_t* in) {
+  return in[0] | (in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * mqtt_filter.cpp
+ *
+ * Topic Filter Trie Implementation
+ *
+ * Node 0 is the root; every other node is one topic level of one or more
+ * patterns, labelled by a slice of the compiled filter text. Children
+ * are a singly linked sibling list (a handful per level at most), and a
+ * node where a pattern ends carries that pattern's allow/deny flag.
+ */
+
+#include "mqtt_filter.h"
+
+#define FILTER_ALLOW  0x01
+#define FILTER_DENY   0x02
+#define NO_NODE       -1
+
+struct FilterNode {
+  const char* label;             // Level text in filterText ("+" / "#" for wildcards)
+  uint8_t labelLength;
+  int8_t child;                  // First child (NO_NODE = none)
+  int8_t sibling;                // Next child of the same parent
+  uint8_t flags;                 // FILTER_ALLOW / FILTER_DENY - a pattern ends here
+};
+
+static char filterText[MQTT_FILTER_LEN];
+static FilterNode nodes[MQTT_FILTER_NODES];
+static uint8_t nodeCount = 0;
+static bool hasAllow = false;    // Some pattern is an allow (else everything not denied passes)
+
+static int addNode(const char* label, uint8_t length) {
+  if (nodeCount >= MQTT_FILTER_NODES) return NO_NODE;
+  FilterNode* node = &nodes[nodeCount];
+  node->label = label;
+  node->labelLength = length;
+  node->child = NO_NODE;
+  node->sibling = NO_NODE;
+  node->flags = 0;
+  return nodeCount++;
+}
+
+// Child of parent with this label, added if missing
+static int childNode(int parent, const char* label, uint8_t length) {
+  for (int i = nodes[parent].child; i != NO_NODE; i = nodes[i].sibling) {
+    if (nodes[i].labelLength == length && memcmp(nodes[i].label, label, length) == 0) return i;
+  }
+  int node = addNode(label, length);
+  if (node == NO_NODE) return NO_NODE;
+  nodes[node].sibling = nodes[parent].child;
+  nodes[parent].child = node;
+  return node;
+}
+
+int compileMqttFilter(const char* filter) {
+  strlcpy(filterText, filter ? filter : "", sizeof(filterText));
+  nodeCount = 0;
+  hasAllow = false;
+  addNode("", 0);
+  
+  int patterns = 0;
+  char* p = filterText;
+  while (*p) {
+    // One pattern: up to the next comma, spaces trimmed
+    while (*p == ' ' || *p == ',') p++;
+    if (!*p) break;
+    char* end = p;
+    while (*end && *end != ',') end++;
+    char* last = end;
+    while (last > p && last[-1] == ' ') last--;
+    
+    uint8_t flag = FILTER_ALLOW;
+    if (*p == '!') {
+      flag = FILTER_DENY;
+      p++;
+    }
+    
+    int node = 0;
+    const char* level = p;
+    while (node != NO_NODE) {
+      const char* levelEnd = level;
+      while (levelEnd < last && *levelEnd != '/') levelEnd++;
+      node = childNode(node, level, levelEnd - level);
+      if (levelEnd >= last) break;
+      level = levelEnd + 1;
+    }
+    if (node == NO_NODE) {
+      Serial.println(F("MQTT receive filter too long - accepting all topics"));
+      nodeCount = 0;
+      hasAllow = false;
+      return -1;
+    }
+    
+    nodes[node].flags |= flag;
+    if (flag == FILTER_ALLOW) hasAllow = true;
+    patterns++;
+    p = end;
+  }
+  return patterns;
+}
+
+// Flags of every pattern matching the topic from this node on (level =
+// start of the next topic level, nullptr once the topic is used up)
+static uint8_t matchFrom(int node, const char* level) {
+  uint8_t flags = 0;
+  size_t length = 0;
+  const char* next = nullptr;
+  if (level) {
+    const char* slash = strchr(level, '/');
+    length = slash ? slash - level : strlen(level);
+    next = slash ? slash + 1 : nullptr;
+  }
+  
+  for (int i = nodes[node].child; i != NO_NODE; i = nodes[i].sibling) {
+    const FilterNode* child = &nodes[i];
+    if (child->labelLength == 1 && child->label[0] == '#') {
+      flags |= child->flags;  // Rest of the topic, including the parent level
+      continue;
+    }
+    if (!level) continue;
+    bool plus = child->labelLength == 1 && child->label[0] == '+';
+    if (plus || (child->labelLength == length && memcmp(child->label, level, length) == 0)) {
+      if (!next) flags |= child->flags;
+      flags |= matchFrom(i, next);
+    }
+  }
+  return flags;
+}
+
+bool mqttTopicAllowed(const char* topic) {
+  if (nodeCount <= 1) return true;
+  
+  uint8_t flags = matchFrom(0, topic);
+  if (flags & FILTER_DENY) return false;
+  return !hasAllow || (flags & FILTER_ALLOW);
+}
@@ -0,0 +1,31 @@
+/*
+ * mqtt_filter.h
+ *
+ * Topic Filter for Received MQTT Messages
+ * Decides, before any payload parsing, whether a message on the
+ * subscribed topic is wanted. The filter is a comma-separated list of
+ * MQTT topic filters (+ and # wildcards); a leading ! makes a pattern a
+ * deny. A topic passes if no deny pattern matches it and, when there are
+ * allow patterns, at least one of them does. Example:
+ *   rfid/#,!rfid/Continuing,!rfid/+/debug
+ *
+ * The patterns are compiled into a small trie of topic levels, so a
+ * topic is matched level by level against all patterns at once.
+ */
+
+#ifndef MQTT_FILTER_H
+#define MQTT_FILTER_H
+
+#include <Arduino.h>
+
+#define MQTT_FILTER_LEN    96   // Filter text (config mqtt_rx_filter)
+#define MQTT_FILTER_NODES  32   // Trie nodes (one per distinct topic level)
+
+// Compile a filter (empty = accept everything). Returns the number of
+// patterns, or -1 if it didn't fit (everything is accepted then).
+int compileMqttFilter(const char* filter);
+
+// Whether a received topic passes the filter
+bool mqttTopicAllowed(const char* topic);
+
+#endif
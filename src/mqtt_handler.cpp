@@ -6,7 +6,14 @@
 
 #include "mqtt_handler.h"
 #include "display.h"
+#include "nfc_reader.h"
+#include "mqtt_queue.h"
+#include "mqtt_inflight.h"
+#include "mqtt_filter.h"
+#include "fleet_stats.h"
+#include "le_bytes.h"
 #include <ArduinoJson.h>
+#include <lwip/sockets.h>
 
 // Forward declare the Config structure
 struct Config {
@@ -17,28 +24,172 @@ struct Config {
   char mqtt_base_topic[64];
   char mqtt_subscribe_topic[64];
   uint8_t sensor_id;
+  uint16_t scan_min_interval;
+  uint16_t scan_max_interval;
+  uint8_t debounce_mode;
+  uint8_t debounce_enter;
+  uint8_t debounce_window;
+  uint8_t debounce_leave;
+  uint8_t debounce_timeout;
+  uint8_t mqtt_tag_memory;   // 1 = add tag memory hex ("m") to Read messages
+  uint16_t lpcd_quiet;       // Seconds of empty field before LPCD idle (0 = off)
+  uint8_t protocols;         // Protocols to scan (NFC_PROTOCOL_BIT mask)
+  uint16_t continuing_interval;  // Seconds between Continuing messages per tag (0 = off)
+  uint16_t mqtt_batch_ms;    // Batch window in ms (0 = one message per event)
+  uint8_t mqtt_batch_max;    // Events per batch (1..MQTT_BATCH_MAX)
+  uint8_t mqtt_format;       // MQTT_FORMAT_JSON or MQTT_FORMAT_BINARY
+  uint8_t mqtt_qos;          // 0, or 1 = wait for PUBACK (see mqtt_inflight.h)
+  uint8_t mqtt_inflight;     // QoS 1 messages outstanding at once (1..MQTT_INFLIGHT_MAX)
+  char mqtt_rx_filter[96];   // Received topic allow/deny patterns (see mqtt_filter.h)
+  uint8_t display_page;      // DISPLAY_PAGE_MAIN, _FLEET or _CYCLE
 };
 
 // Module-level pointers
 static PubSubClient* mqttClient = nullptr;
 static Config* config = nullptr;
-static uint32_t mqttPublished = 0;
+static uint32_t mqttPublished = 0;  // Tag events sent (live and from the queue)
+static unsigned long lastQueueDrain = 0;
 
-void initMqttHandler(PubSubClient* client, Config* cfg) {
+// Connection state machine (processMqttConnection)
+static WiFiClient* netClient = nullptr;
+static MqttConnectionState connState = MQTT_CONN_WAITING;
+static int connectFd = -1;               // Socket while the TCP connect is in progress
+static unsigned long attemptStart = 0;
+static unsigned long retryStart = 0;
+static uint32_t retryDelay = 0;
+static uint32_t attempts = 0;
+static uint32_t successfulConnects = 0;
+static uint32_t failedAttempts = 0;      // Consecutive (sets the backoff)
+static uint32_t connectingTime = 0;
+static uint32_t longestStall = 0;
+
+// Publish topics and client ID, built once from the config (refreshMqttConfig)
+enum PublishTopic { TOPIC_READ, TOPIC_CONTINUING, TOPIC_UNREAD, TOPIC_BATCH, TOPIC_COUNT };
+static char topics[TOPIC_COUNT][MQTT_TOPIC_LEN];
+static char clientId[24];
+static char ownSensorKey[8];     // "s":<sensor_id> - spots our own JSON coming back
+static uint8_t ownSensorKeyLength = 0;
+
+// Payload of a single-event message (JSON or binary)
+static char payloadBuffer[96 + TAG_MEM_HEX_LEN];
+
+// Received messages - only the fields the history needs are kept, so a
+// batch full of tag memory still fits
+static StaticJsonDocument<MQTT_BATCH_JSON_SIZE> rxDoc;
+static StaticJsonDocument<128> rxFilter;
+
+void initMqttHandler(PubSubClient* client, WiFiClient* net, Config* cfg) {
   mqttClient = client;
+  netClient = net;
   config = cfg;
   
   if (mqttClient && config) {
     mqttClient->setServer(config->mqtt_broker, config->mqtt_port);
     mqttClient->setCallback(mqttCallback);
+    mqttClient->setClient(*initMqttInflight(netClient));  // Sees PUBACKs for QoS 1
+    setMqttInflightWindow(config->mqtt_inflight);
+    mqttClient->setBufferSize(MQTT_BUFFER_SIZE);  // Room for a [base]/Batch message
+    mqttClient->setKeepAlive(MQTT_KEEPALIVE_SECONDS);
+    mqttClient->setSocketTimeout(MQTT_HANDSHAKE_TIMEOUT);
+    refreshMqttConfig();
+    
+    rxFilter["u"] = true;
+    rxFilter["s"] = true;
+    rxFilter["R"] = true;
+    rxFilter["e"][0]["u"] = true;
+    rxFilter["e"][0]["R"] = true;
     Serial.println(F("MQTT handler initialized"));
   }
 }
 
-void reconnectMQTT() {
-  if (!mqttClient || !config) return;
+void refreshMqttConfig() {
+  if (!config) return;
+  
+  static const char* const names[TOPIC_COUNT] = { "Read", "Continuing", "Unread", "Batch" };
+  for (int i = 0; i < TOPIC_COUNT; i++) {
+    snprintf(topics[i], MQTT_TOPIC_LEN, "%s/%s", config->mqtt_base_topic, names[i]);
+  }
+  snprintf(clientId, sizeof(clientId), "ESP32-RFID-%u", config->sensor_id);
+  ownSensorKeyLength = snprintf(ownSensorKey, sizeof(ownSensorKey), "\"s\":%u", config->sensor_id);
+  compileMqttFilter(config->mqtt_rx_filter);
+}
+
+// Broker IP (resolved once, again after a failed attempt)
+static IPAddress brokerIp;
+static bool brokerResolved = false;
+
+// Mark the attempt failed and schedule the next one
+static void failConnect(const __FlashStringHelper* reason, int rc = 0) {
+  if (connectFd >= 0) {
+    close(connectFd);
+    connectFd = -1;
+  }
+  connectingTime += millis() - attemptStart;
+  failedAttempts++;
+  brokerResolved = false;
+  
+  uint32_t backoff = MQTT_BACKOFF_MAX;
+  if (failedAttempts < 16) {
+    backoff = min((uint32_t)MQTT_BACKOFF_MIN << (failedAttempts - 1), (uint32_t)MQTT_BACKOFF_MAX);
+  }
+  retryDelay = backoff / 2 + random(backoff / 2 + 1);
+  retryStart = millis();
+  connState = MQTT_CONN_WAITING;
+  
+  Serial.print(F("failed ("));
+  Serial.print(reason);
+  if (rc != 0) {
+    Serial.print(F(" rc="));
+    Serial.print(rc);
+  }
+  Serial.print(F("), retry in "));
+  Serial.print(retryDelay);
+  Serial.println(F(" ms"));
+}
+
+// TCP is up - hand the socket to the WiFiClient and do the MQTT handshake
+static void finishConnect() {
+  int fd = connectFd;
+  connectFd = -1;
+  
+  // Back to blocking with bounded send/receive, like WiFiClient::connect()
+  struct timeval tv;
+  tv.tv_sec = MQTT_HANDSHAKE_TIMEOUT;
+  tv.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+  
+  netClient->stop();
+  *netClient = WiFiClient(fd);
+  mqttInflightConnected();  // Unacknowledged QoS 1 messages go again
+  
+  if (!mqttClient->connect(clientId)) {
+    failConnect(F("handshake"), mqttClient->state());
+    return;
+  }
   
-  if (mqttClient->connected()) return;
+  connectingTime += millis() - attemptStart;
+  successfulConnects++;
+  failedAttempts = 0;
+  connState = MQTT_CONN_CONNECTED;
+  Serial.println(F("connected"));
+  
+  // Subscribe to configured topic
+  if (strlen(config->mqtt_subscribe_topic) > 0) {
+    mqttClient->subscribe(config->mqtt_subscribe_topic);
+    Serial.print(F("Subscribed to: "));
+    Serial.println(config->mqtt_subscribe_topic);
+  }
+  setMqttStatus(true);
+}
+
+// Start an attempt: resolve the broker and begin a non-blocking TCP connect
+static void startConnect() {
+  attempts++;
+  attemptStart = millis();
   
   Serial.print(F("Attempting MQTT connection to "));
   Serial.print(config->mqtt_broker);
@@ -46,96 +197,626 @@ void reconnectMQTT() {
   Serial.print(config->mqtt_port);
   Serial.print(F("..."));
   
-  // Create client ID
-  String clientId = "ESP32-RFID-";
-  clientId += String(config->sensor_id);
-  
-  if (mqttClient->connect(clientId.c_str())) {
-    Serial.println(F("connected"));
-    
-    // Subscribe to configured topic
-    if (strlen(config->mqtt_subscribe_topic) > 0) {
-      mqttClient->subscribe(config->mqtt_subscribe_topic);
-      Serial.print(F("Subscribed to: "));
-      Serial.println(config->mqtt_subscribe_topic);
+  // A DNS lookup blocks, so the address is kept until an attempt fails
+  if (!brokerResolved) {
+    if (!brokerIp.fromString(config->mqtt_broker) &&
+        !WiFi.hostByName(config->mqtt_broker, brokerIp)) {
+      failConnect(F("DNS"));
+      return;
     }
-    
-    setMqttStatus(true);
+    brokerResolved = true;
+  }
+  
+  connectFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (connectFd < 0) {
+    failConnect(F("socket"));
+    return;
+  }
+  fcntl(connectFd, F_SETFL, fcntl(connectFd, F_GETFL, 0) | O_NONBLOCK);
+  
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = (uint32_t)brokerIp;
+  addr.sin_port = htons(config->mqtt_port);
+  
+  if (connect(connectFd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+    finishConnect();
+  } else if (errno == EINPROGRESS) {
+    connState = MQTT_CONN_TCP;
   } else {
-    Serial.print(F("failed, rc="));
-    Serial.println(mqttClient->state());
-    setMqttStatus(false);
+    failConnect(F("connect"));
   }
 }
 
-void publishTag(const char* uid, const char* event) {
-  if (!mqttClient || !config) return;
-  if (!mqttClient->connected()) return;
+// TCP connect in progress - check it without waiting
+static void pollConnect() {
+  fd_set writable;
+  FD_ZERO(&writable);
+  FD_SET(connectFd, &writable);
+  struct timeval noWait = { 0, 0 };
   
-  String topic = String(config->mqtt_base_topic) + "/" + event;
+  if (select(connectFd + 1, nullptr, &writable, nullptr, &noWait) <= 0) {
+    if (millis() - attemptStart >= MQTT_CONNECT_TIMEOUT) {
+      failConnect(F("timeout"));
+    }
+    return;
+  }
   
-  StaticJsonDocument<200> doc;
-  doc["u"] = uid;          // UID (shortened)
-  doc["s"] = config->sensor_id;  // Sensor ID (shortened)
+  int error = 0;
+  socklen_t len = sizeof(error);
+  if (getsockopt(connectFd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0) {
+    failConnect(F("refused"));
+    return;
+  }
+  finishConnect();
+}
+
+void processMqttConnection() {
+  if (!mqttClient || !netClient || !config) return;
+  
+  unsigned long stepStart = millis();
+  switch (connState) {
+    case MQTT_CONN_CONNECTED:
+      if (mqttClient->connected()) return;
+      Serial.print(F("MQTT connection lost, rc="));
+      Serial.println(mqttClient->state());
+      setMqttStatus(false);
+      connState = MQTT_CONN_WAITING;
+      retryStart = millis();
+      retryDelay = 0;  // First retry right away, backoff after that
+      return;
+      
+    case MQTT_CONN_WAITING:
+      if (WiFi.status() != WL_CONNECTED || millis() - retryStart < retryDelay) return;
+      startConnect();
+      break;
+      
+    case MQTT_CONN_TCP:
+      pollConnect();
+      break;
+  }
+  
+  uint32_t stall = millis() - stepStart;
+  if (stall > longestStall) longestStall = stall;
+}
+
+MqttConnectionStats getMqttConnectionStats() {
+  MqttConnectionStats stats;
+  stats.state = connState;
+  stats.attempts = attempts;
+  stats.connects = successfulConnects;
+  stats.failures = failedAttempts;
+  stats.connectingTime = connectingTime;
+  stats.longestStall = longestStall;
+  stats.retryIn = 0;
+  if (connState == MQTT_CONN_WAITING) {
+    uint32_t waited = millis() - retryStart;
+    if (waited < retryDelay) stats.retryIn = retryDelay - waited;
+  }
+  return stats;
+}
+
+// Text for one tag's JSON fields (the document stores these by pointer,
+// so they must live until it is serialized)
+struct TagText {
+  char uid[TAG_UID_HEX_LEN];
+  char memory[TAG_MEM_HEX_LEN];
+  char direction[2];
+};
+
+// One event waiting in the current batch
+struct BatchSlot {
+  QueuedPublish item;
+  TagText text;
+};
+
+// Batch being collected for [base]/Batch (see MQTT_BATCH_MAX)
+static StaticJsonDocument<MQTT_BATCH_JSON_SIZE> batchDoc;
+static JsonArray batchEvents;
+static BatchSlot batch[MQTT_BATCH_MAX];
+static uint8_t batchCount = 0;
+static unsigned long batchStart = 0;
+static char batchPayload[MQTT_BATCH_PAYLOAD_MAX];
+
+// Publish statistics
+static uint32_t mqttMessages = 0;   // MQTT publishes (a batch is one)
+static uint32_t batchesSent = 0;
+static uint32_t payloadBytes = 0;
+static unsigned long rateWindowStart = 0;
+static uint32_t rateWindowCount = 0;
+static float publishRate = 0;
+
+// Publish at the configured QoS - a QoS 1 message is held (and resent)
+// until its PUBACK; false means the window is full or the write failed
+static bool publishPayload(const char* topic, const uint8_t* payload, size_t length) {
+  if (config->mqtt_qos == 1) return mqttInflightPublish(topic, payload, length);
+  return mqttClient->publish(topic, payload, length, false);
+}
+
+// A tag event seen on the broker: display history and fleet statistics
+static void addBrokerEvent(const char* uid, uint8_t sensor, char direction) {
+  addMqttMessage(uid, sensor, direction);
+  recordFleetEvent(sensor, direction);
+}
+
+// Our own events go into the display history as they are sent; the
+// broker's echo of them is dropped in mqttCallback before parsing
+static void addOwnMessage(const QueuedPublish& item) {
+  char uid[TAG_UID_HEX_LEN];
+  item.uid.toHex(uid);
+  addBrokerEvent(uid, config->sensor_id, item.event);
+}
+
+// Count one successful publish carrying this many tag events
+static void countPublish(uint8_t events, size_t bytes) {
+  mqttMessages++;
+  mqttPublished += events;
+  payloadBytes += bytes;
+  
+  unsigned long now = millis();
+  if (now - rateWindowStart >= MQTT_RATE_WINDOW) {
+    publishRate = rateWindowCount * 1000.0f / (now - rateWindowStart);
+    rateWindowStart = now;
+    rateWindowCount = 0;
+  }
+  rateWindowCount++;
+}
+
+// Fields of one tag event (withSensor = false inside a batch, which has one "s")
+static void addTagFields(JsonObject obj, const QueuedPublish& item, bool queued, bool withSensor,
+                         TagText* text) {
+  item.uid.toHex(text->uid);
+  text->direction[0] = item.event;
+  text->direction[1] = 0;
+  
+  obj["u"] = (const char*)text->uid;  // UID (shortened, stored by pointer)
+  if (withSensor) {
+    obj["s"] = config->sensor_id;  // Sensor ID (shortened)
+  }
+  if (NFC_READER_COUNT > 1) {
+    obj["r"] = item.reader;  // Reader index (only sent with several readers)
+  }
+  if (config->protocols & NFC_PROTOCOL_BIT(PROTOCOL_ISO14443A)) {
+    obj["p"] = (item.protocol == PROTOCOL_ISO14443A) ? "A" : "V";  // Protocol (only sent with Type A on)
+  }
   
   // Read direction: R=Read, C=Continuing, U=Unread
-  if (strcmp(event, "Read") == 0) {
-    doc["R"] = "R";
-  } else if (strcmp(event, "Continuing") == 0) {
-    doc["R"] = "C";
-  } else if (strcmp(event, "Unread") == 0) {
-    doc["R"] = "U";
+  obj["R"] = (const char*)text->direction;
+  if (item.event == 'R') {
+    // Tag memory is already cached by the reader - no RF access here
+    TagMemory memory;
+    if (config->mqtt_tag_memory && getTagMemory(item.uid, &memory) && memory.length > 0) {
+      obj["m"] = (const char*)tagMemoryToHex(memory, text->memory);
+    }
+  }
+  
+  // How long the tag was in the field
+  if (item.event == 'U' && item.dwell > 0) {
+    obj["d"] = item.dwell;
+  }
+  
+  // Queued events carry when they happened (reader millis) and, from this boot, their age
+  if (queued) {
+    obj["t"] = item.time;
+    if (!item.previousBoot) {
+      obj["a"] = millis() - item.time;
+    }
   }
+}
+
+// Fixed binary record for one event (layout in mqtt_handler.h)
+static void encodeBinary(const QueuedPublish& item, bool queued, uint8_t* out) {
+  uint8_t flags = item.reader & MQTT_BINARY_READER_MASK;
+  if (queued) flags |= MQTT_BINARY_FLAG_QUEUED;
+  if (item.protocol == PROTOCOL_ISO14443A) flags |= MQTT_BINARY_FLAG_TYPE_A;
   
-  String payload;
-  serializeJson(doc, payload);
+  out[0] = MQTT_BINARY_MARKER;
+  out[1] = (uint8_t)item.event;
+  out[2] = config->sensor_id;
+  out[3] = flags;
+  item.uid.toBytes(&out[4]);
+  putU32(&out[12], item.time);
+  putU32(&out[16], !queued ? 0 : item.previousBoot ? MQTT_BINARY_AGE_UNKNOWN : millis() - item.time);
+  putU32(&out[20], item.event == 'U' ? item.dwell : 0);
+}
+
+// Build and send one tag message (queued = from the store-and-forward queue)
+static bool sendTag(const QueuedPublish& item, bool queued) {
+  // Precomputed topic and static payload buffer - nothing is allocated per event
+  const char* topic = topics[(item.event == 'R') ? TOPIC_READ :
+                             (item.event == 'C') ? TOPIC_CONTINUING : TOPIC_UNREAD];
   
-  if (mqttClient->publish(topic.c_str(), payload.c_str())) {
-    mqttPublished++;
-    Serial.print(F("MQTT: "));
+  if (config->mqtt_format == MQTT_FORMAT_BINARY) {
+    // Record, then the cached tag memory as raw bytes (Read only)
+    uint8_t* packet = (uint8_t*)payloadBuffer;
+    size_t length = MQTT_BINARY_RECORD;
+    encodeBinary(item, queued, packet);
+    TagMemory memory;
+    if (item.event == 'R' && config->mqtt_tag_memory && getTagMemory(item.uid, &memory)) {
+      memcpy(&packet[length], memory.data, memory.length);
+      length += memory.length;
+    }
+    
+    if (!publishPayload(topic, packet, length)) return false;
+    
+    countPublish(1, length);
+    addOwnMessage(item);
+    Serial.print(queued ? F("MQTT (queued): ") : F("MQTT: "));
     Serial.print(topic);
     Serial.print(F(" -> "));
-    Serial.println(payload);
+    Serial.print(length);
+    Serial.println(F(" bytes (binary)"));
+    return true;
+  }
+  
+  TagText text;
+  StaticJsonDocument<200> doc;
+  addTagFields(doc.to<JsonObject>(), item, queued, true, &text);
+  
+  size_t length = serializeJson(doc, payloadBuffer, sizeof(payloadBuffer));
+  
+  if (!publishPayload(topic, (const uint8_t*)payloadBuffer, length)) return false;
+  
+  countPublish(1, length);
+  addOwnMessage(item);
+  Serial.print(queued ? F("MQTT (queued): ") : F("MQTT: "));
+  Serial.print(topic);
+  Serial.print(F(" -> "));
+  Serial.println(payloadBuffer);
+  return true;
+}
+
+// Send the collected batch as one [base]/Batch message; if that isn't
+// possible its events go to the store-and-forward queue
+static void flushBatch() {
+  if (batchCount == 0) return;
+  uint8_t count = batchCount;
+  batchCount = 0;
+  
+  if (mqttClient->connected()) {
+    const char* topic = topics[TOPIC_BATCH];
     
-    // Don't add here - we'll receive it back via mqttCallback which avoids duplicates
+    size_t length;
+    if (config->mqtt_format == MQTT_FORMAT_BINARY) {
+      // Batch header, then one record per event (no tag memory)
+      uint8_t* out = (uint8_t*)batchPayload;
+      out[0] = MQTT_BINARY_BATCH_MARKER;
+      out[1] = count;
+      length = 2;
+      for (uint8_t i = 0; i < count; i++) {
+        encodeBinary(batch[i].item, false, &out[length]);
+        length += MQTT_BINARY_RECORD;
+      }
+    } else {
+      length = serializeJson(batchDoc, batchPayload, sizeof(batchPayload));
+    }
+    
+    if (publishPayload(topic, (const uint8_t*)batchPayload, length)) {
+      countPublish(count, length);
+      batchesSent++;
+      for (uint8_t i = 0; i < count; i++) {
+        addOwnMessage(batch[i].item);
+      }
+      Serial.print(F("MQTT: "));
+      Serial.print(topic);
+      Serial.print(F(" -> "));
+      Serial.print(count);
+      Serial.print(F(" events, "));
+      Serial.print(length);
+      Serial.println(F(" bytes"));
+      return;
+    }
+  }
+  
+  for (uint8_t i = 0; i < count; i++) {
+    mqttQueuePush(batch[i].item);
+  }
+}
+
+// Add an event to the batch, sending it once full (count or payload size)
+static void addToBatch(const QueuedPublish& item) {
+  if (batchCount == 0) {
+    batchDoc.clear();
+    batchDoc["s"] = config->sensor_id;
+    batchEvents = batchDoc.createNestedArray("e");
+    batchStart = millis();
+  }
+  
+  BatchSlot* slot = &batch[batchCount];
+  slot->item = item;
+  if (config->mqtt_format == MQTT_FORMAT_BINARY) {
+    // Records are fixed size - a full binary batch always fits
+    if (++batchCount >= constrain(config->mqtt_batch_max, 1, MQTT_BATCH_MAX)) {
+      flushBatch();
+    }
+    return;
+  }
+  addTagFields(batchEvents.createNestedObject(), item, false, false, &slot->text);
+  
+  if (batchDoc.overflowed() || measureJson(batchDoc) > MQTT_BATCH_PAYLOAD_MAX) {
+    // Doesn't fit - send what came before and start the next batch with it
+    batchEvents.remove(batchEvents.size() - 1);
+    if (batchCount == 0) {
+      if (!sendTag(item, false)) mqttQueuePush(item);
+      return;
+    }
+    flushBatch();
+    addToBatch(item);
+    return;
+  }
+  
+  batchCount++;
+  if (batchCount >= constrain(config->mqtt_batch_max, 1, MQTT_BATCH_MAX)) {
+    flushBatch();
+  }
+}
+
+bool publishTag(TagUID uid, const char* event, uint8_t reader, uint8_t protocol,
+                unsigned long dwell, unsigned long time) {
+  if (!mqttClient || !config) return false;
+  
+  QueuedPublish item;
+  item.time = time;  // When it happened, not when loop() got to it
+  item.event = event[0];  // Read/Continuing/Unread -> R/C/U
+  item.reader = reader;
+  item.protocol = protocol;
+  item.previousBoot = false;
+  item.uid = uid;
+  item.dwell = dwell;
+  
+  // Live events go straight out (or into the batch) even while a backlog drains
+  if (mqttClient->connected()) {
+    if (config->mqtt_batch_ms > 0) {
+      addToBatch(item);
+      return true;
+    }
+    if (sendTag(item, false)) return true;
+  }
+  
+  // Broker unreachable - keep it for later
+  mqttQueuePush(item);
+  return false;
+}
+
+void processMqttBatch() {
+  if (!mqttClient || !config || batchCount == 0) return;
+  
+  // Window over (or batching switched off) - send what we have
+  if (config->mqtt_batch_ms == 0 || millis() - batchStart >= config->mqtt_batch_ms) {
+    flushBatch();
+  }
+}
+
+MqttPublishStats getMqttPublishStats() {
+  MqttPublishStats stats;
+  stats.messages = mqttMessages;
+  stats.events = mqttPublished;
+  stats.batches = batchesSent;
+  stats.bytes = payloadBytes;
+  stats.eventsPerPublish = mqttMessages ? (float)mqttPublished / mqttMessages : 0;
+  
+  // Last full window; nothing published lately means 0
+  unsigned long sinceWindow = millis() - rateWindowStart;
+  if (sinceWindow >= 2 * MQTT_RATE_WINDOW) {
+    stats.publishRate = 0;
+  } else if (publishRate == 0 && sinceWindow > 0) {
+    stats.publishRate = rateWindowCount * 1000.0f / sinceWindow;
+  } else {
+    stats.publishRate = publishRate;
+  }
+  return stats;
+}
+
+void processMqttQueue() {
+  if (!mqttClient || !config || !mqttClient->connected()) return;
+  if (getMqttQueueDepth() == 0) return;
+  
+  unsigned long now = millis();
+  if (now - lastQueueDrain < MQTT_QUEUE_DRAIN_INTERVAL) return;
+  lastQueueDrain = now;
+  
+  // A few per interval, so the backlog never starves live events
+  QueuedPublish item;
+  int sent = 0;
+  while (sent < MQTT_QUEUE_DRAIN_BATCH && mqttQueuePeek(&item)) {
+    if (!sendTag(item, true)) break;
+    mqttQueuePop();
+    sent++;
+  }
+  if (sent > 0) {
+    mqttQueueCommit();
+  }
+}
+
+// Add one received binary record to the history
+static void addBinaryMessage(const uint8_t* record) {
+  char uidStr[TAG_UID_HEX_LEN];
+  TagUID::fromBytes(&record[4]).toHex(uidStr);
+  addBrokerEvent(uidStr, record[2], (char)record[1]);
+}
+
+// Receive statistics (every message, then dropped before parsing or parsed)
+enum ReceiveCount { RX_RECEIVED, RX_FILTERED, RX_PARSED, RX_COUNTS };
+static uint32_t rxCounts[RX_COUNTS];
+static uint32_t rxTopicFiltered = 0;
+static uint32_t rxEchoes = 0;
+static uint32_t rxIgnored = 0;
+static unsigned long rxWindowStart = 0;
+static uint32_t rxWindowCount[RX_COUNTS];
+static float rxRate[RX_COUNTS];
+
+static void countReceive(ReceiveCount what) {
+  unsigned long now = millis();
+  if (now - rxWindowStart >= MQTT_RATE_WINDOW) {
+    for (int i = 0; i < RX_COUNTS; i++) {
+      rxRate[i] = rxWindowCount[i] * 1000.0f / (now - rxWindowStart);
+      rxWindowCount[i] = 0;
+    }
+    rxWindowStart = now;
   }
+  rxCounts[what]++;
+  rxWindowCount[what]++;
+}
+
+// Byte-level look at a payload, before any parsing
+enum PayloadCheck { PAYLOAD_PARSE, PAYLOAD_ECHO, PAYLOAD_IGNORE };
+
+static PayloadCheck checkPayload(const uint8_t* payload, unsigned int length) {
+  if (length >= MQTT_BINARY_RECORD && payload[0] == MQTT_BINARY_MARKER) {
+    return (payload[2] == config->sensor_id) ? PAYLOAD_ECHO : PAYLOAD_PARSE;
+  }
+  if (payload[0] == MQTT_BINARY_BATCH_MARKER) {
+    if (length < 2 + MQTT_BINARY_RECORD) return PAYLOAD_IGNORE;
+    return (payload[2 + 2] == config->sensor_id) ? PAYLOAD_ECHO : PAYLOAD_PARSE;
+  }
+  
+  // JSON tag events (single or batch) always have a "R" direction; ours
+  // carry "s":<sensor_id> as written by ArduinoJson (no spaces)
+  if (length < 2 || payload[0] != '{') return PAYLOAD_IGNORE;
+  const uint8_t* key = (const uint8_t*)memmem(payload, length, ownSensorKey, ownSensorKeyLength);
+  if (key) {
+    unsigned int after = (key - payload) + ownSensorKeyLength;
+    if (after < length && !isdigit(payload[after])) return PAYLOAD_ECHO;
+  }
+  if (!memmem(payload, length, "\"R\":", 4)) return PAYLOAD_IGNORE;
+  return PAYLOAD_PARSE;
 }
 
 void mqttCallback(char* topic, byte* payload, unsigned int length) {
+  countReceive(RX_RECEIVED);
+  
+  // Cheap checks first - on a busy broker most messages end here
+  if (!mqttTopicAllowed(topic)) {
+    rxTopicFiltered++;
+    countReceive(RX_FILTERED);
+    return;
+  }
+  PayloadCheck check = (length > 0) ? checkPayload(payload, length) : PAYLOAD_IGNORE;
+  if (check != PAYLOAD_PARSE) {
+    if (check == PAYLOAD_ECHO) rxEchoes++; else rxIgnored++;
+    countReceive(RX_FILTERED);
+    return;
+  }
+  countReceive(RX_PARSED);
+  
+#if MQTT_RX_LOG
   Serial.print(F("MQTT received: "));
   Serial.print(topic);
   Serial.print(F(" -> "));
+#endif
+  
+  // Binary records are told apart from JSON by their first byte
+  if (payload[0] == MQTT_BINARY_MARKER) {
+    addBinaryMessage(payload);
+#if MQTT_RX_LOG
+    Serial.print(F("binary, Sensor: "));
+    Serial.print(payload[2]);
+    Serial.print(F(", Direction: "));
+    Serial.println((char)payload[1]);
+#endif
+    return;
+  }
+  if (payload[0] == MQTT_BINARY_BATCH_MARKER) {
+    uint8_t count = min((unsigned int)payload[1], (length - 2) / MQTT_BINARY_RECORD);
+    for (uint8_t i = 0; i < count; i++) {
+      addBinaryMessage(&payload[2 + i * MQTT_BINARY_RECORD]);
+    }
+#if MQTT_RX_LOG
+    Serial.print(F("binary batch of "));
+    Serial.println(count);
+#endif
+    return;
+  }
   
   // Parse JSON payload
-  StaticJsonDocument<200> doc;
-  DeserializationError error = deserializeJson(doc, payload, length);
+  DeserializationError error = deserializeJson(rxDoc, payload, length,
+                                               DeserializationOption::Filter(rxFilter));
   
   if (error) {
-    Serial.println(F("JSON parse failed"));
+    Serial.println(F("MQTT received: JSON parse failed"));
+    return;
+  }
+  
+  // Our own message written differently (e.g. by an older firmware) -
+  // it is already in the history
+  uint8_t sensor = rxDoc["s"];   // Sensor ID
+  if (sensor == config->sensor_id) {
+    rxEchoes++;
+    return;
+  }
+  
+  // Batch: one sensor ID, an "e" array of events
+  JsonArray events = rxDoc["e"];
+  if (!events.isNull()) {
+    int added = 0;
+    for (JsonObject e : events) {
+      const char* uid = e["u"];
+      const char* dirStr = e["R"];
+      if (uid && dirStr) {
+        addBrokerEvent(uid, sensor, dirStr[0]);
+        added++;
+      }
+    }
+#if MQTT_RX_LOG
+    Serial.print(F("batch of "));
+    Serial.print(added);
+    Serial.print(F(" from sensor "));
+    Serial.println(sensor);
+#endif
     return;
   }
   
   // Extract fields - using shortened field names
-  const char* uid = doc["u"];  // UID
-  uint8_t sensor = doc["s"];   // Sensor ID
-  const char* dirStr = doc["R"];  // Direction (R/C/U)
+  const char* uid = rxDoc["u"];  // UID
+  const char* dirStr = rxDoc["R"];  // Direction (R/C/U)
   
   if (!uid || !dirStr) {
+#if MQTT_RX_LOG
     Serial.println(F("Missing required fields"));
+#endif
     return;
   }
   
   char direction = dirStr[0];  // Get first character
   
+#if MQTT_RX_LOG
   Serial.print(F("UID: "));
   Serial.print(uid);
   Serial.print(F(", Sensor: "));
   Serial.print(sensor);
   Serial.print(F(", Direction: "));
   Serial.println(direction);
+#endif
   
   // Add to display history
-  addMqttMessage(uid, sensor, direction);
+  addBrokerEvent(uid, sensor, direction);
+}
+
+MqttReceiveStats getMqttReceiveStats() {
+  MqttReceiveStats stats;
+  stats.received = rxCounts[RX_RECEIVED];
+  stats.topicFiltered = rxTopicFiltered;
+  stats.echoes = rxEchoes;
+  stats.ignored = rxIgnored;
+  stats.parsed = rxCounts[RX_PARSED];
+  
+  // Last full window; nothing received lately means 0
+  unsigned long sinceWindow = millis() - rxWindowStart;
+  float rates[RX_COUNTS];
+  for (int i = 0; i < RX_COUNTS; i++) {
+    if (sinceWindow >= 2 * MQTT_RATE_WINDOW) {
+      rates[i] = 0;
+    } else if (rxRate[RX_RECEIVED] == 0 && sinceWindow > 0) {
+      rates[i] = rxWindowCount[i] * 1000.0f / sinceWindow;
+    } else {
+      rates[i] = rxRate[i];
+    }
+  }
+  stats.receivedRate = rates[RX_RECEIVED];
+  stats.filteredRate = rates[RX_FILTERED];
+  stats.parsedRate = rates[RX_PARSED];
+  return stats;
 }
 
 uint32_t getMqttPublishCount() {
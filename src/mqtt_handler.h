@@ -10,23 +10,137 @@
 
 #include <Arduino.h>
 #include <PubSubClient.h>
+#include <WiFi.h>
+#include "tag_uid.h"
+
+// Broker connection (processMqttConnection). The TCP connect runs on a
+// non-blocking socket polled from loop(); only the MQTT CONNECT/CONNACK
+// exchange is synchronous (PubSubClient), bounded by MQTT_HANDSHAKE_TIMEOUT.
+// Failed attempts are retried after a jittered exponential backoff.
+#define MQTT_CONNECT_TIMEOUT      5000   // ms for the TCP connect
+#define MQTT_HANDSHAKE_TIMEOUT    1      // s to wait for CONNACK (also per-byte read timeout)
+#define MQTT_KEEPALIVE_SECONDS    10     // A dead broker is noticed within ~2x this
+#define MQTT_BACKOFF_MIN          1000   // ms before the first retry
+#define MQTT_BACKOFF_MAX          60000  // ms, longest retry delay
+                                         // (delay is randomly 50-100% of the backoff)
+
+// Store-and-forward drain rate (see mqtt_queue.h)
+#define MQTT_QUEUE_DRAIN_INTERVAL 100  // ms between drain batches
+#define MQTT_QUEUE_DRAIN_BATCH    4    // Queued events per batch (max 40/s)
+
+// Continuing heartbeat per present tag (config continuing_interval, seconds)
+#define MQTT_CONTINUING_DEFAULT   3
+#define MQTT_CONTINUING_LIMIT     3600
+
+// Batching (config mqtt_batch_ms > 0): events are collected for up to
+// mqtt_batch_ms, or mqtt_batch_max events, and sent as one [base]/Batch message
+#define MQTT_BATCH_MAX            16    // Events per batch
+#define MQTT_BATCH_MS_LIMIT       5000  // Longest window accepted from config
+#define MQTT_BATCH_PAYLOAD_MAX    2048  // A batch is sent early rather than grow past this
+#define MQTT_BATCH_JSON_SIZE      3072  // JSON document for a full batch
+#define MQTT_BUFFER_SIZE          (MQTT_BATCH_PAYLOAD_MAX + 128)  // PubSubClient buffer (topic + header)
+#define MQTT_RATE_WINDOW          1000  // Publish rate measurement window (ms)
+
+// Payload format (config mqtt_format). MQTT_FORMAT_BINARY sends one fixed
+// 24-byte record per event (little-endian), received messages of either
+// format are recognised by their first byte:
+//   0     0xA7 marker (JSON starts with '{')
+//   1     event 'R', 'C' or 'U'
+//   2     sensor ID
+//   3     flags: bits 0-1 reader, bit 6 queued, bit 7 ISO14443A
+//   4-11  UID (LSB first)
+//   12-15 reader millis() when the event happened
+//   16-19 age in ms when sent (queued only, 0xFFFFFFFF = before a reboot)
+//   20-23 dwell in ms (Unread)
+//   24-   tag memory bytes (Read with tag memory on, single messages only)
+// A binary [base]/Batch is 0xA8, a count byte, then the records.
+#define MQTT_FORMAT_JSON          0
+#define MQTT_FORMAT_BINARY        1
+#define MQTT_BINARY_RECORD        24
+#define MQTT_BINARY_MARKER        0xA7
+#define MQTT_BINARY_BATCH_MARKER  0xA8
+#define MQTT_BINARY_READER_MASK   0x03
+#define MQTT_BINARY_FLAG_QUEUED   0x40
+#define MQTT_BINARY_FLAG_TYPE_A   0x80
+#define MQTT_BINARY_AGE_UNKNOWN   0xFFFFFFFF
+
+enum MqttConnectionState {
+  MQTT_CONN_WAITING,             // Waiting for WiFi or the retry delay
+  MQTT_CONN_TCP,                 // TCP connect in progress
+  MQTT_CONN_CONNECTED
+};
+
+struct MqttConnectionStats {
+  MqttConnectionState state;
+  uint32_t attempts;             // Connection attempts since boot
+  uint32_t connects;             // Attempts that succeeded
+  uint32_t failures;             // Consecutive failed attempts
+  uint32_t connectingTime;       // ms spent in connection attempts (total)
+  uint32_t longestStall;         // Longest ms one connection step held up loop()
+  uint32_t retryIn;              // ms until the next attempt (waiting only)
+};
+
+struct MqttPublishStats {
+  uint32_t messages;             // MQTT publishes (a batch counts once)
+  uint32_t events;               // Tag events carried by them
+  uint32_t bytes;                // Payload bytes sent
+  uint32_t batches;              // [base]/Batch messages
+  float eventsPerPublish;
+  float publishRate;             // Publishes/s (last second)
+};
+
+// Received messages: topic filter (config mqtt_rx_filter, mqtt_filter.h)
+// and a byte-level check drop our own echoes and non-tag payloads before
+// any JSON parsing. 1 = print every parsed message on Serial.
+#define MQTT_RX_LOG               0
+
+struct MqttReceiveStats {
+  uint32_t received;             // Messages on the subscribed topic
+  uint32_t topicFiltered;        // Dropped by the topic filter
+  uint32_t echoes;               // Our own messages coming back
+  uint32_t ignored;              // Not a tag event
+  uint32_t parsed;               // Parsed into the display history
+  float receivedRate;            // Messages/s (last second)
+  float filteredRate;            // Dropped before parsing, /s
+  float parsedRate;
+};
+
+#define MQTT_TOPIC_LEN            (64 + 12)  // Base topic + "/Continuing"
 
 // Configuration structure (shared with main)
 struct Config;
 
-// Initialize MQTT handler
-void initMqttHandler(PubSubClient* client, Config* cfg);
+// Initialize MQTT handler (net = the WiFiClient the PubSubClient uses)
+void initMqttHandler(PubSubClient* client, WiFiClient* net, Config* cfg);
+
+// Rebuild the publish topics and client ID after a config change
+void refreshMqttConfig();
+
+// Connect / reconnect to the broker, one non-blocking step (call from loop)
+void processMqttConnection();
+
+MqttConnectionStats getMqttConnectionStats();
+
+// Publish tag event (reader = index of the PN5180 that saw the tag,
+// dwell = ms the tag was present, sent with Unread when non-zero,
+// time = millis() when the scan task raised the event).
+// Returns false if it was queued (or dropped) instead of sent.
+bool publishTag(TagUID uid, const char* event, uint8_t reader, uint8_t protocol,
+                unsigned long dwell, unsigned long time);
+
+// Publish queued events while connected, rate-limited (call from loop)
+void processMqttQueue();
 
-// MQTT reconnection
-void reconnectMQTT();
+// Send the current batch once its window is over (call from loop)
+void processMqttBatch();
 
-// Publish tag event
-void publishTag(const char* uid, const char* event);
+MqttPublishStats getMqttPublishStats();
+MqttReceiveStats getMqttReceiveStats();
 
 // MQTT callback (internal)
 void mqttCallback(char* topic, byte* payload, unsigned int length);
 
-// Get MQTT publish counter
+// Get MQTT publish counter (messages actually sent, live and queued)
 uint32_t getMqttPublishCount();
 
 #endif
@@ -0,0 +1,294 @@
+/*
+ * mqtt_inflight.cpp
+ *
+ * QoS 1 In-Flight Window Implementation
+ *
+ * Open messages sit in a ring of slots, oldest first, and their payloads
+ * in a ring of bytes. Brokers acknowledge QoS 1 in order, so space is
+ * freed from the oldest end; a PUBACK that arrives out of order just
+ * marks its slot until the ones before it are done. Only loop() touches
+ * any of this (PubSubClient reads from loop() too), so there is no
+ * locking.
+ */
+
+#include "mqtt_inflight.h"
+#include "mqtt_handler.h"
+
+#define MQTT_PUBLISH_QOS1  0x32  // PUBLISH, QoS 1, not retained
+#define MQTT_FLAG_DUP      0x08
+#define MQTT_PUBACK        0x40
+
+struct InflightSlot {
+  char topic[MQTT_TOPIC_LEN];    // A copy - the handler's topics change on config save
+  uint16_t packetId;
+  uint16_t offset;               // Payload in payloadRing
+  uint16_t length;
+  bool acked;
+  unsigned long firstSent;
+  unsigned long lastSent;
+};
+
+// Client in front of the WiFiClient - passes everything through and
+// follows the MQTT framing of what PubSubClient reads to spot PUBACKs
+class MqttAckClient : public Client {
+public:
+  Client* net = nullptr;
+  
+  int connect(IPAddress ip, uint16_t port) { resetFraming(); return net->connect(ip, port); }
+  int connect(const char* host, uint16_t port) { resetFraming(); return net->connect(host, port); }
+  int connect(IPAddress ip, uint16_t port, int32_t) { return connect(ip, port); }  // Newer cores
+  int connect(const char* host, uint16_t port, int32_t) { return connect(host, port); }
+  size_t write(uint8_t b) { return net->write(b); }
+  size_t write(const uint8_t* buf, size_t size) { return net->write(buf, size); }
+  int available() { return net->available(); }
+  int peek() { return net->peek(); }
+  void flush() { net->flush(); }
+  void stop() { resetFraming(); net->stop(); }
+  uint8_t connected() { return net->connected(); }
+  operator bool() { return net && (bool)*net; }
+  
+  int read() {
+    int b = net->read();
+    if (b >= 0) follow((uint8_t)b);
+    return b;
+  }
+  
+  int read(uint8_t* buf, size_t size) {
+    int n = net->read(buf, size);
+    for (int i = 0; i < n; i++) follow(buf[i]);
+    return n;
+  }
+  
+  void resetFraming() { frameState = FRAME_HEADER; }
+
+private:
+  enum { FRAME_HEADER, FRAME_LENGTH, FRAME_BODY } frameState = FRAME_HEADER;
+  uint8_t frameType = 0;
+  uint32_t frameLength = 0;
+  uint32_t lengthShift = 0;
+  uint32_t framePos = 0;
+  uint8_t packetId[2];
+  
+  void follow(uint8_t b);
+  void frameDone();
+};
+
+static MqttAckClient ackClient;
+
+static InflightSlot slots[MQTT_INFLIGHT_MAX];
+static uint8_t slotHead = 0;       // Oldest open message
+static uint8_t slotCount = 0;
+static uint8_t window = MQTT_INFLIGHT_DEFAULT;
+static uint8_t payloadRing[MQTT_INFLIGHT_BYTES];
+static uint16_t ringHead = 0;      // Where the next payload goes
+static uint16_t nextPacketId = 1;
+static uint8_t resendCount = 0;  // Oldest slots still open from before a reconnect
+
+// Statistics
+static uint32_t sentCount = 0;
+static uint32_t ackedCount = 0;
+static uint32_t retransmitCount = 0;
+static uint32_t windowFullCount = 0;
+static uint32_t ackLast = 0;
+static uint32_t ackMax = 0;
+static uint64_t ackTotal = 0;
+
+static void ackPacket(uint16_t id);
+
+void MqttAckClient::follow(uint8_t b) {
+  switch (frameState) {
+    case FRAME_HEADER:
+      frameType = b & 0xF0;
+      frameLength = 0;
+      lengthShift = 0;
+      frameState = FRAME_LENGTH;
+      break;
+    
+    case FRAME_LENGTH:
+      // Remaining length: 7 bits per byte, LSB first, top bit = more
+      frameLength |= (uint32_t)(b & 0x7F) << lengthShift;
+      lengthShift += 7;
+      if (!(b & 0x80)) {
+        framePos = 0;
+        if (frameLength == 0) {
+          frameDone();
+        } else {
+          frameState = FRAME_BODY;
+        }
+      }
+      break;
+    
+    case FRAME_BODY:
+      if (framePos < sizeof(packetId)) packetId[framePos] = b;
+      if (++framePos >= frameLength) frameDone();
+      break;
+  }
+}
+
+void MqttAckClient::frameDone() {
+  frameState = FRAME_HEADER;
+  if (frameType == MQTT_PUBACK && frameLength == 2) {
+    ackPacket((packetId[0] << 8) | packetId[1]);
+  }
+}
+
+Client* initMqttInflight(Client* net) {
+  ackClient.net = net;
+  return &ackClient;
+}
+
+void setMqttInflightWindow(uint8_t size) {
+  window = constrain(size, 1, MQTT_INFLIGHT_MAX);
+}
+
+static InflightSlot* slotAt(uint8_t i) {
+  return &slots[(slotHead + i) % MQTT_INFLIGHT_MAX];
+}
+
+// Free acknowledged messages from the oldest end
+static void releaseAcked() {
+  while (slotCount > 0 && slots[slotHead].acked) {
+    slotHead = (slotHead + 1) % MQTT_INFLIGHT_MAX;
+    slotCount--;
+    if (resendCount > 0) resendCount--;
+  }
+}
+
+static void ackPacket(uint16_t id) {
+  for (uint8_t i = 0; i < slotCount; i++) {
+    InflightSlot* slot = slotAt(i);
+    if (slot->packetId != id || slot->acked) continue;
+    
+    slot->acked = true;
+    ackedCount++;
+    ackLast = millis() - slot->firstSent;
+    ackTotal += ackLast;
+    if (ackLast > ackMax) ackMax = ackLast;
+    releaseAcked();
+    return;
+  }
+}
+
+// Room for a payload in the byte ring. Free space is [ringHead, oldest)
+// when the ring has wrapped, else [ringHead, end) plus [0, oldest).
+static bool reservePayload(size_t length, uint16_t* offset) {
+  if (slotCount == 0) ringHead = 0;
+  if (length > MQTT_INFLIGHT_BYTES) return false;
+  
+  if (slotCount == 0) {
+    *offset = 0;
+    return true;
+  }
+  uint16_t oldest = slots[slotHead].offset;
+  if (ringHead > oldest) {
+    if ((size_t)(MQTT_INFLIGHT_BYTES - ringHead) >= length) {
+      *offset = ringHead;
+      return true;
+    }
+    if (oldest >= length) {
+      *offset = 0;
+      return true;
+    }
+    return false;
+  }
+  if ((size_t)(oldest - ringHead) >= length) {
+    *offset = ringHead;
+    return true;
+  }
+  return false;
+}
+
+// Write one PUBLISH packet (fixed header, topic, packet ID, payload)
+static bool sendPacket(const InflightSlot* slot, bool dup) {
+  size_t topicLength = strlen(slot->topic);
+  uint32_t remaining = 2 + topicLength + 2 + slot->length;
+  
+  uint8_t header[5];
+  size_t headerLength = 0;
+  header[headerLength++] = MQTT_PUBLISH_QOS1 | (dup ? MQTT_FLAG_DUP : 0);
+  do {
+    uint8_t digit = remaining & 0x7F;
+    remaining >>= 7;
+    header[headerLength++] = digit | (remaining ? 0x80 : 0);
+  } while (remaining > 0);
+  
+  uint8_t topicLen[2] = { (uint8_t)(topicLength >> 8), (uint8_t)topicLength };
+  uint8_t id[2] = { (uint8_t)(slot->packetId >> 8), (uint8_t)slot->packetId };
+  
+  return ackClient.write(header, headerLength) == headerLength &&
+         ackClient.write(topicLen, 2) == 2 &&
+         ackClient.write((const uint8_t*)slot->topic, topicLength) == topicLength &&
+         ackClient.write(id, 2) == 2 &&
+         ackClient.write(&payloadRing[slot->offset], slot->length) == slot->length;
+}
+
+bool mqttInflightPublish(const char* topic, const uint8_t* payload, size_t length) {
+  uint16_t offset;
+  if (!ackClient.net || slotCount >= window || !reservePayload(length, &offset)) {
+    windowFullCount++;
+    return false;
+  }
+  
+  InflightSlot* slot = slotAt(slotCount);
+  strlcpy(slot->topic, topic, sizeof(slot->topic));
+  slot->packetId = nextPacketId;
+  slot->offset = offset;
+  slot->length = length;
+  slot->acked = false;
+  slot->firstSent = millis();
+  slot->lastSent = slot->firstSent;
+  memcpy(&payloadRing[offset], payload, length);
+  
+  // Not kept if the write fails - the caller queues it instead
+  if (!sendPacket(slot, false)) return false;
+  
+  slotCount++;
+  ringHead = offset + length;
+  nextPacketId = (nextPacketId == 0xFFFF) ? 1 : nextPacketId + 1;
+  sentCount++;
+  return true;
+}
+
+void mqttInflightConnected() {
+  ackClient.resetFraming();
+  resendCount = slotCount;  // Not messages sent on the new connection before the next check
+}
+
+void processMqttInflight() {
+  if (slotCount == 0) {
+    resendCount = 0;
+    return;
+  }
+  
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < slotCount; i++) {
+    InflightSlot* slot = slotAt(i);
+    if (slot->acked) continue;
+    if (i >= resendCount && now - slot->lastSent < MQTT_ACK_TIMEOUT) continue;
+    
+    if (!sendPacket(slot, true)) return;  // Connection trouble - try again later
+    slot->lastSent = now;
+    retransmitCount++;
+  }
+  resendCount = 0;
+}
+
+MqttInflightStats getMqttInflightStats() {
+  MqttInflightStats stats;
+  stats.window = window;
+  stats.inflight = 0;
+  stats.bytes = 0;
+  for (uint8_t i = 0; i < slotCount; i++) {
+    if (slotAt(i)->acked) continue;
+    stats.inflight++;
+    stats.bytes += slotAt(i)->length;
+  }
+  stats.sent = sentCount;
+  stats.acked = ackedCount;
+  stats.retransmits = retransmitCount;
+  stats.windowFull = windowFullCount;
+  stats.ackLast = ackLast;
+  stats.ackAvg = ackedCount ? ackTotal / ackedCount : 0;
+  stats.ackMax = ackMax;
+  return stats;
+}
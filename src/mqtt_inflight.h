@@ -0,0 +1,59 @@
+/*
+ * mqtt_inflight.h
+ *
+ * QoS 1 Publishing with an In-Flight Window
+ * PubSubClient only publishes at QoS 0 and drops the PUBACKs it reads, so
+ * QoS 1 messages are written here as raw PUBLISH packets and kept until
+ * their PUBACK arrives. Up to the configured window of messages are
+ * outstanding at once (not stop-and-wait); a message without a PUBACK
+ * after MQTT_ACK_TIMEOUT, or still open on a reconnect, is sent again
+ * with the DUP flag.
+ *
+ * PUBACKs are seen by sitting between PubSubClient and the WiFiClient:
+ * every byte PubSubClient reads passes through a Client wrapper that
+ * follows the MQTT packet framing.
+ */
+
+#ifndef MQTT_INFLIGHT_H
+#define MQTT_INFLIGHT_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+#define MQTT_INFLIGHT_MAX      32    // Largest window (config mqtt_inflight)
+#define MQTT_INFLIGHT_DEFAULT  8
+#define MQTT_INFLIGHT_BYTES    8192  // Payload copies held for retransmission
+#define MQTT_ACK_TIMEOUT       5000  // ms without PUBACK before a resend
+
+struct MqttInflightStats {
+  uint8_t window;                // Configured window
+  uint8_t inflight;              // Messages waiting for a PUBACK
+  uint16_t bytes;                // Payload bytes held for them
+  uint32_t sent;                 // QoS 1 messages sent (first send only)
+  uint32_t acked;
+  uint32_t retransmits;          // Resends (timeout or reconnect)
+  uint32_t windowFull;           // Publishes refused - window or buffer full
+  uint32_t ackLast;              // ms from first send to PUBACK
+  uint32_t ackAvg;
+  uint32_t ackMax;
+};
+
+// Wrap the network client; give the result to PubSubClient::setClient()
+Client* initMqttInflight(Client* net);
+
+// Messages allowed in flight (1..MQTT_INFLIGHT_MAX)
+void setMqttInflightWindow(uint8_t window);
+
+// Send a QoS 1 PUBLISH (false = window full or write failed; the caller
+// keeps the message)
+bool mqttInflightPublish(const char* topic, const uint8_t* payload, size_t length);
+
+// New connection - resend everything still open (call once connected)
+void mqttInflightConnected();
+
+// Resend messages whose PUBACK is overdue (call from loop while connected)
+void processMqttInflight();
+
+MqttInflightStats getMqttInflightStats();
+
+#endif
@@ -0,0 +1,250 @@
+/*
+ * mqtt_queue.cpp
+ *
+ * Store-and-Forward Queue Implementation
+ *
+ * Only loop() touches the queue (publishTag and the drain both run
+ * there), so there is no locking. Records are fixed size: the depth is
+ * plain arithmetic on the file size and read offset, and a small RAM
+ * read-ahead keeps the drain from reopening the file for every event.
+ * Once the backlog is fully drained both files are removed.
+ */
+
+#include "mqtt_queue.h"
+#include "le_bytes.h"
+#include <LittleFS.h>
+
+#define QUEUE_HEADER_BYTES   4     // Magic
+#define QUEUE_RECORD_BYTES   20    // millis + event + reader + protocol + UID + dwell + end marker
+#define QUEUE_RECORD_END     0xA5  // Last byte of a complete record
+#define QUEUE_READ_AHEAD     8     // Records read from flash at once
+#define QUEUE_RATE_WINDOW    1000  // Drain rate measurement window (ms)
+
+static bool fsMounted = false;
+static uint32_t writeOffset = 0;   // File size (0 = no file)
+static uint32_t readOffset = 0;    // Next record to publish
+static uint32_t bootOffset = 0;    // Records before this were queued before the reboot
+
+// Read-ahead of the oldest records
+static uint8_t readBuffer[QUEUE_READ_AHEAD * QUEUE_RECORD_BYTES];
+static uint32_t bufferOffset = 0;  // File offset of readBuffer[0]
+static uint32_t bufferBytes = 0;
+
+// Statistics
+static uint32_t queuedCount = 0;
+static uint32_t drainedCount = 0;
+static uint32_t droppedCount = 0;
+static unsigned long rateWindowStart = 0;
+static uint32_t rateWindowCount = 0;
+static float drainRate = 0;
+
+static void encodeRecord(const QueuedPublish& item, uint8_t* out) {
+  putU32(&out[0], item.time);
+  out[4] = (uint8_t)item.event;
+  out[5] = item.reader;
+  out[6] = item.protocol;
+  item.uid.toBytes(&out[7]);
+  putU32(&out[15], item.dwell);
+  out[19] = QUEUE_RECORD_END;
+}
+
+static void decodeRecord(const uint8_t* in, QueuedPublish* item) {
+  item->time = getU32(&in[0]);
+  item->event = (char)in[4];
+  item->reader = in[5];
+  item->protocol = in[6];
+  item->uid = TagUID::fromBytes(&in[7]);
+  item->dwell = getU32(&in[15]);
+}
+
+// Empty queue - remove the files so the next outage starts a fresh one
+static void resetQueue() {
+  LittleFS.remove(MQTT_QUEUE_FILE);
+  LittleFS.remove(MQTT_QUEUE_POS_FILE);
+  writeOffset = 0;
+  readOffset = 0;
+  bootOffset = 0;
+  bufferBytes = 0;
+}
+
+bool initMqttQueue() {
+  fsMounted = LittleFS.begin(true);
+  if (!fsMounted) {
+    Serial.println(F("ERROR: LittleFS mount failed - MQTT queue disabled"));
+    return false;
+  }
+  
+  File f = LittleFS.open(MQTT_QUEUE_FILE, FILE_READ);
+  if (f) {
+    uint32_t magic = 0;
+    uint32_t size = f.size();
+    bool valid = f.read((uint8_t*)&magic, sizeof(magic)) == sizeof(magic) && magic == MQTT_QUEUE_MAGIC;
+    f.close();
+    if (valid) {
+      writeOffset = size;
+      readOffset = QUEUE_HEADER_BYTES;
+      File pos = LittleFS.open(MQTT_QUEUE_POS_FILE, FILE_READ);
+      if (pos) {
+        uint32_t saved = 0;
+        if (pos.read((uint8_t*)&saved, sizeof(saved)) == sizeof(saved) && saved <= size) {
+          readOffset = max(saved, (uint32_t)QUEUE_HEADER_BYTES);
+        }
+        pos.close();
+      }
+      
+      // A record cut short by a power loss: pad it out so new records stay
+      // aligned (it has no end marker, so it is skipped when read)
+      uint32_t partial = (writeOffset - QUEUE_HEADER_BYTES) % QUEUE_RECORD_BYTES;
+      if (partial > 0) {
+        uint8_t pad[QUEUE_RECORD_BYTES] = {0};
+        File a = LittleFS.open(MQTT_QUEUE_FILE, FILE_APPEND);
+        if (a) {
+          a.write(pad, QUEUE_RECORD_BYTES - partial);
+          a.close();
+          writeOffset += QUEUE_RECORD_BYTES - partial;
+        }
+      }
+      bootOffset = writeOffset;
+    }
+    if (!valid || readOffset >= writeOffset) {
+      resetQueue();
+    }
+  }
+  
+  uint32_t depth = getMqttQueueDepth();
+  if (depth > 0) {
+    Serial.print(F("MQTT queue: "));
+    Serial.print(depth);
+    Serial.println(F(" events waiting from before reboot"));
+  } else {
+    Serial.println(F("MQTT queue ready (LittleFS)"));
+  }
+  return true;
+}
+
+bool mqttQueuePush(const QueuedPublish& item) {
+  if (!fsMounted) return false;
+  
+  uint32_t start = (writeOffset == 0) ? QUEUE_HEADER_BYTES : writeOffset;
+  if (start + QUEUE_RECORD_BYTES > MQTT_QUEUE_MAX_BYTES) {
+    droppedCount++;
+    return false;
+  }
+  
+  File f = LittleFS.open(MQTT_QUEUE_FILE, FILE_APPEND);
+  if (!f) {
+    droppedCount++;
+    return false;
+  }
+  if (writeOffset == 0) {
+    uint32_t magic = MQTT_QUEUE_MAGIC;
+    f.write((const uint8_t*)&magic, sizeof(magic));
+    readOffset = QUEUE_HEADER_BYTES;
+  }
+  
+  uint8_t record[QUEUE_RECORD_BYTES];
+  encodeRecord(item, record);
+  size_t written = f.write(record, sizeof(record));
+  f.close();
+  if (written != sizeof(record)) {
+    droppedCount++;
+    return false;
+  }
+  
+  writeOffset = start + QUEUE_RECORD_BYTES;
+  queuedCount++;
+  return true;
+}
+
+// Refill the read-ahead from the current read offset
+static bool fillBuffer() {
+  File f = LittleFS.open(MQTT_QUEUE_FILE, FILE_READ);
+  if (!f) return false;
+  
+  uint32_t want = min(writeOffset - readOffset, (uint32_t)sizeof(readBuffer));
+  f.seek(readOffset);
+  bufferBytes = f.read(readBuffer, want);
+  bufferOffset = readOffset;
+  f.close();
+  
+  bufferBytes -= bufferBytes % QUEUE_RECORD_BYTES;
+  return bufferBytes > 0;
+}
+
+bool mqttQueuePeek(QueuedPublish* item) {
+  while (fsMounted && readOffset < writeOffset) {
+    if (readOffset < bufferOffset || readOffset >= bufferOffset + bufferBytes) {
+      if (!fillBuffer()) return false;
+    }
+    
+    const uint8_t* record = &readBuffer[readOffset - bufferOffset];
+    if (record[QUEUE_RECORD_BYTES - 1] == QUEUE_RECORD_END) {
+      decodeRecord(record, item);
+      item->previousBoot = readOffset < bootOffset;
+      return true;
+    }
+    readOffset += QUEUE_RECORD_BYTES;  // Cut-short record
+  }
+  return false;
+}
+
+void mqttQueuePop() {
+  if (readOffset >= writeOffset) return;
+  readOffset += QUEUE_RECORD_BYTES;
+  drainedCount++;
+  
+  unsigned long now = millis();
+  if (now - rateWindowStart >= QUEUE_RATE_WINDOW) {
+    drainRate = rateWindowCount * 1000.0f / (now - rateWindowStart);
+    rateWindowStart = now;
+    rateWindowCount = 0;
+  }
+  rateWindowCount++;
+  
+  if (readOffset >= writeOffset) {
+    resetQueue();
+  }
+}
+
+void mqttQueueCommit() {
+  if (!fsMounted || writeOffset == 0) return;
+  
+  File f = LittleFS.open(MQTT_QUEUE_POS_FILE, FILE_WRITE);
+  if (!f) return;
+  f.write((const uint8_t*)&readOffset, sizeof(readOffset));
+  f.close();
+}
+
+uint32_t getMqttQueueDepth() {
+  if (writeOffset <= readOffset) return 0;
+  return (writeOffset - readOffset) / QUEUE_RECORD_BYTES;
+}
+
+MqttQueueStatus getMqttQueueStatus() {
+  MqttQueueStatus status;
+  status.available = fsMounted;
+  status.depth = getMqttQueueDepth();
+  status.oldestAge = 0;
+  status.oldestPreviousBoot = false;
+  status.queued = queuedCount;
+  status.drained = drainedCount;
+  status.dropped = droppedCount;
+  
+  QueuedPublish oldest;
+  if (status.depth > 0 && mqttQueuePeek(&oldest)) {
+    status.oldestPreviousBoot = oldest.previousBoot;
+    status.oldestAge = oldest.previousBoot ? millis() : millis() - oldest.time;
+  }
+  
+  // The rate is for the last full window (the current one until the first
+  // completes); nothing drained lately means 0
+  unsigned long sinceWindow = millis() - rateWindowStart;
+  if (sinceWindow >= 2 * QUEUE_RATE_WINDOW) {
+    status.drainRate = 0;
+  } else if (drainRate == 0 && sinceWindow > 0) {
+    status.drainRate = rateWindowCount * 1000.0f / sinceWindow;
+  } else {
+    status.drainRate = drainRate;
+  }
+  return status;
+}
@@ -0,0 +1,68 @@
+/*
+ * mqtt_queue.h
+ *
+ * Store-and-Forward Queue for MQTT Outages
+ * Tag events that can't be published (broker down, WiFi lost) are
+ * appended to a LittleFS file and published in order, with their
+ * original timestamps, once the broker is back. The read position is
+ * kept in a second small file, so the backlog survives a reboot.
+ *
+ * File format (little-endian):
+ *   header:  uint32 magic "MQQ2"
+ *   record:  uint32 millis, uint8 event ('R', 'C' or 'U'), uint8 reader,
+ *            uint8 protocol, 8 UID bytes (LSB first), uint32 dwell ms,
+ *            uint8 0xA5 end marker
+ */
+
+#ifndef MQTT_QUEUE_H
+#define MQTT_QUEUE_H
+
+#include <Arduino.h>
+#include "tag_uid.h"
+
+#define MQTT_QUEUE_FILE       "/mqttq.bin"
+#define MQTT_QUEUE_POS_FILE   "/mqttq.pos"   // Read offset into MQTT_QUEUE_FILE
+#define MQTT_QUEUE_MAX_BYTES  65536          // ~3200 events; newer events are dropped beyond this
+#define MQTT_QUEUE_MAGIC      0x3251514D     // "MQQ2"
+
+// One queued publish
+struct QueuedPublish {
+  uint32_t time;                 // millis() when the event happened
+  char event;                    // 'R' = Read, 'C' = Continuing, 'U' = Unread
+  uint8_t reader;
+  uint8_t protocol;
+  bool previousBoot;             // Queued before the last reboot (time is from that boot)
+  TagUID uid;
+  uint32_t dwell;                // ms the tag was present (Unread, 0 = unknown)
+};
+
+struct MqttQueueStatus {
+  bool available;                // LittleFS mounted
+  uint32_t depth;                // Events waiting
+  uint32_t oldestAge;            // ms since the oldest waiting event (since boot if it is older)
+  bool oldestPreviousBoot;       // Oldest event was queued before the last reboot
+  uint32_t queued;               // Events queued since boot
+  uint32_t drained;              // Queued events published since boot
+  uint32_t dropped;              // Events lost because the queue was full
+  float drainRate;               // Events/s published from the queue (last second)
+};
+
+// Mount LittleFS and pick up a backlog left from before a reboot (call in setup)
+bool initMqttQueue();
+
+// Append an event (false = queue full or no file system)
+bool mqttQueuePush(const QueuedPublish& item);
+
+// Oldest waiting event without removing it (false = empty)
+bool mqttQueuePeek(QueuedPublish* item);
+
+// Remove the event returned by mqttQueuePeek
+void mqttQueuePop();
+
+// Persist the read position (after a batch of pops)
+void mqttQueueCommit();
+
+uint32_t getMqttQueueDepth();
+MqttQueueStatus getMqttQueueStatus();
+
+#endif
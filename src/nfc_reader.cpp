@@ -5,48 +5,272 @@
  */
 
 #include "nfc_reader.h"
+#include "nfc_trace.h"
 #include <PN5180.h>
 #include <PN5180ISO15693.h>
+#include <PN5180ISO14443.h>
 #include <string.h>  // For memset
+#include <atomic>
+#if NFC_LPCD_LIGHT_SLEEP
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#endif
+
+#if NFC_SIMULATION
+#include "nfc_simulator.h"
+typedef PN5180Simulator NFCDevice;
+typedef PN5180Simulator NFCDeviceA;
+#else
+typedef PN5180ISO15693 NFCDevice;
+typedef PN5180ISO14443 NFCDeviceA;
+#endif
 
 // Global objects
-static PN5180ISO15693* nfc = nullptr;
-static bool readerInitialized = false;
-static NFCStatus nfcStatus = {false, false, 0, 0, 0, 0, 0, "Not initialized"};
-static TagCallback tagCallback = nullptr;
+static bool readerInitialized = false;  // At least one reader answered
 
-// State tracking
-static String lastUID = "";
-static bool tagPresent = false;
-static unsigned long lastTagTime = 0;
-static unsigned long lastScanTime = 0;
+// Status - each reader's status block is owned by the scan task; other
+// cores read the copy published under statusMux, plus the atomic counters
+static const NFCStatus initialStatus = {false, false, 0, 0, 0, 0, 0, 0, 0, SCAN_INTERVAL_MAX_DEFAULT, 0, 0, 0, 0, 0, 0, 0, DEBOUNCE_MODE_DEFAULT, 0, 0, 0, 0, 0, 0, 0, 0, 0, {0}, {0}, 0, 0, 0, false, 0, 0, 0, 0, 0, PROTOCOL_ISO15693, 0, {}, {}, {}, {}, "Not initialized"};
+static portMUX_TYPE statusMux = portMUX_INITIALIZER_UNLOCKED;
+static unsigned long lastProcessTime = 0;  // Whole round over all readers (us)
+static unsigned long maxProcessTime = 0;
 
-// Debouncing - require consecutive reads
-static String pendingUID = "";
-static int consecutiveReads = 0;
-#define REQUIRED_CONSECUTIVE_READS 2  // Must see tag 2 times in a row
+// Scan task
+static TaskHandle_t nfcTaskHandle = nullptr;
+static SemaphoreHandle_t busMutex = nullptr;  // PN5180 and display share SPI
 
-// Tag timeout (tag considered gone after this period of no detection)
-#define TAG_TIMEOUT 1000  // 1 second (4 scan cycles at 250ms interval)
+// Tag event bus - one ring per subscriber, each single producer (scan
+// task) / single consumer (loop). head is only written by the producer,
+// tail only by the consumer. Subscribers are added before the task starts.
+struct QueuedTagEvent {
+  TagEventInfo info;
+  uint32_t sightingMicros;  // First sighting of the tag (enter events)
+};
 
-bool initNFCReader() {
-  Serial.println(F("\n=== PN5180 Initialization ==="));
+struct TagSubscriber {
+  const char* name;
+  TagEventHandler handler;
+  uint16_t budget;                   // Events per dispatch (0 = all waiting)
+  QueuedTagEvent ring[NFC_EVENT_RING_SIZE];
+  std::atomic<uint32_t> head;
+  std::atomic<uint32_t> tail;
+  std::atomic<uint32_t> dropped;     // Producer side
+  uint32_t delivered;                // Consumer side
+  uint16_t maxDepth;
+};
+static TagSubscriber subscribers[NFC_MAX_SUBSCRIBERS];
+static std::atomic<uint8_t> subscriberCount(0);
+
+// Present-tag set - one slot per UID in the field
+// A slot is pending until the debounce policy confirms the tag, then
+// present until the policy decides it has left.
+struct TrackedTag {
+  bool used;
+  bool present;                 // Confirmed (enter event fired)
+  bool seenThisCycle;
+  uint16_t history;             // Read history, bit 0 = latest scan
+  uint8_t missedScans;          // Scans missed in a row while present
+  unsigned long lastTagTime;    // Last confirmed sighting
+  unsigned long firstSeenTime;  // First sighting (detection latency)
+  uint32_t firstSeenMicros;     // First sighting (callback latency histogram)
+  uint8_t protocol;             // TagProtocol it answers on
+  TagUID uid;
+};
+
+// Scan scheduler limits (shared by all readers) - owned by the scan task;
+// setNFCScanIntervals() stages new ones and the task picks them up like
+// a debounce policy
+static uint16_t scanIntervalMin = SCAN_INTERVAL_MIN_DEFAULT;
+static uint16_t scanIntervalMax = SCAN_INTERVAL_MAX_DEFAULT;
+static uint16_t pendingIntervalMin = SCAN_INTERVAL_MIN_DEFAULT;
+static uint16_t pendingIntervalMax = SCAN_INTERVAL_MAX_DEFAULT;
+static std::atomic<bool> intervalsChanged(false);
+
+// Protocol scheduler - the enabled set is written from loop, read by the scan task
+static std::atomic<uint8_t> protocolMask(NFC_PROTOCOLS_DEFAULT);
+
+// Trace replay - recorded inventory results stand in for the PN5180
+#define NFC_REPLAY_BATCH  16  // Records per call in fast replay
+static bool replayActive = false;
+
+// Tag memory cache - written by the scan task, read from loop/web under memMux
+struct TagMemorySlot {
+  bool used;
+  uint32_t lastUsed;  // LRU stamp
+  TagMemory memory;
+};
+static TagMemorySlot memCache[TAG_MEM_CACHE_SIZE];
+static uint32_t memCacheClock = 0;
+static portMUX_TYPE memMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Latency histograms - log scale, LATENCY_SUB_BUCKETS per power of two
+// Each has a single writer: inventory and jitter are recorded by the scan
+// task, callback latency by dispatchNFCEvents(); readers summarize a copy.
+#define LATENCY_SUB_BITS     2
+#define LATENCY_SUB_BUCKETS  (1 << LATENCY_SUB_BITS)
+#define LATENCY_OCTAVES      24  // Up to ~16s
+#define LATENCY_BUCKETS      (LATENCY_OCTAVES * LATENCY_SUB_BUCKETS)
+
+struct LatencyHistogram {
+  uint32_t buckets[LATENCY_BUCKETS];
+  uint32_t count;
+  uint32_t max;
+};
+static LatencyHistogram inventoryHist = {};
+static LatencyHistogram jitterHist = {};
+static LatencyHistogram callbackHist = {};
+static LatencyHistogram wakeHist = {};
+
+// RF quality window - ring of the last RF_HIST_WINDOW scans
+struct RFSample {
+  uint16_t agc;
+  bool read;
+};
+
+// ISO15693 inventory command
+#define ISO15693_INVENTORY_FLAGS 0x06  // 16 slots, high data rate, inventory flag
+#define ISO15693_CMD_INVENTORY   0x01
+
+// Inventory slot timing (microseconds)
+#define NFC_SOF_TIMEOUT_US   1000  // No start of frame by now = empty slot
+#define NFC_RX_TIMEOUT_US    8000  // Frame started but not complete = give up
+#define NFC_MAX_MASK_ROUNDS  8     // Collision masks queued per scan
+
+// Inventory transaction state
+enum InventoryState {
+  INV_IDLE,       // Waiting for next scan interval
+  INV_WAIT_SLOT   // Slot command sent, waiting for answer or timeout
+};
+
+struct InventoryMask {
+  uint32_t mask;
+  uint8_t maskLen;
+};
+
+struct InventoryTransaction {
+  InventoryState state;
+  uint32_t txConfig;              // TX_CONFIG to restore after EOF-only slots
+  uint32_t mask;                  // Current round's mask
+  uint8_t maskLen;
+  uint8_t slot;                   // Current slot (0-15)
+  unsigned long slotStart;        // micros() when the slot was issued
+  InventoryMask queue[NFC_MAX_MASK_ROUNDS];
+  uint8_t queueLen;
+  uint8_t uids[MAX_TAGS * 8];     // UIDs found this scan (LSB first)
+  uint8_t numCard;
+  uint8_t collisions;
+  uint8_t integrityErrors;        // RX_STATUS error flags seen this scan
+  uint8_t protocolErrors;
+  uint16_t agc;                   // AGC value read when the scan completed
+  ISO15693ErrorCode result;
+};
+
+// LPCD idle - quiet time is set from loop, read by the scan task
+static std::atomic<uint32_t> lpcdQuietMs(NFC_LPCD_QUIET_DEFAULT * 1000UL);
+
+// Why a reader last left LPCD (until its first read or next idle)
+enum WakeReason {
+  WAKE_NONE,
+  WAKE_IRQ,     // PN5180 detected a card
+  WAKE_CHECK    // Routine inventory
+};
+
+// One PN5180 module - its device, inventory, tag set, scheduler and status
+struct NFCReader {
+  uint8_t index;
+  NFCDevice* nfc;
+  NFCDeviceA* nfcA;                     // Same chip, ISO14443A commands
+  bool initialized;
+  InventoryTransaction inv;
+  TrackedTag tags[MAX_TAGS];
+  NFCStatus status;                     // Owned by the scan task
+  NFCStatus shared;                     // Published copy (statusMux)
+  std::atomic<uint32_t> totalScans;
+  std::atomic<uint32_t> successfulReads;
+  std::atomic<uint32_t> failedReads;
+  unsigned long lastScanTime;
+  uint16_t scanInterval;
+  unsigned long lastActivityTime;       // Last scan with any tag pending/present
+  unsigned long rateWindowStart;
+  uint32_t rateWindowScans;
+  uint32_t detectCount;
+  unsigned long totalDetectLatency;
+  uint32_t inventoryStartMicros;
+  uint32_t lastScanMicros;
+  RFSample rfWindow[RF_HIST_WINDOW];    // RF quality window - ring of the last scans
+  uint16_t rfWindowCount;
+  uint16_t rfWindowNext;
+  bool lpcd;                            // RF off, PN5180 in LPCD
+  unsigned long lpcdStart;
+  uint8_t wakeReason;                   // WakeReason
+  unsigned long wakeTime;
+  uint32_t wakeMicros;
+  uint8_t protocol;                     // TagProtocol the RF is set up for
+  uint8_t protocolRun;                  // Scans in a row on it while staying
+  uint8_t protocolStride;               // Scans per scan of each present tag's protocol
+};
+static NFCReader readers[NFC_READER_COUNT];
+static const uint8_t readerPins[][4] = NFC_READER_PINS;
+static uint8_t nextReader = 0;          // Round-robin start for the next step
+
+// Debounce policy - owned by the scan task; setNFCDebounce() stages a new
+// one in pendingDebounce and the task picks it up before the next update
+static DebouncePolicy debounce = {
+  DEBOUNCE_MODE_DEFAULT, DEBOUNCE_ENTER_DEFAULT, DEBOUNCE_WINDOW_DEFAULT,
+  DEBOUNCE_LEAVE_DEFAULT, DEBOUNCE_TIMEOUT_DEFAULT
+};
+static DebouncePolicy pendingDebounce = debounce;
+static std::atomic<bool> debounceChanged(false);
+
+static void publishStatus(NFCReader* r);
+
+// Load the RF configuration for a protocol and switch the field on
+static bool setupProtocolRF(NFCReader* r, uint8_t protocol) {
+  if (protocol != PROTOCOL_ISO14443A) return r->nfc->setupRF();
+#if NFC_SIMULATION
+  return r->nfc->setupRFTypeA();
+#else
+  return r->nfcA->setupRF();
+#endif
+}
+
+// Can this reader idle in LPCD? (needs its IRQ line wired)
+static bool lpcdCapable(NFCReader* r) {
+#if NFC_SIMULATION
+  return true;
+#else
+  return readerPins[r->index][3] != NFC_NO_PIN;
+#endif
+}
+
+// Bring up one PN5180 (false if it does not answer or RF setup fails)
+static bool initReader(NFCReader* r) {
+  Serial.print(F("Reader "));
+  Serial.print(r->index);
+  Serial.print(F(" (NSS GPIO"));
+  Serial.print(readerPins[r->index][0]);
+  Serial.println(F(")"));
   
   // Create PN5180 object
-  if (nfc == nullptr) {
-    nfc = new PN5180ISO15693(NFC_NSS_PIN, NFC_BUSY_PIN, NFC_RST_PIN);
+  if (r->nfc == nullptr) {
+    r->nfc = new NFCDevice(readerPins[r->index][0], readerPins[r->index][1], readerPins[r->index][2]);
+#if NFC_SIMULATION
+    r->nfcA = r->nfc;  // The simulator answers both protocols
+#else
+    r->nfcA = new NFCDeviceA(readerPins[r->index][0], readerPins[r->index][1], readerPins[r->index][2]);
+#endif
   }
   
   // Initialize PN5180
-  nfc->begin();
+  r->nfc->begin();
   delay(100);
   
-  nfc->reset();
+  r->nfc->reset();
   delay(100);
   
   // Read product version to verify communication
   uint8_t productVersion[2];
-  nfc->readEEprom(0x12, productVersion, sizeof(productVersion));
+  r->nfc->readEEprom(0x12, productVersion, sizeof(productVersion));
   
   Serial.print(F("PN5180 Version: "));
   Serial.print(productVersion[1]);
@@ -56,191 +280,1359 @@ bool initNFCReader() {
   // Check if we got valid data
   if (productVersion[1] == 0xFF && productVersion[0] == 0xFF) {
     Serial.println(F("ERROR: Cannot communicate with PN5180!"));
-    strcpy(nfcStatus.lastError, "No SPI communication");
-    nfcStatus.initialized = false;
-    nfcStatus.rfActive = false;
+    strcpy(r->status.lastError, "No SPI communication");
+    r->status.initialized = false;
+    r->status.rfActive = false;
+    publishStatus(r);
     return false;
   }
   
-  nfcStatus.productVersion = productVersion[1] * 10 + productVersion[0];
+  r->status.productVersion = productVersion[1] * 10 + productVersion[0];
   
-  // Setup RF for ISO15693 - CRITICAL: Only once!
-  Serial.println(F("Setting up ISO15693 protocol..."));
-  if (!nfc->setupRF()) {
+  // Setup RF for the first enabled protocol - CRITICAL: Only once! The
+  // scheduler reconfigures it only when it changes protocol
+  r->protocol = (protocolMask.load() & NFC_PROTOCOL_BIT(PROTOCOL_ISO15693)) ? PROTOCOL_ISO15693 : PROTOCOL_ISO14443A;
+  r->protocolStride = 1;
+  r->status.protocol = r->protocol;
+  Serial.print(F("Setting up "));
+  Serial.print(nfcProtocolName(r->protocol));
+  Serial.println(F(" protocol..."));
+  if (!setupProtocolRF(r, r->protocol)) {
     Serial.println(F("ERROR: setupRF failed!"));
-    strcpy(nfcStatus.lastError, "setupRF failed");
-    nfcStatus.initialized = false;
-    nfcStatus.rfActive = false;
+    strcpy(r->status.lastError, "setupRF failed");
+    r->status.initialized = false;
+    r->status.rfActive = false;
+    publishStatus(r);
     return false;
   }
   
-  nfcStatus.rfActive = true;
-  nfcStatus.initialized = true;
-  readerInitialized = true;
-  strcpy(nfcStatus.lastError, "Scanning...");
+  // LPCD needs the IRQ line and a calibrated detector (kept in EEPROM)
+  if (readerPins[r->index][3] != NFC_NO_PIN) {
+    pinMode(readerPins[r->index][3], INPUT);
+    r->nfc->prepareLPCD();
+  }
   
-  Serial.println(F("PN5180 ready for ISO15693 tags"));
+  r->status.rfActive = true;
+  r->status.initialized = true;
+  r->status.readersActive = 1;
+  r->initialized = true;
+  strcpy(r->status.lastError, "Scanning...");
   
+  publishStatus(r);
   return true;
 }
 
-void processNFCReader() {
-  if (!readerInitialized || nfc == nullptr) return;
+bool initNFCReader() {
+  Serial.println(F("\n=== PN5180 Initialization ==="));
   
-  unsigned long now = millis();
+  if (busMutex == nullptr) {
+    busMutex = xSemaphoreCreateMutex();
+  }
   
-  // Check for scan interval
-  if (now - lastScanTime < SCAN_INTERVAL) {
-    return;
+  // Each reader is brought up on its own; a missing module only costs
+  // its own coverage
+  int ready = 0;
+  for (int i = 0; i < NFC_READER_COUNT; i++) {
+    NFCReader* r = &readers[i];
+    r->index = i;
+    r->status = initialStatus;
+    r->scanInterval = SCAN_INTERVAL_MAX_DEFAULT;
+    if (initReader(r)) ready++;
   }
   
-  lastScanTime = now;
-  nfcStatus.totalScans++;
+  readerInitialized = (ready > 0);
+  if (!readerInitialized) return false;
+  
+  Serial.print(F("PN5180 ready for "));
+  uint8_t mask = protocolMask.load();
+  if (mask & NFC_PROTOCOL_BIT(PROTOCOL_ISO15693)) Serial.print(F("ISO15693 "));
+  if (mask & NFC_PROTOCOL_BIT(PROTOCOL_ISO14443A)) Serial.print(F("ISO14443A "));
+  Serial.print(F("tags ("));
+  Serial.print(ready);
+  Serial.print(F("/"));
+  Serial.print(NFC_READER_COUNT);
+  Serial.println(F(" readers)"));
+  return true;
+}
+
+// Check UID is valid (not all zeros or all 0xFF)
+static bool isValidUID(const uint8_t* uid) {
+  for (int i = 0; i < 8; i++) {
+    if (uid[i] != 0x00 && uid[i] != 0xFF) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Find the slot tracking this UID, or claim a free one (nullptr if full)
+// now = time of the scan that saw it (the record's own time in a replay)
+static TrackedTag* findOrAddTag(NFCReader* r, TagUID uid, unsigned long now) {
+  TrackedTag* freeSlot = nullptr;
+  for (int i = 0; i < MAX_TAGS; i++) {
+    if (r->tags[i].used) {
+      if (r->tags[i].uid == uid) return &r->tags[i];
+    } else if (freeSlot == nullptr) {
+      freeSlot = &r->tags[i];
+    }
+  }
+  if (freeSlot != nullptr) {
+    memset(freeSlot, 0, sizeof(TrackedTag));
+    freeSlot->used = true;
+    freeSlot->firstSeenTime = now;
+    freeSlot->firstSeenMicros = micros();
+    freeSlot->uid = uid;
+  }
+  return freeSlot;
+}
+
+static void fireTagEvent(NFCReader* r, TrackedTag* tag, TagEvent event, unsigned long now) {
+#if NFC_SIMULATION
+  if (event != TAG_PRESENT) {
+    r->nfc->noteTagEvent(event == TAG_ENTER);
+  }
+#endif
   
-  // CRITICAL: Just call getInventory, no reset/setupRF!
-  uint8_t uid[8];
-  memset(uid, 0, sizeof(uid));  // Clear buffer before reading
-  ISO15693ErrorCode rc = nfc->getInventory(uid);
+  // Stamped once with the scan's time, so every subscriber gets the same event
+  QueuedTagEvent queued;
+  queued.info.uid = tag->uid;
+  queued.info.event = event;
+  queued.info.reader = r->index;
+  queued.info.protocol = tag->protocol;
+  queued.info.time = now;
+  queued.sightingMicros = tag->firstSeenMicros;
   
-  if (rc == ISO15693_EC_OK) {
-    // Check if UID is valid (not all zeros or all 0xFF)
-    bool validUID = false;
-    bool allZeros = true;
-    bool allFF = true;
+  // Copy into every subscriber's queue (dispatchNFCEvents drains them)
+  uint8_t count = subscriberCount.load(std::memory_order_acquire);
+  for (int i = 0; i < count; i++) {
+    TagSubscriber* sub = &subscribers[i];
+    uint32_t head = sub->head.load(std::memory_order_relaxed);
+    uint32_t tail = sub->tail.load(std::memory_order_acquire);
     
-    for (int i = 0; i < 8; i++) {
-      if (uid[i] != 0x00) allZeros = false;
-      if (uid[i] != 0xFF) allFF = false;
-      if (uid[i] != 0x00 && uid[i] != 0xFF) {
-        validUID = true;
-      }
+    // This subscriber is behind - only it loses the event. Present events
+    // leave NFC_EVENT_RESERVE slots free for enters and leaves, which the
+    // caller holds back while any ring is full (see transitionSpace)
+    uint32_t limit = (event == TAG_PRESENT) ? NFC_EVENT_RING_SIZE - NFC_EVENT_RESERVE : NFC_EVENT_RING_SIZE;
+    if (head - tail >= limit) {
+      sub->dropped++;
+      continue;
     }
     
-    if (allZeros || allFF || !validUID) {
-      // Invalid UID - treat as no tag
-      nfcStatus.failedReads++;
-      
-      // Reset consecutive read counter
-      consecutiveReads = 0;
-      pendingUID = "";
-      
-      if (tagPresent && (now - lastTagTime > TAG_TIMEOUT)) {
-        Serial.println(F("Tag removed (timeout)"));
-        tagPresent = false;
-        strcpy(nfcStatus.lastError, "Scanning...");
-        if (tagCallback) {
-          tagCallback(lastUID.c_str(), false);
-        }
-        lastUID = "";  // Clear UID
-      }
-      return;
+    sub->ring[head % NFC_EVENT_RING_SIZE] = queued;
+    sub->head.store(head + 1, std::memory_order_release);
+  }
+}
+
+// Free space in the fullest subscriber queue (replay throttling)
+static uint32_t eventSpace() {
+  uint32_t space = NFC_EVENT_RING_SIZE;
+  uint8_t count = subscriberCount.load(std::memory_order_acquire);
+  for (int i = 0; i < count; i++) {
+    uint32_t queued = subscribers[i].head.load(std::memory_order_relaxed) -
+                      subscribers[i].tail.load(std::memory_order_acquire);
+    space = min(space, NFC_EVENT_RING_SIZE - queued);
+  }
+  return space;
+}
+
+// Can an enter/leave go out to every subscriber now? If not it waits for
+// the next scan rather than being dropped, so each enter gets its leave
+static bool transitionSpace(NFCReader* r) {
+  if (eventSpace() > 0) return true;
+  r->status.eventsDeferred++;
+  return false;
+}
+
+// ---- Tag memory (read on confirm, cached by UID) ----
+
+// Cached entry for a UID, or nullptr (caller holds memMux)
+static TagMemorySlot* findCachedMemory(TagUID uid) {
+  for (int i = 0; i < TAG_MEM_CACHE_SIZE; i++) {
+    if (memCache[i].used && memCache[i].memory.uid == uid) return &memCache[i];
+  }
+  return nullptr;
+}
+
+// Read system info and user blocks over RF (blocking, bus already held)
+static bool readTagMemory(NFCReader* r, TagUID uid, TagMemory* memory) {
+  uint8_t uidBytes[8];
+  uid.toBytes(uidBytes);
+  
+  memset(memory, 0, sizeof(TagMemory));
+  memory->uid = uid;
+  
+  uint8_t blockSize = 0;
+  uint8_t numBlocks = 0;
+  ISO15693ErrorCode rc = r->nfc->getSystemInfo(uidBytes, &blockSize, &numBlocks);
+  if (rc == ISO15693_EC_NOT_SUPPORTED || rc == ISO15693_EC_OPTION_NOT_SUPPORTED) {
+    return true;  // No readable memory - cache that so we don't keep asking
+  }
+  if (rc != ISO15693_EC_OK || blockSize == 0 || blockSize > TAG_MEM_MAX_BYTES) {
+    return false;
+  }
+  
+  uint8_t blocks = min((int)numBlocks, TAG_MEM_MAX_BYTES / blockSize);
+  rc = r->nfc->readMultipleBlock(uidBytes, 0, blocks, memory->data, blockSize);
+  if (rc != ISO15693_EC_OK) {
+    return false;
+  }
+  
+  memory->blockSize = blockSize;
+  memory->numBlocks = numBlocks;
+  memory->length = blocks * blockSize;
+  return true;
+}
+
+// Make sure a newly confirmed tag's memory is cached
+static void loadTagMemory(NFCReader* r, TagUID uid) {
+#if TAG_MEM_READ
+  if (replayActive) return;  // Replayed tags are not in the field
+  
+  portENTER_CRITICAL(&memMux);
+  TagMemorySlot* cached = findCachedMemory(uid);
+  if (cached != nullptr) cached->lastUsed = ++memCacheClock;
+  portEXIT_CRITICAL(&memMux);
+  
+  if (cached != nullptr) {
+    r->status.memCacheHits++;
+    return;
+  }
+  
+  TagMemory memory;
+  if (!readTagMemory(r, uid, &memory)) {
+    r->status.memReadErrors++;
+    return;
+  }
+  r->status.memRfReads++;
+  
+  // Store in a free slot, or over the least recently used one
+  portENTER_CRITICAL(&memMux);
+  TagMemorySlot* slot = &memCache[0];
+  for (int i = 0; i < TAG_MEM_CACHE_SIZE; i++) {
+    if (!memCache[i].used) {
+      slot = &memCache[i];
+      break;
     }
+    if (memCache[i].lastUsed < slot->lastUsed) slot = &memCache[i];
+  }
+  slot->used = true;
+  slot->lastUsed = ++memCacheClock;
+  slot->memory = memory;
+  portEXIT_CRITICAL(&memMux);
+#endif
+}
+
+// Record one tag seen in this inventory cycle (decisions in updateTags)
+static void processTagSighting(NFCReader* r, TagUID uid, uint8_t protocol, unsigned long now) {
+  TrackedTag* tag = findOrAddTag(r, uid, now);
+  if (tag == nullptr) {
+    char uidStr[TAG_UID_HEX_LEN];
+    Serial.print(F("Tag set full, ignoring: "));
+    Serial.println(uid.toHex(uidStr));
+    return;
+  }
+  
+  // Same UID reported twice in one cycle counts once
+  tag->seenThisCycle = true;
+  tag->protocol = protocol;
+}
+
+// Reads recorded in the policy's sliding window
+static uint8_t windowReads(const TrackedTag* tag) {
+  uint16_t windowMask = (uint16_t)((1UL << debounce.window) - 1);
+  return __builtin_popcount(tag->history & windowMask);
+}
+
+// Has a pending tag earned its enter event?
+static bool debounceConfirms(const TrackedTag* tag) {
+  if (debounce.mode == DEBOUNCE_CONSECUTIVE) {
+    uint16_t runMask = (uint16_t)((1UL << debounce.enterReads) - 1);
+    return (tag->history & runMask) == runMask;
+  }
+  return windowReads(tag) >= debounce.enterReads;
+}
+
+// Should a pending tag be forgotten?
+static bool debounceDiscards(const TrackedTag* tag) {
+  if (debounce.mode == DEBOUNCE_CONSECUTIVE) {
+    return !(tag->history & 1);  // Any miss resets the run
+  }
+  return windowReads(tag) == 0;  // Nothing left in the window
+}
+
+// Should a present tag that missed this scan leave?
+static bool debounceReleases(const NFCReader* r, const TrackedTag* tag, unsigned long now) {
+  // Tags are polled at the minimum interval, so 4 x 250ms = 1s, 4 x 50ms = 200ms
+  // (times the stride while the scheduler alternates protocols)
+  unsigned long tagTimeout = (unsigned long)debounce.timeoutScans * scanIntervalMin * r->protocolStride;
+  if (now - tag->lastTagTime > tagTimeout) return true;
+  
+  if (debounce.mode == DEBOUNCE_HYSTERESIS) {
+    return windowReads(tag) < debounce.leaveReads;
+  }
+  return false;
+}
+
+// Pick up a policy staged by setNFCDebounce() (once per round, all readers)
+static void applyPendingDebounce() {
+  if (!debounceChanged.load(std::memory_order_acquire)) return;
+  
+  portENTER_CRITICAL(&statusMux);
+  debounce = pendingDebounce;
+  debounceChanged.store(false, std::memory_order_relaxed);
+  portEXIT_CRITICAL(&statusMux);
+  for (int i = 0; i < NFC_READER_COUNT; i++) {
+    readers[i].status.debounceMode = debounce.mode;
+  }
+}
+
+// Pick up scan intervals staged by setNFCScanIntervals() (every reader
+// restarts from the new minimum)
+static void applyPendingIntervals() {
+  if (!intervalsChanged.load(std::memory_order_acquire)) return;
+  
+  portENTER_CRITICAL(&statusMux);
+  scanIntervalMin = pendingIntervalMin;
+  scanIntervalMax = pendingIntervalMax;
+  intervalsChanged.store(false, std::memory_order_relaxed);
+  portEXIT_CRITICAL(&statusMux);
+  for (int i = 0; i < NFC_READER_COUNT; i++) {
+    NFCReader* r = &readers[i];
+    r->scanInterval = scanIntervalMin;
+    r->status.scanInterval = r->scanInterval;
+    publishStatus(r);
+  }
+}
+
+// Apply the debounce policy to every tracked tag after an inventory cycle
+// Only tags of the scanned protocol are judged - the others were not asked
+// (unless their protocol has been switched off, so they leave)
+static void updateTags(NFCReader* r, uint8_t protocol, unsigned long now) {
+  uint8_t mask = protocolMask.load(std::memory_order_relaxed);
+  
+  for (int i = 0; i < MAX_TAGS; i++) {
+    TrackedTag* tag = &r->tags[i];
+    if (!tag->used) continue;
+    if (tag->protocol != protocol && (mask & NFC_PROTOCOL_BIT(tag->protocol))) continue;
     
-    // Tag detected with valid UID
-    nfcStatus.successfulReads++;
-    nfcStatus.lastSuccessTime = now;
+    bool seen = tag->seenThisCycle;
+    tag->seenThisCycle = false;
+    tag->history = (tag->history << 1) | (seen ? 1 : 0);
     
-    // Format UID as hex string (MSB first)
-    String uidStr = "";
-    for (int i = 7; i >= 0; i--) {
-      if (uid[i] < 0x10) uidStr += "0";
-      uidStr += String(uid[i], HEX);
+    if (!tag->present) {
+      if (seen && debounceConfirms(tag) && transitionSpace(r)) {
+        tag->present = true;
+        tag->missedScans = 0;
+        tag->lastTagTime = now;
+        r->status.tagsPresent++;
+        
+        // Detection latency (first sighting to confirmed)
+        r->status.lastDetectLatency = now - tag->firstSeenTime;
+        r->detectCount++;
+        r->totalDetectLatency += r->status.lastDetectLatency;
+        r->status.avgDetectLatency = r->totalDetectLatency / r->detectCount;
+        strcpy(r->status.lastError, "Tag present");
+        
+        // Memory is cached before the enter event so consumers can use it
+        if (tag->protocol == PROTOCOL_ISO15693) loadTagMemory(r, tag->uid);
+        fireTagEvent(r, tag, TAG_ENTER, now);
+      } else if (seen) {
+#if NFC_DEBUG_PENDING
+        char uidStr[TAG_UID_HEX_LEN];
+        Serial.print(F("Pending read ("));
+        Serial.print(windowReads(tag));
+        Serial.print(F("/"));
+        Serial.print(debounce.enterReads);
+        Serial.print(F("): "));
+        Serial.println(tag->uid.toHex(uidStr));
+#endif
+      } else if (debounceDiscards(tag)) {
+        // Transient sighting - would have been a Read/Unread flap
+        r->status.suppressedEnters++;
+        tag->used = false;
+      }
+      continue;
     }
-    uidStr.toUpperCase();
     
-    // Check if this is a consecutive read of the same UID
-    if (uidStr == pendingUID) {
-      consecutiveReads++;
-    } else {
-      // Different UID or first read
-      pendingUID = uidStr;
-      consecutiveReads = 1;
-    }
-    
-    // Only process tag if we've seen it REQUIRED_CONSECUTIVE_READS times
-    if (consecutiveReads < REQUIRED_CONSECUTIVE_READS) {
-      Serial.print(F("Pending read ("));
-      Serial.print(consecutiveReads);
-      Serial.print(F("/")); 
-      Serial.print(REQUIRED_CONSECUTIVE_READS);
-      Serial.print(F("): "));
-      Serial.println(uidStr);
-      return;  // Wait for more consecutive reads
-    }
-    
-    if (uidStr != lastUID) {
-      // New tag (confirmed by consecutive reads)
-      Serial.print(F("Tag detected: "));
-      Serial.println(uidStr);
-      
-      lastUID = uidStr;
-      tagPresent = true;
-      lastTagTime = now;
-      
-      strcpy(nfcStatus.lastError, "Tag present");
+    if (seen) {
+      // Missed scans bridged by the policy - would have been a flap
+      if (tag->missedScans > 0) r->status.suppressedLeaves++;
+      tag->missedScans = 0;
+      tag->lastTagTime = now;
       
-      // Trigger callback
-      if (tagCallback) {
-        tagCallback(uidStr.c_str(), true);
+      // Trigger callback to allow Continuing messages to be published
+      fireTagEvent(r, tag, TAG_PRESENT, now);
+      continue;
+    }
+    
+    if (tag->missedScans < 255) tag->missedScans++;
+    
+    // Check for tag removal
+    if (debounceReleases(r, tag, now) && transitionSpace(r)) {
+      tag->present = false;
+      if (r->status.tagsPresent > 0) r->status.tagsPresent--;
+      if (r->status.tagsPresent == 0) {
+        strcpy(r->status.lastError, "Scanning...");
       }
       
-    } else if (!tagPresent) {
-      // Same tag returning after timeout (confirmed by consecutive reads)
-      Serial.print(F("Tag returned: "));
-      Serial.println(uidStr);
+      // Trigger callback
+      fireTagEvent(r, tag, TAG_LEAVE, now);
       
-      tagPresent = true;
-      lastTagTime = now;
+      // CRITICAL: Free the slot to prevent spurious re-detection
+      tag->used = false;
+    }
+  }
+}
+
+// Forget every tracked tag, sending leave events for confirmed ones
+// (switching between live scanning and replay)
+static void resetTags(NFCReader* r, unsigned long now) {
+  for (int i = 0; i < MAX_TAGS; i++) {
+    if (r->tags[i].used && r->tags[i].present) {
+      fireTagEvent(r, &r->tags[i], TAG_LEAVE, now);
+    }
+    r->tags[i].used = false;
+  }
+  r->status.tagsPresent = 0;
+}
+
+// Copy the task-owned status where other cores can read it
+static void publishStatus(NFCReader* r) {
+  portENTER_CRITICAL(&statusMux);
+  r->shared = r->status;
+  portEXIT_CRITICAL(&statusMux);
+}
+
+// Effective scan rate over a one second window
+static void updateScanRate(NFCReader* r, unsigned long now) {
+  r->rateWindowScans++;
+  unsigned long elapsed = now - r->rateWindowStart;
+  if (elapsed >= 1000) {
+    r->status.scanRate = r->rateWindowScans * 1000.0 / elapsed;
+    r->rateWindowScans = 0;
+    r->rateWindowStart = now;
+  }
+}
+
+// Pick the interval until the next scan
+static void scheduleNextScan(NFCReader* r, unsigned long now) {
+  bool active = false;
+  for (int i = 0; i < MAX_TAGS; i++) {
+    if (r->tags[i].used) {
+      active = true;
+      break;
+    }
+  }
+  
+  if (active) {
+    // Tag pending or present - poll as fast as allowed
+    r->lastActivityTime = now;
+    r->scanInterval = scanIntervalMin;
+  } else if (now - r->lastActivityTime < SCAN_BACKOFF_DELAY) {
+    // Field only just emptied - keep polling fast for a returning tag
+    r->scanInterval = scanIntervalMin;
+  } else {
+    // Field quiet - back off towards the maximum interval
+    uint32_t next = (uint32_t)r->scanInterval * 2;
+    r->scanInterval = (next > scanIntervalMax) ? scanIntervalMax : next;
+  }
+  
+  r->status.scanInterval = r->scanInterval;
+}
+
+// Bucket for a latency: values below LATENCY_SUB_BUCKETS are exact, above
+// that each power of two is split into LATENCY_SUB_BUCKETS equal parts
+static int latencyBucket(uint32_t us) {
+  if (us < LATENCY_SUB_BUCKETS) return us;
+  int msb = 31 - __builtin_clz(us);
+  int octave = msb - LATENCY_SUB_BITS + 1;
+  int sub = (us >> (msb - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1);
+  int index = octave * LATENCY_SUB_BUCKETS + sub;
+  return (index < LATENCY_BUCKETS) ? index : LATENCY_BUCKETS - 1;
+}
+
+// Largest value that lands in a bucket
+static uint32_t latencyBucketLimit(int index) {
+  if (index < LATENCY_SUB_BUCKETS) return index;
+  int octave = index / LATENCY_SUB_BUCKETS;
+  int sub = index % LATENCY_SUB_BUCKETS;
+  uint32_t lower = (uint32_t)(LATENCY_SUB_BUCKETS + sub) << (octave - 1);
+  return lower + (1UL << (octave - 1)) - 1;
+}
+
+static void recordLatency(LatencyHistogram* hist, uint32_t us) {
+  hist->buckets[latencyBucket(us)]++;
+  hist->count++;
+  if (us > hist->max) hist->max = us;
+}
+
+static void summarizeLatency(const LatencyHistogram* hist, LatencySummary* out) {
+  out->count = hist->count;
+  out->max = hist->max;
+  out->p50 = out->p90 = out->p99 = 0;
+  if (out->count == 0) return;
+  
+  // Walk the buckets once, filling each percentile as its rank is reached
+  const uint8_t percents[3] = { 50, 90, 99 };
+  uint32_t* results[3] = { &out->p50, &out->p90, &out->p99 };
+  int next = 0;
+  uint32_t seen = 0;
+  for (int i = 0; i < LATENCY_BUCKETS && next < 3; i++) {
+    seen += hist->buckets[i];
+    uint32_t limit = min(latencyBucketLimit(i), out->max);
+    while (next < 3 && (uint64_t)seen * 100 >= (uint64_t)out->count * percents[next]) {
+      *results[next++] = limit;
+    }
+  }
+}
+
+// ---- Inventory transaction (issue / poll / collect) ----
+// The 16-slot inventory is driven one step per processNFCReader() call so
+// the loop never waits on RF: each call does at most one IRQ status read
+// plus, when a slot completes, one RX read and the next slot's EOF.
+
+// Start an inventory round (optionally masked for collision resolution)
+static void issueInventory(NFCReader* r, uint32_t mask, uint8_t maskLen) {
+  // Full command frame needs the normal TX config (EOF-only mode is cleared)
+  r->nfc->writeRegister(TX_CONFIG, r->inv.txConfig);
+  
+  uint8_t cmd[7];
+  cmd[0] = ISO15693_INVENTORY_FLAGS;  // 16 slots, high data rate, inventory
+  cmd[1] = ISO15693_CMD_INVENTORY;
+  cmd[2] = maskLen;                   // Mask length in bits
+  int cmdLen = 3;
+  for (int i = 0; i < (maskLen + 7) / 8; i++) {
+    cmd[cmdLen++] = (uint8_t)(mask >> (8 * i));  // Mask value, LSB first
+  }
+  
+  r->inv.mask = mask;
+  r->inv.maskLen = maskLen;
+  r->inv.slot = 0;
+  r->nfc->clearIRQStatus(0x000FFFFF);
+  r->nfc->sendData(cmd, cmdLen);
+  r->inv.slotStart = micros();
+}
+
+// Advance to the next slot by sending an EOF only
+static void issueNextSlot(NFCReader* r) {
+  r->nfc->writeRegisterWithAndMask(TX_CONFIG, 0xFFFFFB3F);  // EOF only, no data/SOF
+  uint8_t eof = 0;
+  r->nfc->clearIRQStatus(0x000FFFFF);
+  r->nfc->sendData(&eof, 0);
+  r->inv.slotStart = micros();
+}
+
+static void startInventory(NFCReader* r) {
+  r->inv.numCard = 0;
+  r->inv.collisions = 0;
+  r->inv.integrityErrors = 0;
+  r->inv.protocolErrors = 0;
+  r->inv.queueLen = 0;
+  r->inv.result = ISO15693_EC_OK;
+  memset(r->inv.uids, 0, sizeof(r->inv.uids));  // Clear buffer before reading
+  
+  // Remember TX config so it can be restored after EOF-only slots
+  r->nfc->readRegister(TX_CONFIG, &r->inv.txConfig);
+  
+  issueInventory(r, 0, 0);
+  r->inv.state = INV_WAIT_SLOT;
+}
+
+// Read the response of the current slot
+static void collectSlot(NFCReader* r) {
+  uint32_t rxStatus = 0;
+  r->nfc->readRegister(RX_STATUS, &rxStatus);
+  uint16_t len = rxStatus & 0x000001FF;
+  
+  if (rxStatus & 0x00070000) {
+    r->status.lastRxStatus = rxStatus;
+  }
+  if ((rxStatus >> 16) & 0x01) r->inv.integrityErrors++;
+  if ((rxStatus >> 17) & 0x01) r->inv.protocolErrors++;
+  
+  if ((rxStatus >> 18) & 0x01) {
+    // Two or more tags answered in this slot - resolve with a longer mask
+    r->inv.collisions++;
+    if (r->inv.queueLen < NFC_MAX_MASK_ROUNDS && r->inv.maskLen + 4 <= 32) {
+      r->inv.queue[r->inv.queueLen].mask = r->inv.mask | ((uint32_t)r->inv.slot << r->inv.maskLen);
+      r->inv.queue[r->inv.queueLen].maskLen = r->inv.maskLen + 4;
+      r->inv.queueLen++;
+    }
+    return;
+  }
+  
+  if (len == 0) return;
+  r->status.lastRxStatus = rxStatus;
+  
+  uint8_t response[16];
+  if (len > sizeof(response)) len = sizeof(response);
+  r->nfc->readData(len, response);
+  
+  if (response[0] & 0x01) {
+    // Error flag set - second byte is the ISO15693 error code
+    r->inv.result = (ISO15693ErrorCode)response[1];
+    return;
+  }
+  
+  // Flags, DSFID, then 8 byte UID (LSB first)
+  if (len >= 10 && r->inv.numCard < MAX_TAGS) {
+    memcpy(&r->inv.uids[r->inv.numCard * 8], &response[2], 8);
+    r->inv.numCard++;
+  }
+}
+
+// Poll the running inventory - returns true once the whole round is done
+static bool pollInventory(NFCReader* r) {
+  uint32_t irq = r->nfc->getIRQStatus();
+  unsigned long elapsed = micros() - r->inv.slotStart;
+  
+  if (irq & RX_IRQ_STAT) {
+    collectSlot(r);
+  } else if (irq & GENERAL_ERROR_IRQ_STAT) {
+    r->inv.result = ISO15693_EC_UNKNOWN_ERROR;
+  } else if (irq & RX_SOF_DET_IRQ_STAT) {
+    // Tag is answering - wait for the rest of the frame
+    if (elapsed < NFC_RX_TIMEOUT_US) return false;
+  } else if (elapsed < NFC_SOF_TIMEOUT_US) {
+    return false;  // Nothing yet - check again next call
+  }
+  // Otherwise no answer in time - empty slot
+  
+  r->inv.slot++;
+  if (r->inv.slot < 16) {
+    issueNextSlot(r);
+    return false;
+  }
+  
+  // Round finished - run any collision masks that were queued
+  if (r->inv.queueLen > 0) {
+    r->inv.queueLen--;
+    issueInventory(r, r->inv.queue[r->inv.queueLen].mask, r->inv.queue[r->inv.queueLen].maskLen);
+    return false;
+  }
+  
+  r->nfc->writeRegister(TX_CONFIG, r->inv.txConfig);
+  
+  recordLatency(&inventoryHist, micros() - r->inventoryStartMicros);
+  
+  // Signal level for this scan (RF is still on)
+  uint32_t agc = 0;
+  r->nfc->readRegister(PN5180_AGC_VALUE, &agc);
+  r->inv.agc = agc & 0x3FF;
+  
+  r->inv.state = INV_IDLE;
+  return true;
+}
+
+// Histogram band for an AGC value (out-of-range values go to the end bands)
+static uint8_t agcBand(uint16_t agc) {
+  if (agc <= RF_HIST_BASE) return 0;
+  uint16_t band = (agc - RF_HIST_BASE) >> RF_HIST_SHIFT;
+  return (band < RF_HIST_BUCKETS) ? band : RF_HIST_BUCKETS - 1;
+}
+
+// Add one scan to the RF quality window and histogram
+static void recordRFSample(NFCReader* r, uint16_t agc, bool read) {
+  RFSample* slot = &r->rfWindow[r->rfWindowNext];
+  
+  if (r->rfWindowCount == RF_HIST_WINDOW) {
+    // Window full - the oldest sample drops out of the histogram
+    uint8_t oldBand = agcBand(slot->agc);
+    r->status.rfHistScans[oldBand]--;
+    if (slot->read) r->status.rfHistReads[oldBand]--;
+  } else {
+    r->rfWindowCount++;
+  }
+  
+  slot->agc = agc;
+  slot->read = read;
+  r->rfWindowNext = (r->rfWindowNext + 1) % RF_HIST_WINDOW;
+  
+  uint8_t band = agcBand(agc);
+  r->status.rfHistScans[band]++;
+  if (read) r->status.rfHistReads[band]++;
+  
+  r->status.agcValue = agc;
+  r->status.agcMin = 0x3FF;
+  r->status.agcMax = 0;
+  for (int i = 0; i < r->rfWindowCount; i++) {
+    if (r->rfWindow[i].agc < r->status.agcMin) r->status.agcMin = r->rfWindow[i].agc;
+    if (r->rfWindow[i].agc > r->status.agcMax) r->status.agcMax = r->rfWindow[i].agc;
+  }
+}
+
+// Apply the results of one complete inventory round
+static void processInventoryResult(NFCReader* r, uint8_t protocol, ISO15693ErrorCode rc, const uint8_t* uids,
+                                   uint8_t numCard, unsigned long now) {
+  int validCount = 0;
+  
+  if (numCard > 0) {
+    for (int t = 0; t < numCard; t++) {
+      const uint8_t* uid = &uids[t * 8];
       
-      if (tagCallback) {
-        tagCallback(uidStr.c_str(), true);
+      if (!isValidUID(uid)) {
+        continue;  // Invalid UID - treat as no tag
       }
+      validCount++;
       
-    } else {
-      // Same tag still present - update time and trigger callback
-      lastTagTime = now;
+      processTagSighting(r, TagUID::fromBytes(uid), protocol, now);
+    }
+    
+    if (validCount > 0) {
+      // At least one tag detected with valid UID
+      r->successfulReads++;
+      r->status.lastSuccessTime = now;
       
-      // Trigger callback to allow Continuing messages to be published
-      if (tagCallback) {
-        tagCallback(uidStr.c_str(), true);
+      // First read since leaving LPCD
+      if (r->wakeReason == WAKE_IRQ) {
+        uint32_t us = micros() - r->wakeMicros;
+        recordLatency(&wakeHist, us);
+        r->status.lastWakeLatency = us / 1000;
+      } else if (r->wakeReason == WAKE_CHECK) {
+        r->status.lpcdMissed++;  // Tag was there but the detector didn't fire
       }
+      r->wakeReason = WAKE_NONE;
+    } else {
+      r->failedReads++;
     }
     
-  } else if (rc != 0x01) {
-    // Error (0x01 is normal "no tag")
-    nfcStatus.failedReads++;
+  } else if (rc != ISO15693_EC_OK) {
+    // Error response (an empty field is not an error)
+    r->failedReads++;
     
-    // Reset consecutive read counter
-    consecutiveReads = 0;
-    pendingUID = "";
+    if (r->status.tagsPresent == 0 &&
+        (r->successfulReads.load() > 0 || r->totalScans.load() > 10)) {
+      strcpy(r->status.lastError, "No tag in range");
+    }
+  }
+  
+  // RF capture only describes live ISO15693 inventories
+  if (!replayActive && protocol == PROTOCOL_ISO15693) {
+    r->status.rxIntegrityErrors += r->inv.integrityErrors;
+    r->status.rxProtocolErrors += r->inv.protocolErrors;
+    r->status.rxCollisions += r->inv.collisions;
+    recordRFSample(r, r->inv.agc, validCount > 0);
+  }
+  
+  updateTags(r, protocol, now);
+  scheduleNextScan(r, now);
+  publishStatus(r);
+}
+
+// ---- LPCD idle ----
+
+// Has the PN5180 flagged a card? (reads the IRQ line only - any SPI access
+// would wake it)
+static bool lpcdTriggered(NFCReader* r) {
+#if NFC_SIMULATION
+  return r->nfc->lpcdTriggered();
+#else
+  return digitalRead(readerPins[r->index][3]) == HIGH;
+#endif
+}
+
+// Should this reader go (back) to LPCD after the scan that just finished?
+static bool lpcdDue(NFCReader* r, unsigned long now) {
+  uint32_t quiet = lpcdQuietMs.load(std::memory_order_relaxed);
+  if (quiet == 0 || replayActive || !lpcdCapable(r)) return false;
+  for (int i = 0; i < MAX_TAGS; i++) {
+    if (r->tags[i].used) return false;
+  }
+  
+  if (r->wakeReason == WAKE_CHECK) return true;  // Routine check found nothing
+  if (r->wakeReason == WAKE_IRQ) return now - r->wakeTime >= SCAN_BACKOFF_DELAY;
+  return now - r->lastActivityTime >= quiet;
+}
+
+// Drop the RF field and let the PN5180 watch for a card (bus held)
+static void enterLPCD(NFCReader* r, unsigned long now) {
+  if (r->wakeReason == WAKE_IRQ) r->status.lpcdFalseWakes++;
+  r->wakeReason = WAKE_NONE;
+  
+  if (!r->nfc->switchToLPCD(NFC_LPCD_WAKE_MS)) {
+    // Try again after another quiet period
+    strcpy(r->status.lastError, "LPCD failed");
+    r->lastActivityTime = now;
+    return;
+  }
+  
+  r->lpcd = true;
+  r->lpcdStart = now;
+  r->status.lpcdActive = true;
+  r->status.rfActive = false;
+  r->status.scanRate = 0;
+  strcpy(r->status.lastError, "LPCD idle");
+  publishStatus(r);
+}
+
+// Back to full-rate inventory (bus held)
+static void leaveLPCD(NFCReader* r, unsigned long now, bool triggered) {
+  // Reset is the way out of LPCD; RF has to be set up again after it
+  r->nfc->reset();
+  bool rfOk = setupProtocolRF(r, r->protocol);
+  
+  r->lpcd = false;
+  r->status.lpcdActive = false;
+  r->status.rfActive = rfOk;
+  r->status.idleTime += now - r->lpcdStart;
+  strcpy(r->status.lastError, rfOk ? "Scanning..." : "setupRF failed");
+  
+  r->wakeReason = triggered ? WAKE_IRQ : WAKE_CHECK;
+  r->wakeTime = now;
+  r->wakeMicros = micros();
+  if (triggered) {
+    r->status.lpcdWakeups++;
+    r->lastActivityTime = now;  // Poll fast - a tag is on its way in
+  }
+  
+  // Scan on the next step
+  r->scanInterval = scanIntervalMin;
+  r->lastScanTime = now - scanIntervalMin;
+  publishStatus(r);
+}
+
+// Is every reader idle in LPCD? (the scan task can then slow down or sleep)
+static bool allReadersIdle() {
+  if (replayActive) return false;
+  for (int i = 0; i < NFC_READER_COUNT; i++) {
+    if (readers[i].initialized && !readers[i].lpcd) return false;
+  }
+  return true;
+}
+
+#if NFC_LPCD_LIGHT_SLEEP && !NFC_SIMULATION
+// Light-sleep the ESP32 until an IRQ line rises or the next routine check
+// Returns false without sleeping if no idle reader has an IRQ line to
+// wake on (the caller waits NFC_LPCD_POLL_MS instead)
+static bool lightSleepUntilWake() {
+  unsigned long now = millis();
+  uint32_t sleepMs = NFC_LPCD_CHECK_MS;
+  int wakePins = 0;
+  for (int i = 0; i < NFC_READER_COUNT; i++) {
+    NFCReader* r = &readers[i];
+    if (!r->initialized || !r->lpcd || readerPins[i][3] == NFC_NO_PIN) continue;
+    unsigned long idle = now - r->lpcdStart;
+    sleepMs = min(sleepMs, (uint32_t)(idle < NFC_LPCD_CHECK_MS ? NFC_LPCD_CHECK_MS - idle : 0));
+    gpio_wakeup_enable((gpio_num_t)readerPins[i][3], GPIO_INTR_HIGH_LEVEL);
+    wakePins++;
+  }
+  if (wakePins == 0) return false;
+  if (sleepMs == 0) return true;  // Routine check due now
+  
+  esp_sleep_enable_gpio_wakeup();
+  esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000);
+  esp_light_sleep_start();
+  return true;
+}
+#endif
+
+// Feed recorded inventory results through the normal debounce/timeout path
+// Returns true while a replay is running (the PN5180s are left idle)
+static bool processReplay() {
+  // Let live inventories finish first
+  for (int i = 0; i < NFC_READER_COUNT; i++) {
+    if (readers[i].inv.state != INV_IDLE) return false;
+  }
+  
+  bool active = traceReplayActive();
+  if (active != replayActive) {
+    // Switch once every ring has room for the leaves of the tags present
+    uint32_t leaving = 0;
+    for (int i = 0; i < NFC_READER_COUNT; i++) {
+      leaving += readers[i].status.tagsPresent;
+    }
+    if (eventSpace() < leaving) return replayActive;
     
-    if (nfcStatus.successfulReads > 0 || nfcStatus.totalScans > 10) {
-      strcpy(nfcStatus.lastError, "No tag in range");
+    unsigned long now = millis();
+    for (int i = 0; i < NFC_READER_COUNT; i++) {
+      resetTags(&readers[i], now);
+    }
+    replayActive = active;
+    for (int i = 0; i < NFC_READER_COUNT; i++) {
+      publishStatus(&readers[i]);
     }
   }
+  if (!active) return false;
   
-  // Check for tag removal
-  if (tagPresent && (now - lastTagTime > TAG_TIMEOUT)) {
-    Serial.print(F("Tag removed: "));
-    Serial.println(lastUID);
+  // Fast replay runs a batch per call, but never outruns the slowest subscriber
+  TraceEntry entry;
+  for (int i = 0; i < NFC_REPLAY_BATCH; i++) {
+    if (eventSpace() < MAX_TAGS) break;
+    if (!traceReplayNext(&entry)) break;
     
-    tagPresent = false;
-    strcpy(nfcStatus.lastError, "Scanning...");
+    // Records from a reader this build doesn't have go to reader 0
+    NFCReader* r = &readers[entry.reader < NFC_READER_COUNT ? entry.reader : 0];
+    ISO15693ErrorCode rc = (entry.rc == NFC_TRACE_NO_CARD) ? EC_NO_CARD : (ISO15693ErrorCode)entry.rc;
+    r->totalScans++;
+    processInventoryResult(r, entry.protocol, rc, entry.uids, entry.numCard, entry.time);
+  }
+  return true;
+}
+
+// ---- Protocol scheduler ----
+
+// Is any tag of this protocol pending or present?
+static bool protocolHasTags(NFCReader* r, uint8_t protocol) {
+  for (int i = 0; i < MAX_TAGS; i++) {
+    if (r->tags[i].used && r->tags[i].protocol == protocol) return true;
+  }
+  return false;
+}
+
+// Pick the protocol for the next scan
+// A switch costs an RF reconfiguration, so stay put while only this
+// protocol's tags are in the field (with a look at the other every
+// NFC_PROTOCOL_PEEK scans); alternate when the field is empty or both
+// kinds are present.
+static uint8_t nextProtocol(NFCReader* r) {
+  uint8_t mask = protocolMask.load(std::memory_order_relaxed);
+  if (mask != NFC_PROTOCOLS_ALL) {
+    r->protocolStride = 1;
+    return (mask & NFC_PROTOCOL_BIT(PROTOCOL_ISO14443A)) ? PROTOCOL_ISO14443A : PROTOCOL_ISO15693;
+  }
+  
+  uint8_t other = (r->protocol == PROTOCOL_ISO15693) ? PROTOCOL_ISO14443A : PROTOCOL_ISO15693;
+  bool here = protocolHasTags(r, r->protocol);
+  bool there = protocolHasTags(r, other);
+  r->protocolStride = (here && there) ? 2 : 1;
+  
+  if (here && !there && r->protocolRun < NFC_PROTOCOL_PEEK) {
+    r->protocolRun++;
+    return r->protocol;
+  }
+  return other;
+}
+
+// Reconfigure RF for another protocol (bus held) - dropping the field
+// first also returns any ISO14443A card to IDLE
+static bool switchProtocol(NFCReader* r, uint8_t protocol) {
+  r->nfc->setRF_off();
+  bool rfOk = setupProtocolRF(r, protocol);
+  
+  r->protocol = protocol;
+  r->protocolRun = 0;
+  r->status.protocol = protocol;
+  r->status.protocolSwitches++;
+  r->status.rfActive = rfOk;
+  if (!rfOk) strcpy(r->status.lastError, "setupRF failed");
+  return rfOk;
+}
+
+// One ISO14443A scan - WUPA, anticollision and select for one card, then
+// HLTA so it answers the next scan's WUPA again. Unlike the 15693 slots this
+// blocks for the whole exchange (a few ms); results land in r->inv.
+static void scanTypeA(NFCReader* r) {
+  uint8_t response[10];  // ATQA, SAK, then the UID
+  uint8_t uidLength = r->nfcA->activateTypeA(response, 1);
+  
+  r->inv.numCard = 0;
+  r->inv.result = ISO15693_EC_OK;  // Nothing answering is not an error
+  memset(r->inv.uids, 0, 8);
+  if (uidLength == 4 || uidLength == 7) {
+    TagUID::fromTypeA(&response[3], uidLength).toBytes(r->inv.uids);
+    r->inv.numCard = 1;
+    r->nfcA->mifareHalt();
+  }
+  
+  recordLatency(&inventoryHist, micros() - r->inventoryStartMicros);
+}
+
+// Record and apply a finished scan, then idle if the field has gone quiet
+static void finishScan(NFCReader* r) {
+  unsigned long doneTime = millis();
+  traceRecord(doneTime, r->inv.result, r->inv.uids, r->inv.numCard, r->index, r->protocol);
+  processInventoryResult(r, r->protocol, r->inv.result, r->inv.uids, r->inv.numCard, doneTime);
+  if (lpcdDue(r, doneTime)) enterLPCD(r, doneTime);
+}
+
+// Does a reader need the bus? (scan due or running, or LPCD wake)
+static bool readerDue(NFCReader* r, unsigned long now) {
+  if (!r->initialized) return false;
+  if (r->lpcd) return lpcdTriggered(r) || now - r->lpcdStart >= NFC_LPCD_CHECK_MS;
+  return r->inv.state != INV_IDLE || now - r->lastScanTime >= r->scanInterval;
+}
+
+// Advance one reader's inventory by one step (bus already held)
+static void stepReader(NFCReader* r, unsigned long now) {
+  if (r->lpcd) {
+    bool triggered = lpcdTriggered(r);
+    if (triggered || now - r->lpcdStart >= NFC_LPCD_CHECK_MS) {
+      leaveLPCD(r, now, triggered);
+    }
+    return;
+  }
+  
+  if (r->inv.state == INV_IDLE) {
+    // Check for scan interval
+    if (now - r->lastScanTime < r->scanInterval) {
+      return;
+    }
+    
+    // How late this scan starts against its schedule
+    uint32_t startMicros = micros();
+    if (r->lastScanMicros != 0) {
+      uint32_t sinceLast = startMicros - r->lastScanMicros;
+      uint32_t due = (uint32_t)r->scanInterval * 1000;
+      recordLatency(&jitterHist, (sinceLast > due) ? sinceLast - due : 0);
+    }
+    r->lastScanMicros = startMicros;
+    r->inventoryStartMicros = startMicros;
     
-    // Trigger callback
-    if (tagCallback) {
-      tagCallback(lastUID.c_str(), false);
+    r->lastScanTime = now;
+    r->totalScans++;
+    updateScanRate(r, now);
+    
+    // RF is only set up again when the scheduler changes protocol
+    uint8_t protocol = nextProtocol(r);
+    if (protocol != r->protocol && !switchProtocol(r, protocol)) {
+      publishStatus(r);
+      return;
+    }
+    
+    if (protocol == PROTOCOL_ISO14443A) {
+      scanTypeA(r);
+      finishScan(r);
+      return;
     }
     
-    // CRITICAL: Clear lastUID to prevent spurious re-detection
-    lastUID = "";
+    // CRITICAL: Just run the inventory, no reset/setupRF!
+    startInventory(r);
+  } else if (pollInventory(r)) {
+    finishScan(r);
   }
 }
 
-void setTagCallback(TagCallback callback) {
-  tagCallback = callback;
+void processNFCReader() {
+  if (!readerInitialized) return;
+  applyPendingDebounce();
+  applyPendingIntervals();
+  if (processReplay()) return;
+  
+  unsigned long now = millis();
+  
+  // Only take the bus when some reader has a scan due or in flight
+  bool due = false;
+  for (int i = 0; i < NFC_READER_COUNT && !due; i++) {
+    due = readerDue(&readers[i], now);
+  }
+  if (!due) return;
+  
+  unsigned long startMicros = micros();
+  lockNFCBus();
+  
+  // Round robin - every reader gets one step per call, starting one further
+  // along each time. A reader waiting on RF costs a single IRQ status read,
+  // so its slot timeout runs while the others use the bus.
+  for (int n = 0; n < NFC_READER_COUNT; n++) {
+    NFCReader* r = &readers[(nextReader + n) % NFC_READER_COUNT];
+    if (r->initialized) stepReader(r, now);
+  }
+  nextReader = (nextReader + 1) % NFC_READER_COUNT;
+  
+  unlockNFCBus();
+  
+  // Time spent in this call (the loop is blocked for this long)
+  unsigned long elapsed = micros() - startMicros;
+  lastProcessTime = elapsed;
+  if (elapsed > maxProcessTime) {
+    maxProcessTime = elapsed;
+  }
+}
+
+// Scan task - polls the PN5180 state machine, yielding between steps
+static void nfcTask(void* param) {
+  for (;;) {
+    processNFCReader();
+    
+    if (!allReadersIdle()) {
+      vTaskDelay(1);
+      continue;
+    }
+    // Only IRQ lines to watch
+#if NFC_LPCD_LIGHT_SLEEP && !NFC_SIMULATION
+    if (lightSleepUntilWake()) continue;
+#endif
+    vTaskDelay(pdMS_TO_TICKS(NFC_LPCD_POLL_MS));
+  }
+}
+
+bool startNFCTask() {
+  if (!readerInitialized || nfcTaskHandle != nullptr) return false;
+  
+  BaseType_t rc = xTaskCreatePinnedToCore(nfcTask, "nfc_scan", NFC_TASK_STACK, nullptr,
+                                          NFC_TASK_PRIORITY, &nfcTaskHandle, NFC_TASK_CORE);
+  if (rc != pdPASS) {
+    Serial.println(F("ERROR: Cannot start NFC task"));
+    nfcTaskHandle = nullptr;
+    return false;
+  }
+  
+  Serial.print(F("NFC scan task started on core "));
+  Serial.println(NFC_TASK_CORE);
+  return true;
+}
+
+void dispatchNFCEvents() {
+  uint8_t count = subscriberCount.load(std::memory_order_acquire);
+  for (int i = 0; i < count; i++) {
+    TagSubscriber* sub = &subscribers[i];
+    uint32_t tail = sub->tail.load(std::memory_order_relaxed);
+    uint32_t head = sub->head.load(std::memory_order_acquire);
+    if (head - tail > sub->maxDepth) sub->maxDepth = head - tail;
+    
+    // Each subscriber gets at most its budget per call, so a backlog in one
+    // can't hold up the others for a whole loop
+    uint32_t limit = (sub->budget > 0 && head - tail > sub->budget) ? tail + sub->budget : head;
+    while (tail != limit) {
+      QueuedTagEvent record = sub->ring[tail % NFC_EVENT_RING_SIZE];
+      sub->tail.store(++tail, std::memory_order_release);
+      
+      // Callback latency is measured at the first subscriber
+      if (i == 0 && record.info.event == TAG_ENTER) {
+        recordLatency(&callbackHist, micros() - record.sightingMicros);
+      }
+      sub->handler(record.info);
+      sub->delivered++;
+    }
+  }
+}
+
+void lockNFCBus() {
+  if (busMutex == nullptr) return;
+  xSemaphoreTake(busMutex, portMAX_DELAY);
+}
+
+void unlockNFCBus() {
+  if (busMutex == nullptr) return;
+  xSemaphoreGive(busMutex);
+}
+
+int subscribeTagEvents(const char* name, TagEventHandler handler, uint16_t budget) {
+  uint8_t count = subscriberCount.load();
+  if (count >= NFC_MAX_SUBSCRIBERS || handler == nullptr) return -1;
+  
+  TagSubscriber* sub = &subscribers[count];
+  sub->name = name;
+  sub->handler = handler;
+  sub->budget = budget;
+  sub->head = 0;
+  sub->tail = 0;
+  sub->dropped = 0;
+  sub->delivered = 0;
+  sub->maxDepth = 0;
+  subscriberCount.store(count + 1, std::memory_order_release);
+  return count;
+}
+
+bool getTagSubscriberStatus(uint8_t index, TagSubscriberStatus* status) {
+  if (index >= subscriberCount.load(std::memory_order_acquire)) return false;
+  
+  TagSubscriber* sub = &subscribers[index];
+  status->name = sub->name;
+  status->depth = sub->head.load() - sub->tail.load();
+  status->maxDepth = sub->maxDepth;
+  status->delivered = sub->delivered;
+  status->dropped = sub->dropped.load();
+  return true;
+}
+
+void setNFCScanIntervals(uint16_t minInterval, uint16_t maxInterval) {
+  minInterval = constrain(minInterval, 10, SCAN_INTERVAL_LIMIT);
+  maxInterval = constrain(maxInterval, minInterval, SCAN_INTERVAL_LIMIT);
+  
+  portENTER_CRITICAL(&statusMux);
+  pendingIntervalMin = minInterval;
+  pendingIntervalMax = maxInterval;
+  intervalsChanged.store(true, std::memory_order_release);
+  portEXIT_CRITICAL(&statusMux);
+  
+  Serial.print(F("NFC scan interval: "));
+  Serial.print(minInterval);
+  Serial.print(F("-"));
+  Serial.print(maxInterval);
+  Serial.println(F("ms"));
+}
+
+void setNFCIdleMode(uint16_t quietSeconds) {
+  quietSeconds = min(quietSeconds, (uint16_t)NFC_LPCD_QUIET_LIMIT);
+  lpcdQuietMs = quietSeconds * 1000UL;
+  
+  Serial.print(F("NFC LPCD idle: "));
+  if (quietSeconds == 0) {
+    Serial.println(F("off"));
+  } else {
+    Serial.print(F("after "));
+    Serial.print(quietSeconds);
+    Serial.println(F("s empty"));
+  }
+}
+
+void setNFCProtocols(uint8_t mask) {
+  mask &= NFC_PROTOCOLS_ALL;
+  if (mask == 0) mask = NFC_PROTOCOLS_DEFAULT;
+  protocolMask = mask;
+  
+  Serial.print(F("NFC protocols: "));
+  if (mask & NFC_PROTOCOL_BIT(PROTOCOL_ISO15693)) Serial.print(F("ISO15693 "));
+  if (mask & NFC_PROTOCOL_BIT(PROTOCOL_ISO14443A)) Serial.print(F("ISO14443A"));
+  Serial.println();
+}
+
+uint8_t getNFCProtocols() {
+  return protocolMask.load();
+}
+
+const char* nfcProtocolName(uint8_t protocol) {
+  return (protocol == PROTOCOL_ISO14443A) ? "ISO14443A" : "ISO15693";
+}
+
+void setNFCDebounce(const DebouncePolicy& policy) {
+  DebouncePolicy p = policy;
+  if (p.mode > DEBOUNCE_HYSTERESIS) p.mode = DEBOUNCE_MODE_DEFAULT;
+  p.window = constrain(p.window, 1, DEBOUNCE_WINDOW_LIMIT);
+  // A run of N reads needs no window; a vote needs N to fit inside it
+  p.enterReads = constrain(p.enterReads, 1,
+      p.mode == DEBOUNCE_CONSECUTIVE ? DEBOUNCE_WINDOW_LIMIT : p.window);
+  p.leaveReads = constrain(p.leaveReads, 1, p.enterReads);
+  p.timeoutScans = constrain(p.timeoutScans, 1, 255);
+  
+  portENTER_CRITICAL(&statusMux);
+  pendingDebounce = p;
+  debounceChanged.store(true, std::memory_order_release);
+  portEXIT_CRITICAL(&statusMux);
+  
+  static const char* const modeNames[] = { "consecutive", "N-of-M", "hysteresis" };
+  Serial.print(F("NFC debounce: "));
+  Serial.print(modeNames[p.mode]);
+  Serial.print(F(" enter "));
+  Serial.print(p.enterReads);
+  Serial.print(F("/"));
+  Serial.print(p.window);
+  if (p.mode == DEBOUNCE_HYSTERESIS) {
+    Serial.print(F(" leave <"));
+    Serial.print(p.leaveReads);
+  }
+  Serial.print(F(" timeout "));
+  Serial.print(p.timeoutScans);
+  Serial.println(F(" scans"));
+}
+
+bool getTagMemory(TagUID uid, TagMemory* memory) {
+  portENTER_CRITICAL(&memMux);
+  TagMemorySlot* cached = findCachedMemory(uid);
+  if (cached != nullptr) *memory = cached->memory;
+  portEXIT_CRITICAL(&memMux);
+  return cached != nullptr;
+}
+
+const char* tagMemoryToHex(const TagMemory& memory, char* out) {
+  static const char hexDigits[] = "0123456789ABCDEF";
+  for (int i = 0; i < memory.length; i++) {
+    out[i * 2] = hexDigits[memory.data[i] >> 4];
+    out[i * 2 + 1] = hexDigits[memory.data[i] & 0x0F];
+  }
+  out[memory.length * 2] = '\0';
+  return out;
+}
+
+// Published status of one reader with its live counters filled in
+static NFCStatus readerStatus(NFCReader* r) {
+  NFCStatus status;
+  portENTER_CRITICAL(&statusMux);
+  status = r->shared;
+  portEXIT_CRITICAL(&statusMux);
+  
+  status.totalScans = r->totalScans.load();
+  status.successfulReads = r->successfulReads.load();
+  status.failedReads = r->failedReads.load();
+  status.eventsDropped = 0;
+  for (int i = 0; i < subscriberCount.load(std::memory_order_acquire); i++) {
+    status.eventsDropped += subscribers[i].dropped.load();
+  }
+  status.lastProcessTime = lastProcessTime;
+  status.maxProcessTime = maxProcessTime;
+  summarizeLatency(&inventoryHist, &status.inventoryTime);
+  summarizeLatency(&jitterHist, &status.scanJitter);
+  summarizeLatency(&callbackHist, &status.callbackLatency);
+  summarizeLatency(&wakeHist, &status.wakeToRead);
+  
+  // Include the idle period in progress
+  if (status.lpcdActive) status.idleTime += millis() - r->lpcdStart;
+  return status;
 }
 
 NFCStatus getNFCStatus() {
-  return nfcStatus;
+  NFCStatus status = readerStatus(&readers[0]);
+  uint64_t detectTotal = (uint64_t)status.avgDetectLatency * readers[0].detectCount;
+  uint32_t detects = readers[0].detectCount;
+  
+  // Combine the other readers: counters add up, the RF range spans all of
+  // them, and the "last" values come from whichever reader read most recently
+  for (int i = 1; i < NFC_READER_COUNT; i++) {
+    NFCStatus other = readerStatus(&readers[i]);
+    if (!other.initialized) continue;
+    
+    if (!status.initialized || other.lastSuccessTime > status.lastSuccessTime) {
+      status.lastSuccessTime = other.lastSuccessTime;
+      status.lastDetectLatency = other.lastDetectLatency;
+      status.lastWakeLatency = other.lastWakeLatency;
+      status.agcValue = other.agcValue;
+      status.lastRxStatus = other.lastRxStatus;
+      strlcpy(status.lastError, other.lastError, sizeof(status.lastError));
+    }
+    if (!status.initialized) {
+      status.productVersion = other.productVersion;
+      status.scanInterval = other.scanInterval;
+      status.agcMin = other.agcMin;
+      status.agcMax = other.agcMax;
+      status.lpcdActive = other.lpcdActive;
+    }
+    status.initialized = true;
+    status.rfActive = status.rfActive || other.rfActive;
+    status.lpcdActive = status.lpcdActive && other.lpcdActive;
+    status.readersActive += other.readersActive;
+    
+    status.totalScans += other.totalScans;
+    status.successfulReads += other.successfulReads;
+    status.failedReads += other.failedReads;
+    status.tagsPresent += other.tagsPresent;
+    status.scanInterval = min(status.scanInterval, other.scanInterval);
+    status.scanRate += other.scanRate;
+    detectTotal += (uint64_t)other.avgDetectLatency * readers[i].detectCount;
+    detects += readers[i].detectCount;
+    status.suppressedEnters += other.suppressedEnters;
+    status.suppressedLeaves += other.suppressedLeaves;
+    status.eventsDeferred += other.eventsDeferred;
+    status.agcMin = min(status.agcMin, other.agcMin);
+    status.agcMax = max(status.agcMax, other.agcMax);
+    status.rxIntegrityErrors += other.rxIntegrityErrors;
+    status.rxProtocolErrors += other.rxProtocolErrors;
+    status.rxCollisions += other.rxCollisions;
+    for (int b = 0; b < RF_HIST_BUCKETS; b++) {
+      status.rfHistScans[b] += other.rfHistScans[b];
+      status.rfHistReads[b] += other.rfHistReads[b];
+    }
+    status.memCacheHits += other.memCacheHits;
+    status.memRfReads += other.memRfReads;
+    status.memReadErrors += other.memReadErrors;
+    status.lpcdWakeups += other.lpcdWakeups;
+    status.lpcdFalseWakes += other.lpcdFalseWakes;
+    status.lpcdMissed += other.lpcdMissed;
+    status.idleTime += other.idleTime;
+    status.protocolSwitches += other.protocolSwitches;
+  }
+  if (detects > 0) status.avgDetectLatency = detectTotal / detects;
+  return status;
+}
+
+NFCStatus getNFCReaderStatus(uint8_t reader) {
+  if (reader >= NFC_READER_COUNT) reader = 0;
+  return readerStatus(&readers[reader]);
+}
+
+#if NFC_SIMULATION
+PN5180Simulator* getNFCSimulator(uint8_t reader) {
+  if (reader >= NFC_READER_COUNT) reader = 0;
+  return readers[reader].nfc;
 }
+#endif
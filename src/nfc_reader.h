@@ -2,47 +2,303 @@
  * nfc_reader.h
  * 
  * PN5180 NFC Reader Interface for ESP32
- * Handles ISO15693 tag detection
+ * Handles ISO15693 tag detection (multi-tag anticollision) and
+ * ISO14443A cards (MIFARE/NTAG) through a time-sliced protocol scheduler
  */
 
 #ifndef NFC_READER_H
 #define NFC_READER_H
 
 #include <Arduino.h>
+#include "tag_uid.h"
 
 // PN5180 Pin Definitions (NFC_ prefix to avoid library conflicts)
 #define NFC_NSS_PIN  5   // GPIO5 - Chip Select
 #define NFC_BUSY_PIN 21  // GPIO21 - Busy signal
 #define NFC_RST_PIN  22  // GPIO22 - Reset
+#define NFC_IRQ_PIN  39  // GPIO39 - IRQ (LPCD wake, input only)
+#define NFC_NO_PIN   0xFF
 
-// Timing
-#define SCAN_INTERVAL 250  // Scan every 250ms (optimized for range testing)
+// Multiple readers - up to 4 PN5180 modules share SCK/MISO/MOSI, each with
+// its own NSS, BUSY and RST. The scan task steps every reader's inventory in
+// turn, so one reader's RF slot wait overlaps the others' SPI traffic.
+// BUSY is input only, so the extra readers use the input-only GPIOs for it.
+// IRQ is only needed for LPCD idle; a reader without one keeps polling.
+#define NFC_READER_COUNT 1   // PN5180 modules fitted (1-4)
+#define NFC_READER_PINS { \
+  { NFC_NSS_PIN, NFC_BUSY_PIN, NFC_RST_PIN, NFC_IRQ_PIN }, \
+  { 32, 34, 25, NFC_NO_PIN },  /* Reader 1: NSS, BUSY, RST, IRQ */ \
+  { 33, 35, 26, NFC_NO_PIN },  /* Reader 2 */ \
+  { 27, 36, 13, NFC_NO_PIN }   /* Reader 3 */ \
+}
+
+// Timing - adaptive scan scheduler
+// Polls at the minimum interval while any tag is pending or present, then
+// doubles the interval per empty scan (up to the maximum) once the field has
+// been empty for SCAN_BACKOFF_DELAY. Min/max are set from the /config page.
+#define SCAN_INTERVAL_MIN_DEFAULT 50    // Fast polling (PN5180 inventory takes ~20-30ms)
+#define SCAN_INTERVAL_MAX_DEFAULT 250   // Idle polling (the old fixed SCAN_INTERVAL)
+#define SCAN_INTERVAL_LIMIT       2000  // Upper bound accepted from config
+#define SCAN_BACKOFF_DELAY        2000  // Empty field time before backing off (ms)
+
+// Low-power card detect (LPCD) idle mode
+// After the configured quiet time with nothing in the field the PN5180 drops
+// its RF field and checks the antenna for detuning itself every
+// NFC_LPCD_WAKE_MS, raising IRQ when a card arrives. The scan task then
+// resets the PN5180, sets RF up again and resumes full-rate inventory. A
+// wake that finds no tag within SCAN_BACKOFF_DELAY goes straight back to
+// LPCD, and a routine inventory every NFC_LPCD_CHECK_MS catches a tag the
+// detector missed. The quiet time is set on the /config page (0 = off).
+#define NFC_LPCD_QUIET_DEFAULT  0      // Seconds of empty field before idling (0 = off)
+#define NFC_LPCD_QUIET_LIMIT    3600
+#define NFC_LPCD_WAKE_MS        250    // PN5180 wake-up counter (field check period)
+#define NFC_LPCD_CHECK_MS       30000  // Routine inventory while idle
+#define NFC_LPCD_POLL_MS        10     // Scan task IRQ check period while all readers idle
+#define NFC_LPCD_LIGHT_SLEEP    0      // 1 = light-sleep the ESP32 until IRQ/check
+                                       //     (WiFi, MQTT and web stall while asleep)
+
+// Protocols - chosen on the /config page (bit mask of TagProtocol)
+// With both enabled the scheduler alternates one scan per protocol while the
+// field is empty. While only tags of one protocol are present it stays on
+// that protocol (an RF reconfiguration costs a few ms) and looks at the other
+// every NFC_PROTOCOL_PEEK scans; with both kinds present it alternates.
+// ISO14443A is read one card at a time (WUPA/anticollision/select, then HLTA).
+enum TagProtocol {
+  PROTOCOL_ISO15693,   // ICODE SLIX etc. - 16-slot inventory, many tags
+  PROTOCOL_ISO14443A   // MIFARE / NTAG - 4 or 7 byte UID, one card per scan
+};
+
+#define NFC_PROTOCOL_BIT(p)    (1 << (p))
+#define NFC_PROTOCOLS_ALL      (NFC_PROTOCOL_BIT(PROTOCOL_ISO15693) | NFC_PROTOCOL_BIT(PROTOCOL_ISO14443A))
+#define NFC_PROTOCOLS_DEFAULT  NFC_PROTOCOL_BIT(PROTOCOL_ISO15693)
+#define NFC_PROTOCOL_PEEK      8   // Scans on a protocol with tags before one on the other
+
+// Debounce policies - chosen on the /config page, so latency can be traded
+// against false Read/Unread events per deployment without a rebuild
+enum DebounceMode {
+  DEBOUNCE_CONSECUTIVE,  // Enter after N reads in a row (the original behaviour)
+  DEBOUNCE_N_OF_M,       // Enter after N reads within the last M scans
+  DEBOUNCE_HYSTERESIS    // N of M to enter, leave when reads in the window drop below L
+};
+
+struct DebouncePolicy {
+  uint8_t mode;          // DebounceMode
+  uint8_t enterReads;    // N - reads needed to confirm a tag
+  uint8_t window;        // M - scans in the sliding window (1-16)
+  uint8_t leaveReads;    // L - hysteresis only, reads needed to stay present
+  uint8_t timeoutScans;  // Missed scans before a present tag leaves (all modes)
+};
+
+#define DEBOUNCE_MODE_DEFAULT     DEBOUNCE_CONSECUTIVE
+#define DEBOUNCE_ENTER_DEFAULT    2   // The old REQUIRED_CONSECUTIVE_READS
+#define DEBOUNCE_WINDOW_DEFAULT   4
+#define DEBOUNCE_LEAVE_DEFAULT    1
+#define DEBOUNCE_TIMEOUT_DEFAULT  4   // The old TAG_TIMEOUT_SCANS
+#define DEBOUNCE_WINDOW_LIMIT     16  // Per-tag read history is 16 bits
+
+// RF quality capture (range testing)
+// Each scan records the PN5180 AGC value and whether a tag was read, and a
+// histogram of read success per AGC band is kept over a sliding window.
+// A tag loading the antenna pulls the AGC value down, so lower bands mean
+// stronger coupling. Raise RF_HIST_BASE / lower RF_HIST_SHIFT to zoom in on
+// the range a particular antenna actually uses.
+#define PN5180_AGC_VALUE  0x1F  // AGC_VALUE register (not in the library's list)
+#define RF_HIST_BUCKETS   8     // AGC bands
+#define RF_HIST_BASE      0     // AGC value at the bottom of band 0
+#define RF_HIST_SHIFT     7     // (AGC - base) >> 7 = band (10-bit AGC, 128 wide)
+#define RF_HIST_WINDOW    128   // Scans in the sliding window
+
+// Tag memory - user blocks are read once when a tag is confirmed and kept in
+// a small LRU cache by UID, so a re-presented tag or the Continuing path
+// never goes back to RF for them
+#define TAG_MEM_READ        1    // 0 = UID only (no block reads)
+#define TAG_MEM_MAX_BYTES   64   // Bytes cached per tag (e.g. 16 blocks x 4)
+#define TAG_MEM_CACHE_SIZE  8    // Tags remembered
+#define TAG_MEM_HEX_LEN     (TAG_MEM_MAX_BYTES * 2 + 1)
+
+struct TagMemory {
+  TagUID uid;
+  uint8_t blockSize;     // Bytes per block (0 = tag has no readable memory)
+  uint8_t numBlocks;     // Blocks on the tag
+  uint8_t length;        // Bytes cached (blocks from 0 up to TAG_MEM_MAX_BYTES)
+  uint8_t data[TAG_MEM_MAX_BYTES];
+};
+
+// Present-tag set capacity (matches the 16 anticollision inventory slots)
+#define MAX_TAGS 16
+
+// Scan task (FreeRTOS) - scanning runs on its own task so web/MQTT/display
+// work in loop() cannot stall tag detection
+#define NFC_TASK_CORE        1
+#define NFC_TASK_STACK       4096
+#define NFC_TASK_PRIORITY    2
+#define NFC_EVENT_RING_SIZE  32    // Tag events buffered per subscriber (power of 2)
+#define NFC_EVENT_RESERVE    MAX_TAGS  // Ring slots kept for enter/leave (present events skip them)
+#define NFC_MAX_SUBSCRIBERS  4     // Tag event bus subscribers (display, MQTT, web, log)
+
+// 1 = print every unconfirmed sighting ("Pending read (1/2): ...") on
+// Serial. The scan task would wait on the UART for each one, so it is
+// off unless the debounce itself is being debugged.
+#define NFC_DEBUG_PENDING    0
+
+// Simulation
+// 1 = replace the PN5180 with the scripted simulator in nfc_simulator.cpp
+//     (bench testing of the scan/debounce path without hardware or tags;
+//     the host build in host/ always uses it)
+#ifndef NFC_SIMULATION
+#define NFC_SIMULATION 0
+#endif
+
+// Latency percentiles (microseconds) from a log-scale histogram
+// Percentiles are bucket upper bounds, so they overstate by at most 25%
+struct LatencySummary {
+  uint32_t count;
+  uint32_t p50;
+  uint32_t p90;
+  uint32_t p99;
+  uint32_t max;
+};
 
 // NFC Status Structure
 struct NFCStatus {
   bool initialized;
   bool rfActive;
   uint8_t productVersion;
+  uint8_t readersActive;      // Readers that initialized (1 per reader, summed in getNFCStatus)
   uint32_t totalScans;
   uint32_t successfulReads;
   uint32_t failedReads;
   unsigned long lastSuccessTime;
+  uint8_t tagsPresent;        // Confirmed tags currently in the field
+  uint16_t scanInterval;      // Current scheduler interval (ms)
+  float scanRate;             // Effective scans/second (last second)
+  unsigned long lastDetectLatency;  // First sighting to confirmed (ms)
+  unsigned long avgDetectLatency;   // Running average of the above (ms)
+  unsigned long lastProcessTime;    // Time spent in last processNFCReader() call (us)
+  unsigned long maxProcessTime;     // Worst case processNFCReader() call (us)
+  uint32_t eventsDropped;           // Present events lost because a subscriber queue was full
+  uint32_t eventsDeferred;          // Enters/leaves held to a later scan for the same reason
+  uint8_t debounceMode;             // Active DebounceMode
+  uint32_t suppressedEnters;        // Sightings that never confirmed (no Read sent)
+  uint32_t suppressedLeaves;        // Missed scans recovered before timeout (no Unread sent)
+  uint16_t agcValue;                // PN5180 AGC value at the last scan
+  uint16_t agcMin;                  // AGC range over the window
+  uint16_t agcMax;
+  uint32_t lastRxStatus;            // RX_STATUS of the last slot that answered
+  uint32_t rxIntegrityErrors;       // Slots with RX_STATUS data integrity error (CRC/parity)
+  uint32_t rxProtocolErrors;        // Slots with RX_STATUS protocol error
+  uint32_t rxCollisions;            // Slots with RX_STATUS collision
+  uint16_t rfHistScans[RF_HIST_BUCKETS];  // Scans per AGC band (window)
+  uint16_t rfHistReads[RF_HIST_BUCKETS];  // ... of which read a tag
+  uint32_t memCacheHits;            // Confirmed tags served from the memory cache
+  uint32_t memRfReads;              // Confirmed tags whose memory was read over RF
+  uint32_t memReadErrors;           // Memory reads that failed (not cached, retried next time)
+  bool lpcdActive;                  // In LPCD idle (combined status: every reader)
+  uint32_t lpcdWakeups;             // LPCD card detections that resumed scanning
+  uint32_t lpcdFalseWakes;          // ... that found no tag before idling again
+  uint32_t lpcdMissed;              // Tags found by the routine check, not by LPCD
+  unsigned long idleTime;           // Total time in LPCD idle (ms)
+  unsigned long lastWakeLatency;    // LPCD wake to first tag read (ms)
+  uint8_t protocol;                 // TagProtocol the RF is set up for
+  uint32_t protocolSwitches;        // RF reconfigurations between protocols
+  LatencySummary inventoryTime;     // Inventory start to last slot collected
+  LatencySummary scanJitter;        // Scan start past its scheduled time
+  LatencySummary callbackLatency;   // First sighting to tagCallback (enter events)
+  LatencySummary wakeToRead;        // LPCD wake to first tag read
   char lastError[40];
 };
 
-// Callback function type for tag events
-typedef void (*TagCallback)(const char* uid, bool present);
+// Tag events (fired per tag)
+enum TagEvent {
+  TAG_ENTER,    // Tag confirmed in the field
+  TAG_PRESENT,  // Tag still present (every scan while in the field)
+  TAG_LEAVE     // Tag removed (timeout)
+};
+
+// One tag event as delivered to subscribers
+struct TagEventInfo {
+  TagUID uid;
+  TagEvent event;
+  uint8_t reader;        // PN5180 that saw the tag (0 with a single reader)
+  uint8_t protocol;      // TagProtocol it answered on
+  unsigned long time;    // millis() of the scan that raised the event
+};
+
+// Tag event bus - the scan task copies every event into each subscriber's
+// own queue and never waits; dispatchNFCEvents() drains each queue in loop
+// up to that subscriber's budget. A subscriber that falls behind only
+// fills (and then drops present events from) its own queue; enter and
+// leave are never dropped - they wait for the next scan until every queue
+// has room, so each enter still gets its leave.
+typedef void (*TagEventHandler)(const TagEventInfo& event);
+
+struct TagSubscriberStatus {
+  const char* name;
+  uint16_t depth;        // Events waiting now
+  uint16_t maxDepth;     // Most ever waiting
+  uint32_t delivered;
+  uint32_t dropped;      // Present events lost because this subscriber's queue was full
+};
 
-// Initialize NFC reader
+// Initialize NFC readers (true if at least one answered)
 bool initNFCReader();
 
-// Process NFC reader (call in loop)
+// Process NFC reader (called by the scan task, or from loop if no task)
 void processNFCReader();
 
-// Set callback for tag events
-void setTagCallback(TagCallback callback);
+// Start the scan task (call after initNFCReader)
+bool startNFCTask();
+
+// Deliver queued tag events to every subscriber (call in loop)
+void dispatchNFCEvents();
+
+// SPI bus lock shared with the display
+void lockNFCBus();
+void unlockNFCBus();
+
+// Add a tag event subscriber (call in setup, before startNFCTask)
+// budget = events delivered per dispatchNFCEvents() call (0 = all waiting)
+// Returns the subscriber index, or -1 if NFC_MAX_SUBSCRIBERS are taken
+int subscribeTagEvents(const char* name, TagEventHandler handler, uint16_t budget);
+
+// Queue counters of one subscriber (false if there is no such subscriber)
+bool getTagSubscriberStatus(uint8_t index, TagSubscriberStatus* status);
+
+// Set scan scheduler limits (ms; applied by the scan task)
+void setNFCScanIntervals(uint16_t minInterval, uint16_t maxInterval);
 
-// Get NFC status
+// Set debounce policy (values are clamped; applied by the scan task)
+void setNFCDebounce(const DebouncePolicy& policy);
+
+// Set the empty-field time before LPCD idle (seconds, 0 = never idle)
+void setNFCIdleMode(uint16_t quietSeconds);
+
+// Set the protocols to scan (NFC_PROTOCOL_BIT mask, 0 = ISO15693 only)
+void setNFCProtocols(uint8_t mask);
+
+// Protocols being scanned (NFC_PROTOCOL_BIT mask)
+uint8_t getNFCProtocols();
+
+// Protocol name for display ("ISO15693", "ISO14443A")
+const char* nfcProtocolName(uint8_t protocol);
+
+// Copy a tag's cached memory (false if not read yet)
+bool getTagMemory(TagUID uid, TagMemory* memory);
+
+// Format cached memory as hex (buffer >= TAG_MEM_HEX_LEN)
+const char* tagMemoryToHex(const TagMemory& memory, char* out);
+
+// Get NFC status - all readers combined (counters summed, last values from
+// the reader that read most recently)
 NFCStatus getNFCStatus();
 
+// Get one reader's own status block
+NFCStatus getNFCReaderStatus(uint8_t reader);
+
+#if NFC_SIMULATION
+// Access a reader's simulator (e.g. to load a custom scenario)
+class PN5180Simulator;
+PN5180Simulator* getNFCSimulator(uint8_t reader = 0);
+#endif
+
 #endif
@@ -0,0 +1,498 @@
+/*
+ * nfc_simulator.cpp
+ *
+ * Scripted PN5180 ISO15693 / ISO14443A Simulator Implementation
+ */
+
+#include "nfc_simulator.h"
+#include "nfc_reader.h"  // For PN5180_AGC_VALUE
+#include <string.h>  // For memset
+
+// Simulated answer timing (microseconds after the slot command)
+#define SIM_SOF_DELAY_US   320   // Tag response time t1
+#define SIM_FRAME_US       3800  // Full inventory answer at 26 kbit/s
+#define SIM_RF_SETUP_US    2500  // loadRFConfig plus RF on
+#define SIM_TYPEA_US       3000  // WUPA, anticollision and select (one card)
+#define SIM_TYPEA_EMPTY_US 800   // WUPA with nothing answering
+
+// Simulated tag memory layout (ICODE SLIX: 28 blocks of 4 bytes)
+#define SIM_BLOCK_SIZE     4
+#define SIM_NUM_BLOCKS     28
+
+// Simulated AGC value with no tag in the field
+#define SIM_AGC_IDLE       620
+
+// Stand-in UIDs for the all-zero / all-FF scenario steps
+#define SIM_UID_ZERO 0x0000000000000000ULL
+#define SIM_UID_FF   0xFFFFFFFFFFFFFFFFULL
+
+// Default scenario - covers every path in processNFCReader()
+// The script loops forever; a summary is printed after each pass.
+static const SimStep defaultScenario[] = {
+  // type          duration  uid                    uid2                   read%  err   busy  cardA
+  { SIM_EMPTY,     2000,     0,                     0,                     0,     0,    0,    0 },
+  { SIM_TAG,       5000,     0xE004010918485391ULL, 0,                     100,   0,    0,    0 },  // Clean read
+  { SIM_EMPTY,     2000,     0,                     0,                     0,     0,    0,    0 },
+  { SIM_TAG,       5000,     0xE004010918485391ULL, 0,                     70,    0,    0,    0 },  // Edge of range
+  { SIM_ZERO_UID,  1000,     0,                     0,                     0,     0,    0,    0 },
+  { SIM_FF_UID,    1000,     0,                     0,                     0,     0,    0,    0 },
+  { SIM_ERROR,     1000,     0,                     0,                     0,     0x0F, 0,    0 },  // Unknown error
+  { SIM_TAG,       4000,     0xE0040150A1B2C3D4ULL, 0,                     100,   0,    40,   0 },  // Slow BUSY
+  { SIM_TAG,       3000,     0xE004010918485391ULL, 0,                     100,   0,    0,    0 },  // Tag swap
+  { SIM_TAG,       4000,     0xE004010918485391ULL, 0xE0040150A1B2C3D4ULL, 90,    0,    0,    0 },  // Stacked
+  { SIM_TAG,       4000,     0xE004010918485391ULL, 0xE004015000000021ULL, 90,    0,    0,    0 },  // Same slot
+  { SIM_EMPTY,     2000,     0,                     0,                     0,     0,    0,    0 },
+};
+
+// Protocol scheduler - Type A card alone, next to a 15693 tag, then swapped
+const SimStep simProtocolScenario[] = {
+  // type          duration  uid                    uid2                   read%  err   busy  cardA
+  { SIM_EMPTY,     2000,     0,                     0,                     0,     0,    0,    0                     },
+  { SIM_TAG,       4000,     0,                     0,                     100,   0,    0,    0x0004A1B2C3D4E5F6ULL },  // NTAG (7 byte)
+  { SIM_EMPTY,     2000,     0,                     0,                     0,     0,    0,    0                     },
+  { SIM_TAG,       4000,     0xE004010918485391ULL, 0,                     100,   0,    0,    0                     },  // 15693 only
+  { SIM_TAG,       4000,     0xE004010918485391ULL, 0,                     100,   0,    0,    0x00000000DEADBEEFULL },  // Both (4 byte)
+  { SIM_TAG,       3000,     0,                     0,                     90,    0,    0,    0x00000000DEADBEEFULL },  // 15693 removed
+  { SIM_EMPTY,     2000,     0,                     0,                     0,     0,    0,    0                     },
+};
+const size_t simProtocolScenarioSteps = sizeof(simProtocolScenario) / sizeof(simProtocolScenario[0]);
+
+PN5180Simulator::PN5180Simulator(uint8_t ssPin, uint8_t busyPin, uint8_t rstPin)
+  : steps(defaultScenario),
+    stepCount(sizeof(defaultScenario) / sizeof(defaultScenario[0])),
+    currentStep(0),
+    stepStart(0),
+    started(false),
+    rngState(0x1234567),  // Fixed seed - every run is identical
+    responderCount(0),
+    roundMaskLen(0),
+    slot(0),
+    txConfig(0),
+    irqStatus(0),
+    slotStart(0),
+    slotAnswers(0),
+    slotUid(0),
+    typeA(false),
+    lpcdMode(false),
+    lpcdIrq(false),
+    lpcdPeriod(0),
+    lpcdLastCheck(0),
+    pendingArrival(0),
+    pendingDeparture(0),
+    pendingArrivals(0),
+    pendingDepartures(0) {
+  memset(&stats, 0, sizeof(stats));
+  memset(responders, 0, sizeof(responders));
+}
+
+void PN5180Simulator::begin() {
+  Serial.println(F("PN5180 SIMULATOR active - no RF hardware used"));
+}
+
+void PN5180Simulator::reset() {
+  // Leaves LPCD; the scenario clock keeps running (it starts on first use)
+  lpcdMode = false;
+  lpcdIrq = false;
+  irqStatus = 0;
+  typeA = false;
+}
+
+bool PN5180Simulator::readEEprom(uint8_t addr, uint8_t* buffer, int len) {
+  // Report product version 0.0 (anything other than FF.FF passes the check)
+  memset(buffer, 0, len);
+  return true;
+}
+
+bool PN5180Simulator::setupRF() {
+  delayMicroseconds(SIM_RF_SETUP_US);
+  typeA = false;
+  return true;
+}
+
+bool PN5180Simulator::setRF_off() {
+  return true;
+}
+
+bool PN5180Simulator::setupRFTypeA() {
+  delayMicroseconds(SIM_RF_SETUP_US);
+  typeA = true;
+  return true;
+}
+
+uint8_t PN5180Simulator::activateTypeA(uint8_t* buffer, uint8_t kind) {
+  advance(millis());
+  stats.polls++;
+  memset(buffer, 0, 10);
+
+  const SimStep& step = steps[currentStep];
+  if (!typeA || step.type != SIM_TAG || step.cardA == 0 ||
+      nextRandom() % 100 >= step.readPercent) {
+    delayMicroseconds(SIM_TYPEA_EMPTY_US);
+    return 0;
+  }
+  delayMicroseconds(SIM_TYPEA_US);
+
+  // ATQA, SAK, then the UID first byte first
+  uint8_t length = (step.cardA >> 32) ? 7 : 4;
+  buffer[0] = (length == 7) ? 0x44 : 0x04;
+  buffer[2] = 0x00;
+  for (int i = 0; i < length; i++) {
+    buffer[3 + i] = (uint8_t)(step.cardA >> (8 * (length - 1 - i)));
+  }
+  return length;
+}
+
+bool PN5180Simulator::mifareHalt() {
+  return true;
+}
+
+void PN5180Simulator::setScenario(const SimStep* newSteps, size_t count) {
+  if (newSteps == nullptr || count == 0) return;
+  steps = newSteps;
+  stepCount = count;
+  started = false;
+  memset(&stats, 0, sizeof(stats));
+}
+
+uint32_t PN5180Simulator::nextRandom() {
+  // xorshift32 - cheap and deterministic
+  rngState ^= rngState << 13;
+  rngState ^= rngState >> 17;
+  rngState ^= rngState << 5;
+  return rngState;
+}
+
+bool PN5180Simulator::stepHasTag(const SimStep& step, uint64_t uid) {
+  return step.type == SIM_TAG && uid != 0 && (step.uid == uid || step.uid2 == uid || step.cardA == uid);
+}
+
+void PN5180Simulator::enterStep(size_t index, unsigned long now) {
+  const SimStep& next = steps[index];
+
+  // Compare the tags in the field before and after this boundary
+  if (started) {
+    const SimStep& prev = steps[currentStep];
+    if (prev.type == SIM_TAG) {
+      uint64_t prevUids[3] = { prev.uid, prev.uid2, prev.cardA };
+      for (int i = 0; i < 3; i++) {
+        if (prevUids[i] != 0 && !stepHasTag(next, prevUids[i])) {
+          stats.departures++;
+          pendingDepartures++;
+          pendingDeparture = now;
+        }
+      }
+    }
+  }
+  if (next.type == SIM_TAG) {
+    uint64_t nextUids[3] = { next.uid, next.uid2, next.cardA };
+    for (int i = 0; i < 3; i++) {
+      if (nextUids[i] != 0 && !(started && stepHasTag(steps[currentStep], nextUids[i]))) {
+        stats.arrivals++;
+        pendingArrivals++;
+        pendingArrival = now;
+      }
+    }
+  }
+
+  currentStep = index;
+  stepStart = now;
+}
+
+void PN5180Simulator::advance(unsigned long now) {
+  if (!started) {
+    memset(&stats, 0, sizeof(stats));
+    stats.startTime = now;
+    pendingArrivals = 0;
+    pendingDepartures = 0;
+    currentStep = 0;
+    enterStep(0, now);
+    started = true;
+    return;
+  }
+
+  // Step boundaries are exact scripted times, not poll times
+  while (now - stepStart >= steps[currentStep].duration) {
+    unsigned long boundary = stepStart + steps[currentStep].duration;
+    size_t next = currentStep + 1;
+    if (next >= stepCount) {
+      next = 0;
+      stats.runs++;
+      printSummary(boundary);
+    }
+    enterStep(next, boundary);
+  }
+}
+
+// Decide which tags answer this inventory round
+void PN5180Simulator::startRound(uint32_t mask, uint8_t maskLen) {
+  advance(millis());
+  stats.polls++;
+
+  const SimStep& step = steps[currentStep];
+  responderCount = 0;
+  roundMaskLen = maskLen;
+  slot = 0;
+  if (typeA) return;  // ISO15693 tags don't answer a Type A field
+
+  // Hold the caller for as long as the real chip would keep BUSY high
+  if (step.busyLatency > 0) {
+    delay(step.busyLatency);
+  }
+
+  uint64_t candidates[2] = { 0, 0 };
+  switch (step.type) {
+    case SIM_TAG:
+      candidates[0] = step.uid;
+      candidates[1] = step.uid2;
+      break;
+    case SIM_ZERO_UID:
+      responders[responderCount++] = SIM_UID_ZERO;
+      return;
+    case SIM_FF_UID:
+      responders[responderCount++] = SIM_UID_FF;
+      return;
+    default:
+      return;
+  }
+
+  uint64_t maskBits = (maskLen >= 64) ? ~0ULL : ((1ULL << maskLen) - 1);
+  for (int t = 0; t < 2; t++) {
+    if (candidates[t] == 0) continue;
+    if ((candidates[t] & maskBits) != mask) continue;       // Not addressed by mask
+    if (nextRandom() % 100 >= step.readPercent) continue;   // Missed read
+    responders[responderCount++] = candidates[t];
+  }
+}
+
+// Work out who answers in the current slot
+void PN5180Simulator::startSlot() {
+  slotStart = micros();
+  slotAnswers = 0;
+  slotUid = 0;
+  irqStatus = 0;
+
+  const SimStep& step = steps[currentStep];
+  if (step.type == SIM_ERROR) {
+    slotAnswers = (slot == 0) ? 1 : 0;  // Error response in the first slot
+    return;
+  }
+
+  for (int t = 0; t < responderCount; t++) {
+    // Slot number is the 4 UID bits following the mask
+    uint8_t tagSlot = (uint8_t)((responders[t] >> roundMaskLen) & 0x0F);
+    if (tagSlot == slot) {
+      slotAnswers++;
+      slotUid = responders[t];
+    }
+  }
+}
+
+bool PN5180Simulator::writeRegister(uint8_t reg, uint32_t value) {
+  if (reg == TX_CONFIG) txConfig = value;
+  return true;
+}
+
+bool PN5180Simulator::writeRegisterWithAndMask(uint8_t reg, uint32_t mask) {
+  if (reg == TX_CONFIG) txConfig &= mask;
+  return true;
+}
+
+bool PN5180Simulator::readRegister(uint8_t reg, uint32_t* value) {
+  *value = 0;
+  if (reg == TX_CONFIG) {
+    *value = txConfig;
+  } else if (reg == RX_STATUS && slotAnswers > 0) {
+    if (slotAnswers > 1) {
+      *value = (1UL << 18);  // Collision detected
+    } else if (steps[currentStep].type == SIM_ERROR) {
+      *value = 2;            // Flags + error code
+    } else {
+      *value = 10;           // Flags + DSFID + UID
+    }
+  } else if (reg == PN5180_AGC_VALUE) {
+    // Idle antenna around 620; a tag in the field loads it down, more so
+    // when close (high read%) or stacked
+    const SimStep& step = steps[currentStep];
+    uint32_t agc = SIM_AGC_IDLE + ((micros() >> 4) & 0x07);
+    if (step.type == SIM_TAG) {
+      agc -= step.readPercent * 2;
+      if (step.uid2 != 0) agc -= 40;
+    }
+    *value = agc;
+  }
+  return true;
+}
+
+uint64_t PN5180Simulator::uidFromBytes(const uint8_t* uid) {
+  uint64_t value = 0;
+  for (int i = 7; i >= 0; i--) {
+    value = (value << 8) | uid[i];
+  }
+  return value;
+}
+
+ISO15693ErrorCode PN5180Simulator::getSystemInfo(uint8_t* uid, uint8_t* blockSize, uint8_t* numBlocks) {
+  const SimStep& step = steps[currentStep];
+  if (step.type != SIM_TAG || !stepHasTag(step, uidFromBytes(uid))) {
+    return EC_NO_CARD;
+  }
+  *blockSize = SIM_BLOCK_SIZE;
+  *numBlocks = SIM_NUM_BLOCKS;
+  return ISO15693_EC_OK;
+}
+
+ISO15693ErrorCode PN5180Simulator::readMultipleBlock(uint8_t* uid, uint8_t blockNo, uint8_t numBlock,
+                                                     uint8_t* blockData, uint8_t blockSize) {
+  const SimStep& step = steps[currentStep];
+  if (step.type != SIM_TAG || !stepHasTag(step, uidFromBytes(uid))) {
+    return EC_NO_CARD;
+  }
+  if (blockSize != SIM_BLOCK_SIZE || blockNo + numBlock > SIM_NUM_BLOCKS) {
+    return ISO15693_EC_BLOCK_NOT_AVAILABLE;
+  }
+  // Contents derived from the UID so each tag reads back differently
+  for (int i = 0; i < numBlock * blockSize; i++) {
+    int offset = blockNo * blockSize + i;
+    blockData[i] = uid[offset % 8] ^ offset;
+  }
+  return ISO15693_EC_OK;
+}
+
+bool PN5180Simulator::sendData(const uint8_t* data, int len, uint8_t validBits) {
+  if (len >= 3 && data[1] == 0x01) {
+    // Inventory command: flags, command, mask length, mask value
+    uint8_t maskLen = data[2];
+    uint32_t mask = 0;
+    for (int i = 0; i < (maskLen + 7) / 8 && 3 + i < len; i++) {
+      mask |= (uint32_t)data[3 + i] << (8 * i);
+    }
+    startRound(mask, maskLen);
+  } else if (len == 0) {
+    // EOF only - next slot
+    slot++;
+  }
+  startSlot();
+  return true;
+}
+
+bool PN5180Simulator::readData(int len, uint8_t* buffer) {
+  memset(buffer, 0, len);
+  if (steps[currentStep].type == SIM_ERROR) {
+    buffer[0] = 0x01;  // Error flag
+    if (len > 1) buffer[1] = steps[currentStep].errorCode;
+    return true;
+  }
+  // Flags, DSFID, then UID LSB first (as the PN5180 returns it)
+  for (int i = 0; i < 8 && 2 + i < len; i++) {
+    buffer[2 + i] = (uint8_t)(slotUid >> (8 * i));
+  }
+  return true;
+}
+
+uint32_t PN5180Simulator::getIRQStatus() {
+  if (slotAnswers > 0) {
+    unsigned long elapsed = micros() - slotStart;
+    if (elapsed >= SIM_SOF_DELAY_US) irqStatus |= RX_SOF_DET_IRQ_STAT;
+    if (elapsed >= SIM_FRAME_US) irqStatus |= RX_IRQ_STAT;
+  }
+  return irqStatus;
+}
+
+bool PN5180Simulator::clearIRQStatus(uint32_t irqMask) {
+  irqStatus &= ~irqMask;
+  return true;
+}
+
+bool PN5180Simulator::prepareLPCD() {
+  return true;
+}
+
+bool PN5180Simulator::switchToLPCD(uint16_t wakeupCounterInMs) {
+  advance(millis());
+  lpcdMode = true;
+  lpcdIrq = false;
+  lpcdPeriod = wakeupCounterInMs;
+  lpcdLastCheck = millis();
+  stats.lpcdEntries++;
+  return true;
+}
+
+bool PN5180Simulator::lpcdTriggered() {
+  if (!lpcdMode) return false;
+  unsigned long now = millis();
+  advance(now);
+
+  // The detector only looks at the field once per wake-up period; anything
+  // scripted in the field (even a bad UID) detunes the antenna
+  while (!lpcdIrq && now - lpcdLastCheck >= lpcdPeriod) {
+    lpcdLastCheck += lpcdPeriod;
+    if (steps[currentStep].type != SIM_EMPTY) {
+      lpcdIrq = true;
+      stats.lpcdTriggers++;
+    }
+  }
+  return lpcdIrq;
+}
+
+void PN5180Simulator::noteTagEvent(bool present) {
+  unsigned long now = millis();
+
+  if (present) {
+    stats.enterEvents++;
+    if (pendingArrivals > 0) {
+      pendingArrivals--;
+      stats.lastEnterLatency = now - pendingArrival;
+      stats.totalEnterLatency += stats.lastEnterLatency;
+      if (stats.lastEnterLatency > stats.maxEnterLatency) {
+        stats.maxEnterLatency = stats.lastEnterLatency;
+      }
+    }
+  } else {
+    stats.leaveEvents++;
+    if (pendingDepartures > 0) {
+      pendingDepartures--;
+      stats.lastLeaveLatency = now - pendingDeparture;
+      stats.totalLeaveLatency += stats.lastLeaveLatency;
+      if (stats.lastLeaveLatency > stats.maxLeaveLatency) {
+        stats.maxLeaveLatency = stats.lastLeaveLatency;
+      }
+    }
+  }
+}
+
+SimStats PN5180Simulator::getStats() {
+  return stats;
+}
+
+void PN5180Simulator::printSummary(unsigned long now) {
+  unsigned long elapsed = now - stats.startTime;
+  uint32_t events = stats.enterEvents + stats.leaveEvents;
+
+  Serial.println(F("\n=== Simulator Run Complete ==="));
+  Serial.print(F("Runs: ")); Serial.print(stats.runs);
+  Serial.print(F("  Polls: ")); Serial.println(stats.polls);
+  Serial.print(F("Arrivals: ")); Serial.print(stats.arrivals);
+  Serial.print(F("  Enter events: ")); Serial.println(stats.enterEvents);
+  Serial.print(F("Departures: ")); Serial.print(stats.departures);
+  Serial.print(F("  Leave events: ")); Serial.println(stats.leaveEvents);
+  if (stats.lpcdEntries > 0) {
+    Serial.print(F("LPCD entries: ")); Serial.print(stats.lpcdEntries);
+    Serial.print(F("  Triggers: ")); Serial.println(stats.lpcdTriggers);
+  }
+  if (elapsed > 0) {
+    Serial.print(F("Events/sec: "));
+    Serial.println(events * 1000.0 / elapsed, 3);
+  }
+  if (stats.enterEvents > 0) {
+    Serial.print(F("Enter latency avg/max (ms): "));
+    Serial.print(stats.totalEnterLatency / stats.enterEvents);
+    Serial.print(F(" / "));
+    Serial.println(stats.maxEnterLatency);
+  }
+  if (stats.leaveEvents > 0) {
+    Serial.print(F("Leave latency avg/max (ms): "));
+    Serial.print(stats.totalLeaveLatency / stats.leaveEvents);
+    Serial.print(F(" / "));
+    Serial.println(stats.maxLeaveLatency);
+  }
+}
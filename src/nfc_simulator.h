@@ -0,0 +1,155 @@
+/*
+ * nfc_simulator.h
+ *
+ * Scripted PN5180 ISO15693 / ISO14443A Simulator
+ * Stands in for PN5180ISO15693 and PN5180ISO14443 when NFC_SIMULATION is enabled in
+ * nfc_reader.h, so the real scan/debounce/timeout logic can be
+ * exercised and timed without waving physical tags.
+ *
+ * Emulates the register-level calls the reader's inventory state
+ * machine uses (sendData, IRQ status, RX_STATUS, readData) including
+ * 16-slot anticollision and mask-based collision resolution. A step's
+ * ISO14443A card answers activateTypeA() once RF is set up for Type A.
+ *
+ * LPCD is simulated too: after switchToLPCD() the detector "checks" the
+ * field every wake-up period and lpcdTriggered() stands in for the IRQ
+ * line, firing once anything is in the scripted field.
+ */
+
+#ifndef NFC_SIMULATOR_H
+#define NFC_SIMULATOR_H
+
+#include <Arduino.h>
+#include <PN5180ISO15693.h>  // For ISO15693ErrorCode and register names
+
+// What the simulated field contains during one scenario step
+enum SimStepType {
+  SIM_EMPTY,      // No tag in the field
+  SIM_TAG,        // Tag present (readPercent controls noisy reads)
+  SIM_ZERO_UID,   // Reports OK with an all-zero UID
+  SIM_FF_UID,     // Reports OK with an all-0xFF UID
+  SIM_ERROR       // Reports errorCode (use anything other than 0x01)
+};
+
+// One step of a scripted scenario
+struct SimStep {
+  SimStepType type;
+  unsigned long duration;   // How long this step lasts (ms)
+  uint64_t uid;             // Tag UID, MSB first as displayed (SIM_TAG only)
+  uint64_t uid2;            // Second stacked tag (0 = none, SIM_TAG only)
+  uint8_t readPercent;      // Chance a poll sees each tag (SIM_TAG only)
+  uint8_t errorCode;        // Code returned for SIM_ERROR
+  uint16_t busyLatency;     // Simulated BUSY time per inventory command (ms)
+  uint64_t cardA;           // ISO14443A card, 4 or 7 byte UID (0 = none, SIM_TAG only)
+};
+
+// Built-in scenario with ISO14443A cards alone and next to an ISO15693 tag
+// (load with setScenario; needs both protocols enabled on the reader)
+extern const SimStep simProtocolScenario[];
+extern const size_t simProtocolScenarioSteps;
+
+// Scenario statistics (one "run" = one pass through the script)
+struct SimStats {
+  uint32_t runs;
+  uint32_t polls;              // Inventory rounds (including collision masks) and Type A activations
+  uint32_t arrivals;           // Scripted tag arrivals
+  uint32_t departures;         // Scripted tag departures
+  uint32_t enterEvents;        // Reader callbacks with present = true (new tag)
+  uint32_t leaveEvents;        // Reader callbacks with present = false
+  uint32_t lpcdEntries;        // switchToLPCD() calls
+  uint32_t lpcdTriggers;       // Simulated LPCD detections
+  unsigned long lastEnterLatency;
+  unsigned long maxEnterLatency;
+  unsigned long totalEnterLatency;
+  unsigned long lastLeaveLatency;
+  unsigned long maxLeaveLatency;
+  unsigned long totalLeaveLatency;
+  unsigned long startTime;
+};
+
+class PN5180Simulator {
+public:
+  PN5180Simulator(uint8_t ssPin, uint8_t busyPin, uint8_t rstPin);
+
+  // Same surface nfc_reader.cpp uses on PN5180ISO15693
+  void begin();
+  void reset();
+  bool readEEprom(uint8_t addr, uint8_t* buffer, int len);
+  bool setupRF();
+  bool setRF_off();
+  bool writeRegister(uint8_t reg, uint32_t value);
+  bool writeRegisterWithAndMask(uint8_t reg, uint32_t mask);
+  bool readRegister(uint8_t reg, uint32_t* value);
+  bool sendData(const uint8_t* data, int len, uint8_t validBits = 0);
+  bool readData(int len, uint8_t* buffer);
+  uint32_t getIRQStatus();
+  bool clearIRQStatus(uint32_t irqMask);
+  
+  // ISO14443A (PN5180ISO14443's setupRF is setupRFTypeA here)
+  bool setupRFTypeA();
+  uint8_t activateTypeA(uint8_t* buffer, uint8_t kind);
+  bool mifareHalt();
+  
+  // Low-power card detect
+  bool prepareLPCD();
+  bool switchToLPCD(uint16_t wakeupCounterInMs);
+  bool lpcdTriggered();         // Stands in for the IRQ line while in LPCD
+  
+  // Tag memory (answered only for a tag in the field)
+  ISO15693ErrorCode getSystemInfo(uint8_t* uid, uint8_t* blockSize, uint8_t* numBlocks);
+  ISO15693ErrorCode readMultipleBlock(uint8_t* uid, uint8_t blockNo, uint8_t numBlock,
+                                      uint8_t* blockData, uint8_t blockSize);
+
+  // Replace the built-in scenario (steps must stay valid)
+  void setScenario(const SimStep* steps, size_t count);
+
+  // Called by the reader when it fires a tag enter/leave callback
+  void noteTagEvent(bool present);
+
+  SimStats getStats();
+
+private:
+  const SimStep* steps;
+  size_t stepCount;
+  size_t currentStep;
+  unsigned long stepStart;
+  bool started;
+  uint32_t rngState;
+
+  // Current inventory round
+  uint64_t responders[4];       // Tags answering this round (0 = empty)
+  uint8_t responderCount;
+  uint8_t roundMaskLen;
+  uint8_t slot;
+  uint32_t txConfig;
+  uint32_t irqStatus;
+  unsigned long slotStart;      // micros() when the slot was issued
+  uint8_t slotAnswers;          // Tags answering in the current slot
+  uint64_t slotUid;
+  bool typeA;                   // RF set up for ISO14443A
+
+  // LPCD
+  bool lpcdMode;
+  bool lpcdIrq;
+  uint16_t lpcdPeriod;
+  unsigned long lpcdLastCheck;
+
+  // Scripted edges awaiting a reader callback
+  unsigned long pendingArrival;
+  unsigned long pendingDeparture;
+  uint8_t pendingArrivals;
+  uint8_t pendingDepartures;
+
+  SimStats stats;
+
+  void advance(unsigned long now);
+  void enterStep(size_t index, unsigned long now);
+  static bool stepHasTag(const SimStep& step, uint64_t uid);
+  static uint64_t uidFromBytes(const uint8_t* uid);
+  void startRound(uint32_t mask, uint8_t maskLen);
+  void startSlot();
+  uint32_t nextRandom();
+  void printSummary(unsigned long now);
+};
+
+#endif
@@ -0,0 +1,330 @@
+/*
+ * nfc_trace.cpp
+ *
+ * Raw Scan Trace Recorder and Replay Implementation
+ *
+ * The scan task only copies records into a RAM ring (single producer);
+ * loop() writes them to flash in batches with flushNFCTrace() (single
+ * consumer), so a slow flash write never stalls scanning. Replay reads
+ * the files from the scan task, which owns the reader state it feeds.
+ */
+
+#include "nfc_trace.h"
+#include <LittleFS.h>
+#include <atomic>
+
+#define TRACE_RECORD_HEADER  6     // millis + error code + card count
+#define TRACE_CARD_MASK      0x1F  // Card count bits
+#define TRACE_READER_SHIFT   5     // Then two reader bits...
+#define TRACE_READER_MASK    0x03
+#define TRACE_PROTOCOL_BIT   0x80  // ...and the top bit for ISO14443A
+#define TRACE_FLUSH_BYTES    512   // Write once this much is buffered...
+#define TRACE_FLUSH_INTERVAL 2000  // ...or this often (ms)
+
+// Replay requests from loop to the scan task
+enum ReplayRequest {
+  REPLAY_NONE,
+  REPLAY_START_REALTIME,
+  REPLAY_START_FAST,
+  REPLAY_STOP
+};
+
+static bool fsMounted = false;
+
+// Recording - RAM ring between scan task and flush
+static std::atomic<bool> recording(false);
+static uint8_t ring[NFC_TRACE_RAM_BUFFER];
+static std::atomic<uint32_t> ringHead(0);
+static std::atomic<uint32_t> ringTail(0);
+static std::atomic<uint32_t> recordsWritten(0);
+static std::atomic<uint32_t> recordsDropped(0);
+static File traceFile;                 // loop side
+static unsigned long lastFlushTime = 0;
+
+// Replay - owned by the scan task
+static std::atomic<uint8_t> replayRequest(REPLAY_NONE);
+static std::atomic<bool> replaying(false);
+static bool replayFast = false;
+static File replayFile;
+static bool replayOnOldFile = false;
+static TraceEntry pending;
+static bool pendingValid = false;
+static uint32_t replayBase = 0;        // Trace time of the first record
+static unsigned long replayStartTime = 0;
+static std::atomic<uint32_t> replayRecords(0);
+static std::atomic<uint32_t> replayElapsed(0);
+
+bool initNFCTrace() {
+  fsMounted = LittleFS.begin(true);  // Format on first use
+  if (!fsMounted) {
+    Serial.println(F("ERROR: LittleFS mount failed - scan trace disabled"));
+    return false;
+  }
+  Serial.println(F("Scan trace ready (LittleFS)"));
+  return true;
+}
+
+// ---- Recording ----
+
+void traceRecord(uint32_t time, int rc, const uint8_t* uids, uint8_t numCard, uint8_t reader,
+                 uint8_t protocol) {
+  if (!recording.load(std::memory_order_relaxed)) return;
+  
+  uint32_t len = TRACE_RECORD_HEADER + numCard * 8;
+  uint32_t head = ringHead.load(std::memory_order_relaxed);
+  uint32_t tail = ringTail.load(std::memory_order_acquire);
+  if (NFC_TRACE_RAM_BUFFER - (head - tail) < len) {
+    recordsDropped++;
+    return;
+  }
+  
+  uint8_t cards = numCard | ((reader & TRACE_READER_MASK) << TRACE_READER_SHIFT);
+  if (protocol == PROTOCOL_ISO14443A) cards |= TRACE_PROTOCOL_BIT;
+  uint8_t header[TRACE_RECORD_HEADER] = {
+    (uint8_t)time, (uint8_t)(time >> 8), (uint8_t)(time >> 16), (uint8_t)(time >> 24),
+    (uint8_t)(rc < 0 ? NFC_TRACE_NO_CARD : rc), cards
+  };
+  for (uint32_t i = 0; i < len; i++) {
+    uint8_t b = (i < TRACE_RECORD_HEADER) ? header[i] : uids[i - TRACE_RECORD_HEADER];
+    ring[(head + i) % NFC_TRACE_RAM_BUFFER] = b;
+  }
+  
+  // Only whole records are published, so the flush always ends on a boundary
+  ringHead.store(head + len, std::memory_order_release);
+  recordsWritten++;
+}
+
+// Move the current file to the old slot (the log keeps two files)
+static void rotateTrace() {
+  traceFile.close();
+  LittleFS.remove(NFC_TRACE_OLD_FILE);
+  LittleFS.rename(NFC_TRACE_FILE, NFC_TRACE_OLD_FILE);
+}
+
+void flushNFCTrace() {
+  if (!fsMounted) return;
+  
+  uint32_t tail = ringTail.load(std::memory_order_relaxed);
+  uint32_t head = ringHead.load(std::memory_order_acquire);
+  uint32_t buffered = head - tail;
+  unsigned long now = millis();
+  
+  if (buffered == 0) {
+    // Idle and stopped - close so replay reads a complete file
+    if (traceFile && !recording.load()) traceFile.close();
+    return;
+  }
+  if (buffered < TRACE_FLUSH_BYTES && now - lastFlushTime < TRACE_FLUSH_INTERVAL &&
+      recording.load()) {
+    return;
+  }
+  lastFlushTime = now;
+  
+  if (!traceFile) {
+    traceFile = LittleFS.open(NFC_TRACE_FILE, FILE_APPEND);
+    if (!traceFile) {
+      ringTail.store(head, std::memory_order_release);  // Can't write - discard
+      return;
+    }
+    if (traceFile.size() == 0) {
+      uint32_t magic = NFC_TRACE_MAGIC;
+      traceFile.write((const uint8_t*)&magic, sizeof(magic));
+    }
+  }
+  
+  // At most two contiguous pieces (the buffered bytes may wrap)
+  uint32_t start = tail % NFC_TRACE_RAM_BUFFER;
+  uint32_t first = min(buffered, (uint32_t)(NFC_TRACE_RAM_BUFFER - start));
+  traceFile.write(&ring[start], first);
+  if (buffered > first) {
+    traceFile.write(&ring[0], buffered - first);
+  }
+  traceFile.flush();
+  ringTail.store(head, std::memory_order_release);
+  
+  if (traceFile.size() >= NFC_TRACE_MAX_BYTES) {
+    rotateTrace();
+  }
+}
+
+void startNFCTrace() {
+  if (!fsMounted || replaying.load()) return;
+  recording = true;
+  Serial.println(F("Scan trace recording started"));
+}
+
+void stopNFCTrace() {
+  if (!recording.load()) return;
+  recording = false;
+  flushNFCTrace();
+  Serial.println(F("Scan trace recording stopped"));
+}
+
+void clearNFCTrace() {
+  if (!fsMounted) return;
+  if (traceFile) traceFile.close();
+  ringTail.store(ringHead.load(std::memory_order_acquire), std::memory_order_release);
+  LittleFS.remove(NFC_TRACE_FILE);
+  LittleFS.remove(NFC_TRACE_OLD_FILE);
+  recordsWritten = 0;
+  recordsDropped = 0;
+  Serial.println(F("Scan trace cleared"));
+}
+
+// ---- Replay ----
+
+bool startNFCReplay(bool fast) {
+  if (!fsMounted || replaying.load()) return false;
+  if (!LittleFS.exists(NFC_TRACE_FILE) && !LittleFS.exists(NFC_TRACE_OLD_FILE)) return false;
+  
+  // Replayed results are not recorded again
+  recording = false;
+  flushNFCTrace();
+  if (traceFile) traceFile.close();
+  
+  replayRequest = fast ? REPLAY_START_FAST : REPLAY_START_REALTIME;
+  return true;
+}
+
+void stopNFCReplay() {
+  if (replaying.load()) replayRequest = REPLAY_STOP;
+}
+
+// Open a trace file and check its header (scan task)
+static bool openReplayFile(const char* path) {
+  replayFile = LittleFS.open(path, FILE_READ);
+  if (!replayFile) return false;
+  
+  uint32_t magic = 0;
+  if (replayFile.read((uint8_t*)&magic, sizeof(magic)) != sizeof(magic) || magic != NFC_TRACE_MAGIC) {
+    Serial.print(F("Trace file invalid: "));
+    Serial.println(path);
+    replayFile.close();
+    return false;
+  }
+  return true;
+}
+
+// Next record from the old file, then the current one (scan task)
+static bool readReplayEntry(TraceEntry* entry) {
+  for (;;) {
+    if (replayFile) {
+      uint8_t header[TRACE_RECORD_HEADER];
+      if (replayFile.read(header, sizeof(header)) == sizeof(header) &&
+          (header[5] & TRACE_CARD_MASK) <= MAX_TAGS) {
+        entry->time = header[0] | (header[1] << 8) | ((uint32_t)header[2] << 16) | ((uint32_t)header[3] << 24);
+        entry->rc = header[4];
+        entry->numCard = header[5] & TRACE_CARD_MASK;
+        entry->reader = (header[5] >> TRACE_READER_SHIFT) & TRACE_READER_MASK;
+        entry->protocol = (header[5] & TRACE_PROTOCOL_BIT) ? PROTOCOL_ISO14443A : PROTOCOL_ISO15693;
+        size_t uidBytes = entry->numCard * 8;
+        if (replayFile.read(entry->uids, uidBytes) == uidBytes) return true;
+      }
+      replayFile.close();  // End of file (or truncated record)
+    }
+    
+    if (!replayOnOldFile) return false;
+    replayOnOldFile = false;
+    openReplayFile(NFC_TRACE_FILE);
+  }
+}
+
+static void finishReplay() {
+  if (replayFile) replayFile.close();
+  replaying = false;
+  pendingValid = false;
+  
+  uint32_t records = replayRecords.load();
+  uint32_t elapsed = replayElapsed.load();
+  Serial.print(F("Replay finished: "));
+  Serial.print(records);
+  Serial.print(F(" records in "));
+  Serial.print(elapsed);
+  Serial.print(F("ms"));
+  if (elapsed > 0) {
+    Serial.print(F(" ("));
+    Serial.print(records * 1000.0 / elapsed, 0);
+    Serial.print(F(" records/s)"));
+  }
+  Serial.println();
+}
+
+bool traceReplayActive() {
+  uint8_t request = replayRequest.exchange(REPLAY_NONE);
+  
+  if (request == REPLAY_STOP && replaying.load()) {
+    finishReplay();
+  } else if (request == REPLAY_START_REALTIME || request == REPLAY_START_FAST) {
+    replayFast = (request == REPLAY_START_FAST);
+    replayOnOldFile = LittleFS.exists(NFC_TRACE_OLD_FILE);
+    bool opened = replayOnOldFile ? openReplayFile(NFC_TRACE_OLD_FILE) : openReplayFile(NFC_TRACE_FILE);
+    if (!opened && replayOnOldFile) {
+      replayOnOldFile = false;
+      opened = openReplayFile(NFC_TRACE_FILE);
+    }
+    if (opened) {
+      replayRecords = 0;
+      replayElapsed = 0;
+      pendingValid = false;
+      replayStartTime = millis();
+      replaying = true;
+      Serial.println(replayFast ? F("Replay started (fast)") : F("Replay started (real time)"));
+    }
+  }
+  
+  return replaying.load();
+}
+
+bool traceReplayNext(TraceEntry* entry) {
+  if (!replaying.load()) return false;
+  
+  if (!pendingValid) {
+    if (!readReplayEntry(&pending)) {
+      finishReplay();
+      return false;
+    }
+    pendingValid = true;
+    if (replayRecords.load() == 0) replayBase = pending.time;
+  }
+  
+  // Real time: hold each record until its original offset from the first
+  unsigned long elapsed = millis() - replayStartTime;
+  if (!replayFast && elapsed < pending.time - replayBase) {
+    return false;
+  }
+  
+  *entry = pending;
+  pendingValid = false;
+  replayRecords++;
+  replayElapsed = elapsed;
+  return true;
+}
+
+TraceStatus getNFCTraceStatus() {
+  TraceStatus status;
+  status.available = fsMounted;
+  status.recording = recording.load();
+  status.replaying = replaying.load();
+  status.replayFast = replayFast;
+  status.recordsWritten = recordsWritten.load();
+  status.recordsDropped = recordsDropped.load();
+  status.replayRecords = replayRecords.load();
+  status.replayElapsed = replayElapsed.load();
+  status.fileBytes = 0;
+  
+  if (fsMounted) {
+    if (traceFile) {
+      status.fileBytes += traceFile.size();
+    } else if (LittleFS.exists(NFC_TRACE_FILE)) {
+      File f = LittleFS.open(NFC_TRACE_FILE, FILE_READ);
+      status.fileBytes += f.size();
+      f.close();
+    }
+    if (LittleFS.exists(NFC_TRACE_OLD_FILE)) {
+      File f = LittleFS.open(NFC_TRACE_OLD_FILE, FILE_READ);
+      status.fileBytes += f.size();
+      f.close();
+    }
+  }
+  return status;
+}
@@ -0,0 +1,74 @@
+/*
+ * nfc_trace.h
+ *
+ * Raw Scan Trace Recorder and Replay
+ * Records every raw inventory result (time, error code, UIDs) to a
+ * compact binary log in LittleFS, and feeds a recorded log back through
+ * the reader's debounce/timeout logic in place of the PN5180, so field
+ * problems can be reproduced and measured on the bench.
+ *
+ * File format (little-endian):
+ *   header:  uint32 magic "NFT1"
+ *   record:  uint32 millis, uint8 error code (0xFF = no card),
+ *            uint8 card count (bits 0-4; reader index in bits 5-6,
+ *            bit 7 set for an ISO14443A result),
+ *            then 8 UID bytes (LSB first) per card
+ */
+
+#ifndef NFC_TRACE_H
+#define NFC_TRACE_H
+
+#include <Arduino.h>
+#include "nfc_reader.h"
+
+#define NFC_TRACE_FILE        "/trace.bin"
+#define NFC_TRACE_OLD_FILE    "/trace.old"   // Previous file - the log is a ring of two
+#define NFC_TRACE_MAX_BYTES   65536          // Size at which the current file rotates
+#define NFC_TRACE_RAM_BUFFER  2048           // Bytes buffered between scan task and flush
+#define NFC_TRACE_MAGIC       0x3154464E     // "NFT1"
+#define NFC_TRACE_NO_CARD     0xFF           // Stored error code for EC_NO_CARD
+
+// One raw inventory result
+struct TraceEntry {
+  uint32_t time;                 // millis() when the inventory completed
+  uint8_t rc;                    // ISO15693ErrorCode (NFC_TRACE_NO_CARD for EC_NO_CARD)
+  uint8_t numCard;
+  uint8_t reader;                // PN5180 that produced the result
+  uint8_t protocol;              // TagProtocol the scan used
+  uint8_t uids[MAX_TAGS * 8];
+};
+
+struct TraceStatus {
+  bool available;                // LittleFS mounted
+  bool recording;
+  bool replaying;
+  bool replayFast;               // Replay as fast as possible (throughput) vs. real time
+  uint32_t recordsWritten;
+  uint32_t recordsDropped;       // RAM buffer full (flush not keeping up)
+  uint32_t fileBytes;            // Both files
+  uint32_t replayRecords;
+  unsigned long replayElapsed;   // ms spent in the last/current replay
+};
+
+// Mount LittleFS (call in setup)
+bool initNFCTrace();
+
+// Recording control and flush (call from loop / web handlers)
+void startNFCTrace();
+void stopNFCTrace();
+void clearNFCTrace();
+void flushNFCTrace();
+
+// Replay control (call from loop / web handlers)
+bool startNFCReplay(bool fast);
+void stopNFCReplay();
+
+TraceStatus getNFCTraceStatus();
+
+// Scan task side - used by nfc_reader.cpp
+void traceRecord(uint32_t time, int rc, const uint8_t* uids, uint8_t numCard, uint8_t reader,
+                 uint8_t protocol);
+bool traceReplayActive();
+bool traceReplayNext(TraceEntry* entry);
+
+#endif
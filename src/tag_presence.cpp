@@ -0,0 +1,83 @@
+/*
+ * tag_presence.cpp
+ *
+ * Per-Tag Publish State Implementation
+ *
+ * Only the MQTT tag event subscriber (loop) uses the table. Linear
+ * probing keeps a lookup to a couple of slot compares at the table's
+ * low load; deleting shifts later entries of the probe run back, so no
+ * tombstones build up as tags come and go.
+ */
+
+#include "tag_presence.h"
+
+#define SLOT_MASK (TAG_PRESENCE_SLOTS - 1)
+
+static TagPresence slots[TAG_PRESENCE_SLOTS];
+static uint16_t usedCount = 0;
+static uint32_t overflows = 0;
+
+// Home slot (64-bit multiplicative hash of UID and reader)
+static uint16_t homeSlot(TagUID uid, uint8_t reader) {
+  uint64_t key = uid.value ^ ((uint64_t)reader << 56);
+  return (uint16_t)((key * 0x9E3779B97F4A7C15ULL) >> 48) & SLOT_MASK;
+}
+
+TagPresence* findTagPresence(TagUID uid, uint8_t reader) {
+  uint16_t i = homeSlot(uid, reader);
+  for (int probes = 0; probes < TAG_PRESENCE_SLOTS && slots[i].used; probes++) {
+    if (slots[i].uid == uid && slots[i].reader == reader) return &slots[i];
+    i = (i + 1) & SLOT_MASK;
+  }
+  return nullptr;
+}
+
+TagPresence* addTagPresence(TagUID uid, uint8_t reader, unsigned long now) {
+  uint16_t i = homeSlot(uid, reader);
+  for (int probes = 0; probes < TAG_PRESENCE_SLOTS; probes++) {
+    TagPresence* entry = &slots[i];
+    if (!entry->used) {
+      entry->uid = uid;
+      entry->reader = reader;
+      entry->used = true;
+      entry->firstSeen = now;
+      entry->lastPublished = now;
+      usedCount++;
+      return entry;
+    }
+    if (entry->uid == uid && entry->reader == reader) return entry;
+    i = (i + 1) & SLOT_MASK;
+  }
+
+  overflows++;
+  return nullptr;
+}
+
+void removeTagPresence(TagPresence* entry) {
+  if (!entry || !entry->used) return;
+
+  uint16_t hole = entry - slots;
+  slots[hole].used = false;
+  usedCount--;
+
+  // Move back any later entry whose home slot lies at or before the hole,
+  // so lookups never stop early at it
+  uint16_t i = (hole + 1) & SLOT_MASK;
+  while (slots[i].used) {
+    uint16_t home = homeSlot(slots[i].uid, slots[i].reader);
+    if (((i - home) & SLOT_MASK) >= ((i - hole) & SLOT_MASK)) {
+      slots[hole] = slots[i];
+      slots[i].used = false;
+      hole = i;
+    }
+    i = (i + 1) & SLOT_MASK;
+  }
+}
+
+uint16_t getTagPresenceCount() {
+  return usedCount;
+}
+
+uint32_t getTagPresenceOverflows() {
+  return overflows;
+}
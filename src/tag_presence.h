@@ -0,0 +1,42 @@
+/*
+ * tag_presence.h
+ *
+ * Per-Tag Publish State
+ * Remembers, for every tag currently in a reader's field, when it
+ * arrived and when it was last published, so Read/Continuing/Unread can
+ * be decided per tag (Continuing heartbeat, dwell time on Unread).
+ *
+ * Fixed-capacity open-addressing table (linear probing, backward-shift
+ * delete) keyed by UID and reader - no heap allocation.
+ */
+
+#ifndef TAG_PRESENCE_H
+#define TAG_PRESENCE_H
+
+#include <Arduino.h>
+#include "tag_uid.h"
+
+#define TAG_PRESENCE_SLOTS 128  // Power of two, at least 2x MAX_TAGS * NFC_READER_COUNT
+
+struct TagPresence {
+  TagUID uid;
+  uint8_t reader;
+  bool used;
+  unsigned long firstSeen;       // millis() of the enter event
+  unsigned long lastPublished;   // millis() of the last Read/Continuing
+};
+
+// Entry for a tag on a reader (nullptr = not tracked)
+TagPresence* findTagPresence(TagUID uid, uint8_t reader);
+
+// Start tracking a tag (returns the existing entry if already tracked,
+// nullptr if the table is full)
+TagPresence* addTagPresence(TagUID uid, uint8_t reader, unsigned long now);
+
+// Stop tracking (entry from find/add; pointers to other entries may move)
+void removeTagPresence(TagPresence* entry);
+
+uint16_t getTagPresenceCount();
+uint32_t getTagPresenceOverflows();  // Tags that didn't fit
+
+#endif
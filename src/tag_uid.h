@@ -0,0 +1,64 @@
+/*
+ * tag_uid.h
+ *
+ * Fixed-size tag UID value type (ISO15693, or a 4/7 byte ISO14443A UID)
+ * Carried through scan -> publish -> display without heap allocation;
+ * hex text is only produced on demand into a caller-supplied buffer.
+ */
+
+#ifndef TAG_UID_H
+#define TAG_UID_H
+
+#include <Arduino.h>
+
+#define TAG_UID_HEX_LEN 17  // 16 hex digits + terminator
+
+struct TagUID {
+  uint64_t value;  // UID with byte 7 (MSB, e.g. 0xE0) at the top
+
+  bool isEmpty() const { return value == 0; }
+  bool operator==(const TagUID& other) const { return value == other.value; }
+  bool operator!=(const TagUID& other) const { return value != other.value; }
+
+  // Build from the 8 bytes the PN5180 returns (LSB first)
+  static TagUID fromBytes(const uint8_t* bytes) {
+    TagUID uid = { 0 };
+    for (int i = 7; i >= 0; i--) {
+      uid.value = (uid.value << 8) | bytes[i];
+    }
+    return uid;
+  }
+
+  // Build from an ISO14443A UID (4 or 7 bytes, first byte most significant
+  // - the usual NFC tool order, shown with leading zeros)
+  static TagUID fromTypeA(const uint8_t* bytes, uint8_t length) {
+    TagUID uid = { 0 };
+    for (uint8_t i = 0; i < length; i++) {
+      uid.value = (uid.value << 8) | bytes[i];
+    }
+    return uid;
+  }
+
+  // Back to the 8 byte form the PN5180 commands take (LSB first)
+  void toBytes(uint8_t* bytes) const {
+    uint64_t v = value;
+    for (int i = 0; i < 8; i++) {
+      bytes[i] = v & 0xFF;
+      v >>= 8;
+    }
+  }
+
+  // Format as 16 upper-case hex digits, MSB first (buffer >= TAG_UID_HEX_LEN)
+  const char* toHex(char* out) const {
+    static const char hexDigits[] = "0123456789ABCDEF";
+    uint64_t v = value;
+    for (int i = 15; i >= 0; i--) {
+      out[i] = hexDigits[v & 0x0F];
+      v >>= 4;
+    }
+    out[16] = '\0';
+    return out;
+  }
+};
+
+#endif
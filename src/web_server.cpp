@@ -7,6 +7,13 @@
 #include "web_server.h"
 #include "display.h"
 #include "nfc_reader.h"
+#include "nfc_trace.h"
+#include "mqtt_handler.h"
+#include "mqtt_queue.h"
+#include "mqtt_inflight.h"
+#include "tag_presence.h"
+#include "fleet_stats.h"
+#include <LittleFS.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
 
@@ -14,9 +21,16 @@
 static WebServer* webServer = nullptr;
 static Config* config = nullptr;
 static PubSubClient* mqttClient = nullptr;
-static uint32_t* mqttPublished = nullptr;
 static void (*configSaveCallback)() = nullptr;
 
+// Recent tag events (ring, filled by the event bus subscriber in loop)
+static TagEventInfo eventLog[WEB_EVENT_LOG];
+static uint32_t eventLogCount = 0;  // Events logged since boot
+
+// /status document - too big for the loop task's 8KB stack, and only one
+// request is served at a time
+static StaticJsonDocument<WEB_STATUS_JSON_SIZE> statusDoc;
+
 void setWebServerConfig(Config* cfg) {
   config = cfg;
 }
@@ -25,10 +39,6 @@ void setWebServerMqttClient(void* client) {
   mqttClient = (PubSubClient*)client;
 }
 
-void setWebServerMqttPublished(uint32_t* counter) {
-  mqttPublished = counter;
-}
-
 void setConfigSaveCallback(void (*callback)()) {
   configSaveCallback = callback;
 }
@@ -41,6 +51,10 @@ void initWebServer(WebServer* server) {
   webServer->on("/config", HTTP_GET, handleConfig);
   webServer->on("/config", HTTP_POST, handleConfigSave);
   webServer->on("/status", handleStatus);
+  webServer->on("/trace", HTTP_GET, handleTraceDownload);
+  webServer->on("/trace/control", handleTraceControl);
+  webServer->on("/events", handleEvents);
+  webServer->on("/fleet", handleFleet);
   
   webServer->begin();
   Serial.println(F("Web server started"));
@@ -63,6 +77,7 @@ void handleRoot() {
   html += F(".section-lower{min-height:100px}");
   html += F("h2{color:#00FF00;margin:5px 0;font-size:20px;border-bottom:1px solid #0F0;padding-bottom:5px}");
   html += F(".local-tag{font-size:24px;color:#00FFFF;margin:10px 0;font-weight:bold}");
+  html += F(".tag-mem{font-size:12px;color:#88AAAA;margin:-6px 0 10px 0;word-break:break-all}");
   html += F(".scanning{font-size:20px;color:#FFA500;margin:10px 0}");
   html += F(".mqtt-line{font-size:18px;margin:8px 0;padding:5px;border-left:3px solid #0F0}");
   html += F(".mqtt-first{position:relative;display:flex;justify-content:space-between;align-items:center}");
@@ -104,13 +119,29 @@ void handleRoot() {
   
   // ===== UPPER SECTION - LOCAL TAG =====
   html += F("<div class='section section-upper'>");
-  html += F("<h2>Local Tag Read:</h2>");
-  String currentUID = getCurrentUID();
-  bool currentTagPresent = getCurrentTagPresent();
-  if (currentUID.length() > 0 && currentTagPresent) {
-    html += F("<div class='local-tag'>");
-    html += currentUID;
-    html += F("</div>");
+  int localTagCount = getLocalTagCount();
+  if (localTagCount > 1) {
+    html += F("<h2>Local Tags Read: ");
+    html += String(localTagCount);
+    html += F("</h2>");
+  } else {
+    html += F("<h2>Local Tag Read:</h2>");
+  }
+  if (localTagCount > 0) {
+    char uidStr[TAG_UID_HEX_LEN];
+    char memHex[TAG_MEM_HEX_LEN];
+    TagMemory memory;
+    for (int i = 0; i < localTagCount; i++) {
+      TagUID uid = getLocalTagUID(i);
+      html += F("<div class='local-tag'>");
+      html += uid.toHex(uidStr);
+      html += F("</div>");
+      if (getTagMemory(uid, &memory) && memory.length > 0) {
+        html += F("<div class='tag-mem'>");
+        html += tagMemoryToHex(memory, memHex);
+        html += F("</div>");
+      }
+    }
   } else {
     html += F("<div class='scanning'>Scanning...</div>");
   }
@@ -185,7 +216,43 @@ void handleRoot() {
   html += String(nfcStatus.productVersion / 10.0, 1);
   html += F("</span>");
   html += F("<span class='status-label'>  Protocol : </span>");
-  html += F("<span class='status-val'>ISO15693</span></div>");
+  html += F("<span class='status-val'>");
+  if (config->protocols == NFC_PROTOCOLS_ALL) {
+    html += F("ISO15693 + ISO14443A (");
+    html += String(nfcStatus.protocolSwitches);
+    html += F(" switches)");
+  } else {
+    html += nfcProtocolName((config->protocols & NFC_PROTOCOL_BIT(PROTOCOL_ISO14443A)) ? PROTOCOL_ISO14443A : PROTOCOL_ISO15693);
+  }
+  html += F("</span></div>");
+  
+  // One line per reader when several are fitted
+  if (NFC_READER_COUNT > 1) {
+    for (int i = 0; i < NFC_READER_COUNT; i++) {
+      NFCStatus reader = getNFCReaderStatus(i);
+      html += F("<div class='status-line'>");
+      html += F("<span class='status-label'>Reader ");
+      html += String(i);
+      html += F(" : </span>");
+      if (reader.initialized) {
+        html += F("<span class='status-ok'>OK</span>");
+      } else {
+        html += F("<span class='status-err'>FAIL</span>");
+      }
+      html += F("<span class='status-label'>  Scans : </span>");
+      html += F("<span class='status-val'>");
+      html += String(reader.totalScans);
+      html += F("</span>");
+      html += F("<span class='status-label'>  Tags : </span>");
+      html += F("<span class='status-val'>");
+      html += String(reader.tagsPresent);
+      html += F("</span>");
+      html += F("<span class='status-label'>  AGC : </span>");
+      html += F("<span class='status-val'>");
+      html += String(reader.agcValue);
+      html += F("</span></div>");
+    }
+  }
   
   // Scan statistics
   html += F("<div class='status-line'>");
@@ -202,6 +269,61 @@ void handleRoot() {
   html += String(nfcStatus.failedReads);
   html += F("</span></div>");
   
+  // Scan scheduler
+  html += F("<div class='status-line'>");
+  html += F("<span class='status-label'>Rate   : </span>");
+  html += F("<span class='status-val'>");
+  html += String(nfcStatus.scanRate, 1);
+  html += F("/s</span>");
+  html += F("<span class='status-label'>  Interval : </span>");
+  html += F("<span class='status-val'>");
+  html += String(nfcStatus.scanInterval);
+  html += F("ms</span>");
+  html += F("<span class='status-label'>  Detect : </span>");
+  html += F("<span class='status-val'>");
+  html += String(nfcStatus.lastDetectLatency);
+  html += F("ms</span></div>");
+  
+  // LPCD idle
+  if (config->lpcd_quiet > 0) {
+    html += F("<div class='status-line'>");
+    html += F("<span class='status-label'>Idle   : </span>");
+    html += F("<span class='status-val'>");
+    html += nfcStatus.lpcdActive ? F("LPCD") : F("Scanning");
+    html += F("</span>");
+    html += F("<span class='status-label'>  Total : </span>");
+    html += F("<span class='status-val'>");
+    html += String(nfcStatus.idleTime / 1000);
+    html += F("s</span>");
+    html += F("<span class='status-label'>  Wakes : </span>");
+    html += F("<span class='status-val'>");
+    html += String(nfcStatus.lpcdWakeups);
+    html += F("</span>");
+    html += F("<span class='status-label'>  Wake->Read : </span>");
+    html += F("<span class='status-val'>");
+    html += String(nfcStatus.lastWakeLatency);
+    html += F("ms</span></div>");
+  }
+  
+  // RF quality
+  html += F("<div class='status-line'>");
+  html += F("<span class='status-label'>AGC    : </span>");
+  html += F("<span class='status-val'>");
+  html += String(nfcStatus.agcValue);
+  html += F(" (");
+  html += String(nfcStatus.agcMin);
+  html += F("-");
+  html += String(nfcStatus.agcMax);
+  html += F(")</span>");
+  html += F("<span class='status-label'>  RX err : </span>");
+  html += F("<span class='status-val'>");
+  html += String(nfcStatus.rxIntegrityErrors + nfcStatus.rxProtocolErrors);
+  html += F("</span>");
+  html += F("<span class='status-label'>  Coll : </span>");
+  html += F("<span class='status-val'>");
+  html += String(nfcStatus.rxCollisions);
+  html += F("</span></div>");
+  
   // MQTT status
   html += F("<div class='status-line'>");
   html += F("<span class='status-label'>MQTT   : </span>");
@@ -224,13 +346,56 @@ void handleRoot() {
   html += config->mqtt_base_topic;
   html += F("/#</span></div>");
   
+  // Store-and-forward queue (only while something is waiting or was lost)
+  MqttQueueStatus queue = getMqttQueueStatus();
+  if (queue.depth > 0 || queue.dropped > 0) {
+    html += F("<div class='status-line'>");
+    html += F("<span class='status-label'>Queue  : </span>");
+    html += F("<span class='status-val'>");
+    html += String(queue.depth);
+    html += F(" waiting, oldest ");
+    html += String(queue.oldestAge / 1000);
+    html += queue.oldestPreviousBoot ? F("s+ (before reboot)") : F("s");
+    if (queue.dropped > 0) {
+      html += F(", ");
+      html += String(queue.dropped);
+      html += F(" dropped");
+    }
+    html += F("</span></div>");
+  }
+  
   html += F("</div>");  // End status section
   
   html += F("</div>");  // End container
   
   // Configuration link at bottom
   html += F("<div style='text-align:center;margin-top:20px'>");
-  html += F("<a href='/config' class='config-link'>[Configuration]</a>");
+  html += F("<a href='/config' class='config-link'>[Configuration]</a> ");
+  html += F("<a href='/fleet' class='config-link'>[Fleet]</a>");
+  
+  // Scan trace controls
+  TraceStatus trace = getNFCTraceStatus();
+  if (trace.available) {
+    html += F("<div class='status-line'>");
+    html += F("<span class='status-label'>Trace  : </span>");
+    html += F("<span class='status-val'>");
+    if (trace.replaying) {
+      html += F("Replaying ");
+      html += String(trace.replayRecords);
+    } else if (trace.recording) {
+      html += F("Recording ");
+      html += String(trace.recordsWritten);
+    } else {
+      html += F("Stopped");
+    }
+    html += F(" (");
+    html += String(trace.fileBytes / 1024);
+    html += F("KB)</span> ");
+    html += F("<a href='/trace/control?cmd=start'>[Record]</a> <a href='/trace/control?cmd=stop'>[Stop]</a> ");
+    html += F("<a href='/trace'>[Download]</a> <a href='/trace/control?cmd=replay'>[Replay]</a> ");
+    html += F("<a href='/trace/control?cmd=replay_fast'>[Replay Fast]</a> <a href='/trace/control?cmd=clear'>[Clear]</a>");
+    html += F("</div>");
+  }
   html += F("</div>");
   
   html += F("</body></html>");
@@ -269,9 +434,62 @@ void handleConfig() {
   html += F("<p style='font-size:12px;color:#666;margin:5px 0'>This node publishes to: [base]/Read, [base]/Continuing, [base]/Unread</p>");
   html += F("<label>Subscribe Topic:</label><input name='sub_topic' value='"); html += config->mqtt_subscribe_topic; html += F("'>");
   html += F("<p style='font-size:12px;color:#666;margin:5px 0'>Examples: rfid/# (all), rfid/Read (reads only), rfid/+ (one level)</p>");
+  html += F("<label>Receive Filter:</label><input name='rx_filter' maxlength='95' value='"); html += config->mqtt_rx_filter; html += F("'>");
+  html += F("<p style='font-size:12px;color:#666;margin:5px 0'>Comma-separated topics to keep, ! to drop, e.g. rfid/#,!rfid/Continuing (empty = all)</p>");
+  html += F("<label><input type='checkbox' name='tag_mem' value='1' style='width:auto'");
+  if (config->mqtt_tag_memory) html += F(" checked");
+  html += F("> Include tag memory in Read messages</label>");
+  html += F("<label>Continuing Every (s):</label><input type='number' name='cont_int' min='0' max='3600' value='"); html += config->continuing_interval; html += F("'>");
+  html += F("<p style='font-size:12px;color:#666;margin:5px 0'>Per tag while it stays present (0 = no Continuing messages)</p>");
+  html += F("<label>Batch Window (ms):</label><input type='number' name='batch_ms' min='0' max='5000' value='"); html += config->mqtt_batch_ms; html += F("'>");
+  html += F("<label>Batch Max Events:</label><input type='number' name='batch_max' min='1' max='16' value='"); html += config->mqtt_batch_max; html += F("'>");
+  html += F("<p style='font-size:12px;color:#666;margin:5px 0'>With a window above 0, events are sent together on [base]/Batch instead of one message each</p>");
+  html += F("<label>Payload Format:</label><select name='mqtt_fmt'>");
+  html += F("<option value='0'"); if (config->mqtt_format == MQTT_FORMAT_JSON) html += F(" selected"); html += F(">JSON</option>");
+  html += F("<option value='1'"); if (config->mqtt_format == MQTT_FORMAT_BINARY) html += F(" selected"); html += F(">Binary (24-byte records)</option>");
+  html += F("</select>");
+  html += F("<label>QoS:</label><select name='mqtt_qos'>");
+  html += F("<option value='0'"); if (config->mqtt_qos == 0) html += F(" selected"); html += F(">0 - fire and forget</option>");
+  html += F("<option value='1'"); if (config->mqtt_qos == 1) html += F(" selected"); html += F(">1 - wait for broker PUBACK</option>");
+  html += F("</select>");
+  html += F("<label>QoS 1 In-Flight Window:</label><input type='number' name='inflight' min='1' max='32' value='"); html += config->mqtt_inflight; html += F("'>");
   html += F("<label>Sensor ID:</label><input type='number' name='sensor' min='1' max='255' value='"); html += config->sensor_id; html += F("'>");
   html += F("</div>");
   
+  html += F("<div class='card'><h2>Scanning</h2>");
+  html += F("<label>Min Scan Interval (ms):</label><input type='number' name='scan_min' min='10' max='2000' value='"); html += config->scan_min_interval; html += F("'>");
+  html += F("<label>Max Scan Interval (ms):</label><input type='number' name='scan_max' min='10' max='2000' value='"); html += config->scan_max_interval; html += F("'>");
+  html += F("<p style='font-size:12px;color:#666;margin:5px 0'>Polls at the minimum while a tag is present, backs off to the maximum when the field is empty</p>");
+  html += F("<label>LPCD Idle After (s):</label><input type='number' name='lpcd_quiet' min='0' max='3600' value='"); html += config->lpcd_quiet; html += F("'>");
+  html += F("<p style='font-size:12px;color:#666;margin:5px 0'>Turns the RF field off and waits for the PN5180 card detector after this long with no tag (0 = always scan)</p>");
+  html += F("<label>Protocols:</label><select name='protocols'>");
+  html += F("<option value='1'"); if (config->protocols == NFC_PROTOCOL_BIT(PROTOCOL_ISO15693)) html += F(" selected"); html += F(">ISO15693 (ICODE SLIX)</option>");
+  html += F("<option value='2'"); if (config->protocols == NFC_PROTOCOL_BIT(PROTOCOL_ISO14443A)) html += F(" selected"); html += F(">ISO14443A (MIFARE / NTAG)</option>");
+  html += F("<option value='3'"); if (config->protocols == NFC_PROTOCOLS_ALL) html += F(" selected"); html += F(">Both (time-sliced)</option>");
+  html += F("</select>");
+  html += F("</div>");
+  
+  html += F("<div class='card'><h2>Debounce</h2>");
+  html += F("<label>Policy:</label><select name='db_mode'>");
+  html += F("<option value='0'"); if (config->debounce_mode == DEBOUNCE_CONSECUTIVE) html += F(" selected"); html += F(">N reads in a row</option>");
+  html += F("<option value='1'"); if (config->debounce_mode == DEBOUNCE_N_OF_M) html += F(" selected"); html += F(">N of last M scans</option>");
+  html += F("<option value='2'"); if (config->debounce_mode == DEBOUNCE_HYSTERESIS) html += F(" selected"); html += F(">Hysteresis (N of M in, below L out)</option>");
+  html += F("</select>");
+  html += F("<label>Reads to Enter (N):</label><input type='number' name='db_enter' min='1' max='16' value='"); html += config->debounce_enter; html += F("'>");
+  html += F("<label>Window (M scans):</label><input type='number' name='db_window' min='1' max='16' value='"); html += config->debounce_window; html += F("'>");
+  html += F("<label>Reads to Stay (L, hysteresis):</label><input type='number' name='db_leave' min='1' max='16' value='"); html += config->debounce_leave; html += F("'>");
+  html += F("<label>Timeout (missed scans):</label><input type='number' name='db_timeout' min='1' max='255' value='"); html += config->debounce_timeout; html += F("'>");
+  html += F("<p style='font-size:12px;color:#666;margin:5px 0'>Higher N / timeout = fewer false Read/Unread events, slower detection and removal</p>");
+  html += F("</div>");
+  
+  html += F("<div class='card'><h2>Display</h2>");
+  html += F("<label>TFT Page:</label><select name='disp_page'>");
+  html += F("<option value='0'"); if (config->display_page == DISPLAY_PAGE_MAIN) html += F(" selected"); html += F(">Reader (tags, MQTT history, status)</option>");
+  html += F("<option value='1'"); if (config->display_page == DISPLAY_PAGE_FLEET) html += F(" selected"); html += F(">Fleet (all sensors on the broker)</option>");
+  html += F("<option value='2'"); if (config->display_page == DISPLAY_PAGE_CYCLE) html += F(" selected"); html += F(">Alternate every 10s</option>");
+  html += F("</select>");
+  html += F("</div>");
+  
   html += F("<button type='submit'>Save & Reboot</button></form>");
   html += F("<p><a href='/'>[Back]</a></p></body></html>");
   
@@ -292,7 +510,25 @@ void handleConfigSave() {
   if (webServer->hasArg("port")) config->mqtt_port = webServer->arg("port").toInt();
   if (webServer->hasArg("pub_topic")) strlcpy(config->mqtt_base_topic, webServer->arg("pub_topic").c_str(), sizeof(config->mqtt_base_topic));
   if (webServer->hasArg("sub_topic")) strlcpy(config->mqtt_subscribe_topic, webServer->arg("sub_topic").c_str(), sizeof(config->mqtt_subscribe_topic));
+  if (webServer->hasArg("disp_page")) config->display_page = constrain(webServer->arg("disp_page").toInt(), DISPLAY_PAGE_MAIN, DISPLAY_PAGE_CYCLE);
+  if (webServer->hasArg("rx_filter")) strlcpy(config->mqtt_rx_filter, webServer->arg("rx_filter").c_str(), sizeof(config->mqtt_rx_filter));
+  config->mqtt_tag_memory = webServer->hasArg("tag_mem") ? 1 : 0;  // Unchecked boxes are not sent
+  if (webServer->hasArg("cont_int")) config->continuing_interval = constrain(webServer->arg("cont_int").toInt(), 0, MQTT_CONTINUING_LIMIT);
+  if (webServer->hasArg("batch_ms")) config->mqtt_batch_ms = constrain(webServer->arg("batch_ms").toInt(), 0, MQTT_BATCH_MS_LIMIT);
+  if (webServer->hasArg("batch_max")) config->mqtt_batch_max = constrain(webServer->arg("batch_max").toInt(), 1, MQTT_BATCH_MAX);
+  if (webServer->hasArg("mqtt_fmt")) config->mqtt_format = constrain(webServer->arg("mqtt_fmt").toInt(), MQTT_FORMAT_JSON, MQTT_FORMAT_BINARY);
+  if (webServer->hasArg("mqtt_qos")) config->mqtt_qos = constrain(webServer->arg("mqtt_qos").toInt(), 0, 1);
+  if (webServer->hasArg("inflight")) config->mqtt_inflight = constrain(webServer->arg("inflight").toInt(), 1, MQTT_INFLIGHT_MAX);
   if (webServer->hasArg("sensor")) config->sensor_id = constrain(webServer->arg("sensor").toInt(), 1, 255);
+  if (webServer->hasArg("scan_min")) config->scan_min_interval = constrain(webServer->arg("scan_min").toInt(), 10, SCAN_INTERVAL_LIMIT);
+  if (webServer->hasArg("scan_max")) config->scan_max_interval = constrain(webServer->arg("scan_max").toInt(), config->scan_min_interval, SCAN_INTERVAL_LIMIT);
+  if (webServer->hasArg("lpcd_quiet")) config->lpcd_quiet = constrain(webServer->arg("lpcd_quiet").toInt(), 0, NFC_LPCD_QUIET_LIMIT);
+  if (webServer->hasArg("protocols")) config->protocols = constrain(webServer->arg("protocols").toInt(), 1, NFC_PROTOCOLS_ALL);
+  if (webServer->hasArg("db_mode")) config->debounce_mode = constrain(webServer->arg("db_mode").toInt(), 0, (int)DEBOUNCE_HYSTERESIS);
+  if (webServer->hasArg("db_enter")) config->debounce_enter = constrain(webServer->arg("db_enter").toInt(), 1, DEBOUNCE_WINDOW_LIMIT);
+  if (webServer->hasArg("db_window")) config->debounce_window = constrain(webServer->arg("db_window").toInt(), 1, DEBOUNCE_WINDOW_LIMIT);
+  if (webServer->hasArg("db_leave")) config->debounce_leave = constrain(webServer->arg("db_leave").toInt(), 1, DEBOUNCE_WINDOW_LIMIT);
+  if (webServer->hasArg("db_timeout")) config->debounce_timeout = constrain(webServer->arg("db_timeout").toInt(), 1, 255);
   
   // Call save callback if registered
   if (configSaveCallback) {
@@ -308,12 +544,74 @@ void handleConfigSave() {
   ESP.restart();
 }
 
+// Raw scan trace as one binary log (old file, then current without its header)
+void handleTraceDownload() {
+  if (!webServer) return;
+  
+  flushNFCTrace();
+  if (!LittleFS.exists(NFC_TRACE_FILE) && !LittleFS.exists(NFC_TRACE_OLD_FILE)) {
+    webServer->send(404, "text/plain", "No trace recorded");
+    return;
+  }
+  
+  webServer->sendHeader("Content-Disposition", "attachment; filename=trace.bin");
+  webServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer->send(200, "application/octet-stream", "");
+  
+  uint8_t buffer[512];
+  bool headerSent = false;
+  const char* files[] = { NFC_TRACE_OLD_FILE, NFC_TRACE_FILE };
+  for (int i = 0; i < 2; i++) {
+    File f = LittleFS.open(files[i], FILE_READ);
+    if (!f) continue;
+    if (headerSent) f.seek(4);  // Skip the second magic
+    headerSent = true;
+    size_t n;
+    while ((n = f.read(buffer, sizeof(buffer))) > 0) {
+      webServer->sendContent((const char*)buffer, n);
+    }
+    f.close();
+  }
+  webServer->sendContent("");  // End of chunked response
+}
+
+// Record / stop / clear / replay, then back to the main page
+void handleTraceControl() {
+  if (!webServer) return;
+  
+  String cmd = webServer->arg("cmd");
+  if (cmd == "start") {
+    startNFCTrace();
+  } else if (cmd == "stop") {
+    stopNFCTrace();
+    stopNFCReplay();
+  } else if (cmd == "clear") {
+    clearNFCTrace();
+  } else if (cmd == "replay" || cmd == "replay_fast") {
+    startNFCReplay(cmd == "replay_fast");
+  }
+  
+  webServer->sendHeader("Location", "/", true);
+  webServer->send(302, "text/plain", "");
+}
+
+// Percentile summary as a nested JSON object
+static void addLatencyJson(JsonObject parent, const char* key, const LatencySummary& summary) {
+  JsonObject obj = parent.createNestedObject(key);
+  obj["n"] = summary.count;
+  obj["p50"] = summary.p50;
+  obj["p90"] = summary.p90;
+  obj["p99"] = summary.p99;
+  obj["max"] = summary.max;
+}
+
 void handleStatus() {
   if (!webServer || !config) return;
   
   NFCStatus nfcStatus = getNFCStatus();
   
-  StaticJsonDocument<512> doc;
+  JsonDocument& doc = statusDoc;
+  doc.clear();
   doc["version"] = "1.0.1";
   doc["uptime"] = millis();
   doc["nfc_initialized"] = nfcStatus.initialized;
@@ -321,9 +619,167 @@ void handleStatus() {
   doc["total_scans"] = nfcStatus.totalScans;
   doc["successful_reads"] = nfcStatus.successfulReads;
   doc["failed_reads"] = nfcStatus.failedReads;
-  if (mqttPublished) {
-    doc["mqtt_published"] = *mqttPublished;
+  doc["tags_present"] = nfcStatus.tagsPresent;
+  doc["scan_interval_ms"] = nfcStatus.scanInterval;
+  doc["scan_rate"] = nfcStatus.scanRate;
+  doc["detect_latency_ms"] = nfcStatus.lastDetectLatency;
+  doc["detect_latency_avg_ms"] = nfcStatus.avgDetectLatency;
+  doc["nfc_process_max_us"] = nfcStatus.maxProcessTime;
+  doc["nfc_events_dropped"] = nfcStatus.eventsDropped;
+  doc["nfc_events_deferred"] = nfcStatus.eventsDeferred;
+  doc["debounce_mode"] = nfcStatus.debounceMode;
+  doc["protocols"] = config->protocols;
+  doc["protocol"] = nfcProtocolName(nfcStatus.protocol);
+  doc["protocol_switches"] = nfcStatus.protocolSwitches;
+  doc["suppressed_enters"] = nfcStatus.suppressedEnters;
+  doc["suppressed_leaves"] = nfcStatus.suppressedLeaves;
+  doc["mem_cache_hits"] = nfcStatus.memCacheHits;
+  doc["mem_rf_reads"] = nfcStatus.memRfReads;
+  doc["mem_read_errors"] = nfcStatus.memReadErrors;
+  
+  // LPCD idle
+  JsonObject lpcd = doc.createNestedObject("lpcd");
+  lpcd["active"] = nfcStatus.lpcdActive;
+  lpcd["quiet_s"] = config->lpcd_quiet;
+  lpcd["idle_ms"] = nfcStatus.idleTime;
+  lpcd["wakeups"] = nfcStatus.lpcdWakeups;
+  lpcd["false_wakes"] = nfcStatus.lpcdFalseWakes;
+  lpcd["missed"] = nfcStatus.lpcdMissed;
+  lpcd["last_wake_ms"] = nfcStatus.lastWakeLatency;
+  
+  // RF quality - read success per AGC band over the last RF_HIST_WINDOW scans
+  JsonObject rf = doc.createNestedObject("rf");
+  rf["agc"] = nfcStatus.agcValue;
+  rf["agc_min"] = nfcStatus.agcMin;
+  rf["agc_max"] = nfcStatus.agcMax;
+  rf["rx_status"] = nfcStatus.lastRxStatus;
+  rf["integrity_errors"] = nfcStatus.rxIntegrityErrors;
+  rf["protocol_errors"] = nfcStatus.rxProtocolErrors;
+  rf["collisions"] = nfcStatus.rxCollisions;
+  rf["band_base"] = RF_HIST_BASE;
+  rf["band_width"] = 1 << RF_HIST_SHIFT;
+  JsonArray scans = rf.createNestedArray("scans");
+  JsonArray reads = rf.createNestedArray("reads");
+  for (int i = 0; i < RF_HIST_BUCKETS; i++) {
+    scans.add(nfcStatus.rfHistScans[i]);
+    reads.add(nfcStatus.rfHistReads[i]);
+  }
+  
+  // Per-reader breakdown (the fields above are all readers combined)
+  if (NFC_READER_COUNT > 1) {
+    JsonArray readerList = doc.createNestedArray("readers");
+    for (int i = 0; i < NFC_READER_COUNT; i++) {
+      NFCStatus reader = getNFCReaderStatus(i);
+      JsonObject r = readerList.createNestedObject();
+      r["initialized"] = reader.initialized;
+      r["total_scans"] = reader.totalScans;
+      r["successful_reads"] = reader.successfulReads;
+      r["failed_reads"] = reader.failedReads;
+      r["tags_present"] = reader.tagsPresent;
+      r["agc"] = reader.agcValue;
+    }
+  }
+  
+  // Scan trace recorder / replay
+  TraceStatus trace = getNFCTraceStatus();
+  JsonObject traceJson = doc.createNestedObject("trace");
+  traceJson["recording"] = trace.recording;
+  traceJson["replaying"] = trace.replaying;
+  traceJson["records"] = trace.recordsWritten;
+  traceJson["dropped"] = trace.recordsDropped;
+  traceJson["bytes"] = trace.fileBytes;
+  traceJson["replay_records"] = trace.replayRecords;
+  traceJson["replay_ms"] = trace.replayElapsed;
+  
+  // Tag event bus - per-subscriber queues
+  JsonArray bus = doc.createNestedArray("event_bus");
+  TagSubscriberStatus sub;
+  for (uint8_t i = 0; getTagSubscriberStatus(i, &sub); i++) {
+    JsonObject s = bus.createNestedObject();
+    s["name"] = sub.name;
+    s["depth"] = sub.depth;
+    s["max_depth"] = sub.maxDepth;
+    s["delivered"] = sub.delivered;
+    s["dropped"] = sub.dropped;
   }
+  
+  // Latency percentiles (microseconds, since boot)
+  JsonObject latency = doc.createNestedObject("latency_us");
+  addLatencyJson(latency, "inventory", nfcStatus.inventoryTime);
+  addLatencyJson(latency, "scan_jitter", nfcStatus.scanJitter);
+  addLatencyJson(latency, "sighting_to_callback", nfcStatus.callbackLatency);
+  addLatencyJson(latency, "lpcd_wake_to_read", nfcStatus.wakeToRead);
+  doc["mqtt_published"] = getMqttPublishCount();
+  
+  // Publishing (one message per event, or batches on [base]/Batch)
+  MqttPublishStats publish = getMqttPublishStats();
+  JsonObject pub = doc.createNestedObject("mqtt_publish");
+  pub["format"] = (config->mqtt_format == MQTT_FORMAT_BINARY) ? "binary" : "json";
+  pub["batch_ms"] = config->mqtt_batch_ms;
+  pub["batch_max"] = config->mqtt_batch_max;
+  pub["messages"] = publish.messages;
+  pub["events"] = publish.events;
+  pub["bytes"] = publish.bytes;
+  pub["batches"] = publish.batches;
+  pub["events_per_publish"] = publish.eventsPerPublish;
+  pub["publishes_per_s"] = publish.publishRate;
+  pub["qos"] = config->mqtt_qos;
+  
+  // Received messages (dropped by topic filter / byte check, or parsed)
+  MqttReceiveStats rx = getMqttReceiveStats();
+  JsonObject rxJson = doc.createNestedObject("mqtt_receive");
+  rxJson["received"] = rx.received;
+  rxJson["topic_filtered"] = rx.topicFiltered;
+  rxJson["echoes"] = rx.echoes;
+  rxJson["ignored"] = rx.ignored;
+  rxJson["parsed"] = rx.parsed;
+  rxJson["received_per_s"] = rx.receivedRate;
+  rxJson["filtered_per_s"] = rx.filteredRate;
+  rxJson["parsed_per_s"] = rx.parsedRate;
+  
+  // QoS 1 in-flight window (messages waiting for their PUBACK)
+  MqttInflightStats inflight = getMqttInflightStats();
+  JsonObject qos = doc.createNestedObject("mqtt_inflight");
+  qos["window"] = inflight.window;
+  qos["inflight"] = inflight.inflight;
+  qos["bytes"] = inflight.bytes;
+  qos["sent"] = inflight.sent;
+  qos["acked"] = inflight.acked;
+  qos["retransmits"] = inflight.retransmits;
+  qos["window_full"] = inflight.windowFull;
+  qos["ack_last_ms"] = inflight.ackLast;
+  qos["ack_avg_ms"] = inflight.ackAvg;
+  qos["ack_max_ms"] = inflight.ackMax;
+  
+  // Broker connection (non-blocking connect with backoff)
+  MqttConnectionStats conn = getMqttConnectionStats();
+  JsonObject mc = doc.createNestedObject("mqtt_connection");
+  static const char* const connStates[] = { "waiting", "connecting", "connected" };
+  mc["state"] = connStates[conn.state];
+  mc["attempts"] = conn.attempts;
+  mc["connects"] = conn.connects;
+  mc["failures"] = conn.failures;
+  mc["connecting_ms"] = conn.connectingTime;
+  mc["longest_stall_ms"] = conn.longestStall;
+  mc["retry_in_ms"] = conn.retryIn;
+  doc["fleet_sensors"] = getFleetSensorCount();  // Sensors seen on the broker (see /fleet)
+  doc["mqtt_continuing_s"] = config->continuing_interval;
+  doc["mqtt_tags_tracked"] = getTagPresenceCount();  // Tags with Continuing/dwell state
+  doc["mqtt_tags_overflow"] = getTagPresenceOverflows();
+  
+  // Store-and-forward queue (events held while the broker was unreachable)
+  MqttQueueStatus queue = getMqttQueueStatus();
+  JsonObject mq = doc.createNestedObject("mqtt_queue");
+  mq["available"] = queue.available;
+  mq["depth"] = queue.depth;
+  mq["oldest_age_ms"] = queue.oldestAge;
+  mq["oldest_previous_boot"] = queue.oldestPreviousBoot;
+  mq["queued"] = queue.queued;
+  mq["drained"] = queue.drained;
+  mq["dropped"] = queue.dropped;
+  mq["drain_rate"] = queue.drainRate;
+  doc["free_heap"] = ESP.getFreeHeap();
+  doc["max_alloc_heap"] = ESP.getMaxAllocHeap();  // Largest free block (fragmentation)
   doc["wifi_ssid"] = WiFi.SSID();
   doc["ip"] = WiFi.localIP().toString();
   if (mqttClient) {
@@ -334,3 +790,74 @@ void handleStatus() {
   serializeJson(doc, json);
   webServer->send(200, "application/json", json);
 }
+
+void webTagEvent(const TagEventInfo& event) {
+  if (event.event == TAG_PRESENT) return;  // Enter/leave only
+  eventLog[eventLogCount % WEB_EVENT_LOG] = event;
+  eventLogCount++;
+}
+
+// Recent tag enter/leave events, newest first
+void handleEvents() {
+  if (!webServer) return;
+  
+  StaticJsonDocument<2560> doc;
+  doc["total"] = eventLogCount;
+  JsonArray events = doc.createNestedArray("events");
+  
+  unsigned long now = millis();
+  char uidStr[TAG_UID_HEX_LEN];
+  uint32_t count = min(eventLogCount, (uint32_t)WEB_EVENT_LOG);
+  for (uint32_t i = 0; i < count; i++) {
+    const TagEventInfo& event = eventLog[(eventLogCount - 1 - i) % WEB_EVENT_LOG];
+    JsonObject e = events.createNestedObject();
+    e["uid"] = (char*)event.uid.toHex(uidStr);  // char* is copied; a const char* would be linked to uidStr
+    e["event"] = (event.event == TAG_ENTER) ? "enter" : "leave";
+    e["reader"] = event.reader;
+    e["protocol"] = nfcProtocolName(event.protocol);
+    e["age_ms"] = now - event.time;
+  }
+  
+  String json;
+  serializeJson(doc, json);
+  webServer->send(200, "application/json", json);
+}
+
+// Per-sensor statistics from MQTT traffic. Up to 255 sensors don't fit one
+// JSON document, so each sensor is serialized on its own and streamed
+void handleFleet() {
+  if (!webServer) return;
+  
+  webServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  webServer->send(200, "application/json", "");
+  
+  char buffer[192];
+  snprintf(buffer, sizeof(buffer), "{\"count\":%u,\"silent_ms\":%u,\"sensors\":[",
+           getFleetSensorCount(), FLEET_SILENT_MS);
+  webServer->sendContent(buffer);
+  
+  bool first = true;
+  FleetSensorStats s;
+  for (int id = 0; id < FLEET_SENSORS; id++) {
+    if (!getFleetSensor(id, &s)) continue;
+    
+    StaticJsonDocument<256> doc;
+    doc["s"] = s.sensor;
+    doc["R"] = s.reads;
+    doc["C"] = s.continuing;
+    doc["U"] = s.unreads;
+    doc["rate_1s"] = s.rate1;
+    doc["rate_10s"] = s.rate10;
+    doc["rate_60s"] = s.rate60;
+    doc["last_seen_ms"] = s.lastSeenAge;
+    
+    size_t length = 0;
+    if (!first) buffer[length++] = ',';
+    length += serializeJson(doc, &buffer[length], sizeof(buffer) - length);
+    webServer->sendContent(buffer, length);
+    first = false;
+  }
+  
+  webServer->sendContent("]}");
+  webServer->sendContent("");  // End of chunked response
+}
@@ -11,6 +11,10 @@
 #include <Arduino.h>
 #include <WebServer.h>
 #include <WiFi.h>
+#include "nfc_reader.h"
+
+#define WEB_EVENT_LOG 16  // Recent tag enter/leave events kept for /events
+#define WEB_STATUS_JSON_SIZE 4352  // JSON document for /status
 
 // Configuration structure (shared with main)
 struct Config {
@@ -21,6 +25,24 @@ struct Config {
   char mqtt_base_topic[64];
   char mqtt_subscribe_topic[64];
   uint8_t sensor_id;
+  uint16_t scan_min_interval;
+  uint16_t scan_max_interval;
+  uint8_t debounce_mode;
+  uint8_t debounce_enter;
+  uint8_t debounce_window;
+  uint8_t debounce_leave;
+  uint8_t debounce_timeout;
+  uint8_t mqtt_tag_memory;   // 1 = add tag memory hex ("m") to Read messages
+  uint16_t lpcd_quiet;       // Seconds of empty field before LPCD idle (0 = off)
+  uint8_t protocols;         // Protocols to scan (NFC_PROTOCOL_BIT mask)
+  uint16_t continuing_interval;  // Seconds between Continuing messages per tag (0 = off)
+  uint16_t mqtt_batch_ms;    // Batch window in ms (0 = one message per event)
+  uint8_t mqtt_batch_max;    // Events per batch (1..MQTT_BATCH_MAX)
+  uint8_t mqtt_format;       // MQTT_FORMAT_JSON or MQTT_FORMAT_BINARY
+  uint8_t mqtt_qos;          // 0, or 1 = wait for PUBACK (see mqtt_inflight.h)
+  uint8_t mqtt_inflight;     // QoS 1 messages outstanding at once (1..MQTT_INFLIGHT_MAX)
+  char mqtt_rx_filter[96];   // Received topic allow/deny patterns (see mqtt_filter.h)
+  uint8_t display_page;      // DISPLAY_PAGE_MAIN, _FLEET or _CYCLE
 };
 
 // Initialize web server
@@ -31,6 +53,13 @@ void handleRoot();
 void handleConfig();
 void handleConfigSave();
 void handleStatus();
+void handleTraceDownload();
+void handleTraceControl();
+void handleEvents();
+void handleFleet();
+
+// Tag event bus subscriber - keeps the recent events for /events
+void webTagEvent(const TagEventInfo& event);
 
 // Set configuration pointer (so web server can access config)
 void setWebServerConfig(Config* cfg);
@@ -38,9 +67,6 @@ void setWebServerConfig(Config* cfg);
 // Set MQTT client pointer (for status reporting)
 void setWebServerMqttClient(void* client);
 
-// Set MQTT published count pointer
-void setWebServerMqttPublished(uint32_t* counter);
-
 // Set config save callback (called after config is saved via web)
 void setConfigSaveCallback(void (*callback)());
 